@@ -1,7 +1,7 @@
 "use strict";
 
-// C library API
-const ffi = require("ffi-napi");
+// C library API, every call runs on a pool of worker threads
+const ParserPool = require("./parserPool");
 
 // Express App (Routes)
 const express = require("express");
@@ -89,343 +89,612 @@ app.get("/endpoint1", function (req, res) {
 app.listen(portNum);
 console.log("Running app at localhost: " + portNum);
 
-// Creating an object called sharedLib that will contain the C functions
-let sharedLib = ffi.Library("./libgpxparser", {
-	GPXFiletoJSON: ["string", ["string"]],
-	GPXFiletoRouteListJSON: ["string", ["string"]],
-	GPXFiletoTrackListJSON: ["string", ["string"]],
-	GPXFiletoRouteGPXDataListJSON: ["string", ["string"]],
-	GPXFiletoTrackGPXDataListJSON: ["string", ["string"]],
-	renameGPXComponent: ["int", ["string", "string", "string", "int"]],
-	createGPXFile: ["int", ["string", "string"]],
-	addRouteToFile: ["int", ["string", "string"]],
-	addWaypointToRoute: ["int", ["string", "string"]],
-	routeListOfRoutesBetween: [
-		"string",
-		["string", "float", "float", "float", "float", "float"],
-	],
-	trackListOfRoutesBetween: [
-		"string",
-		["string", "float", "float", "float", "float", "float"],
-	],
-	numberOfRoutesWithLengthFromFile: ["int", ["string", "float", "float"]],
-	numberOfTracksWithLengthFromFile: ["int", ["string", "float", "float"]],
+// Creating the pool of worker threads that run the C functions, its size, queue length and timeout can be set from the environment
+const parserPool = new ParserPool({
+	size: parseInt(process.env.PARSER_WORKERS),
+	maxQueue: parseInt(process.env.PARSER_QUEUE),
+	timeout: parseInt(process.env.PARSER_TIMEOUT),
 });
 
-// Respond to get request to get the attributes of GPX file, sending an array of GPX attributes attached with their respective file names
-app.get("/GPXattributes", function (req, res) {
-	// Reads all the files in the uploads directory
-	let files = fs.readdirSync("uploads");
-	let JSONObjectArray = [];
-	let failedUploads = [];
-
-	// Traverses through each file name concatenating the "uploads/" directory so the file could be opened by apps.js
-	files.forEach((file) => {
-		let filePath = "uploads/" + file;
-
-		// Calls on the C function to take in the file name and getting the GPX attributes as a JSON string then parsing it as an object and adding it onto the array of objects
-		// Also adds the file name of the current GPX file onto the JSON object as a key value pair
-		let parsedJSON;
-		let JSONString = sharedLib.GPXFiletoJSON(filePath);
-		if (JSONString !== "{}") {
-			parsedJSON = JSON.parse(JSONString.replace("\n", "\\n"));
-			parsedJSON.fileName = file;
-			JSONObjectArray.push(parsedJSON);
-			// Else the file was invalid and is removed from uploads with an error message and appends it to the array of failed files
-		} else {
-			console.log(`File failed to upload and was removed: ${file}`);
-			fs.unlinkSync(filePath);
-			failedUploads.push(file);
-		}
-	});
-
-	// Sending the array of JSON strings and array of files that failed to validate
-	console.log("Sending data from /GPXattributes endpoint");
-	res.send({
-		JSONObjectArray: JSONObjectArray,
-		failedUploads: failedUploads,
-	});
-});
-
-// Responds to get request to get the component data of a speecific file, sending an array containing routes and tracks objects in JSON format for each file
-app.get("/componentData", function (req, res) {
-	// Reads all the files in the uploads directory
-	let files = fs.readdirSync("uploads");
-	let JSONFileArrayRoutes = [];
-	let JSONFileArrayTracks = [];
-
-	// Traverses through each file name concatenating the "uploads/" directory so the file could be opened by apps.js
-	files.forEach((file) => {
-		let filePath = "uploads/" + file;
-
-		// Calls on the C function to take in the file name and getting array of JSON strings containing routes for that specific file and parsing it into an object
-		let JSONArray = sharedLib.GPXFiletoRouteListJSON(filePath);
-		let parsedJSONArray = JSON.parse(JSONArray.replace("\n", "\\n"));
-
-		// Traverses through each JSON string and adding the respective file name as a key value pair
-		parsedJSONArray.forEach((JSONString) => {
-			JSONString.fileName = file;
+// Creating an object called sharedLib whose C functions return promises of their results from the pool
+let sharedLib = new Proxy(
+	{},
+	{ get: (target, name) => (...args) => parserPool.call(name, args) }
+);
+
+// Function that wraps an endpoint using the parser pool, answering 503 when the pool is full and 504 when a call timed out
+function parserEndpoint(handler) {
+	return function (req, res) {
+		handler(req, res).catch((error) => {
+			console.log(`Responding to ${req.path} failed: ${error.message}`);
+			if (res.headersSent) {
+				res.end();
+			} else if (error.code === "PARSER_BUSY") {
+				res.set("Retry-After", "1");
+				res.status(503).send({ error: error.message });
+			} else if (error.code === "PARSER_TIMEOUT") {
+				res.status(504).send({ error: error.message });
+			} else {
+				res.status(500).send({ error: error.message });
+			}
 		});
+	};
+}
+
+// The Node-API addon builds results straight into JS objects and loads files on the libuv threadpool, it is built by "make addon" in parser/
+// When it has not been built, the ffi-napi wrappers and JSON strings are used instead
+let addon = null;
+try {
+	addon = require("./gpxaddon.node");
+} catch (error) {
+	console.log("gpxaddon.node was not found, using the ffi-napi wrappers");
+}
+
+// Function that returns a promise of the summary of one file in the directory, or null if the file is invalid
+function summarizeFile(directory, fileName) {
+	if (addon !== null) {
+		return addon.fileSummaryAsync(directory, fileName);
+	}
+	return sharedLib
+		.summaryOfFile(directory, fileName)
+		.then((JSONString) =>
+			JSONString === "{}" ? null : JSON.parse(JSONString)
+		);
+}
+
+// Summaries of the files already summarized, by path with the size and modification time of the file they were made from
+// A file is only loaded again once it has changed, so listing the uploads after one upload or rename only loads that file
+let fileSummaries = new Map();
+
+// Function that returns a promise of the summary of one file like summarizeFile, reusing the summary made before if the file has not changed since
+function cachedFileSummary(directory, fileName) {
+	let filePath = path.join(directory, fileName);
+	let stat = fs.statSync(filePath);
+	let version = `${stat.size}:${stat.mtimeMs}`;
+	let cached = fileSummaries.get(filePath);
+	if (cached !== undefined && cached.version === version) {
+		return cached.summary;
+	}
 
-		// Adds the array of routes for the current file to the array containing all the file routes
-		JSONFileArrayRoutes.push(parsedJSONArray);
+	// The promise is kept rather than the summary, so requests arriving while the file loads share it, a failed call is not kept
+	let summary = summarizeFile(directory, fileName);
+	fileSummaries.set(filePath, { version: version, summary: summary });
+	summary.catch(() => {
+		let current = fileSummaries.get(filePath);
+		if (current !== undefined && current.summary === summary) {
+			fileSummaries.delete(filePath);
+		}
 	});
+	return summary;
+}
+
+// Function that summarizes every file in the directory in parallel, passing each result to onResult in file order as soon as it and the files before it are done
+// Only as many files as there are workers are loading at once, so other requests are not stuck behind a large directory
+async function forEachFileSummary(directory, onResult) {
+	let files = fs.readdirSync(directory);
+	let pending = [];
+	let nextFile = 0;
+
+	// Forgetting the summaries of files that are no longer in the directory
+	for (let filePath of fileSummaries.keys()) {
+		if (path.dirname(filePath) === path.normalize(directory) && !files.includes(path.basename(filePath))) {
+			fileSummaries.delete(filePath);
+		}
+	}
 
-	// Traverses through each file nam concatenating the "uploads/" directory sot he file could be opened by apps.js
-	files.forEach((file) => {
-		let filePath = "uploads/" + file;
-
-		// Calls on the C funciton to take in the file name and getting array of JSON strings containing tracks for that specific file and parsing it into an object
-		let JSONArray = sharedLib.GPXFiletoTrackListJSON(filePath);
-		let parsedJSONArray = JSON.parse(JSONArray.replace("\n", "\\n"));
+	// Starts summarizing the next file, keeping a failed call as the result instead of stopping the listing
+	function startNextFile() {
+		if (nextFile < files.length) {
+			let fileName = files[nextFile++];
+			pending.push(
+				Promise.resolve()
+					.then(() => cachedFileSummary(directory, fileName))
+					.then(
+						(summary) => ({ fileName: fileName, summary: summary }),
+						(error) => ({ fileName: fileName, error: error })
+					)
+			);
+		}
+	}
+	for (let i = 0; i < parserPool.size; i++) {
+		startNextFile();
+	}
 
-		// Traverses through each JSON string and adding the respective file name as a key value pair
-		parsedJSONArray.forEach((JSONString) => {
-			JSONString.fileName = file;
+	while (pending.length > 0) {
+		let result = await pending.shift();
+		startNextFile();
+		onResult(result);
+	}
+}
+
+// Responds to get request, sending the summary of every file in the uploads directory with their routes and tracks, the page builds both of its tables from it
+app.get(
+	"/uploadsSummary",
+	parserEndpoint(async function (req, res) {
+		let numSent = 0;
+		let failedFiles = [];
+
+		// The summary of each file is streamed as soon as it is ready, the client still receives a single JSON object
+		console.log("Responding to get request to get the summary of every uploaded file");
+		res.type("json");
+		res.write(`{"files":[`);
+		await forEachFileSummary("uploads", (result) => {
+			// A file that could not be loaded in time is left in uploads and listed on the next request
+			if (result.error !== undefined) {
+				console.log(`File could not be loaded: ${result.fileName}, ${result.error.message}`);
+			}
+			// The files that were invalid are removed from uploads with an error message and added to the array of failed files
+			else if (result.summary === null) {
+				console.log(`File failed to upload and was removed: ${result.fileName}`);
+				fs.unlinkSync("uploads/" + result.fileName);
+				fileSummaries.delete(path.join("uploads", result.fileName));
+				failedFiles.push(result.fileName);
+			} else {
+				res.write((numSent++ > 0 ? "," : "") + JSON.stringify(result.summary));
+			}
 		});
 
-		// Adds the array of tracks for the current file to the array containing all the file tracks
-		JSONFileArrayTracks.push(parsedJSONArray);
-	});
-
-	// Sending the array of an array of JSON strings for the routes and tracks of each respective file
-	console.log("Sending data from /componentData endpoint");
-	res.send({
-		routeData: JSONFileArrayRoutes,
-		trackData: JSONFileArrayTracks,
-	});
-});
+		// Finishing the array of summaries with the array of files that failed to validate
+		res.end(`],"failedFiles":${JSON.stringify(failedFiles)}}`);
+	})
+);
+
+// Function that sends JSON written by the addon straight into the response one chunk at a time, so the whole of it is never held in memory
+// Without the addon the JSON string from the parser pool is sent instead
+async function sendStreamedJSON(res, type, stream, fallback) {
+	res.type(type);
+	if (addon === null) {
+		res.send(await fallback());
+		return;
+	}
+	await stream((chunk) => res.write(chunk));
+	res.end();
+}
+
+// Responds to get request, exporting the waypoints, routes and tracks of the file chosen by the user as GeoJSON
+app.get(
+	"/exportGeometry",
+	parserEndpoint(async function (req, res) {
+		let fileName = "uploads/" + path.basename(req.query.fileName || "");
+
+		console.log(`Responding to get request to export the geometry of ${fileName}`);
+		res.attachment(path.basename(fileName, ".gpx") + ".geojson");
+		await sendStreamedJSON(
+			res,
+			"application/geo+json",
+			(onChunk) => addon.streamGeometry(fileName, onChunk),
+			() => sharedLib.geometryOfFile(fileName)
+		);
+	})
+);
 
 // Responds to a get request to get the other data of a specific component of a specific file
-app.get("/otherData", function (req, res) {
-	// Variable to hold the array of JSON strings containing other data for the specific component specified by the user
-	let otherDataArray = [];
-
-	// If the component includes "Route" means that the user chose to view a routes other data
-	if (req.query.componentChosen.includes("Route")) {
-		// Gets the array of another array containing objects for all the routes in the file currently being viewed by the user (each index of outer array holds an array containing each other data point at every index)
-		let routesOtherDataArray = sharedLib.GPXFiletoRouteGPXDataListJSON(
-			`uploads/${req.query.fileName}`
-		);
+app.get(
+	"/otherData",
+	parserEndpoint(async function (req, res) {
+		// Variable to hold the array of JSON strings containing other data for the specific component specified by the user
+		let otherDataArray = [];
+
+		// If the component includes "Route" means that the user chose to view a routes other data
+		if (req.query.componentChosen.includes("Route")) {
+			// Gets the array of another array containing objects for all the routes in the file currently being viewed by the user (each index of outer array holds an array containing each other data point at every index)
+			let routesOtherDataArray = await sharedLib.GPXFiletoRouteGPXDataListJSON(
+				`uploads/${req.query.fileName}`
+			);
 
-		// Gets the specific route the user wants to view for other data
-		let routeNumber = req.query.componentChosen[6];
+			// Gets the specific route the user wants to view for other data
+			let routeNumber = req.query.componentChosen[6];
 
-		// Parsing the routesOtherDataArray to create an array that holds data for each route at each index and "\n" is a special character to JSON.parse so must escape with "\\n"
-		routesOtherDataArray = routesOtherDataArray.replace("\n", "\\n");
-		let routesOtherData = JSON.parse(routesOtherDataArray);
+			// Parsing the routesOtherDataArray to create an array that holds data for each route at each index, the parser escapes the values so they parse as is
+			let routesOtherData = JSON.parse(routesOtherDataArray);
 
-		// Getting the array of JSON strings representing for the route chosen by the user and setting otherDataArray equal to it
-		otherDataArray = routesOtherData[routeNumber - 1];
+			// Getting the array of JSON strings representing for the route chosen by the user and setting otherDataArray equal to it
+			otherDataArray = routesOtherData[routeNumber - 1];
 
-		// If the component includes "Track" means that the user chose to view a tracks other data
-	} else if (req.query.componentChosen.includes("Track")) {
-		// Gets the array of another array containing objects for all the tracks in the file currently being viewed by the user
-		let tracksOtherDataArray = sharedLib.GPXFiletoTrackGPXDataListJSON(
-			`uploads/${req.query.fileName}`
-		);
-		// Gets the specific track the user wants to view for other data
-		let trackNumber = req.query.componentChosen[6];
+			// If the component includes "Track" means that the user chose to view a tracks other data
+		} else if (req.query.componentChosen.includes("Track")) {
+			// Gets the array of another array containing objects for all the tracks in the file currently being viewed by the user
+			let tracksOtherDataArray = await sharedLib.GPXFiletoTrackGPXDataListJSON(
+				`uploads/${req.query.fileName}`
+			);
+			// Gets the specific track the user wants to view for other data
+			let trackNumber = req.query.componentChosen[6];
 
-		// Parsing the tracksOtherDataArray to create an array that holds data for each track at each index and "\n" is a special character to JSON.parse so must escape with "\\n"
-		tracksOtherDataArray = tracksOtherDataArray.replace("\n", "\\n");
-		let tracksOtherData = JSON.parse(tracksOtherDataArray);
+			// Parsing the tracksOtherDataArray to create an array that holds data for each track at each index, the parser escapes the values so they parse as is
+			let tracksOtherData = JSON.parse(tracksOtherDataArray);
 
-		// Getting the array of JSON strings representing other data for the track chosen by the user setting otherDataArray equal to it
-		otherDataArray = tracksOtherData[trackNumber - 1];
-	}
+			// Getting the array of JSON strings representing other data for the track chosen by the user setting otherDataArray equal to it
+			otherDataArray = tracksOtherData[trackNumber - 1];
+		}
 
-	// Sending the array of JSON strings holding the other data for the component specified by the user in the file specified by the user
-	console.log("Sending data from /OtherData endpoint");
-	res.send(otherDataArray);
-});
+		// Sending the array of JSON strings holding the other data for the component specified by the user in the file specified by the user
+		console.log("Sending data from /OtherData endpoint");
+		res.send(otherDataArray);
+	})
+);
 
 // Responds to a get request to rename a specific component specified by the user
-app.get("/Rename", function (req, res) {
-	// Calls on the renameGPXComponent to rename the component specified by the user
-	let returnValue = sharedLib.renameGPXComponent(
-		`uploads/${req.query.fileName}`,
-		req.query.newName,
-		req.query.componentType,
-		req.query.componentNumber
-	);
+app.get(
+	"/Rename",
+	parserEndpoint(async function (req, res) {
+		// Calls on the renameGPXComponent to rename the component specified by the user
+		let returnValue = await sharedLib.renameGPXComponent(
+			`uploads/${req.query.fileName}`,
+			req.query.newName,
+			req.query.componentType,
+			req.query.componentNumber
+		);
 
-	// Checks the returnValue of renameGPXComponent
-	let status = "";
-	// If the returnValue is 1, stores "SUCCESS" in the JSON string meaning the rename succeeded
-	if (returnValue == 1) {
-		status = `{"status":"SUCCESS"}`;
-	}
-	// If the returnValue is 0, stores "FAIL" in the JSON string meaning the rename failed
-	else {
-		status = `{"status":"FAIL"}`;
-	}
-	// Parses the JSON string and sends it back
-	status = JSON.parse(status);
-	console.log("Sending data from /Rename endpoint");
-	res.send(status);
-});
+		// Checks the returnValue of renameGPXComponent
+		let status = "";
+		// If the returnValue is 1, stores "SUCCESS" in the JSON string meaning the rename succeeded
+		if (returnValue == 1) {
+			status = `{"status":"SUCCESS"}`;
+		}
+		// If the returnValue is 0, stores "FAIL" in the JSON string meaning the rename failed
+		else {
+			status = `{"status":"FAIL"}`;
+		}
+		// Parses the JSON string and sends it back
+		status = JSON.parse(status);
+		console.log("Sending data from /Rename endpoint");
+		res.send(status);
+	})
+);
 
 // Makes it so that any form data is parsed as form data is sent through the body of the post request for "/createGPX"
 app.use(express.urlencoded({ extended: true }));
 // Responds to the post request, creating the GPX file with the values specified by the user and sending back the status
-app.post("/createGPX", function (req, res) {
-	// Creates a new object to store the version and creator entered by the user
-	let fileObject = { version: 1.1, creator: req.body.creator };
-
-	// Creates a new GPX file with the inputs from the user writing it to the uploads directory
-	let returnValue = sharedLib.createGPXFile(
-		JSON.stringify(fileObject),
-		"uploads/" + req.body.fileName
-	);
-
-	// If returnValue is 1, the writing succeeded and responds with success
-	if (returnValue === 1) {
-		console.log(
-			"Responding to post request to create a new GPX file, SUCCESS\n"
+app.post(
+	"/createGPX",
+	parserEndpoint(async function (req, res) {
+		// Creates a new object to store the version and creator entered by the user
+		let fileObject = { version: 1.1, creator: req.body.creator };
+
+		// Creates a new GPX file with the inputs from the user writing it to the uploads directory
+		let returnValue = await sharedLib.createGPXFile(
+			JSON.stringify(fileObject),
+			"uploads/" + req.body.fileName
 		);
-		res.send("SUCCESS");
-	}
-	// Else, the writing failed and responds with failure
-	else {
-		console.log("Responding to post request to create a new GPX file, FAIL\n");
-		res.send("FAIL");
-	}
-});
-
-// Responds to post request, adding the route to the GPX file specified with values specified by the user and sending back the status
-app.post("/routeCreate", function (req, res) {
-	// Adds the route specified by the user to the file at the end
-	let returnValue = sharedLib.addRouteToFile(
-		"uploads/" + req.body.fileName,
-		req.body.routeName
-	);
 
-	// If returnValue is 0, means adding route failed and sends FAIL
-	if (returnValue === 0) {
-		console.log(
-			"Responding to post request to add a route to the specified GPX file, FAIL"
-		);
-	}
-	// If adding the route to the GPX file succeeded, responds with SUCCESS
-	else {
-		console.log(
-			"Responding to post request to add a route to the specified GPX file, SUCCESS"
-		);
-		res.send("SUCCESS");
-	}
-});
-
-// Responds to post request, adding waypoints to the route previously added to the specified GPX file and sends back the status
-app.post("/addWaypoint", function (req, res) {
-	// Adds the waypoints entered by the user to the file at the last route which is the route that was added above
-	req.body.waypoint.forEach((waypoints) => {
-		let returnValue = sharedLib.addWaypointToRoute(
+		// If returnValue is 1, the writing succeeded and responds with success
+		if (returnValue === 1) {
+			console.log(
+				"Responding to post request to create a new GPX file, SUCCESS\n"
+			);
+			res.send("SUCCESS");
+		}
+		// Else, the writing failed and responds with failure
+		else {
+			console.log("Responding to post request to create a new GPX file, FAIL\n");
+			res.send("FAIL");
+		}
+	})
+);
+
+// Responds to post request, adding the routes, along with their waypoints, to the GPX file specified with values specified by the user and sending back the status
+app.post(
+	"/routeCreate",
+	parserEndpoint(async function (req, res) {
+		// Adds the routes specified by the user to the end of the file, the file is only loaded and written once for all of them
+		let returnValue = await sharedLib.addRoutesToFile(
 			"uploads/" + req.body.fileName,
-			JSON.stringify(waypoints)
+			req.body.routes
 		);
-		// If the returnValue for adding a waypoint to the route is 0, means adding the waypoint to the route failed and sends FAIL
+
+		// If returnValue is 0, means adding the routes failed and sends FAIL
 		if (returnValue === 0) {
 			console.log(
-				"Responding to post request to add a waypoint to the route in the specified GPX file, FAIL"
+				"Responding to post request to add a route to the specified GPX file, FAIL"
 			);
 			res.send("FAIL");
 		}
-	});
+		// If adding the routes to the GPX file succeeded, responds with SUCCESS
+		else {
+			console.log(
+				"Responding to post request to add a route to the specified GPX file, SUCCESS"
+			);
+			res.send("SUCCESS");
+		}
+	})
+);
 
-	// If all the waypoints added to the route properly, sends SUCCESS
-	console.log(
-		"Responding to post request to add a waypoint to the route in the specified GPX file, SUCCESS"
-	);
-	res.send("SUCCESS");
-});
+// Responds to post request, adding waypoints to the route previously added to the specified GPX file and sends back the status
+app.post(
+	"/addWaypoint",
+	parserEndpoint(async function (req, res) {
+		// Adds the waypoints entered by the user to the file at the last route which is the route that was added above
+		// The waypoints are added one after the other so they keep their order in the route
+		for (let waypoints of req.body.waypoint) {
+			let returnValue = await sharedLib.addWaypointToRoute(
+				"uploads/" + req.body.fileName,
+				JSON.stringify(waypoints)
+			);
+			// If the returnValue for adding a waypoint to the route is 0, means adding the waypoint to the route failed and sends FAIL
+			if (returnValue === 0) {
+				console.log(
+					"Responding to post request to add a waypoint to the route in the specified GPX file, FAIL"
+				);
+				res.send("FAIL");
+				return;
+			}
+		}
+
+		// If all the waypoints added to the route properly, sends SUCCESS
+		console.log(
+			"Responding to post request to add a waypoint to the route in the specified GPX file, SUCCESS"
+		);
+		res.send("SUCCESS");
+	})
+);
 
 // Responds to get request, getting all the routes and tracks between the source and dest latitude/longitude entered by the user
-app.get("/findPath", function (req, res) {
-	// Stores all the file names inside the "uploads" directory
-	let files = fs.readdirSync("uploads");
-
-	// Variables to hold the routes and tracks between the points
-	let routeListArray = [];
-	let trackListArray = [];
-
-	// Traverses through all the files
-	files.forEach((file) => {
-		// Gets the list of routes that are between the source and dest within the comparison accuracy
-		let routeList = sharedLib.routeListOfRoutesBetween(
-			"uploads/" + file,
+app.get(
+	"/findPath",
+	parserEndpoint(async function (req, res) {
+		// Both between-queries are run in one batch, so every file in the "uploads" directory is only loaded once
+		let between = [
 			req.query.sourceLat,
 			req.query.sourceLon,
 			req.query.destLat,
 			req.query.destLon,
-			req.query.delta
+			req.query.delta,
+		]
+			.map((value) => parseFloat(value))
+			.join(" ");
+		let results = JSON.parse(
+			await sharedLib.batchDirectory(
+				"uploads",
+				`routesBetween ${between};tracksBetween ${between}`
+			)
 		);
 
-		// Gets the list of tracks that are between the source and dest within the comparison accuracy
-		let trackList = sharedLib.trackListOfRoutesBetween(
-			"uploads/" + file,
-			req.query.sourceLat,
-			req.query.sourceLon,
-			req.query.destLat,
-			req.query.destLon,
-			req.query.delta
+		// Variables to hold the routes and tracks between the points, kept as arrays of JSON strings for the client
+		let routeListArray = [];
+		let trackListArray = [];
+		if (results.length === 2 && results[0].length > 0) {
+			routeListArray.push(JSON.stringify(results[0]));
+		}
+		if (results.length === 2 && results[1].length > 0) {
+			trackListArray.push(JSON.stringify(results[1]));
+		}
+
+		// Sends a successful response message to the server console and sends the array of routes and tracks containing JSON strings containing routes and tracks between the user inputs
+		console.log(
+			"Responding to get request to get all routes and tracks between the source and dest entered by the user, SUCCESS"
+		);
+		// Sends the two arrays containing routes and tracks between the two points given by the user
+		res.send({
+			routeList: routeListArray,
+			trackList: trackListArray,
+		});
+	})
+);
+
+// Responds to get request, getting all the routes and tracks whose path passes within delta meters of the source, and of the dest afterwards if one was entered
+app.get(
+	"/findPathAlong",
+	parserEndpoint(async function (req, res) {
+		// The dest is optional, without it any component passing near the source is returned
+		let throughDest =
+			req.query.destLat !== undefined && req.query.destLon !== undefined ? 1 : 0;
+
+		// A missing or non numeric source or delta would reach the parser as NaN, so the request is refused before any file is read
+		let required = [req.query.sourceLat, req.query.sourceLon, req.query.delta];
+		if (throughDest === 1) {
+			required.push(req.query.destLat, req.query.destLon);
+		}
+		if (required.some((value) => !Number.isFinite(parseFloat(value)))) {
+			console.log(
+				"Responding to get request to get all routes and tracks passing the points entered by the user, FAIL"
+			);
+			return res
+				.status(400)
+				.send({ error: "sourceLat, sourceLon and delta must be numbers, and so must destLat and destLon when given" });
+		}
+
+		// Both queries are run in one batch, so every file in the "uploads" directory is only loaded once and one index is searched
+		let along =
+			throughDest === 1
+				? [
+						req.query.sourceLat,
+						req.query.sourceLon,
+						req.query.destLat,
+						req.query.destLon,
+						req.query.delta,
+				  ]
+				: [req.query.sourceLat, req.query.sourceLon, req.query.delta];
+		along = along.map((value) => parseFloat(value)).join(" ");
+		let kind = throughDest === 1 ? "Through" : "Near";
+		let results = JSON.parse(
+			await sharedLib.batchDirectory(
+				"uploads",
+				`routes${kind} ${along};tracks${kind} ${along}`
+			)
 		);
 
-		// If both list are not empty, adds it to the respective route or track list array
-		if (routeList !== "[]") {
-			routeListArray.push(routeList);
+		// Variables to hold the routes and tracks passing the points, kept as arrays of JSON strings for the client
+		let routeListArray = [];
+		let trackListArray = [];
+		if (results.length === 2 && results[0].length > 0) {
+			routeListArray.push(JSON.stringify(results[0]));
 		}
-		if (trackList !== "[]") {
-			trackListArray.push(trackList);
+		if (results.length === 2 && results[1].length > 0) {
+			trackListArray.push(JSON.stringify(results[1]));
 		}
-	});
 
-	// Sends a successful response message to the server console and sends the array of routes and tracks containing JSON strings containing routes and tracks between the user inputs
-	console.log(
-		"Responding to get request to get all routes and tracks between the source and dest entered by the user, SUCCESS"
-	);
-	// Sends the two arrays containing routes and tracks between the two points given by the user
-	res.send({
-		routeList: routeListArray,
-		trackList: trackListArray,
-	});
-});
+		console.log(
+			"Responding to get request to get all routes and tracks passing the points entered by the user, SUCCESS"
+		);
+		res.send({
+			routeList: routeListArray,
+			trackList: trackListArray,
+		});
+	})
+);
+
+// Responds to get request, getting every waypoint, route and track across all the files that enters the polygon sent by the user
+app.get(
+	"/geofence",
+	parserEndpoint(async function (req, res) {
+		// The polygon is a GeoJSON style list of rings of [longitude, latitude] positions
+		let matches = JSON.parse(
+			await sharedLib.geofenceOfDirectory("uploads", req.query.polygon)
+		);
 
-// Responds to get request, getting the number of routes and tracks with the length inputted by the user with a delta of 10m
-app.get("/numberOfRoutesAndTracksWithLen", function (req, res) {
-	// Stores all the file names inside the "uploads" directory
-	let files = fs.readdirSync("uploads");
+		console.log(
+			"Responding to get request to get all components inside the polygon entered by the user, SUCCESS"
+		);
+		res.send({
+			components: matches,
+		});
+	})
+);
+
+// Responds to get request, getting the speed, moving time and elevation statistics of every track in the file chosen by the user
+app.get(
+	"/trackStats",
+	parserEndpoint(async function (req, res) {
+		// The stop speed (m/s) and elevation hysteresis (m) are optional, -1 lets the parser use its defaults
+		let stopSpeed =
+			req.query.stopSpeed !== undefined ? parseFloat(req.query.stopSpeed) : -1;
+		let hysteresis =
+			req.query.hysteresis !== undefined ? parseFloat(req.query.hysteresis) : -1;
+		let stats = JSON.parse(
+			await sharedLib.trackStatsOfFile(
+				`uploads/${req.query.fileName}`,
+				isNaN(stopSpeed) ? -1 : stopSpeed,
+				isNaN(hysteresis) ? -1 : hysteresis
+			)
+		);
+
+		console.log(
+			"Responding to get request to get the track statistics of the file chosen by the user, SUCCESS"
+		);
+		res.send({
+			trackStats: stats,
+		});
+	})
+);
+
+// Responds to get request, getting every track across all the files that was recorded at some point between the start and end times sent by the user
+app.get(
+	"/tracksActive",
+	parserEndpoint(async function (req, res) {
+		// The times are ISO 8601 strings such as 2021-03-04T05:06:07Z
+		let tracks = JSON.parse(
+			await sharedLib.tracksActiveInDirectory("uploads", req.query.start, req.query.end)
+		);
 
-	// Variables to store the number of routes and tracks with the specified length
-	let numRoutes = 0;
-	let numTracks = 0;
+		console.log(
+			"Responding to get request to get all tracks active between the times entered by the user, SUCCESS"
+		);
+		res.send({
+			trackList: tracks,
+		});
+	})
+);
+
+// Responds to get request, getting the runs of track points across all the files that were recorded between the start and end times sent by the user
+app.get(
+	"/pointsInTimeWindow",
+	parserEndpoint(async function (req, res) {
+		let tracks = JSON.parse(
+			await sharedLib.pointsInTimeWindowOfDirectory(
+				"uploads",
+				req.query.start,
+				req.query.end
+			)
+		);
 
-	// Traverses through all the files in the uploads directory
-	files.forEach((file) => {
-		// If the routeLen doesn't equal 0, that means the user inputted a length to search for in the routes
-		if (req.query.routeLen != 0) {
-			numRoutes += sharedLib.numberOfRoutesWithLengthFromFile(
-				"uploads/" + file,
-				req.query.routeLen,
-				10
+		console.log(
+			"Responding to get request to get all track points between the times entered by the user, SUCCESS"
+		);
+		res.send({
+			trackList: tracks,
+		});
+	})
+);
+
+// Responds to get request, getting every component matching the filter expression sent by the user, e.g. "type:route len:1000..2000 loop:true"
+app.get(
+	"/query",
+	parserEndpoint(async function (req, res) {
+		// Only the chosen file is searched when a file name is sent, otherwise every file in uploads is
+		let JSONString;
+		if (req.query.fileName) {
+			JSONString = await sharedLib.queryFile(
+				`uploads/${req.query.fileName}`,
+				req.query.q || ""
 			);
+		} else {
+			JSONString = await sharedLib.queryDirectory("uploads", req.query.q || "");
 		}
-		// If the trackLen doesn't equal 0, that means the user inputted a length to search for in the tracks
-		if (req.query.trackLen != 0) {
-			numTracks += sharedLib.numberOfTracksWithLengthFromFile(
-				"uploads/" + file,
-				req.query.routeLen,
-				10
+
+		console.log(
+			"Responding to get request to get all components matching the query entered by the user, SUCCESS"
+		);
+		res.send({
+			components: JSON.parse(JSONString),
+		});
+	})
+);
+
+// Responds to get request, running every query of a semicolon separated batch such as "count;routesWithLength 1000 10" in one load of the files
+app.get(
+	"/batch",
+	parserEndpoint(async function (req, res) {
+		// Only the chosen file is loaded when a file name is sent, otherwise every file in uploads is
+		let JSONString;
+		if (req.query.fileName) {
+			JSONString = await sharedLib.batchFile(
+				`uploads/${req.query.fileName}`,
+				req.query.q || ""
 			);
+		} else {
+			JSONString = await sharedLib.batchDirectory("uploads", req.query.q || "");
 		}
-	});
 
-	// Sends the number of routes/tracks found in the files with the length specified by the user as JSON strings
-	console.log(
-		"Responding to get request to get number of routes and tracks with specified length by the user, SUCCESS"
-	);
-	res.send({
-		numberRoutes: JSON.stringify(numRoutes),
-		numberTracks: JSON.stringify(numTracks),
-	});
-});
+		console.log(
+			"Responding to get request to run the batch of queries entered by the user, SUCCESS"
+		);
+		res.send({
+			results: JSON.parse(JSONString),
+		});
+	})
+);
+
+// Responds to get request, getting the number of routes and tracks with the length inputted by the user with a delta of 10m
+app.get(
+	"/numberOfRoutesAndTracksWithLen",
+	parserEndpoint(async function (req, res) {
+		// A length of 0 means the user is not searching for that component, the other length is added to the batch with a delta of 10m
+		let queries = [];
+		if (req.query.routeLen != 0) {
+			queries.push(`routesWithLength ${parseFloat(req.query.routeLen)} 10`);
+		}
+		if (req.query.trackLen != 0) {
+			queries.push(`tracksWithLength ${parseFloat(req.query.trackLen)} 10`);
+		}
+
+		// Every file in the "uploads" directory is loaded once for both counts
+		let results =
+			queries.length > 0
+				? JSON.parse(await sharedLib.batchDirectory("uploads", queries.join(";")))
+				: [];
+		let numRoutes = req.query.routeLen != 0 && results.length > 0 ? results[0] : 0;
+		let numTracks =
+			req.query.trackLen != 0 && results.length > 0
+				? results[results.length - 1]
+				: 0;
+
+		// Sends the number of routes/tracks found in the files with the length specified by the user as JSON strings
+		console.log(
+			"Responding to get request to get number of routes and tracks with specified length by the user, SUCCESS"
+		);
+		res.send({
+			numberRoutes: JSON.stringify(numRoutes),
+			numberTracks: JSON.stringify(numTracks),
+		});
+	})
+);
@@ -0,0 +1,97 @@
+#ifndef GPX_BATCH_H
+#define GPX_BATCH_H
+
+#include "GPXParser.h"
+#include "GPXCorpus.h"
+
+// Most arguments taken by a single query of a batch
+#define MAX_BATCH_ARGUMENTS 5
+
+// Kinds of queries a batch can hold, BATCH_INVALID marks a query that could not be read
+typedef enum {
+    BATCH_COUNT,
+    BATCH_ROUTES_WITH_LENGTH,
+    BATCH_TRACKS_WITH_LENGTH,
+    BATCH_ROUTES_BETWEEN,
+    BATCH_TRACKS_BETWEEN,
+    BATCH_ROUTES_NEAR,
+    BATCH_TRACKS_NEAR,
+    BATCH_ROUTES_THROUGH,
+    BATCH_TRACKS_THROUGH,
+    BATCH_INVALID
+} BatchQueryType;
+
+// A single query of a batch along with its arguments
+typedef struct {
+    BatchQueryType type;
+
+    //len and delta of the length queries, sourceLat, sourceLong, destLat, destLong and delta of the between and through queries,
+    //latitude, longitude and distance of the near queries
+    float arguments[MAX_BATCH_ARGUMENTS];
+} BatchQuery;
+
+// A list of queries evaluated together, so each document only has to be loaded and walked once for all of them
+typedef struct {
+    BatchQuery *queries;
+    int numQueries;
+
+    //Whether any query needs the lengths of the routes or tracks, which are then worked out once per document
+    bool needsRouteLengths;
+    bool needsTrackLengths;
+} GPXBatch;
+
+
+/** Function that reads a batch of queries.
+ * Queries are separated by semicolons, each is a name followed by its arguments separated by spaces:
+ *   count                                           numbers of waypoints, routes and tracks
+ *   routesWithLength LEN DELTA                      number of routes as numRoutesWithLength counts them
+ *   tracksWithLength LEN DELTA                      number of tracks as numTracksWithLength counts them
+ *   routesBetween SLAT SLON DLAT DLON DELTA         routes as getRoutesBetween finds them
+ *   tracksBetween SLAT SLON DLAT DLON DELTA         tracks as getTracksBetween finds them
+ *   routesNear LAT LON DISTANCE                     routes as getRoutesNear finds them
+ *   tracksNear LAT LON DISTANCE                     tracks as getTracksNear finds them
+ *   routesThrough SLAT SLON DLAT DLON DISTANCE      routes as getRoutesThrough finds them
+ *   tracksThrough SLAT SLON DLAT DLON DISTANCE      tracks as getTracksThrough finds them
+ * A query that cannot be read, or has an argument that is not a finite number, is kept as BATCH_INVALID so the others still get their results
+ *@pre none
+ *@post Either:
+        A GPXBatch has been created and its address was returned
+		or
+		queries was NULL, and NULL was returned
+ *@return the pointer to the new batch or NULL
+ *@param queries - the list of queries
+**/
+GPXBatch *createGPXBatch(const char *queries);
+
+/** Function to delete a batch and free all the memory.
+ *@pre GPXBatch object exists, is not null, and has not been freed
+ *@post GPXBatch object had been freed
+ *@return none
+ *@param batch - a pointer to a GPXBatch struct
+**/
+void deleteGPXBatch(GPXBatch *batch);
+
+/** Function that evaluates every query of a batch over a GPXdoc in a single walk of its components
+ *@pre batch and doc are not NULL
+ *@post the doc has not been modified
+ *@return A string in JSON format, an array with the result of each query in order: {"numWaypoints":..,"numRoutes":..,
+ *        "numTracks":..} for count, a number for the length queries, an array of routeToJSON or trackToJSON objects for
+ *        the between, near and through queries, and null for a query that could not be read
+ *@param batch - a pointer to a GPXBatch struct
+ *@param doc - a pointer to a GPXdoc struct
+**/
+char *batchDocToJSON(const GPXBatch *batch, const GPXdoc *doc);
+
+/** Function that evaluates every query of a batch over all the documents of a corpus.
+ * Counts are added up over the documents, and the between, near and through queries list the components of every document.
+ * The near and through queries share the corpus spatial index, which is built by the first of them
+ *@pre batch and corpus are not NULL
+ *@post the documents of the corpus have not been modified
+ *@return A string in JSON format, the same array as batchDocToJSON with "fileName" added to the objects found by
+ *        the between, near and through queries
+ *@param batch - a pointer to a GPXBatch struct
+ *@param corpus - a pointer to a GPXCorpus struct
+**/
+char *corpusBatchToJSON(const GPXBatch *batch, GPXCorpus *corpus);
+
+#endif
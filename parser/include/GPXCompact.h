@@ -0,0 +1,121 @@
+#ifndef GPX_COMPACT_H
+#define GPX_COMPACT_H
+
+#include "GPXParser.h"
+
+// Points in each block of compacted coordinates, and the most points a segment cursor hands out at once for them
+#define COMPACT_BLOCK_POINTS 64
+
+// Compacted coordinates are whole numbers of 1e-7 degrees, about a centimetre
+#define COMPACT_SCALE 1e7
+
+// Coordinates of a track segment stored as fixed point integers of 1e-7 degrees in blocks of COMPACT_BLOCK_POINTS points.
+// The first point of a block is stored whole, every other point as the zigzag varint encoded difference from the point
+// before it, so a block can be decoded on its own and a point usually takes 2 to 4 bytes
+struct CompactCoordinates {
+    int64_t numPoints;
+    int64_t numBlocks;
+
+    //Latitude and longitude of the first point of each block
+    int32_t* blockLatitudes;
+    int32_t* blockLongitudes;
+
+    //Offset in deltas of the differences of each block's remaining points
+    uint64_t* blockOffsets;
+
+    //Differences of the points after the first of each block, latitude then longitude, block after block
+    uint8_t* deltas;
+    size_t numDeltaBytes;
+};
+typedef struct CompactCoordinates CompactCoordinates;
+
+// Reads the coordinates of a track segment a run of points at a time, whether the segment keeps them in its columns,
+// in compacted blocks or only in its waypoints list
+typedef struct {
+    const TrackSegment* segment;
+
+    //Position of the first point of the current run in the segment, and the number of points in it
+    int64_t firstPoint;
+    int64_t numPoints;
+
+    //Coordinates of the current run, pointing into the segment's columns or into the buffers below
+    const double* latitudes;
+    const double* longitudes;
+
+    //Where the next run starts in the compacted blocks or in the waypoints list
+    int64_t nextBlock;
+    ListIterator waypointIterator;
+    double latitudeBuffer[COMPACT_BLOCK_POINTS];
+    double longitudeBuffer[COMPACT_BLOCK_POINTS];
+} SegmentCursor;
+
+
+/** Function that archives a track segment created by the parser by compacting its coordinates.
+ * The coordinates are rounded to 1e-7 degrees, a longitude below 180 never rounding up to it, and stored in a CompactCoordinates, the latitude and longitude columns are
+ * freed and so are the segment's waypoints, along with their names and other data.  The elevation and time columns are kept,
+ * so the segment still answers every length, statistics, geometry and time query and is written with lat, lon, ele and time
+ *@pre the segment is not used by another thread
+ *@post Either:
+        The segment is compacted and its waypoints list is empty
+		or
+		The segment has no columns, is already compacted or has a coordinate outside of the WGS84 range, and was not changed
+ *@return TRUE if the segment was compacted, FALSE otherwise
+ *@param segment - a pointer to a TrackSegment struct
+**/
+bool compactTrackSegment(TrackSegment* segment);
+
+/** Function that compacts every track segment of a GPXdoc with compactTrackSegment, for documents that are kept in memory
+ * to be queried rather than edited
+ *@pre doc is not NULL
+ *@post every segment that could be compacted has been
+ *@return the number of segments that were compacted
+ *@param doc - a pointer to a GPXdoc struct
+**/
+int compactGPXdoc(GPXdoc* doc);
+
+/** Function to free compacted coordinates
+ *@pre none
+ *@post the coordinates have been freed
+ *@return none
+ *@param coordinates - a pointer to a CompactCoordinates struct, or NULL
+**/
+void deleteCompactCoordinates(CompactCoordinates* coordinates);
+
+/** Function that returns the number of points of a track segment, however its coordinates are stored
+ *@pre segment is not NULL
+ *@post none
+ *@return the number of points
+ *@param segment - a pointer to a TrackSegment struct
+**/
+int64_t getSegmentNumPoints(const TrackSegment* segment);
+
+/** Function that reads the coordinates of one point of a track segment, however its coordinates are stored
+ *@pre segment is not NULL
+ *@post none
+ *@return TRUE if the point exists, FALSE otherwise
+ *@param segment - a pointer to a TrackSegment struct
+ *@param index - the position of the point in the segment, negative positions count from the end so -1 is the last point
+ *@param latitude - set to the latitude of the point
+ *@param longitude - set to the longitude of the point
+**/
+bool getSegmentPoint(const TrackSegment* segment, int64_t index, double* latitude, double* longitude);
+
+/** Function that starts reading the coordinates of a track segment with a cursor
+ *@pre cursor and segment are not NULL
+ *@post the cursor is before the first run of points
+ *@return none
+ *@param cursor - a pointer to a SegmentCursor struct
+ *@param segment - a pointer to a TrackSegment struct
+**/
+void openSegmentCursor(SegmentCursor* cursor, const TrackSegment* segment);
+
+/** Function that moves a cursor to the next run of points, whose coordinates are then in its latitudes and longitudes
+ * A segment with columns is read in one run, a compacted one a block at a time
+ *@pre the cursor was opened with openSegmentCursor
+ *@post the run is valid until the next call
+ *@return the number of points in the run, 0 once every point has been read
+ *@param cursor - a pointer to a SegmentCursor struct
+**/
+int64_t nextSegmentRun(SegmentCursor* cursor);
+
+#endif
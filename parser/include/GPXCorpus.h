@@ -0,0 +1,146 @@
+#ifndef GPX_CORPUS_H
+#define GPX_CORPUS_H
+
+#include "GPXParser.h"
+#include "GPXSpatial.h"
+#include "GPXTime.h"
+#include "GPXJSON.h"
+
+// A GPX file of the corpus along with the GPXdoc created from it
+typedef struct {
+    //Name of the file inside the corpus directory, without the directory.  Must not be NULL.
+    char* fileName;
+
+    //The valid GPXdoc created from the file.  Must not be NULL.
+    GPXdoc* doc;
+} CorpusDocument;
+
+// Every GPX file of a directory loaded once so that queries can run over all of them without reparsing
+typedef struct {
+    //Directory the corpus was loaded from.  Must not be NULL.
+    char* directory;
+
+    //Documents that were created and validated, in file name order
+    CorpusDocument* documents;
+    int numDocuments;
+
+    //Names of the files that could not be parsed or failed validation, in file name order
+    char** failedFiles;
+    int numFailedFiles;
+
+    //Index over the waypoints, routes and tracks of all documents.  NULL until the first spatial query builds it.
+    SpatialIndex* spatialIndex;
+
+    //Index over the time spans of the tracks of all documents.  NULL until the first time query builds it.
+    TimeIndex* timeIndex;
+} GPXCorpus;
+
+
+/** Function to create a corpus from every file in a directory.
+ * Each file is created and validated the same way as createValidGPXdoc and validateGPXDoc,
+ * files that fail are listed in failedFiles instead of stopping the load.
+ * The files are loaded by a pool of threads sharing one parsed copy of the schema
+ *@pre directory and gpxSchemaFile are not NULL or empty, the directory exists and is readable
+ *@post Either:
+        A GPXCorpus has been created and its address was returned
+		or
+		The directory could not be read, and NULL was returned
+ *@return the pointer to the new corpus or NULL
+ *@param directory - the name of the directory holding the GPX files
+ *@param gpxSchemaFile - the name of a schema file
+**/
+GPXCorpus* createGPXCorpus(char* directory, char* gpxSchemaFile);
+
+/** Function to delete a corpus, all of its documents and free all the memory.
+ *@pre GPXCorpus object exists, is not null, and has not been freed
+ *@post GPXCorpus object had been freed
+ *@return none
+ *@param corpus - a pointer to a GPXCorpus struct
+**/
+void deleteGPXCorpus(GPXCorpus* corpus);
+
+/** Function that summarizes every file of the corpus in one JSON document, replacing a GPXtoJSON,
+ * routeListToJSON and trackListToJSON call per file
+ *@pre GPXCorpus object exists, is not null
+ *@post GPXCorpus documents have not been modified
+ *@return A string in JSON format, {"files":[..],"failedFiles":[..]} where each file is the GPXtoJSON object with
+ *        "fileName" added and "routes" and "tracks" arrays of routeToJSON and trackToJSON objects with "fileName" added
+ *@param corpus - a pointer to a GPXCorpus struct
+**/
+char* corpusSummaryToJSON(GPXCorpus* corpus);
+
+/** Function that writes the summary of corpusSummaryToJSON to a writer, so it can be streamed without ever being held in memory whole
+ *@pre writer is not NULL
+ *@post GPXCorpus documents have not been modified, the writer has been flushed
+ *@return TRUE if the writer's sink took the whole summary, FALSE otherwise
+ *@param writer - a pointer to a JSONWriter struct
+ *@param corpus - a pointer to a GPXCorpus struct, NULL is written as an empty summary
+**/
+bool writeCorpusSummary(JSONWriter* writer, GPXCorpus* corpus);
+
+/** Function that summarizes one valid file the same way corpusSummaryToJSON summarizes each file of a corpus
+ *@pre fileName and doc are not NULL
+ *@post GPXdoc has not been modified
+ *@return A string in JSON format, the GPXtoJSON object with "fileName" added and "routes" and "tracks" arrays
+ *@param fileName - the name the file is listed under
+ *@param doc - a pointer to a GPXdoc struct
+**/
+char* documentSummaryToJSON(const char* fileName, const GPXdoc* doc);
+
+/** Function that returns the spatial index over every waypoint, route and track in the corpus, building it on first use
+ *@pre GPXCorpus object exists, is not null
+ *@post The index belongs to the corpus and is freed by deleteGPXCorpus
+ *@return the corpus spatial index
+ *@param corpus - a pointer to a GPXCorpus struct
+**/
+SpatialIndex* getCorpusSpatialIndex(GPXCorpus* corpus);
+
+/** Function that finds every waypoint, route and track in the corpus that lies inside or crosses a polygon.
+ * The polygon is a GeoJSON style list of rings of [longitude, latitude] positions, the first ring is the
+ * outer boundary and any further rings are holes. A GeoJSON Polygon geometry object is also accepted.
+ * Each match lists the ranges of its path that are inside the polygon as [enter, leave] positions, where
+ * a position is a point number along the component (counted across track segments) plus the fraction of
+ * the way to the next point, so [2.5, 7] enters halfway between points 2 and 3 and leaves at point 7.
+ *@pre GPXCorpus object exists, is not null
+ *@post GPXCorpus documents have not been modified
+ *@return A string in JSON format, an array of
+ *        {"fileName":..,"type":"waypoint"|"route"|"track","number":..,"name":..,"inside":true|false,"ranges":[[enter,leave],..]}
+ *        where number counts from 1 within the file and inside is true when the whole component lies in the polygon
+ *@param corpus - a pointer to a GPXCorpus struct
+ *@param polygonJSON - the polygon rings in JSON format
+**/
+char* corpusGeofenceToJSON(GPXCorpus* corpus, const char* polygonJSON);
+
+/** Function that returns the time index over every track in the corpus, building it on first use
+ *@pre GPXCorpus object exists, is not null
+ *@post The index belongs to the corpus and is freed by deleteGPXCorpus
+ *@return the corpus time index
+ *@param corpus - a pointer to a GPXCorpus struct
+**/
+TimeIndex* getCorpusTimeIndex(GPXCorpus* corpus);
+
+/** Function that finds every track in the corpus that was recorded at some point between two times
+ *@pre GPXCorpus object exists, is not null
+ *@post GPXCorpus documents have not been modified
+ *@return A string in JSON format, an array of {"fileName":..,"number":..,"name":..,"startTime":..,"endTime":..}
+ *        where number counts from 1 within the file and the times are UTC ISO 8601 strings
+ *@param corpus - a pointer to a GPXCorpus struct
+ *@param startTime - start of the window in milliseconds since the Unix epoch
+ *@param endTime - end of the window in milliseconds since the Unix epoch
+**/
+char* corpusTracksActiveToJSON(GPXCorpus* corpus, int64_t startTime, int64_t endTime);
+
+/** Function that finds the track points of the corpus whose time lies between two times.
+ * Each track with points in the window lists them as runs of consecutive points of one segment
+ *@pre GPXCorpus object exists, is not null
+ *@post GPXCorpus documents have not been modified
+ *@return A string in JSON format, an array of
+ *        {"fileName":..,"number":..,"name":..,"numPoints":..,"runs":[{"segment":..,"first":..,"last":..},..]}
+ *        where number and segment count from 1, first and last are point numbers counted from 0 within the segment
+ *@param corpus - a pointer to a GPXCorpus struct
+ *@param startTime - start of the window in milliseconds since the Unix epoch
+ *@param endTime - end of the window in milliseconds since the Unix epoch
+**/
+char* corpusPointsInTimeWindowToJSON(GPXCorpus* corpus, int64_t startTime, int64_t endTime);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef GPX_DATA_NAMES_H
+#define GPX_DATA_NAMES_H
+
+#include "GPXParser.h"
+
+// Most names that can be interned, ids are 16 bits, 0 is never used and 65535 marks a name that is kept inline
+#define GPX_MAX_DATA_NAMES 65534
+
+// Id given to names once the table is full.  Such names are stored next to their value instead of being shared,
+// so files with new names can still be read however many different names the process has seen
+#define GPX_DATA_INLINE_NAME 65535
+
+// Longest name that can be interned, the size GPXData names used to be limited to without the NULL terminator
+#define GPX_DATA_NAME_LENGTH 255
+
+// Id of an interned GPXData name.  Every GPXData with the same name refers to the same id and the same string
+typedef uint16_t GPXNameId;
+
+// Ids of the GPX 1.1 children of wpt, rte and trk, which are interned before any file is read
+typedef enum {
+    GPX_DATA_NO_NAME = 0,
+    GPX_DATA_ELE,
+    GPX_DATA_TIME,
+    GPX_DATA_MAGVAR,
+    GPX_DATA_GEOIDHEIGHT,
+    GPX_DATA_CMT,
+    GPX_DATA_DESC,
+    GPX_DATA_SRC,
+    GPX_DATA_LINK,
+    GPX_DATA_SYM,
+    GPX_DATA_TYPE,
+    GPX_DATA_FIX,
+    GPX_DATA_SAT,
+    GPX_DATA_HDOP,
+    GPX_DATA_VDOP,
+    GPX_DATA_PDOP,
+    GPX_DATA_AGEOFDGPSDATA,
+    GPX_DATA_DGPSID,
+    GPX_DATA_NUMBER,
+    GPX_DATA_EXTENSIONS,
+    GPX_NUM_KNOWN_DATA_NAMES
+} GPXKnownDataName;
+
+
+/** Function that interns a GPXData name in the table shared by every document of the process.
+ * The GPX 1.1 names are found without taking a lock, any other name is added to the table the first time it is seen
+ * and stays there until the process exits.  Once GPX_MAX_DATA_NAMES names are in the table, new names are not added and
+ * the caller keeps its own copy of them.  It is safe to call from several threads at once
+ *@pre name is not NULL
+ *@post name has not been modified
+ *@return the id of the name, GPX_DATA_INLINE_NAME if it is not in the table and the table is full, or GPX_DATA_NO_NAME if
+ *        the name is longer than GPX_DATA_NAME_LENGTH or the table could not be allocated
+ *@param name - the NULL terminated name
+**/
+GPXNameId internGPXDataName(const char *name);
+
+/** Function that looks a name up among the GPX 1.1 names, without a lock and without adding it to the table
+ *@pre name is not NULL
+ *@post name has not been modified and the table has not changed
+ *@return the GPXKnownDataName id of the name, or GPX_DATA_NO_NAME if it is not a GPX 1.1 name
+ *@param name - the NULL terminated name
+**/
+GPXNameId findKnownGPXDataName(const char *name);
+
+/** Function that returns the interned string of a name, which every GPXData with that name points to.
+ * Two interned names are the same name exactly when their pointers are equal
+ *@pre id was returned by internGPXDataName and is not GPX_DATA_INLINE_NAME
+ *@post none
+ *@return the shared string, which must not be freed or changed, or NULL for GPX_DATA_NO_NAME
+ *@param id - the id of the name
+**/
+const char *getGPXDataName(GPXNameId id);
+
+#endif
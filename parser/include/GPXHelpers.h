@@ -1,15 +1,54 @@
 #include "GPXParser.h"
 #include "LinkedListAPI.h"
 
+// Growable string used to build JSON output without rescanning it with strlen/strcat on every append
+typedef struct {
+    char *string;
+    size_t length;
+    size_t capacity;
+} StringBuffer;
+
+// Walks the other data of a waypoint the same way whether it is still packed or already a list of GPXData
+typedef struct {
+    const char *packed;
+    ListIterator listIterator;
+} WaypointDataIterator;
+
 void parseXMLTree(GPXdoc *GPXdoc, xmlNode *root_element);
 Waypoint *getWaypointData(xmlNode *node);
-int waypointData(ListIterator waypointIterator);
+void fillTrackSegmentColumns(TrackSegment *segment);
+void getWaypointElevationAndTime(const Waypoint *waypoint, double *elevation, int64_t *time);
+WaypointDataIterator createWaypointDataIterator(const Waypoint *waypoint);
+bool nextWaypointData(WaypointDataIterator *iterator, const char **name, const char **value);
+int numWaypointData(const Waypoint *waypoint);
+List *unpackWaypointData(const char *packedData);
+GPXData *createGPXData(const char *name, const char *value, size_t valueLength);
+int64_t waypointData(ListIterator waypointIterator);
 xmlDoc *GPXdocToxmlDoc(GPXdoc *GPXDocStruct);
 void addListOfWaypointsToParentNode(xmlNodePtr parentNode, List *waypointList, char *nodeName);
+void addCompactPointsToParentNode(xmlNodePtr parentNode, const TrackSegment *segment);
 void addListOfOtherDataToParentNode(xmlNodePtr parentNode, List *otherDataList);
+void addWaypointDataToParentNode(xmlNodePtr parentNode, const Waypoint *waypoint);
 bool validateXmlTreeWithSchema(xmlDoc *doc, char *gpxSchemaFile);
+bool validGPXdocConstraints(GPXdoc *doc);
+xmlSchemaPtr parseSchemaFile(char *gpxSchemaFile);
+bool validateXmlTreeWithParsedSchema(xmlDoc *doc, xmlSchemaPtr schema);
+GPXdoc *xmlTreeToGPXdoc(xmlDoc *doc);
+GPXdoc *loadValidGPXdoc(char *fileName, xmlSchemaPtr schema);
+bool requireGPXLibrary(void);
+int getGPXParseOptions(void);
 bool validWaypointConstraints(List *waypointList);
 bool validOtherDataConstraints(List *otherDataList);
+bool validWaypointDataConstraints(const Waypoint *waypoint);
 float calculateHaversineFormula(Waypoint *waypoint1, Waypoint *waypoint2);
-float lengthOfWaypoints(List *waypoints);
+float haversineDistance(double latitude1, double longitude1, double latitude2, double longitude2);
 void dummyDelete(void *data);
+void initStringBuffer(StringBuffer *buffer);
+void appendToStringBuffer(StringBuffer *buffer, const char *text);
+void appendBytesToStringBuffer(StringBuffer *buffer, const char *bytes, size_t numBytes);
+bool stringBufferSink(void *context, const char *bytes, size_t length);
+void appendJSONStringToStringBuffer(StringBuffer *buffer, const char *text);
+void appendFixedToStringBuffer(StringBuffer *buffer, double value, int decimals);
+void appendFormatToStringBuffer(StringBuffer *buffer, const char *format, ...);
+StringBuffer *getScratchBuffer(void);
+char *scratchBufferToString(StringBuffer *buffer);
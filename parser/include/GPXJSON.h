@@ -0,0 +1,174 @@
+#ifndef GPX_JSON_H
+#define GPX_JSON_H
+
+#include "GPXParser.h"
+
+// Deepest nesting of arrays and objects the reader accepts
+#define MAX_JSON_DEPTH 64
+
+// Events the reader reports, in document order, while it walks a JSON string
+typedef enum {
+    JSON_OBJECT_START,
+    JSON_OBJECT_END,
+    JSON_ARRAY_START,
+    JSON_ARRAY_END,
+    JSON_KEY,
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL
+} JSONEvent;
+
+// A value passed along with an event
+typedef struct {
+    //Decoded text of a key or string, and the text of a number as written.  NULL terminated, only valid during the callback.
+    const char *text;
+    size_t length;
+
+    //Value of a number
+    double number;
+} JSONValue;
+
+// Function called for every event, returning FALSE stops the reader
+typedef bool (*JSONCallback)(void *context, JSONEvent event, const JSONValue *value);
+
+// Size of the chunk a writer collects output in before passing it to its sink, which bounds the memory a write uses
+#define JSON_WRITER_CHUNK 16384
+
+// Function that receives each chunk of a writer's output, returning FALSE stops the writer
+typedef bool (*JSONSink)(void *context, const char *bytes, size_t length);
+
+// Writes JSON incrementally, output is collected in a fixed chunk and handed to the sink each time the chunk fills up
+typedef struct {
+    char chunk[JSON_WRITER_CHUNK];
+    size_t length;
+    JSONSink sink;
+    void *context;
+
+    //File descriptor written to by a writer made with initJSONFileWriter
+    int fileDescriptor;
+
+    //Whether the sink stopped the writer, everything written afterwards is dropped
+    bool failed;
+} JSONWriter;
+
+
+/** Function that reads a JSON string in a single pass, reporting each value to a callback instead of building a tree.
+ * Strings have their escapes, including \u escapes and surrogate pairs, decoded to UTF-8
+ *@pre none
+ *@post json has not been modified
+ *@return TRUE if json is a single well formed JSON value and the callback never stopped the reader, FALSE otherwise
+ *@param json - the JSON string
+ *@param callback - the function called for every event
+ *@param context - a pointer passed to every call of callback
+**/
+bool readJSON(const char *json, JSONCallback callback, void *context);
+
+/** Function that converts a JSON array of waypoints into a list of Waypoint structs, a single waypoint object is read as an array of one.
+ * A waypoint is {"lat":..,"lon":..} where the coordinates are numbers or strings holding numbers, with an optional "name" and "otherData".
+ * "otherData" is an object, or an array of objects, whose members become GPXData
+ *@pre none
+ *@post json has not been modified
+ *@return A newly allocated list of Waypoint structs, or NULL if json is NULL, malformed or a waypoint lacks a coordinate
+ *@param json - the JSON string
+**/
+List *JSONtoWaypointList(const char *json);
+
+/** Function that converts a JSON array of routes into a list of Route structs, a single route object is read as an array of one.
+ * A route is {"name":..} with an optional "otherData" and an optional "points" (or "waypoints") array of waypoints read like JSONtoWaypointList
+ *@pre none
+ *@post json has not been modified
+ *@return A newly allocated list of Route structs, or NULL if json is NULL, malformed or one of its waypoints lacks a coordinate
+ *@param json - the JSON string
+**/
+List *JSONtoRouteList(const char *json);
+
+/** Function that sets up a writer passing its output to a sink
+ *@pre writer and sink are not NULL
+ *@post the writer is empty and ready to write
+ *@return none
+ *@param writer - a pointer to a JSONWriter struct
+ *@param sink - the function that receives each chunk
+ *@param context - a pointer passed to every call of sink
+**/
+void initJSONWriter(JSONWriter *writer, JSONSink sink, void *context);
+
+/** Function that sets up a writer passing its output to an open file descriptor, such as a file, pipe or socket
+ *@pre writer is not NULL
+ *@post the writer is empty and ready to write, the file descriptor is never closed by the writer
+ *@return none
+ *@param writer - a pointer to a JSONWriter struct
+ *@param fileDescriptor - the file descriptor written to
+**/
+void initJSONFileWriter(JSONWriter *writer, int fileDescriptor);
+
+/** Functions that write raw text, bytes that need not be NULL terminated, or printf formatted text to a writer
+ *@pre writer is not NULL and was set up by initJSONWriter or initJSONFileWriter
+ *@post the output is in the writer's chunk or has been passed to its sink
+ *@return none
+**/
+void writeJSONText(JSONWriter *writer, const char *text);
+void writeJSONBytes(JSONWriter *writer, const char *bytes, size_t length);
+void writeJSONFormat(JSONWriter *writer, const char *format, ...);
+
+/** Function that writes a string as a quoted JSON string, escaping quotes, backslashes and control characters.
+ * Runs of characters that need no escape are found a vector register at a time and passed on in one piece
+ *@pre sink is not NULL
+ *@post text has not been modified
+ *@return TRUE if the sink took the whole string, FALSE if it stopped part way
+ *@param text - the string to write, NULL is written as an empty string
+ *@param sink - the function that receives the pieces of the escaped string
+ *@param context - a pointer passed to every call of sink
+**/
+bool escapeJSONString(const char *text, JSONSink sink, void *context);
+
+/** Function that writes a string to a writer as a quoted JSON string, escaped like escapeJSONString
+ *@pre writer is not NULL and was set up by initJSONWriter or initJSONFileWriter
+ *@post the output is in the writer's chunk or has been passed to its sink
+ *@return none
+ *@param writer - a pointer to a JSONWriter struct
+ *@param text - the string to write, NULL is written as an empty string
+**/
+void writeJSONString(JSONWriter *writer, const char *text);
+
+/** Function that writes a number with a fixed number of decimals to a writer, the same digits as "%.Nf" without going through printf
+ *@pre writer is not NULL and was set up by initJSONWriter or initJSONFileWriter, decimals is between 0 and 15
+ *@post the output is in the writer's chunk or has been passed to its sink
+ *@return none
+ *@param writer - a pointer to a JSONWriter struct
+ *@param value - the number to write
+ *@param decimals - the number of digits written after the decimal point
+**/
+void writeJSONFixed(JSONWriter *writer, double value, int decimals);
+
+/** Function that passes whatever is left in the writer's chunk to its sink
+ *@pre writer is not NULL and was set up by initJSONWriter or initJSONFileWriter
+ *@post the chunk is empty
+ *@return TRUE if the sink took all the output of the writer, FALSE if it stopped the writer at any point
+ *@param writer - a pointer to a JSONWriter struct
+**/
+bool flushJSONWriter(JSONWriter *writer);
+
+/** Functions that write a list of routes or tracks in the format of routeListToJSON and trackListToJSON
+ *@pre writer is not NULL
+ *@post the list has not been modified
+ *@return none
+ *@param writer - a pointer to a JSONWriter struct
+ *@param list - a list of Route or Track structs, NULL is written as an empty array
+**/
+void writeRouteListJSON(JSONWriter *writer, const List *list);
+void writeTrackListJSON(JSONWriter *writer, const List *list);
+
+/** Function that writes the waypoints, routes and tracks of a GPXdoc as a GeoJSON FeatureCollection.
+ * Waypoints are Points, routes are LineStrings and tracks are MultiLineStrings with one line per segment,
+ * each feature has "type" ("waypoint", "route" or "track") and "name" properties
+ *@pre writer and doc are not NULL
+ *@post the doc has not been modified
+ *@return none
+ *@param writer - a pointer to a JSONWriter struct
+ *@param doc - a pointer to a GPXdoc struct
+**/
+void writeDocGeoJSON(JSONWriter *writer, const GPXdoc *doc);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef GPX_LIBRARY_H
+#define GPX_LIBRARY_H
+
+#include "GPXParser.h"
+
+// Thread safety of the parser library
+//
+// libxml2 keeps global state, the parser's dictionaries and locks and the built in schema types, that is set up once and
+// shared by every thread.  gpx_library_init sets it up and gpx_library_shutdown frees it, no other function of the library
+// frees it, so once the library is initialized any number of threads may parse, validate, write and summarize files at
+// the same time.  Threads must not share a GPXdoc, GPXLoader or GPXCorpus while one of them is changing it, while a parsed
+// schema may be read by several threads at once.
+//
+// Calling gpx_library_init is optional for programs that never shut the library down, as every function initializes
+// libxml2 the first time it is needed, but it is the only way to initialize it before a second thread is started.
+
+
+/** Function to initialize the library, and libxml2 along with it, before any other function of the library is called.
+ * It may be called any number of times from any thread, each call has to be matched by a call to gpx_library_shutdown
+ *@pre none
+ *@post Either:
+        libxml2 is initialized and will stay initialized until the matching gpx_library_shutdown
+		or
+		The libxml2 the library was loaded with is not compatible with the one it was built for, and FALSE was returned
+ *@return TRUE if the library can be used, FALSE otherwise
+**/
+bool gpx_library_init(void);
+
+/** Function to release the global state of libxml2 once the last gpx_library_init has been matched.
+ * Calls that do not match a gpx_library_init are ignored.  Every call frees the structs the calling thread keeps pooled
+ *@pre No other thread is calling any function of the library, and every GPXLoader, GPXCorpus and parsed schema has been freed
+ *@post Once every gpx_library_init has been matched libxml2 has been cleaned up, and the library may be initialized again
+ *@return none
+**/
+void gpx_library_shutdown(void);
+
+/** Function that turns the huge document mode on or off for every file parsed afterwards, by any thread.
+ * libxml2 refuses text nodes over 10MB and elements nested over 256 deep unless it is asked to parse huge documents,
+ * which multi-day recordings can go past.  In huge mode files are parsed with XML_PARSE_HUGE, which lifts those limits,
+ * along with XML_PARSE_NONET so nothing is fetched while doing so, and every count of the API is 64 bit so none of them
+ * overflow.  The limits also guard against documents crafted to use up memory, so huge mode is meant for trusted files
+ *@pre none
+ *@post Files parsed afterwards are parsed in huge mode when enabled is TRUE, with libxml2's limits otherwise
+ *@return none
+ *@param enabled - TRUE to parse huge documents, FALSE to go back to libxml2's limits, which is the default
+**/
+void gpx_set_huge_documents(bool enabled);
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef GPX_LOADER_H
+#define GPX_LOADER_H
+
+#include "GPXParser.h"
+
+// Entries the loader's dictionary may hold before the parser context is replaced, which bounds its memory over very long runs
+#define LOADER_DICT_LIMIT 65536
+
+// Loads GPX files one after another, reusing one libxml parser context and schema validation context for all of them.
+// The parser context is reset between documents but keeps its dictionary, so element and attribute names such as trkpt
+// and lat are interned once instead of once per file.  A loader must only be used by one thread at a time
+typedef struct {
+    //Parser context every file is read with.  Must not be NULL.
+    xmlParserCtxtPtr parserContext;
+
+    //Schema the files are validated with, shared and not freed by the loader.  NULL if the files are not validated.
+    xmlSchemaPtr schema;
+
+    //Validation context for schema.  NULL when schema is NULL.
+    xmlSchemaValidCtxtPtr validContext;
+
+    //Number of files the loader has read, whether or not they were valid
+    int numLoads;
+} GPXLoader;
+
+
+/** Function to create a loader
+ *@pre none
+ *@post Either:
+        A GPXLoader has been created and its address was returned
+		or
+		A libxml context could not be created, and NULL was returned
+ *@return the pointer to the new loader or NULL
+ *@param schema - a schema returned by xmlSchemaParse that the files are validated with, or NULL to load files without validating them.
+ *                It must stay alive until the loader is deleted
+**/
+GPXLoader* createGPXLoader(xmlSchemaPtr schema);
+
+/** Function to delete a loader and its libxml contexts, the schema is left alone
+ *@pre GPXLoader object exists, is not null, and has not been freed
+ *@post GPXLoader object had been freed
+ *@return none
+ *@param loader - a pointer to a GPXLoader struct
+**/
+void deleteGPXLoader(GPXLoader* loader);
+
+/** Function to create a GPXdoc from a file with a loader.
+ * When the loader has a schema the file and the GPXdoc are validated the same way as createValidGPXdoc and validateGPXDoc
+ *@pre loader is not NULL
+ *@post Either:
+        A GPXdoc has been created and its address was returned
+		or
+		The file could not be parsed or failed validation, and NULL was returned
+ *@return the pointer to the new GPXdoc or NULL
+ *@param loader - a pointer to a GPXLoader struct
+ *@param fileName - the name of a GPX file
+**/
+GPXdoc* loadGPXdoc(GPXLoader* loader, char* fileName);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef GPX_NUMBER_H
+#define GPX_NUMBER_H
+
+#include "GPXParser.h"
+
+// Longest string written by formatShortestDouble or formatFixedDouble, including the NULL terminator
+#define GPX_NUMBER_STRING_LENGTH 40
+
+
+/** Function that writes the shortest decimal string that reads back as exactly the same double, using the Grisu2 algorithm.
+ * Numbers are written in positional notation like 43.5372991, which XML Schema decimals require, unless their exponent
+ * is below -12 or above 20 where exponent notation like 1.5e-15 is used instead.  The output never depends on the locale
+ *@pre string has room for GPX_NUMBER_STRING_LENGTH characters
+ *@post string holds the NULL terminated number
+ *@return the length of the string written
+ *@param value - the number to write
+ *@param string - where the number is written
+**/
+int formatShortestDouble(double value, char *string);
+
+/** Function that writes a double with a fixed number of decimals, giving the same digits as printf's "%.Nf" in the C locale
+ * whatever locale the process is in.  Values too large for their digits to fit in a double's significand are written
+ * the way formatShortestDouble writes them
+ *@pre string has room for GPX_NUMBER_STRING_LENGTH characters, decimals is between 0 and 15
+ *@post string holds the NULL terminated number
+ *@return the length of the string written
+ *@param value - the number to write
+ *@param decimals - the number of digits written after the decimal point
+ *@param string - where the number is written
+**/
+int formatFixedDouble(double value, int decimals, char *string);
+
+/** Function that reads a decimal number like strtod does, but the same way whatever locale the process is in.
+ * Numbers of up to 15 digits with a small exponent, which covers every coordinate, elevation and version, are converted
+ * exactly with a single multiplication or division.  Any other number is handed to strtod in the C locale
+ *@pre string is not NULL
+ *@post string has not been modified
+ *@return the double closest to the number, or 0 if string does not start with one
+ *@param string - the string holding the number, after any leading whitespace
+ *@param end - if not NULL, set to the first character after the number, or to string when there is no number
+**/
+double parseDecimal(const char *string, char **end);
+
+#endif
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <libxml/encoding.h>
@@ -21,13 +22,18 @@
 // e.g. comment, elevation, desciption, etc..
 typedef struct  {
     //GPXData name.  Must not be an empty string.
-	char 	name[256];
+    //Names are interned, every GPXData with the same name points to the same shared string, which must not be freed or changed.
+    //Set it with getGPXDataName(internGPXDataName(name)) from GPXDataNames.h, or create the GPXData with createGPXData, which
+    //keeps a copy of the name after the value when the shared table is full.
+	const char* name;
 
     //GPXData value.  We use a C99 flexible array member, which we will discuss in class.
 	//Must not be an empty string
 	char	value[]; 
 } GPXData;
 
+//Waypoints must be created with createWaypoint, which sets packedData to NULL.
+//deleteWaypoint frees packedData, so a waypoint allocated any other way must not be given to it.
 typedef struct {
     //Waypoint name.  Must not be NULL.  May be an empty string.
     char* name;
@@ -42,8 +48,16 @@ typedef struct {
     //We will assume that all waypoint children have no children of their own
     //This can be elevation, time, etc.. Note that while the element <name> can be a child of the waypoint node,
     //the name already has its own dedicated filed in the Waypoint sruct - so do not place the name in this list
-    //All objects in the list will be of type GPXData.  It must not be NULL.  It may be empty.
+    //All objects in the list will be of type GPXData.  It must not be NULL unless packedData is set.  It may be empty.
+    //Track points read by the parser have it NULL until their data is expanded, so code reading the data of a waypoint
+    //it did not create must get the list with getWaypointOtherData instead of reading this member.
     List* otherData;
+
+    //Other data of a track point read by the parser, packed in one allocation as the 16 bit id of each interned name followed by
+    //its NULL terminated value, ended by the id 0.  The id GPX_DATA_INLINE_NAME is followed by the NULL terminated name, then the value.
+    //Track points keep their data packed with otherData NULL until getWaypointOtherData expands it.
+    //NULL for any other waypoint, and once the data has been expanded.
+    char* packedData;
 } Waypoint;
 
 typedef struct {
@@ -62,10 +76,35 @@ typedef struct {
     List* otherData;
 } Route;
 
+//Value stored in TrackSegment times for points that have no <time> element
+#define GPX_NO_TIME INT64_MIN
+
+//Track segments must be created with createTrackSegment, which sets every member below the waypoints list to 0 or NULL.
+//deleteTrackSegment frees the arrays, so a segment allocated any other way must not be given to it.
 typedef struct {
     //Waypoints that make up the track segment
     //All objects in the list will be of type Waypoint.  It must not be NULL.  It may be empty.
     List* waypoints;
+
+    //Columnar copy of the points in the waypoints list, filled in by the parser so numeric scans do not have to walk the list.
+    //Each array holds numPoints values in the same order as the waypoints list.
+    //The arrays are NULL for segments that were not filled in by the parser.
+    int64_t numPoints;
+    double* latitudes;
+    double* longitudes;
+
+    //Elevation of each point in meters, parsed from its <ele> element.  NAN if it has none.
+    double* elevations;
+
+    //Time of each point in milliseconds since the Unix epoch, parsed from its <time> element.  GPX_NO_TIME if it has none.
+    //timesAscending is true when every point has a time and the times never decrease, which allows binary searching them.
+    int64_t* times;
+    bool timesAscending;
+
+    //Coordinates of a segment archived with compactTrackSegment from GPXCompact.h, NULL for every other segment.
+    //Once it is set latitudes and longitudes are NULL and the waypoints list is empty, the points are read through the
+    //accessors and the segment cursor in GPXCompact.h instead.
+    struct CompactCoordinates* compact;
 } TrackSegment;
 
 typedef struct {
@@ -149,25 +188,25 @@ They all share the same format and only differ in what they have to count.
  
  *@pre GPX object exists, is not null, and has not been freed
  *@post GPX object has not been modified in any way
- *@return the number of entities in the GPXdoc object
+ *@return the number of entities in the GPXdoc object, 64 bit so documents with over 2^31 of them are counted
  *@param obj - a pointer to an GPXdoc struct
  */
 
 
 //Total number of waypoints in the GPX file
-int getNumWaypoints(const GPXdoc* doc);
+int64_t getNumWaypoints(const GPXdoc* doc);
 
 //Total number of routes in the GPX file
-int getNumRoutes(const GPXdoc* doc);
+int64_t getNumRoutes(const GPXdoc* doc);
 
 //Total number of tracks in the GPX file
-int getNumTracks(const GPXdoc* doc);
+int64_t getNumTracks(const GPXdoc* doc);
 
 //Total number of segments in all tracks in the document
-int getNumSegments(const GPXdoc* doc);
+int64_t getNumSegments(const GPXdoc* doc);
 
 //Total number of GPXData elements in the document
-int getNumGPXData(const GPXdoc* doc);
+int64_t getNumGPXData(const GPXdoc* doc);
 
 // Function that returns a waypoint with the given name.  If more than one exists, return the first one.  
 // Return NULL if the waypoint does not exist
@@ -179,6 +218,30 @@ Track* getTrack(const GPXdoc* doc, char* name);
 // Return NULL if the route does not exist
 Route* getRoute(const GPXdoc* doc, char* name);
 
+/** Function that returns the list of other data of a waypoint, expanding the packed data of a track point into GPXData the first time.
+ * Expanding changes the waypoint, so it must not be called while another thread is reading the same GPXdoc
+ *@pre waypoint is not NULL
+ *@post otherData of the waypoint is a list of GPXData and packedData is NULL
+ *@return the otherData list of the waypoint
+ *@param waypoint - a pointer to a Waypoint struct
+**/
+List* getWaypointOtherData(Waypoint* waypoint);
+
+/** Function that creates an empty waypoint, the only way a Waypoint given to deleteWaypoint may be created
+ *@pre none
+ *@post none
+ *@return A newly allocated Waypoint with an empty name, coordinates of 0, an empty otherData list and no packed data,
+ *        or NULL if memory could not be allocated
+**/
+Waypoint* createWaypoint(void);
+
+/** Function that creates an empty track segment, the only way a TrackSegment given to deleteTrackSegment may be created
+ *@pre none
+ *@post none
+ *@return A newly allocated TrackSegment with an empty waypoints list and no columns, or NULL if memory could not be allocated
+**/
+TrackSegment* createTrackSegment(void);
+
 
 
 /* ******************************* A2 functions  - MUST be implemented *************************** */
@@ -260,7 +323,7 @@ float round10(float len);
  *@param len - search route length
  *@param delta - the tolerance used for comparing route lengths
 **/
-int numRoutesWithLength(const GPXdoc* doc, float len, float delta);
+int64_t numRoutesWithLength(const GPXdoc* doc, float len, float delta);
 
 
 /** Function that returns the number tracks with the specified length, using the provided tolerance 
@@ -272,7 +335,7 @@ int numRoutesWithLength(const GPXdoc* doc, float len, float delta);
  *@param len - search track length
  *@param delta - the tolerance used for comparing track lengths
 **/
-int numTracksWithLength(const GPXdoc* doc, float len, float delta);
+int64_t numTracksWithLength(const GPXdoc* doc, float len, float delta);
 
 /** Function that checks if the current route is a loop
  *@pre Route object exists, is not null
@@ -320,6 +383,69 @@ List* getRoutesBetween(const GPXdoc* doc, float sourceLat, float sourceLong, flo
 */
 List* getTracksBetween(const GPXdoc* doc, float sourceLat, float sourceLong, float destLat, float destLong, float delta);
 
+/** Function that returns all routes whose path passes within the given distance of a location.
+ * Unlike getRoutesBetween, every part of the route is considered and not only its end points
+ *@pre GPXdoc object exists, is not null
+ *@post GPXdoc object exists, is not null, has not been modified
+ *@return a list of Route structs passing near the location, or NULL if there are none or the distance is negative or an argument is not a finite number
+ *@param doc - a pointer to a GPXdoc struct
+ *@param latitude - latitude of the location
+ *@param longitude - longitude of the location
+ *@param distance - the largest distance in meters between the route and the location
+*/
+List* getRoutesNear(const GPXdoc* doc, float latitude, float longitude, float distance);
+
+/** Function that returns all tracks whose path passes within the given distance of a location.
+ * Unlike getTracksBetween, every part of the track is considered and not only its end points
+ *@pre GPXdoc object exists, is not null
+ *@post GPXdoc object exists, is not null, has not been modified
+ *@return a list of Track structs passing near the location, or NULL if there are none or the distance is negative or an argument is not a finite number
+ *@param doc - a pointer to a GPXdoc struct
+ *@param latitude - latitude of the location
+ *@param longitude - longitude of the location
+ *@param distance - the largest distance in meters between the track and the location
+*/
+List* getTracksNear(const GPXdoc* doc, float latitude, float longitude, float distance);
+
+/** Function that returns all routes whose path passes within the given distance of the start location
+ * and then, further along the route, within the given distance of the destination location
+ *@pre GPXdoc object exists, is not null
+ *@post GPXdoc object exists, is not null, has not been modified
+ *@return a list of Route structs passing through both locations in order, or NULL if there are none or the distance is negative or an argument is not a finite number
+ *@param doc - a pointer to a GPXdoc struct
+ *@param sourceLat - latitude of the start location
+ *@param sourceLong - longitude of the start location
+ *@param destLat - latitude of the destination location
+ *@param destLong - longitude of the destination location
+ *@param distance - the largest distance in meters between the route and each location
+*/
+List* getRoutesThrough(const GPXdoc* doc, float sourceLat, float sourceLong, float destLat, float destLong, float distance);
+
+/** Function that returns all tracks whose path passes within the given distance of the start location
+ * and then, further along the track, within the given distance of the destination location
+ *@pre GPXdoc object exists, is not null
+ *@post GPXdoc object exists, is not null, has not been modified
+ *@return a list of Track structs passing through both locations in order, or NULL if there are none or the distance is negative or an argument is not a finite number
+ *@param doc - a pointer to a GPXdoc struct
+ *@param sourceLat - latitude of the start location
+ *@param sourceLong - longitude of the start location
+ *@param destLat - latitude of the destination location
+ *@param destLong - longitude of the destination location
+ *@param distance - the largest distance in meters between the track and each location
+*/
+List* getTracksThrough(const GPXdoc* doc, float sourceLat, float sourceLong, float destLat, float destLong, float distance);
+
+/** Function that returns all tracks that were recorded at some point between two times.
+ * A track is active when the span from its earliest to its latest point time overlaps the window
+ *@pre GPXdoc object exists, is not null
+ *@post GPXdoc object exists, is not null, has not been modified
+ *@return a list of Track structs active in the window, or NULL if there are none
+ *@param doc - a pointer to a GPXdoc struct
+ *@param startTime - start of the window in milliseconds since the Unix epoch
+ *@param endTime - end of the window in milliseconds since the Unix epoch
+*/
+List* getTracksActiveBetween(const GPXdoc* doc, int64_t startTime, int64_t endTime);
+
 
 //Module 3
 
@@ -389,7 +515,7 @@ void addRoute(GPXdoc* doc, Route* rt);
 /** Function to converting a JSON string into an GPXdoc struct
  *@pre JSON string is not NULL
  *@post String has not been modified in any way
- *@return A newly allocated and initialized GPXdoc struct
+ *@return A newly allocated and initialized GPXdoc struct, or NULL if the string is not JSON for one
  *@param str - a pointer to a string
  **/
 GPXdoc* JSONtoGPX(const char* gpxString);
@@ -397,7 +523,7 @@ GPXdoc* JSONtoGPX(const char* gpxString);
 /** Function to converting a JSON string into an Waypoint struct
  *@pre JSON string is not NULL
  *@post String has not been modified in any way
- *@return A newly allocated and initialized Waypoint struct
+ *@return A newly allocated and initialized Waypoint struct, or NULL if the string is not JSON for one
  *@param str - a pointer to a string
  **/
 Waypoint* JSONtoWaypoint(const char* gpxString);
@@ -405,7 +531,7 @@ Waypoint* JSONtoWaypoint(const char* gpxString);
 /** Function to converting a JSON string into an Route struct
  *@pre JSON string is not NULL
  *@post String has not been modified in any way
- *@return A newly allocated and initialized Route struct
+ *@return A newly allocated and initialized Route struct, or NULL if the string is not JSON for one
  *@param str - a pointer to a string
  **/
 Route* JSONtoRoute(const char* gpxString);
@@ -0,0 +1,49 @@
+#ifndef GPX_POOL_H
+#define GPX_POOL_H
+
+// Only standard headers are included, LinkedListAPI.c uses the pools and is built without libxml2
+#include <stddef.h>
+
+// Shapes that are allocated and freed for every document, each has its own free list in every thread.
+// The block size of each class is the exact size of its struct, so a block from a pool can be given to free
+// and a block from malloc can be given back to a pool
+typedef enum {
+    POOL_WAYPOINT,
+    POOL_ROUTE,
+    POOL_TRACK,
+    POOL_TRACK_SEGMENT,
+    POOL_LIST,
+    POOL_NODE,
+    NUM_POOL_CLASSES
+} GPXPoolClass;
+
+
+/** Function that allocates a block for a struct of the given class, taking it from the calling thread's free list
+ * when there is one there and from malloc otherwise.  Building with -DGPX_NO_POOLS keeps the free lists empty,
+ * which lets memory checkers see every block
+ *@pre none
+ *@post the block is not in any free list
+ *@return a block of the size of the class's struct, which is not initialized, or NULL if malloc failed
+ *@param sizeClass - the class of the struct
+**/
+void *poolAllocate(GPXPoolClass sizeClass);
+
+/** Function that gives a block back to the calling thread's free list for its class.
+ * Each thread keeps a bounded number of free blocks per class, blocks past that go back to free, and blocks that sat
+ * unused through a whole trimming period are freed too.  A thread's free blocks are freed when the thread exits
+ *@pre the block was returned by poolAllocate or by malloc for the size of the class's struct, in any thread
+ *@post the block must not be used again
+ *@return none
+ *@param sizeClass - the class of the struct
+ *@param block - the block, or NULL
+**/
+void poolRelease(GPXPoolClass sizeClass, void *block);
+
+/** Function that frees every block in the calling thread's free lists
+ *@pre none
+ *@post the calling thread's free lists are empty
+ *@return none
+**/
+void trimGPXPools(void);
+
+#endif
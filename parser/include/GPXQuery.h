@@ -0,0 +1,131 @@
+#ifndef GPX_QUERY_H
+#define GPX_QUERY_H
+
+#include "GPXParser.h"
+#include "GPXSpatial.h"
+#include "GPXCorpus.h"
+
+// Bits of GPXQuery types, one per ComponentType
+#define QUERY_WAYPOINTS (1 << GPX_WAYPOINT)
+#define QUERY_ROUTES (1 << GPX_ROUTE)
+#define QUERY_TRACKS (1 << GPX_TRACK)
+
+// A compiled filter expression, every predicate that is set must hold for a component to match
+typedef struct {
+    //Component types that can match, a combination of the QUERY_ bits
+    int types;
+
+    //Name the component must start with, or equal when namePrefix is FALSE.  NULL if the name is not filtered.
+    char *name;
+    bool namePrefix;
+
+    //Inclusive range of the number of points, -1 for an open end
+    int minPoints;
+    int maxPoints;
+
+    //Required loop flag, checked the same way as routeToJSON and trackToJSON.  -1 if not filtered, otherwise 0 or 1.
+    int loop;
+
+    //Box the component's bounding box has to intersect
+    bool hasBox;
+    BoundingBox box;
+
+    //Window the span of a track's point times has to overlap, routes and waypoints have no times and never match
+    bool hasTime;
+    int64_t startTime;
+    int64_t endTime;
+
+    //Inclusive range of the length in meters, negative for an open end
+    bool hasLength;
+    double minLength;
+    double maxLength;
+} GPXQuery;
+
+// A component being checked against a query, along with the properties worked out for it so far
+typedef struct {
+    void *data;
+    ComponentType type;
+
+    //Number of points, -1 until it is known
+    int64_t numPoints;
+
+    //Bounding box, only valid when hasBox is TRUE
+    bool hasBox;
+    BoundingBox box;
+
+    //Length in meters, only valid when hasLength is TRUE
+    bool hasLength;
+    float length;
+} QueryComponent;
+
+
+/** Function that compiles a filter expression.
+ * The expression is a list of terms separated by spaces, all of which have to hold:
+ *   type:waypoint|route|track       several types can be given separated by commas, all types match when left out
+ *   name:Trail*                     the name equals the value, or starts with it when it ends in *
+ *   points:MIN..MAX                 number of points, either end may be left out, a single number is an exact count
+ *   loop:true|false                 whether the component is a loop, using a 10m tolerance like routeToJSON
+ *   bbox:minLat,minLon,maxLat,maxLon the component's bounding box intersects the box
+ *   time:START..END                 the track has points recorded between the two ISO 8601 times
+ *   len:MIN..MAX                    length in meters, either end may be left out
+ * Values containing spaces can be written in double quotes, e.g. name:"Mount Steele*"
+ *@pre none
+ *@post Either:
+        A GPXQuery has been created and its address was returned
+		or
+		The expression could not be read, and NULL was returned
+ *@return the pointer to the new query or NULL
+ *@param expression - the filter expression
+**/
+GPXQuery *createGPXQuery(const char *expression);
+
+/** Function to delete a query and free all the memory.
+ *@pre GPXQuery object exists, is not null, and has not been freed
+ *@post GPXQuery object had been freed
+ *@return none
+ *@param query - a pointer to a GPXQuery struct
+**/
+void deleteGPXQuery(GPXQuery *query);
+
+/** Function that sets up a component to be checked against queries, nothing about it is worked out yet
+ *@pre component is not NULL, data is a Waypoint, Route or Track matching the type
+ *@post component refers to data
+ *@param component - the QueryComponent struct to set up
+ *@param data - a pointer to a Waypoint, Route or Track struct
+ *@param type - the type of data
+**/
+void initQueryComponent(QueryComponent *component, void *data, ComponentType type);
+
+/** Function that checks a component against a query.
+ * Predicates are checked from the cheapest to the most expensive and the check stops at the first that fails,
+ * properties that had to be worked out are kept in the component for later checks and for the JSON output
+ *@pre query and component are not NULL
+ *@post the component's data has not been modified
+ *@return TRUE if every predicate of the query holds, FALSE otherwise
+ *@param query - a pointer to a GPXQuery struct
+ *@param component - a pointer to the QueryComponent struct being checked
+**/
+bool componentMatchesQuery(const GPXQuery *query, QueryComponent *component);
+
+/** Function that returns every waypoint, route and track of a GPXdoc matching a query
+ *@pre query and doc are not NULL
+ *@post the doc has not been modified
+ *@return A string in JSON format, an array of {"type":..,"number":..,"name":..,"numPoints":..,"len":..,"loop":..}
+ *        where number counts from 1 within the component's list and the other fields are as in routeToJSON
+ *@param query - a pointer to a GPXQuery struct
+ *@param doc - a pointer to a GPXdoc struct
+**/
+char *queryDocToJSON(const GPXQuery *query, const GPXdoc *doc);
+
+/** Function that returns every waypoint, route and track of a corpus matching a query.
+ * The components are taken from the corpus spatial index, whose cached point counts and bounding boxes
+ * let most components be rejected without looking at their points
+ *@pre query and corpus are not NULL
+ *@post the documents of the corpus have not been modified
+ *@return A string in JSON format, an array of the same objects as queryDocToJSON with a "fileName" added
+ *@param query - a pointer to a GPXQuery struct
+ *@param corpus - a pointer to a GPXCorpus struct
+**/
+char *corpusQueryToJSON(const GPXQuery *query, GPXCorpus *corpus);
+
+#endif
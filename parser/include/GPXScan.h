@@ -0,0 +1,105 @@
+#ifndef GPX_SCAN_H
+#define GPX_SCAN_H
+
+#include "GPXParser.h"
+#include "GPXSpatial.h"
+
+// Delta in meters the scan's loop flags are checked with, the one routeToJSON and trackToJSON use
+#define SCAN_LOOP_DELTA 10
+
+// Summary of one route or track, worked out from the points as they are read and handed to the scan's callback
+// once the component's closing tag is reached.  None of the points are kept
+typedef struct {
+    //GPX_ROUTE or GPX_TRACK
+    ComponentType type;
+
+    //Position of the component among the routes or among the tracks of the file, counted from 0
+    int64_t position;
+
+    //Name of the component, an empty string if it has none.  Only valid during the callback.
+    const char* name;
+
+    //Number of points, and for tracks the number of segments they are spread over
+    int64_t numPoints;
+    int64_t numSegments;
+
+    //Length in meters, the same float sum getRouteLen and getTrackLen make, so the gaps between segments are not counted
+    float length;
+
+    //Whether the ends are within SCAN_LOOP_DELTA of each other, as isLoopRoute and isLoopTrack decide it
+    bool loop;
+
+    //Bounding box of the points, only valid when the component has points
+    BoundingBox box;
+} ScannedComponent;
+
+// Counts of a whole file, the values the getNum functions of GPXParser.h return for the GPXdoc of the same file
+typedef struct {
+    double version;
+
+    //Creator of the file, allocated by the scan and freed by clearGPXScan.  NULL until the root element is read.
+    char* creator;
+
+    int64_t numWaypoints;
+    int64_t numRoutes;
+    int64_t numTracks;
+    int64_t numSegments;
+    int64_t numGPXData;
+
+    //Bounding box of every waypoint, route point and track point, only valid when hasBox is TRUE
+    bool hasBox;
+    BoundingBox box;
+} GPXScan;
+
+// Called for every route and track in file order, returning FALSE stops the scan
+typedef bool (*ScanCallback)(void* context, const ScannedComponent* component);
+
+
+/** Function that reads a GPX file once from start to end and counts it without creating a GPXdoc or an XML tree.
+ * The file is read a node at a time with libxml2's reader, validated against the schema as it streams and checked against
+ * the requirements of the header file the way createValidGPXdoc and validateGPXDoc check them.  There is no GPXdoc to write back
+ * to a tree, so the second validation loadGPXdoc makes of that tree is not made.  That tree is written in schema order, so the
+ * second validation accepts every file the first one does and both reach the same verdict.  Memory does not grow with the number of
+ * components or points, which suits summary listings of large archives
+ *@pre scan is not NULL
+ *@post Either:
+        The file was valid, scan holds its counts, and every route and track was passed to onComponent
+		or
+		The file could not be read, failed validation, or the callback stopped the scan, and FALSE was returned.
+		scan may hold the counts of the part that was read, and onComponent may have been called for some components
+ *@return TRUE if the whole file was scanned and is valid, FALSE otherwise
+ *@param fileName - the name of a GPX file
+ *@param schema - a schema returned by xmlSchemaParse that the file is validated with, or NULL to scan it without validating
+ *@param scan - set to the counts of the file.  Its creator is allocated even when FALSE is returned, clearGPXScan frees it
+ *@param onComponent - called for every route and track, or NULL
+ *@param context - passed to onComponent
+**/
+bool scanGPXFile(char* fileName, xmlSchemaPtr schema, GPXScan* scan, ScanCallback onComponent, void* context);
+
+/** Function to free what a scan allocated
+ *@pre scan is not NULL
+ *@post the creator has been freed and set to NULL
+ *@return none
+ *@param scan - a pointer to a GPXScan struct filled in by scanGPXFile
+**/
+void clearGPXScan(GPXScan* scan);
+
+/** Function that writes a scanned route or track in the format of routeToJSON and trackToJSON
+ *@pre component is not NULL
+ *@post none
+ *@return A string in JSON format, {"name":..,"numPoints":..,"len":..,"loop":..}
+ *@param component - a pointer to a ScannedComponent struct
+**/
+char* scannedComponentToJSON(const ScannedComponent* component);
+
+/** Function that summarizes one file with a scan, the same way documentSummaryToJSON summarizes its GPXdoc
+ *@pre none
+ *@post none
+ *@return A string in JSON format, the summary of documentSummaryToJSON, or {} if the file is invalid
+ *@param filePath - the path of the GPX file
+ *@param fileName - the name the file is listed under
+ *@param schema - a schema returned by xmlSchemaParse that the file is validated with
+**/
+char* scanSummaryToJSON(char* filePath, const char* fileName, xmlSchemaPtr schema);
+
+#endif
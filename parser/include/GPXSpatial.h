@@ -0,0 +1,111 @@
+#ifndef GPX_SPATIAL_H
+#define GPX_SPATIAL_H
+
+#include "GPXParser.h"
+
+// Mean radius of the earth in meters, the same value used by the Haversine formula in GPXHelpers.c
+#define EARTH_RADIUS 6371000.0
+
+// Type of the GPX component an indexed edge belongs to
+typedef enum {
+    GPX_WAYPOINT,
+    GPX_ROUTE,
+    GPX_TRACK
+} ComponentType;
+
+// Axis aligned latitude/longitude box in degrees
+typedef struct {
+    double minLatitude;
+    double minLongitude;
+    double maxLatitude;
+    double maxLongitude;
+} BoundingBox;
+
+// A straight piece of a component's path between two consecutive points
+// Single point components (waypoints, one point routes) are stored as an edge with both ends on the same point
+typedef struct {
+    double latitude1;
+    double longitude1;
+    double latitude2;
+    double longitude2;
+
+    // Position of the edge's first point along the whole component path, counted across track segments
+    int order;
+
+    // Index of the component that owns this edge in the index's component array
+    int component;
+
+    BoundingBox box;
+} IndexedEdge;
+
+// A waypoint, route or track registered in the index along with the range of edges it owns
+typedef struct {
+    void *data;
+    ComponentType type;
+
+    // Index of the document the component was taken from, lets one index cover several files
+    int document;
+
+    // Position of the component inside its list in the GPXdoc
+    int position;
+
+    // Edges of a component are stored contiguously and in path order
+    int firstEdge;
+    int numEdges;
+    int numPoints;
+
+    BoundingBox box;
+} IndexedComponent;
+
+// Uniform grid over the extent of all indexed edges, each cell lists the edges whose bounding box overlaps it
+typedef struct {
+    IndexedComponent *components;
+    int numComponents;
+    int componentCapacity;
+
+    IndexedEdge *edges;
+    int numEdges;
+    int edgeCapacity;
+
+    BoundingBox extent;
+    int rows;
+    int columns;
+    double cellHeight;
+    double cellWidth;
+
+    // Compressed cell lists, the edges of cell c are cellEdges[cellStart[c]] to cellEdges[cellStart[c + 1] - 1]
+    int *cellStart;
+    int *cellEdges;
+} SpatialIndex;
+
+// Polygon made of an outer ring and any number of hole rings, points inside are decided with the even-odd rule
+typedef struct {
+    int numRings;
+    int numPoints;
+
+    // The points of ring r are latitudes/longitudes[ringStart[r]] to [ringStart[r + 1] - 1]
+    int *ringStart;
+    double *latitudes;
+    double *longitudes;
+
+    BoundingBox box;
+} Polygon;
+
+SpatialIndex *createSpatialIndex(void);
+void deleteSpatialIndex(SpatialIndex *index);
+void addDocToSpatialIndex(SpatialIndex *index, const GPXdoc *doc, int document);
+void buildSpatialIndex(SpatialIndex *index);
+void searchSpatialIndex(const SpatialIndex *index, double latitude, double longitude, double distance, double *firstPass, double *lastPass);
+int candidateEdgesInBox(const SpatialIndex *index, BoundingBox box, int **edges);
+int searchPathInSpatialIndex(const SpatialIndex *index, ComponentType type, bool through, double sourceLat, double sourceLong, double destLat, double destLong, double distance, int **components);
+
+Polygon *JSONtoPolygon(const char *ringsJSON);
+void deletePolygon(Polygon *polygon);
+bool pointInPolygon(const Polygon *polygon, double latitude, double longitude);
+int clipEdgeToPolygon(const Polygon *polygon, const IndexedEdge *edge, double *enter, double *leave, int maxPieces);
+
+bool boxesIntersect(BoundingBox box1, BoundingBox box2);
+BoundingBox boxAroundPoint(double latitude, double longitude, double distance);
+double distanceToEdge(double latitude, double longitude, const IndexedEdge *edge, double *fraction);
+
+#endif
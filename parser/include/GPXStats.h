@@ -0,0 +1,81 @@
+#ifndef GPX_STATS_H
+#define GPX_STATS_H
+
+#include "GPXParser.h"
+
+// Speed in meters per second below which a track is considered stopped, about 1.8 km/h
+#define DEFAULT_STOP_SPEED 0.5
+
+// Smallest climb or descent in meters that is counted towards elevation gain and loss
+#define DEFAULT_ELEVATION_HYSTERESIS 5.0
+
+// Motion statistics of a track segment or of a whole track
+typedef struct {
+    int64_t numPoints;
+
+    //Length of the path in meters
+    double distance;
+
+    //Seconds from the first to the last timed point, and the part of them spent moving at or above the stop speed
+    double duration;
+    double movingTime;
+
+    //Meters covered while moving, used for the moving speed and the pace
+    double movingDistance;
+
+    //Fastest speed between two consecutive timed points in meters per second
+    double maxSpeed;
+
+    //Meters climbed and descended, only changes of at least the hysteresis are counted
+    double elevationGain;
+    double elevationLoss;
+
+    //Earliest and latest point times in milliseconds since the Unix epoch, GPX_NO_TIME if no point has a time
+    int64_t startTime;
+    int64_t endTime;
+
+    //FALSE when no two consecutive points have times, or when no point has an elevation
+    bool hasTime;
+    bool hasElevation;
+} MotionStats;
+
+
+/** Function that computes the motion statistics of a track segment in a single pass over its point columns.
+ * A segment without columns, built through the API or too large for them, is read from its waypoints instead
+ *@pre TrackSegment is not NULL, stats is not NULL
+ *@post stats holds the statistics of the segment, the segment has not been modified
+ *@param segment - a pointer to a TrackSegment struct
+ *@param stopSpeed - speed in meters per second below which the track is considered stopped
+ *@param hysteresis - smallest elevation change in meters that is counted
+ *@param stats - the struct the statistics are written into
+**/
+void getSegmentStats(const TrackSegment *segment, double stopSpeed, double hysteresis, MotionStats *stats);
+
+/** Function that computes the motion statistics of a whole track and, optionally, of each of its segments.
+ * Distances, moving time and elevation changes are added up over the segments, the gaps between segments are not
+ * counted as moved, while the duration runs from the earliest to the latest point time of the track
+ *@pre Track is not NULL and was created by the parser, stats is not NULL
+ *@post stats holds the statistics of the track, the track has not been modified
+ *@param track - a pointer to a Track struct
+ *@param stopSpeed - speed in meters per second below which the track is considered stopped
+ *@param hysteresis - smallest elevation change in meters that is counted
+ *@param stats - the struct the track statistics are written into
+ *@param segmentStats - an array with room for every segment of the track, or NULL
+**/
+void getTrackStats(const Track *track, double stopSpeed, double hysteresis, MotionStats *stats, MotionStats *segmentStats);
+
+/** Function to converting the motion statistics of a Track into a JSON string
+ *@pre Track is not NULL
+ *@post Track has not been modified in any way
+ *@return A string in JSON format, {"name":..,"numPoints":..,"len":..,"duration":..,"movingTime":..,"averageSpeed":..,
+ *        "movingSpeed":..,"maxSpeed":..,"pace":..,"elevationGain":..,"elevationLoss":..,"segments":[..]}
+ *        with lengths and elevations in meters, times in seconds, speeds in meters per second and pace in seconds per
+ *        kilometer while moving. Each segment has the same fields apart from name and segments.
+ *        Fields that need times or elevations are null when the points do not have them
+ *@param track - a pointer to a Track struct
+ *@param stopSpeed - speed in meters per second below which the track is considered stopped
+ *@param hysteresis - smallest elevation change in meters that is counted
+**/
+char *trackStatsToJSON(const Track *track, double stopSpeed, double hysteresis);
+
+#endif
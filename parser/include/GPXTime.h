@@ -0,0 +1,109 @@
+#ifndef GPX_TIME_H
+#define GPX_TIME_H
+
+#include "GPXParser.h"
+
+// Longest string written by formatGPXTime, including the NULL terminator
+#define GPX_TIME_STRING_LENGTH 32
+
+// A track registered in a time index along with the first and last time of its points
+typedef struct {
+    Track *track;
+
+    // Index of the document the track was taken from, lets one index cover several files
+    int document;
+
+    // Position of the track inside the tracks list of its GPXdoc
+    int position;
+
+    int64_t startTime;
+    int64_t endTime;
+} TimedTrack;
+
+// Interval index over the time spans of tracks, answers "active between" queries with two binary searches
+typedef struct {
+    //Tracks that have at least one timed point, in the order they were added
+    TimedTrack *tracks;
+    int numTracks;
+    int trackCapacity;
+
+    //Positions in tracks sorted by startTime and by endTime.  NULL until buildTimeIndex is called.
+    int *byStart;
+    int *byEnd;
+} TimeIndex;
+
+
+/** Function that parses an ISO 8601 / xsd:dateTime string such as 2021-03-04T05:06:07.5Z.
+ * Times without a zone are taken as UTC, fractions of a second are kept to the millisecond
+ * Years further than 292000000 from year 0 are not accepted, their milliseconds would not fit in an int64_t
+ *@pre none
+ *@post the string has not been modified
+ *@return milliseconds since the Unix epoch, or GPX_NO_TIME if the string is not a valid time
+ *@param string - the time string, may be NULL
+**/
+int64_t parseGPXTime(const char *string);
+
+/** Function that writes a time as a UTC ISO 8601 string, milliseconds are only written when they are not 0.
+ * Years past the 292000000 parseGPXTime accepts either way are clamped to it
+ *@pre buffer holds at least GPX_TIME_STRING_LENGTH characters
+ *@post buffer holds the time string
+ *@return buffer
+ *@param time - milliseconds since the Unix epoch
+ *@param buffer - the string to write into
+**/
+char *formatGPXTime(int64_t time, char *buffer);
+
+/** Function that finds the earliest and latest point times of a track
+ *@pre Track is not NULL and was created by the parser
+ *@post Track has not been modified
+ *@return TRUE if the track has at least one timed point, FALSE otherwise
+ *@param track - a pointer to a Track struct
+ *@param startTime - set to the earliest point time
+ *@param endTime - set to the latest point time
+**/
+bool getTrackTimeRange(const Track *track, int64_t *startTime, int64_t *endTime);
+
+/** Function that finds the points of a track segment whose time lies between two times, inclusive.
+ * The points are returned as runs of consecutive points, a segment with ascending times has at most one run
+ * and is searched with a binary search instead of a scan
+ *@pre TrackSegment is not NULL
+ *@post runs holds 2 int64_t per run, the first and last point number of the run counted from 0.  The caller frees it.
+ *@return the number of runs
+ *@param segment - a pointer to a TrackSegment struct
+ *@param startTime - start of the window in milliseconds since the Unix epoch
+ *@param endTime - end of the window in milliseconds since the Unix epoch
+ *@param runs - set to an allocated array of runs, NULL when there are none
+**/
+int pointsInTimeWindow(const TrackSegment *segment, int64_t startTime, int64_t endTime, int64_t **runs);
+
+TimeIndex *createTimeIndex(void);
+void deleteTimeIndex(TimeIndex *index);
+
+/** Function that adds every track of a GPXdoc with timed points to a time index
+ *@pre the index has not been built yet
+ *@post the tracks are referenced by the index, the doc must outlive it
+ *@param index - a pointer to a TimeIndex struct
+ *@param doc - a pointer to a GPXdoc struct
+ *@param document - the number the matches of this doc are reported with
+**/
+void addDocToTimeIndex(TimeIndex *index, const GPXdoc *doc, int document);
+
+/** Function that sorts the tracks of the index so it can be searched, called once after the docs are added
+ *@pre index is not NULL
+ *@post index is ready for tracksActiveInTimeIndex
+ *@param index - a pointer to a TimeIndex struct
+**/
+void buildTimeIndex(TimeIndex *index);
+
+/** Function that finds the tracks whose time span overlaps a window, inclusive
+ *@pre index has been built
+ *@post matches holds positions in index -> tracks in ascending order, which is the order they were added in.  The caller frees it.
+ *@return the number of matching tracks
+ *@param index - a pointer to a built TimeIndex struct
+ *@param startTime - start of the window in milliseconds since the Unix epoch
+ *@param endTime - end of the window in milliseconds since the Unix epoch
+ *@param matches - set to an allocated array of matches, NULL when there are none
+**/
+int tracksActiveInTimeIndex(const TimeIndex *index, int64_t startTime, int64_t endTime, int **matches);
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef GPX_VISIT_H
+#define GPX_VISIT_H
+
+#include "GPXParser.h"
+#include "GPXSpatial.h"
+#include "GPXCompact.h"
+
+// Loops over the elements of a list as a typed variable declared before the loop, without allocating or casting.
+// break and continue work as in any for loop.  The list must not be changed while it is looped over
+#define GPX_FOR_EACH(type, variable, list) \
+    for (Node *variable##Node = (list) -> head; variable##Node != NULL && ((variable) = (type*)variable##Node -> data) != NULL; variable##Node = variable##Node -> next)
+
+#define GPX_FOR_EACH_WAYPOINT(waypoint, doc) GPX_FOR_EACH(Waypoint, waypoint, (doc) -> waypoints)
+#define GPX_FOR_EACH_ROUTE(route, doc) GPX_FOR_EACH(Route, route, (doc) -> routes)
+#define GPX_FOR_EACH_TRACK(track, doc) GPX_FOR_EACH(Track, track, (doc) -> tracks)
+#define GPX_FOR_EACH_SEGMENT(segment, track) GPX_FOR_EACH(TrackSegment, segment, (track) -> segments)
+
+// Loops over the points of an iterator opened with openRoutePoints, openSegmentPoints or openTrackPoints
+#define GPX_FOR_EACH_POINT(point, iterator) while (nextPoint(&(iterator), &(point)) == TRUE)
+
+// One point of a route or track, filled in by the point iterators and handed to visitors
+typedef struct {
+    double latitude;
+    double longitude;
+
+    //Elevation in meters and time in milliseconds since the Unix epoch of track points read from the segment columns.
+    //NAN and GPX_NO_TIME for route points, points that have none, and segments that have no columns.
+    double elevation;
+    int64_t time;
+
+    //Position of the point in its route, or in its track counting the points of every segment before its own
+    int64_t index;
+
+    //The waypoint the point was read from, NULL for track points that are read from the segment columns or compacted
+    const Waypoint* waypoint;
+} GPXPoint;
+
+// Walks the points of a route, a track segment or a whole track.  It lives on the caller's stack and never allocates
+typedef struct {
+    //Node of the next waypoint when points are read from a waypoints list, NULL otherwise
+    const Node* waypointNode;
+
+    //Segment whose columns or compacted coordinates are read with the cursor, NULL otherwise
+    const TrackSegment* segment;
+    SegmentCursor cursor;
+    int64_t runPosition;
+
+    //Node of the segment after the current one when a whole track is walked, NULL otherwise
+    const Node* segmentNode;
+
+    int64_t index;
+} PointIterator;
+
+// Callbacks of visitGPXdoc, any of them may be NULL.  Returning FALSE from a callback stops the visit
+typedef struct {
+    bool (*waypoint)(void* context, const Waypoint* waypoint, int position);
+    bool (*route)(void* context, const Route* route, int position);
+    bool (*track)(void* context, const Track* track, int position);
+    bool (*segment)(void* context, const Track* track, const TrackSegment* segment, int position);
+
+    //Called for every point of the route or track that was visited last, type is GPX_ROUTE or GPX_TRACK
+    bool (*point)(void* context, ComponentType type, const GPXPoint* point);
+} GPXVisitor;
+
+
+/** Function that starts walking the points of a route
+ *@pre iterator and route are not NULL
+ *@post the iterator is before the first point
+ *@return none
+ *@param iterator - a pointer to a PointIterator struct
+ *@param route - a pointer to a Route struct
+**/
+void openRoutePoints(PointIterator* iterator, const Route* route);
+
+/** Function that starts walking the points of a track segment, however its coordinates are stored
+ *@pre iterator and segment are not NULL
+ *@post the iterator is before the first point
+ *@return none
+ *@param iterator - a pointer to a PointIterator struct
+ *@param segment - a pointer to a TrackSegment struct
+**/
+void openSegmentPoints(PointIterator* iterator, const TrackSegment* segment);
+
+/** Function that starts walking the points of every segment of a track, one segment after the other
+ *@pre iterator and track are not NULL
+ *@post the iterator is before the first point
+ *@return none
+ *@param iterator - a pointer to a PointIterator struct
+ *@param track - a pointer to a Track struct
+**/
+void openTrackPoints(PointIterator* iterator, const Track* track);
+
+/** Function that moves an iterator to the next point
+ *@pre the iterator was opened, and its route or track has not been changed since
+ *@post the iterator is after the point
+ *@return TRUE if there was a point, FALSE once every point has been read
+ *@param iterator - a pointer to a PointIterator struct
+ *@param point - set to the point
+**/
+bool nextPoint(PointIterator* iterator, GPXPoint* point);
+
+/** Function that adds up the Haversine distances between the consecutive points of an iterator, in the float precision
+ * getRouteLen and getTrackLen have always used.  An iterator over a whole track counts the gaps between its segments,
+ * which getTrackLen does not
+ *@pre the iterator was opened and is before its first point
+ *@post every point of the iterator has been read
+ *@return the length in meters
+ *@param iterator - a pointer to a PointIterator struct
+**/
+float lengthOfPoints(PointIterator* iterator);
+
+/** Function that finds the first and last point of a route
+ *@pre route is not NULL
+ *@post none
+ *@return TRUE if the route has points, FALSE otherwise
+ *@param route - a pointer to a Route struct
+ *@param first - set to the first point
+ *@param last - set to the last point
+**/
+bool getRouteEnds(const Route* route, GPXPoint* first, GPXPoint* last);
+
+/** Function that finds the first point of the first segment of a track and the last point of its last segment,
+ * the ends the loop and between queries compare
+ *@pre track is not NULL
+ *@post none
+ *@return TRUE if both segments exist and have points, FALSE otherwise
+ *@param track - a pointer to a Track struct
+ *@param first - set to the first point
+ *@param last - set to the last point
+**/
+bool getTrackEnds(const Track* track, GPXPoint* first, GPXPoint* last);
+
+/** Function that visits the waypoints of a GPXdoc, then each route followed by its points, then each track followed by
+ * each of its segments and the segment's points.  Points are only walked when the visitor has a point callback,
+ * and nothing is allocated
+ *@pre doc and visitor are not NULL
+ *@post the doc has not been changed
+ *@return TRUE if every component was visited, FALSE if a callback stopped the visit
+ *@param doc - a pointer to a GPXdoc struct
+ *@param visitor - the callbacks
+ *@param context - passed to every callback
+**/
+bool visitGPXdoc(const GPXdoc* doc, const GPXVisitor* visitor, void* context);
+
+#endif
@@ -12,6 +12,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <assert.h>
 
 /**
@@ -33,7 +34,7 @@ typedef struct listNode{
 typedef struct listHead{
     Node* head;
     Node* tail;
-    int length;
+    int64_t length;
     void (*deleteData)(void* toBeDeleted);
     int (*compare)(const void* first,const void* second);
     char* (*printData)(void* toBePrinted);
@@ -197,7 +198,7 @@ void* nextElement(ListIterator* iter);
  *@param list - a pointer to the List struct.
  *@return on success: number of eleemnts in the list (0 or more).  on failure: -1 (e.g. list not initlized correctly)
  **/
-int getLength(List* list);
+int64_t getLength(List* list);
 
 
 /** Function that searches for an element in the list using a comparator function.
@@ -0,0 +1,392 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXBatch.h"
+#include "GPXVisit.h"
+#include "GPXSpatial.h"
+
+// The result of one query of a batch, added to by every document the batch runs over
+typedef struct {
+    //Numbers of waypoints, routes and tracks for BATCH_COUNT, only the first is used by the length queries
+    int64_t counts[3];
+
+    //JSON objects of the components found by the between, near and through queries, without the enclosing brackets
+    StringBuffer list;
+    int listLength;
+} BatchResult;
+
+static void parseBatchQuery(BatchQuery *query, char *text);
+static BatchResult *createBatchResults(const GPXBatch *batch);
+static void addDocToBatchResults(const GPXBatch *batch, BatchResult *results, const GPXdoc *doc, const char *fileName, bool indexPaths);
+static void addCorpusPathsToBatchResults(const GPXBatch *batch, BatchResult *results, GPXCorpus *corpus);
+static bool isPathQuery(BatchQueryType type);
+static char *batchResultsToJSON(const GPXBatch *batch, BatchResult *results);
+static bool endsAreBetween(const GPXPoint *firstPoint, const GPXPoint *lastPoint, const BatchQuery *query);
+static void appendBetweenComponent(BatchResult *result, char *componentString, const char *fileName);
+
+GPXBatch *createGPXBatch(const char *queries) {
+
+    // Error check the queries for NULL
+    if (queries == NULL) {
+        fprintf(stderr, "ERROR: Batch queries are NULL\n");
+        return(NULL);
+    }
+
+    GPXBatch *batch = malloc(sizeof(GPXBatch));
+    batch -> needsRouteLengths = FALSE;
+    batch -> needsTrackLengths = FALSE;
+
+    // Every semicolon starts another query
+    batch -> numQueries = 1;
+    for (const char *cursor = queries; *cursor != '\0'; cursor++) {
+        if (*cursor == ';') {
+            batch -> numQueries++;
+        }
+    }
+    batch -> queries = malloc(batch -> numQueries * sizeof(BatchQuery));
+
+    // Reading each query from a copy of its text, which is cut at the semicolon
+    char *text = malloc(strlen(queries) + 1);
+    strcpy(text, queries);
+    char *start = text;
+    for (int i = 0; i < batch -> numQueries; i++) {
+        char *end = strchr(start, ';');
+        if (end != NULL) {
+            *end = '\0';
+        }
+
+        // A trailing semicolon leaves an empty query at the end, which is dropped rather than reported as invalid
+        if (end == NULL && i > 0 && start[strspn(start, " \t\n")] == '\0') {
+            batch -> numQueries--;
+            break;
+        }
+        parseBatchQuery(&batch -> queries[i], start);
+
+        if (batch -> queries[i].type == BATCH_ROUTES_WITH_LENGTH) {
+            batch -> needsRouteLengths = TRUE;
+        }
+        else if (batch -> queries[i].type == BATCH_TRACKS_WITH_LENGTH) {
+            batch -> needsTrackLengths = TRUE;
+        }
+        if (end != NULL) {
+            start = end + 1;
+        }
+    }
+    free(text);
+
+    return(batch);
+}
+
+void deleteGPXBatch(GPXBatch *batch) {
+    if (batch == NULL) {
+        return;
+    }
+
+    // Freeing the queries and the batch itself
+    free(batch -> queries);
+    free(batch);
+}
+
+char *batchDocToJSON(const GPXBatch *batch, const GPXdoc *doc) {
+
+    // Error check the batch and doc for NULL
+    if (batch == NULL || doc == NULL) {
+        fprintf(stderr, "ERROR: GPXBatch or GPXdoc is NULL\n");
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Running every query over the document, the components found are written without a file name
+    BatchResult *results = createBatchResults(batch);
+    addDocToBatchResults(batch, results, doc, NULL, FALSE);
+
+    // Returns an allocated string of the results in JSON format
+    return(batchResultsToJSON(batch, results));
+}
+
+char *corpusBatchToJSON(const GPXBatch *batch, GPXCorpus *corpus) {
+
+    // Error check the batch and corpus for NULL
+    if (batch == NULL || corpus == NULL) {
+        fprintf(stderr, "ERROR: GPXBatch or GPXCorpus is NULL\n");
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Adding each document of the corpus to the results of every query, the near and through queries search the corpus index instead
+    BatchResult *results = createBatchResults(batch);
+    for (int i = 0; i < corpus -> numDocuments; i++) {
+        addDocToBatchResults(batch, results, corpus -> documents[i].doc, corpus -> documents[i].fileName, TRUE);
+    }
+    addCorpusPathsToBatchResults(batch, results, corpus);
+
+    // Returns an allocated string of the results in JSON format
+    return(batchResultsToJSON(batch, results));
+}
+
+static void parseBatchQuery(BatchQuery *query, char *text) {
+    static const char *names[] = {"count", "routesWithLength", "tracksWithLength", "routesBetween", "tracksBetween", "routesNear", "tracksNear", "routesThrough", "tracksThrough"};
+    static const int numArguments[] = {0, 2, 2, 5, 5, 3, 3, 5, 5};
+
+    // The name runs up to the first space
+    query -> type = BATCH_INVALID;
+    char *cursor = text + strspn(text, " \t\n");
+    size_t nameLength = strcspn(cursor, " \t\n");
+    for (int i = 0; i < BATCH_INVALID; i++) {
+        if (strlen(names[i]) == nameLength && strncmp(cursor, names[i], nameLength) == 0) {
+            query -> type = i;
+        }
+    }
+    if (query -> type == BATCH_INVALID) {
+        fprintf(stderr, "ERROR: Unknown batch query %.*s\n", (int)nameLength, cursor);
+        return;
+    }
+    cursor += nameLength;
+
+    // Reading exactly the number of arguments the query takes, NaN or infinity would make every comparison with them meaningless
+    for (int i = 0; i < numArguments[query -> type]; i++) {
+        char *end;
+        query -> arguments[i] = strtof(cursor, &end);
+        if (end == cursor) {
+            fprintf(stderr, "ERROR: Batch query %s is missing argument %d\n", names[query -> type], i + 1);
+            query -> type = BATCH_INVALID;
+            return;
+        }
+        if (!isfinite(query -> arguments[i])) {
+            fprintf(stderr, "ERROR: Argument %d of batch query %s is not a finite number\n", i + 1, names[query -> type]);
+            query -> type = BATCH_INVALID;
+            return;
+        }
+        cursor = end;
+    }
+    if (cursor[strspn(cursor, " \t\n")] != '\0') {
+        fprintf(stderr, "ERROR: Batch query %s has too many arguments\n", names[query -> type]);
+        query -> type = BATCH_INVALID;
+    }
+}
+
+static BatchResult *createBatchResults(const GPXBatch *batch) {
+    BatchResult *results = malloc((batch -> numQueries + 1) * sizeof(BatchResult));
+    for (int i = 0; i < batch -> numQueries; i++) {
+        results[i].counts[0] = 0;
+        results[i].counts[1] = 0;
+        results[i].counts[2] = 0;
+        results[i].listLength = 0;
+        if (batch -> queries[i].type == BATCH_ROUTES_BETWEEN || batch -> queries[i].type == BATCH_TRACKS_BETWEEN || isPathQuery(batch -> queries[i].type) == TRUE) {
+            initStringBuffer(&results[i].list);
+        }
+    }
+    return(results);
+}
+
+static void addDocToBatchResults(const GPXBatch *batch, BatchResult *results, const GPXdoc *doc, const char *fileName, bool indexPaths) {
+
+    // The lengths need the haversine formula for every pair of points, so they are worked out once for all the length queries
+    int64_t numRoutes = getLength(doc -> routes);
+    int64_t numTracks = getLength(doc -> tracks);
+    float *routeLengths = NULL;
+    float *trackLengths = NULL;
+    if (batch -> needsRouteLengths == TRUE) {
+        routeLengths = malloc((numRoutes + 1) * sizeof(float));
+        int64_t routeNumber = 0;
+        ListIterator routeIterator = createIterator(doc -> routes);
+        void *routeElement;
+        while ((routeElement = nextElement(&routeIterator)) != NULL) {
+            routeLengths[routeNumber++] = getRouteLen((Route*)routeElement);
+        }
+    }
+    if (batch -> needsTrackLengths == TRUE) {
+        trackLengths = malloc((numTracks + 1) * sizeof(float));
+        int64_t trackNumber = 0;
+        ListIterator trackIterator = createIterator(doc -> tracks);
+        void *trackElement;
+        while ((trackElement = nextElement(&trackIterator)) != NULL) {
+            trackLengths[trackNumber++] = getTrackLen((Track*)trackElement);
+        }
+    }
+
+    for (int i = 0; i < batch -> numQueries; i++) {
+        const BatchQuery *query = &batch -> queries[i];
+        BatchResult *result = &results[i];
+        GPXPoint firstPoint;
+        GPXPoint lastPoint;
+
+        if (query -> type == BATCH_COUNT) {
+            result -> counts[0] += getLength(doc -> waypoints);
+            result -> counts[1] += numRoutes;
+            result -> counts[2] += numTracks;
+        }
+
+        // Counting the lengths within delta of len the way numRoutesWithLength and numTracksWithLength do, which rejects negative arguments
+        else if (query -> type == BATCH_ROUTES_WITH_LENGTH || query -> type == BATCH_TRACKS_WITH_LENGTH) {
+            float len = query -> arguments[0];
+            float delta = query -> arguments[1];
+            if (len < 0 || delta < 0) {
+                continue;
+            }
+            float *lengths = (query -> type == BATCH_ROUTES_WITH_LENGTH) ? routeLengths : trackLengths;
+            int64_t numLengths = (query -> type == BATCH_ROUTES_WITH_LENGTH) ? numRoutes : numTracks;
+            for (int64_t j = 0; j < numLengths; j++) {
+                float differenceInLength = abs((int)(lengths[j] - len));
+                if (differenceInLength <= delta) {
+                    result -> counts[0]++;
+                }
+            }
+        }
+
+        // Finding the routes whose first and last waypoints are near the source and dest, as getRoutesBetween does
+        else if (query -> type == BATCH_ROUTES_BETWEEN) {
+            const Route *routeStruct;
+            GPX_FOR_EACH_ROUTE(routeStruct, doc) {
+                if (getRouteEnds(routeStruct, &firstPoint, &lastPoint) == TRUE && endsAreBetween(&firstPoint, &lastPoint, query) == TRUE) {
+                    appendBetweenComponent(result, routeToJSON(routeStruct), fileName);
+                }
+            }
+        }
+
+        // Finding the tracks whose first and last points are near the source and dest, as getTracksBetween does
+        else if (query -> type == BATCH_TRACKS_BETWEEN) {
+            const Track *trackStruct;
+            GPX_FOR_EACH_TRACK(trackStruct, doc) {
+                if (getTrackEnds(trackStruct, &firstPoint, &lastPoint) == TRUE && endsAreBetween(&firstPoint, &lastPoint, query) == TRUE) {
+                    appendBetweenComponent(result, trackToJSON(trackStruct), fileName);
+                }
+            }
+        }
+
+        // Finding the components whose path passes the points with a single pass over the document, unless the corpus index answers them
+        else if (isPathQuery(query -> type) == TRUE && indexPaths == FALSE) {
+            const float *arguments = query -> arguments;
+            List *components = NULL;
+            if (query -> type == BATCH_ROUTES_NEAR) {
+                components = getRoutesNear(doc, arguments[0], arguments[1], arguments[2]);
+            }
+            else if (query -> type == BATCH_TRACKS_NEAR) {
+                components = getTracksNear(doc, arguments[0], arguments[1], arguments[2]);
+            }
+            else if (query -> type == BATCH_ROUTES_THROUGH) {
+                components = getRoutesThrough(doc, arguments[0], arguments[1], arguments[2], arguments[3], arguments[4]);
+            }
+            else {
+                components = getTracksThrough(doc, arguments[0], arguments[1], arguments[2], arguments[3], arguments[4]);
+            }
+
+            // The lists are NULL when nothing matched, and only reference the components, which still belong to the doc
+            if (components == NULL) {
+                continue;
+            }
+            bool isRoute = (query -> type == BATCH_ROUTES_NEAR || query -> type == BATCH_ROUTES_THROUGH);
+            void *componentElement;
+            ListIterator componentIterator = createIterator(components);
+            while ((componentElement = nextElement(&componentIterator)) != NULL) {
+                appendBetweenComponent(result, isRoute ? routeToJSON((Route*)componentElement) : trackToJSON((Track*)componentElement), fileName);
+            }
+            freeList(components);
+        }
+    }
+
+    free(routeLengths);
+    free(trackLengths);
+}
+
+static char *batchResultsToJSON(const GPXBatch *batch, BatchResult *results) {
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "[");
+
+    // Writing the result of each query in the order the queries were given, freeing the lists as they are copied
+    for (int i = 0; i < batch -> numQueries; i++) {
+        BatchResult *result = &results[i];
+        if (i > 0) {
+            appendToStringBuffer(&JSONString, ",");
+        }
+
+        switch (batch -> queries[i].type) {
+            case BATCH_COUNT:
+                appendFormatToStringBuffer(&JSONString, "{\"numWaypoints\":%lld,\"numRoutes\":%lld,\"numTracks\":%lld}", (long long)result -> counts[0], (long long)result -> counts[1], (long long)result -> counts[2]);
+                break;
+            case BATCH_ROUTES_WITH_LENGTH:
+            case BATCH_TRACKS_WITH_LENGTH:
+                appendFormatToStringBuffer(&JSONString, "%lld", (long long)result -> counts[0]);
+                break;
+            case BATCH_ROUTES_BETWEEN:
+            case BATCH_TRACKS_BETWEEN:
+            case BATCH_ROUTES_NEAR:
+            case BATCH_TRACKS_NEAR:
+            case BATCH_ROUTES_THROUGH:
+            case BATCH_TRACKS_THROUGH:
+                appendFormatToStringBuffer(&JSONString, "[%s]", result -> list.string);
+                free(result -> list.string);
+                break;
+            default:
+                appendToStringBuffer(&JSONString, "null");
+                break;
+        }
+    }
+    appendToStringBuffer(&JSONString, "]");
+    free(results);
+
+    return(JSONString.string);
+}
+
+static bool endsAreBetween(const GPXPoint *firstPoint, const GPXPoint *lastPoint, const BatchQuery *query) {
+
+    // The distances are truncated to whole meters before comparing them with delta, like getRoutesBetween
+    int sourceDifference = haversineDistance(firstPoint -> latitude, firstPoint -> longitude, query -> arguments[0], query -> arguments[1]);
+    int destDifference = haversineDistance(lastPoint -> latitude, lastPoint -> longitude, query -> arguments[2], query -> arguments[3]);
+    return(sourceDifference <= query -> arguments[4] && destDifference <= query -> arguments[4]);
+}
+
+static void appendBetweenComponent(BatchResult *result, char *componentString, const char *fileName) {
+
+    // Components found in a corpus get the file name added as their first key, like corpusSummaryToJSON does
+    if (fileName != NULL) {
+        appendToStringBuffer(&result -> list, (result -> listLength == 0) ? "{\"fileName\":" : ",{\"fileName\":");
+        appendJSONStringToStringBuffer(&result -> list, fileName);
+        appendFormatToStringBuffer(&result -> list, ",%s", componentString + 1);
+    }
+    else {
+        appendFormatToStringBuffer(&result -> list, "%s%s", (result -> listLength == 0) ? "" : ",", componentString);
+    }
+    free(componentString);
+    result -> listLength++;
+}
+
+static void addCorpusPathsToBatchResults(const GPXBatch *batch, BatchResult *results, GPXCorpus *corpus) {
+
+    // Every near and through query searches the same corpus index, which is only built when one of them is in the batch
+    for (int i = 0; i < batch -> numQueries; i++) {
+        const BatchQuery *query = &batch -> queries[i];
+        if (isPathQuery(query -> type) == FALSE) {
+            continue;
+        }
+        SpatialIndex *index = getCorpusSpatialIndex(corpus);
+
+        // A near query is a through query without a destination
+        const float *arguments = query -> arguments;
+        bool through = (query -> type == BATCH_ROUTES_THROUGH || query -> type == BATCH_TRACKS_THROUGH);
+        ComponentType type = (query -> type == BATCH_ROUTES_NEAR || query -> type == BATCH_ROUTES_THROUGH) ? GPX_ROUTE : GPX_TRACK;
+        int *components = NULL;
+        int numComponents = 0;
+        if (through == TRUE) {
+            numComponents = searchPathInSpatialIndex(index, type, TRUE, arguments[0], arguments[1], arguments[2], arguments[3], arguments[4], &components);
+        }
+        else {
+            numComponents = searchPathInSpatialIndex(index, type, FALSE, arguments[0], arguments[1], 0, 0, arguments[2], &components);
+        }
+
+        // The components are listed in document order, each with the name of the file it came from
+        for (int j = 0; j < numComponents; j++) {
+            const IndexedComponent *component = &index -> components[components[j]];
+            const char *fileName = corpus -> documents[component -> document].fileName;
+            appendBetweenComponent(&results[i], (type == GPX_ROUTE) ? routeToJSON((Route*)component -> data) : trackToJSON((Track*)component -> data), fileName);
+        }
+        free(components);
+    }
+}
+
+static bool isPathQuery(BatchQueryType type) {
+    return(type == BATCH_ROUTES_NEAR || type == BATCH_TRACKS_NEAR || type == BATCH_ROUTES_THROUGH || type == BATCH_TRACKS_THROUGH);
+}
@@ -0,0 +1,268 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXCompact.h"
+
+// Longest zigzag varint a difference between two coordinates can take, they differ by less than 2^33
+#define COMPACT_MAX_VARINT 5
+
+static CompactCoordinates *encodeCoordinates(const double *latitudes, const double *longitudes, int64_t numPoints);
+static int decodeCompactBlock(const CompactCoordinates *coordinates, int64_t block, double *latitudes, double *longitudes);
+static uint8_t *writeZigzag(uint8_t *bytes, int64_t value);
+static int64_t readZigzag(const uint8_t **bytes);
+
+bool compactTrackSegment(TrackSegment *segment) {
+    if (segment == NULL || segment -> latitudes == NULL || segment -> compact != NULL) {
+        return(FALSE);
+    }
+
+    // Coordinates outside of WGS84, or that are not numbers, would not fit in 32 bit fixed point
+    for (int64_t i = 0; i < segment -> numPoints; i++) {
+        if (!(fabs(segment -> latitudes[i]) <= 90) || !(fabs(segment -> longitudes[i]) <= 180)) {
+            fprintf(stderr, "ERROR: Track segment has a coordinate outside of the WGS84 range\n");
+            return(FALSE);
+        }
+    }
+    CompactCoordinates *coordinates = encodeCoordinates(segment -> latitudes, segment -> longitudes, segment -> numPoints);
+    if (coordinates == NULL) {
+        return(FALSE);
+    }
+
+    // The compacted coordinates take the place of the coordinate columns and of the waypoints, elevations and times stay as they are
+    free(segment -> latitudes);
+    free(segment -> longitudes);
+    segment -> latitudes = NULL;
+    segment -> longitudes = NULL;
+    clearList(segment -> waypoints);
+    segment -> compact = coordinates;
+    return(TRUE);
+}
+
+int compactGPXdoc(GPXdoc *doc) {
+    if (doc == NULL) {
+        return(0);
+    }
+
+    // Compacting every segment of every track, segments that cannot be compacted are left as they are
+    int numCompacted = 0;
+    void *trackElement;
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+        void *segmentElement;
+        ListIterator segmentIterator = createIterator(((Track*)trackElement) -> segments);
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            if (compactTrackSegment((TrackSegment*)segmentElement) == TRUE) {
+                numCompacted++;
+            }
+        }
+    }
+    return(numCompacted);
+}
+
+void deleteCompactCoordinates(CompactCoordinates *coordinates) {
+    if (coordinates == NULL) {
+        return;
+    }
+    free(coordinates -> blockLatitudes);
+    free(coordinates -> blockLongitudes);
+    free(coordinates -> blockOffsets);
+    free(coordinates -> deltas);
+    free(coordinates);
+}
+
+int64_t getSegmentNumPoints(const TrackSegment *segment) {
+    if (segment -> compact != NULL) {
+        return(segment -> compact -> numPoints);
+    }
+    if (segment -> latitudes != NULL) {
+        return(segment -> numPoints);
+    }
+    return(getLength(segment -> waypoints));
+}
+
+bool getSegmentPoint(const TrackSegment *segment, int64_t index, double *latitude, double *longitude) {
+    int64_t numPoints = getSegmentNumPoints(segment);
+    if (index < 0) {
+        index += numPoints;
+    }
+    if (index < 0 || index >= numPoints) {
+        return(FALSE);
+    }
+
+    // Compacted points are found by decoding only the block that holds them
+    if (segment -> compact != NULL) {
+        double latitudes[COMPACT_BLOCK_POINTS];
+        double longitudes[COMPACT_BLOCK_POINTS];
+        decodeCompactBlock(segment -> compact, index / COMPACT_BLOCK_POINTS, latitudes, longitudes);
+        *latitude = latitudes[index % COMPACT_BLOCK_POINTS];
+        *longitude = longitudes[index % COMPACT_BLOCK_POINTS];
+        return(TRUE);
+    }
+    if (segment -> latitudes != NULL) {
+        *latitude = segment -> latitudes[index];
+        *longitude = segment -> longitudes[index];
+        return(TRUE);
+    }
+
+    // The ends of a waypoints list are found directly, any other point by walking the list
+    Waypoint *waypoint = NULL;
+    if (index == 0 || index == numPoints - 1) {
+        waypoint = (Waypoint*)((index == 0) ? getFromFront(segment -> waypoints) : getFromBack(segment -> waypoints));
+    }
+    else {
+        ListIterator waypointIterator = createIterator(segment -> waypoints);
+        for (int64_t i = 0; i <= index; i++) {
+            waypoint = (Waypoint*)nextElement(&waypointIterator);
+        }
+    }
+    *latitude = waypoint -> latitude;
+    *longitude = waypoint -> longitude;
+    return(TRUE);
+}
+
+void openSegmentCursor(SegmentCursor *cursor, const TrackSegment *segment) {
+    cursor -> segment = segment;
+    cursor -> firstPoint = 0;
+    cursor -> numPoints = 0;
+    cursor -> latitudes = NULL;
+    cursor -> longitudes = NULL;
+    cursor -> nextBlock = 0;
+    cursor -> waypointIterator.current = NULL;
+    if (segment -> compact == NULL && segment -> latitudes == NULL) {
+        cursor -> waypointIterator = createIterator(segment -> waypoints);
+    }
+}
+
+int64_t nextSegmentRun(SegmentCursor *cursor) {
+    const TrackSegment *segment = cursor -> segment;
+    cursor -> firstPoint += cursor -> numPoints;
+    cursor -> numPoints = 0;
+
+    // Compacted segments are decoded one block at a time into the cursor's buffers
+    if (segment -> compact != NULL) {
+        if (cursor -> nextBlock < segment -> compact -> numBlocks) {
+            cursor -> numPoints = decodeCompactBlock(segment -> compact, cursor -> nextBlock++, cursor -> latitudeBuffer, cursor -> longitudeBuffer);
+            cursor -> latitudes = cursor -> latitudeBuffer;
+            cursor -> longitudes = cursor -> longitudeBuffer;
+        }
+        return(cursor -> numPoints);
+    }
+
+    // Columns are handed out whole as a single run
+    if (segment -> latitudes != NULL) {
+        if (cursor -> nextBlock++ == 0) {
+            cursor -> numPoints = segment -> numPoints;
+            cursor -> latitudes = segment -> latitudes;
+            cursor -> longitudes = segment -> longitudes;
+        }
+        return(cursor -> numPoints);
+    }
+
+    // Waypoints are copied into the buffers a block at a time
+    void *waypointElement;
+    while (cursor -> numPoints < COMPACT_BLOCK_POINTS && (waypointElement = nextElement(&cursor -> waypointIterator)) != NULL) {
+        cursor -> latitudeBuffer[cursor -> numPoints] = ((Waypoint*)waypointElement) -> latitude;
+        cursor -> longitudeBuffer[cursor -> numPoints] = ((Waypoint*)waypointElement) -> longitude;
+        cursor -> numPoints++;
+    }
+    cursor -> latitudes = cursor -> latitudeBuffer;
+    cursor -> longitudes = cursor -> longitudeBuffer;
+    return(cursor -> numPoints);
+}
+
+static CompactCoordinates *encodeCoordinates(const double *latitudes, const double *longitudes, int64_t numPoints) {
+    CompactCoordinates *coordinates = calloc(1, sizeof(CompactCoordinates));
+    if (coordinates == NULL) {
+        return(NULL);
+    }
+    coordinates -> numPoints = numPoints;
+    coordinates -> numBlocks = (numPoints + COMPACT_BLOCK_POINTS - 1) / COMPACT_BLOCK_POINTS;
+    coordinates -> blockLatitudes = malloc((coordinates -> numBlocks + 1) * sizeof(int32_t));
+    coordinates -> blockLongitudes = malloc((coordinates -> numBlocks + 1) * sizeof(int32_t));
+    coordinates -> blockOffsets = malloc((coordinates -> numBlocks + 1) * sizeof(uint64_t));
+    coordinates -> deltas = malloc((size_t)numPoints * 2 * COMPACT_MAX_VARINT + 1);
+
+    // The differences of a very large segment take room for the longest varints until they are written, which may not be there
+    if (coordinates -> blockLatitudes == NULL || coordinates -> blockLongitudes == NULL || coordinates -> blockOffsets == NULL || coordinates -> deltas == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate the compacted coordinates of %lld points\n", (long long)numPoints);
+        deleteCompactCoordinates(coordinates);
+        return(NULL);
+    }
+
+    // Each block starts from a whole point, the points after it are written as differences from the point before them
+    uint8_t *cursor = coordinates -> deltas;
+    int64_t previousLatitude = 0;
+    int64_t previousLongitude = 0;
+    for (int64_t i = 0; i < numPoints; i++) {
+        int64_t latitude = llround(latitudes[i] * COMPACT_SCALE);
+        int64_t longitude = llround(longitudes[i] * COMPACT_SCALE);
+
+        // A longitude just under 180 would round up to 180, which the schema does not allow, so it stays one step below
+        if (longitude == (int64_t)(180 * COMPACT_SCALE) && longitudes[i] < 180) {
+            longitude--;
+        }
+        if (i % COMPACT_BLOCK_POINTS == 0) {
+            int64_t block = i / COMPACT_BLOCK_POINTS;
+            coordinates -> blockLatitudes[block] = (int32_t)latitude;
+            coordinates -> blockLongitudes[block] = (int32_t)longitude;
+            coordinates -> blockOffsets[block] = (uint64_t)(cursor - coordinates -> deltas);
+        }
+        else {
+            cursor = writeZigzag(cursor, latitude - previousLatitude);
+            cursor = writeZigzag(cursor, longitude - previousLongitude);
+        }
+        previousLatitude = latitude;
+        previousLongitude = longitude;
+    }
+
+    // Giving back the room that was reserved for the longest differences
+    coordinates -> numDeltaBytes = cursor - coordinates -> deltas;
+    uint8_t *deltas = realloc(coordinates -> deltas, coordinates -> numDeltaBytes + 1);
+    if (deltas != NULL) {
+        coordinates -> deltas = deltas;
+    }
+    return(coordinates);
+}
+
+static int decodeCompactBlock(const CompactCoordinates *coordinates, int64_t block, double *latitudes, double *longitudes) {
+    int64_t firstPoint = block * COMPACT_BLOCK_POINTS;
+    int numPoints = (coordinates -> numPoints - firstPoint < COMPACT_BLOCK_POINTS) ? coordinates -> numPoints - firstPoint : COMPACT_BLOCK_POINTS;
+
+    // Adding the differences back up from the block's first point, dividing gives the double closest to each 1e-7 degree value
+    int64_t latitude = coordinates -> blockLatitudes[block];
+    int64_t longitude = coordinates -> blockLongitudes[block];
+    const uint8_t *cursor = coordinates -> deltas + coordinates -> blockOffsets[block];
+    latitudes[0] = latitude / COMPACT_SCALE;
+    longitudes[0] = longitude / COMPACT_SCALE;
+    for (int i = 1; i < numPoints; i++) {
+        latitude += readZigzag(&cursor);
+        longitude += readZigzag(&cursor);
+        latitudes[i] = latitude / COMPACT_SCALE;
+        longitudes[i] = longitude / COMPACT_SCALE;
+    }
+    return(numPoints);
+}
+
+static uint8_t *writeZigzag(uint8_t *bytes, int64_t value) {
+
+    // Zigzag encoding puts small negative differences next to small positive ones, then 7 bits go in each byte
+    uint64_t encoded = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    while (encoded >= 0x80) {
+        *bytes++ = (uint8_t)(encoded | 0x80);
+        encoded >>= 7;
+    }
+    *bytes++ = (uint8_t)encoded;
+    return(bytes);
+}
+
+static int64_t readZigzag(const uint8_t **bytes) {
+    uint64_t encoded = 0;
+    int shift = 0;
+    const uint8_t *cursor = *bytes;
+    while (*cursor & 0x80) {
+        encoded |= (uint64_t)(*cursor++ & 0x7F) << shift;
+        shift += 7;
+    }
+    encoded |= (uint64_t)(*cursor++) << shift;
+    *bytes = cursor;
+    return((int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1));
+}
@@ -0,0 +1,560 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXCorpus.h"
+#include "GPXLoader.h"
+#include <dirent.h>
+#include <pthread.h>
+#include <unistd.h>
+
+// Most inside pieces kept for a single edge when clipping it to a polygon
+#define MAX_EDGE_PIECES 16
+
+// Most threads used to load the files of a corpus
+#define MAX_LOADER_THREADS 8
+
+// Work shared by the threads loading a corpus, each thread takes the next file that nobody has started on
+typedef struct {
+    char *directory;
+    char **fileNames;
+    int numFiles;
+
+    //Schema parsed once and shared by every thread, NULL if it could not be parsed
+    xmlSchemaPtr schema;
+
+    //Valid GPXdoc of each file, NULL for files that failed
+    GPXdoc **docs;
+
+    int nextFile;
+    pthread_mutex_t lock;
+} CorpusLoader;
+
+static int compareFileNames(const void *first, const void *second);
+static char *componentName(const IndexedComponent *component);
+static const char *componentTypeName(ComponentType type);
+static void appendRange(StringBuffer *ranges, int numRanges, double enter, double leave);
+static char *trackName(const Track *track);
+static void *loadCorpusFiles(void *argument);
+static void writeDocumentSummary(JSONWriter *writer, const char *fileName, const GPXdoc *doc);
+static void writeComponentsWithFileName(JSONWriter *writer, List *list, char *(*toJSON)(const void*), const char *fileName);
+static char *routeDataToJSON(const void *data);
+static char *trackDataToJSON(const void *data);
+
+GPXCorpus* createGPXCorpus(char* directory, char* gpxSchemaFile) {
+
+    // Error checking the directory and schema file names
+    if (directory == NULL || (strcmp(directory, "") == 0)) {
+        fprintf(stderr, "ERROR: Empty/NULL directory name\n");
+        return(NULL);
+    }
+    if (gpxSchemaFile == NULL || (strcmp(gpxSchemaFile, "") == 0)) {
+        fprintf(stderr, "ERROR: Empty/NULL Schema File Name\n");
+        return(NULL);
+    }
+
+    // Opening the directory holding the GPX files
+    DIR *directoryStream = opendir(directory);
+    if (directoryStream == NULL) {
+        fprintf(stderr, "ERROR: could not open directory %s\n", directory);
+        return(NULL);
+    }
+
+    // Reading the names of all the files, skipping hidden entries such as "." and ".."
+    int numFiles = 0;
+    int fileCapacity = 16;
+    char **fileNames = malloc(fileCapacity * sizeof(char*));
+    struct dirent *entry;
+    while ((entry = readdir(directoryStream)) != NULL) {
+        if (entry -> d_name[0] == '.') {
+            continue;
+        }
+        if (numFiles == fileCapacity) {
+            fileCapacity *= 2;
+            fileNames = realloc(fileNames, fileCapacity * sizeof(char*));
+        }
+        fileNames[numFiles] = malloc(strlen(entry -> d_name) + 1);
+        strcpy(fileNames[numFiles], entry -> d_name);
+        numFiles++;
+    }
+    closedir(directoryStream);
+
+    // Sorting the names so the corpus lists files in the same order as the uploads listing in app.js
+    qsort(fileNames, numFiles, sizeof(char*), &compareFileNames);
+
+    // Allocating the corpus with room for every file, documents and failed files share the file name strings
+    GPXCorpus *corpus = malloc(sizeof(GPXCorpus));
+    corpus -> directory = malloc(strlen(directory) + 1);
+    strcpy(corpus -> directory, directory);
+    corpus -> documents = malloc((numFiles + 1) * sizeof(CorpusDocument));
+    corpus -> numDocuments = 0;
+    corpus -> failedFiles = malloc((numFiles + 1) * sizeof(char*));
+    corpus -> numFailedFiles = 0;
+    corpus -> spatialIndex = NULL;
+    corpus -> timeIndex = NULL;
+
+    // Setting up the loader, the Schema is parsed once before any thread starts, which initializes the library if it is not already
+    CorpusLoader loader;
+    loader.directory = directory;
+    loader.fileNames = fileNames;
+    loader.numFiles = numFiles;
+    loader.schema = parseSchemaFile(gpxSchemaFile);
+    loader.docs = calloc(numFiles + 1, sizeof(GPXdoc*));
+    loader.nextFile = 0;
+    pthread_mutex_init(&loader.lock, NULL);
+
+    // Creating and validating a GPXdoc for each file, the same checks as createValidGPXdoc and validateGPXDoc
+    // The calling thread loads files as well, so one file or one processor needs no extra thread
+    if (loader.schema != NULL) {
+        long numProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+        int numThreads = (numProcessors < 1) ? 1 : (numProcessors > MAX_LOADER_THREADS) ? MAX_LOADER_THREADS : (int)numProcessors;
+        numThreads = (numThreads > numFiles) ? numFiles : numThreads;
+
+        pthread_t threads[MAX_LOADER_THREADS];
+        int numStarted = 0;
+        for (int i = 1; i < numThreads; i++) {
+            if (pthread_create(&threads[numStarted], NULL, &loadCorpusFiles, &loader) == 0) {
+                numStarted++;
+            }
+        }
+        loadCorpusFiles(&loader);
+        for (int i = 0; i < numStarted; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        xmlSchemaFree(loader.schema);
+    }
+    pthread_mutex_destroy(&loader.lock);
+
+    // Sorting the results into documents and failed files, keeping the file name order
+    for (int i = 0; i < numFiles; i++) {
+        if (loader.docs[i] != NULL) {
+            corpus -> documents[corpus -> numDocuments].fileName = fileNames[i];
+            corpus -> documents[corpus -> numDocuments].doc = loader.docs[i];
+            corpus -> numDocuments++;
+        }
+        else {
+            corpus -> failedFiles[corpus -> numFailedFiles++] = fileNames[i];
+        }
+    }
+    free(loader.docs);
+    free(fileNames);
+
+    return(corpus);
+}
+
+void deleteGPXCorpus(GPXCorpus* corpus) {
+    if (corpus == NULL) {
+        return;
+    }
+
+    // Freeing every document and file name, then the arrays and the corpus itself
+    for (int i = 0; i < corpus -> numDocuments; i++) {
+        free(corpus -> documents[i].fileName);
+        deleteGPXdoc(corpus -> documents[i].doc);
+    }
+    for (int i = 0; i < corpus -> numFailedFiles; i++) {
+        free(corpus -> failedFiles[i]);
+    }
+    deleteSpatialIndex(corpus -> spatialIndex);
+    deleteTimeIndex(corpus -> timeIndex);
+    free(corpus -> documents);
+    free(corpus -> failedFiles);
+    free(corpus -> directory);
+    free(corpus);
+}
+
+SpatialIndex* getCorpusSpatialIndex(GPXCorpus* corpus) {
+
+    // Error check the corpus for NULL
+    if (corpus == NULL) {
+        fprintf(stderr, "ERROR: GPXCorpus is NULL\n");
+        return(NULL);
+    }
+
+    // Building the index the first time it is needed, the documents of a corpus do not change afterwards
+    if (corpus -> spatialIndex == NULL) {
+        corpus -> spatialIndex = createSpatialIndex();
+        for (int i = 0; i < corpus -> numDocuments; i++) {
+            addDocToSpatialIndex(corpus -> spatialIndex, corpus -> documents[i].doc, i);
+        }
+        buildSpatialIndex(corpus -> spatialIndex);
+    }
+
+    return(corpus -> spatialIndex);
+}
+
+char* corpusGeofenceToJSON(GPXCorpus* corpus, const char* polygonJSON) {
+
+    // Error check the corpus for NULL and make sure the polygon could be read
+    Polygon *polygon = JSONtoPolygon(polygonJSON);
+    if (corpus == NULL || polygon == NULL) {
+        fprintf(stderr, "ERROR: GPXCorpus is NULL or polygon is invalid\n");
+        deletePolygon(polygon);
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Only the edges whose bounding box overlaps the polygon's can touch it, they come back in path order
+    SpatialIndex *index = getCorpusSpatialIndex(corpus);
+    int *candidates = NULL;
+    int numCandidates = candidateEdgesInBox(index, polygon -> box, &candidates);
+
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "[");
+    bool firstMatch = TRUE;
+
+    // Working through the candidates one component at a time
+    int i = 0;
+    while (i < numCandidates) {
+        int componentNumber = index -> edges[candidates[i]].component;
+        const IndexedComponent *component = &index -> components[componentNumber];
+
+        StringBuffer ranges;
+        initStringBuffer(&ranges);
+        bool rangeOpen = FALSE;
+        double rangeEnter = 0;
+        double rangeLeave = 0;
+        int numRanges = 0;
+        int edgesInside = 0;
+
+        for (; i < numCandidates && index -> edges[candidates[i]].component == componentNumber; i++) {
+            const IndexedEdge *edge = &index -> edges[candidates[i]];
+
+            // Clipping the edge to the polygon, the pieces are fractions along the edge
+            double enter[MAX_EDGE_PIECES];
+            double leave[MAX_EDGE_PIECES];
+            int numPieces = clipEdgeToPolygon(polygon, edge, enter, leave, MAX_EDGE_PIECES);
+            if (numPieces == 1 && enter[0] == 0 && (leave[0] == 1 || (edge -> latitude1 == edge -> latitude2 && edge -> longitude1 == edge -> longitude2))) {
+                edgesInside++;
+            }
+
+            for (int piece = 0; piece < numPieces; piece++) {
+                double pieceEnter = edge -> order + enter[piece];
+                double pieceLeave = edge -> order + leave[piece];
+
+                // A piece that starts where the open range stops continues it, otherwise the open range is finished
+                if (rangeOpen == TRUE && pieceEnter == rangeLeave) {
+                    rangeLeave = pieceLeave;
+                    continue;
+                }
+                if (rangeOpen == TRUE) {
+                    appendRange(&ranges, numRanges, rangeEnter, rangeLeave);
+                    numRanges++;
+                }
+                rangeOpen = TRUE;
+                rangeEnter = pieceEnter;
+                rangeLeave = pieceLeave;
+            }
+        }
+        if (rangeOpen == TRUE) {
+            appendRange(&ranges, numRanges, rangeEnter, rangeLeave);
+            numRanges++;
+        }
+
+        // Adding the component to the result when any part of it is inside the polygon
+        if (numRanges > 0) {
+            char *name = componentName(component);
+            appendToStringBuffer(&JSONString, (firstMatch == TRUE) ? "{\"fileName\":" : ",{\"fileName\":");
+            appendJSONStringToStringBuffer(&JSONString, corpus -> documents[component -> document].fileName);
+            appendFormatToStringBuffer(&JSONString, ",\"type\":\"%s\",\"number\":%d,\"name\":", componentTypeName(component -> type), component -> position + 1);
+            appendJSONStringToStringBuffer(&JSONString, name);
+            appendFormatToStringBuffer(&JSONString, ",\"inside\":%s,\"ranges\":[%s]}", (edgesInside == component -> numEdges) ? "true" : "false", ranges.string);
+            firstMatch = FALSE;
+        }
+        free(ranges.string);
+    }
+    appendToStringBuffer(&JSONString, "]");
+
+    free(candidates);
+    deletePolygon(polygon);
+
+    // Returns an allocated string of the matching components in JSON format
+    return(JSONString.string);
+}
+
+TimeIndex* getCorpusTimeIndex(GPXCorpus* corpus) {
+
+    // Error check the corpus for NULL
+    if (corpus == NULL) {
+        fprintf(stderr, "ERROR: GPXCorpus is NULL\n");
+        return(NULL);
+    }
+
+    // Building the index the first time it is needed, the same way as the spatial index
+    if (corpus -> timeIndex == NULL) {
+        corpus -> timeIndex = createTimeIndex();
+        for (int i = 0; i < corpus -> numDocuments; i++) {
+            addDocToTimeIndex(corpus -> timeIndex, corpus -> documents[i].doc, i);
+        }
+        buildTimeIndex(corpus -> timeIndex);
+    }
+
+    return(corpus -> timeIndex);
+}
+
+char* corpusTracksActiveToJSON(GPXCorpus* corpus, int64_t startTime, int64_t endTime) {
+
+    // Finding the tracks whose span overlaps the window, they come back in file and track order
+    int *matches = NULL;
+    int numMatches = tracksActiveInTimeIndex(getCorpusTimeIndex(corpus), startTime, endTime, &matches);
+
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "[");
+
+    for (int i = 0; i < numMatches; i++) {
+        const TimedTrack *timedTrack = &corpus -> timeIndex -> tracks[matches[i]];
+        char start[GPX_TIME_STRING_LENGTH];
+        char end[GPX_TIME_STRING_LENGTH];
+        appendToStringBuffer(&JSONString, (i == 0) ? "{\"fileName\":" : ",{\"fileName\":");
+        appendJSONStringToStringBuffer(&JSONString, corpus -> documents[timedTrack -> document].fileName);
+        appendFormatToStringBuffer(&JSONString, ",\"number\":%d,\"name\":", timedTrack -> position + 1);
+        appendJSONStringToStringBuffer(&JSONString, trackName(timedTrack -> track));
+        appendFormatToStringBuffer(&JSONString, ",\"startTime\":\"%s\",\"endTime\":\"%s\"}", formatGPXTime(timedTrack -> startTime, start), formatGPXTime(timedTrack -> endTime, end));
+    }
+    appendToStringBuffer(&JSONString, "]");
+    free(matches);
+
+    // Returns an allocated string of the active tracks in JSON format
+    return(JSONString.string);
+}
+
+char* corpusPointsInTimeWindowToJSON(GPXCorpus* corpus, int64_t startTime, int64_t endTime) {
+
+    // Only tracks active in the window can hold points in it, so the segments of every other track are never looked at
+    int *matches = NULL;
+    int numMatches = tracksActiveInTimeIndex(getCorpusTimeIndex(corpus), startTime, endTime, &matches);
+
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "[");
+    bool firstMatch = TRUE;
+
+    for (int i = 0; i < numMatches; i++) {
+        const TimedTrack *timedTrack = &corpus -> timeIndex -> tracks[matches[i]];
+
+        // Collecting the runs of every segment of the track
+        StringBuffer runsString;
+        initStringBuffer(&runsString);
+        int64_t numPoints = 0;
+        int numRuns = 0;
+        int segmentNumber = 1;
+        ListIterator segmentIterator = createIterator(timedTrack -> track -> segments);
+        void *segmentElement;
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            int64_t *runs = NULL;
+            int numSegmentRuns = pointsInTimeWindow((TrackSegment*)segmentElement, startTime, endTime, &runs);
+            for (int run = 0; run < numSegmentRuns; run++) {
+                appendFormatToStringBuffer(&runsString, "%s{\"segment\":%d,\"first\":%lld,\"last\":%lld}", (numRuns == 0) ? "" : ",", segmentNumber, (long long)runs[2 * run], (long long)runs[2 * run + 1]);
+                numPoints += runs[2 * run + 1] - runs[2 * run] + 1;
+                numRuns++;
+            }
+            free(runs);
+            segmentNumber++;
+        }
+
+        // A track can span the window without a point inside it, those are left out
+        if (numRuns > 0) {
+            appendToStringBuffer(&JSONString, (firstMatch == TRUE) ? "{\"fileName\":" : ",{\"fileName\":");
+            appendJSONStringToStringBuffer(&JSONString, corpus -> documents[timedTrack -> document].fileName);
+            appendFormatToStringBuffer(&JSONString, ",\"number\":%d,\"name\":", timedTrack -> position + 1);
+            appendJSONStringToStringBuffer(&JSONString, trackName(timedTrack -> track));
+            appendFormatToStringBuffer(&JSONString, ",\"numPoints\":%lld,\"runs\":[%s]}", (long long)numPoints, runsString.string);
+            firstMatch = FALSE;
+        }
+        free(runsString.string);
+    }
+    appendToStringBuffer(&JSONString, "]");
+    free(matches);
+
+    // Returns an allocated string of the tracks and their points in the window in JSON format
+    return(JSONString.string);
+}
+
+char* corpusSummaryToJSON(GPXCorpus* corpus) {
+
+    // Error check the corpus for NULL
+    if (corpus == NULL) {
+        fprintf(stderr, "ERROR: GPXCorpus is NULL\n");
+        char *JSONString = malloc(34);
+        strcpy(JSONString, "{\"files\":[],\"failedFiles\":[]}");
+        return(JSONString);
+    }
+
+    // Writing the summary into the thread's scratch buffer, which is copied out at its exact size
+    StringBuffer *JSONString = getScratchBuffer();
+    JSONWriter writer;
+    initJSONWriter(&writer, &stringBufferSink, JSONString);
+    writeCorpusSummary(&writer, corpus);
+
+    // Returns an allocated string of the corpus summary in JSON format
+    return(scratchBufferToString(JSONString));
+}
+
+bool writeCorpusSummary(JSONWriter* writer, GPXCorpus* corpus) {
+
+    // A directory that could not be read is summarized as empty
+    writeJSONText(writer, "{\"files\":[");
+
+    // Writing the summary of each file, only one component string exists at a time
+    for (int i = 0; corpus != NULL && i < corpus -> numDocuments; i++) {
+        if (i > 0) {
+            writeJSONText(writer, ",");
+        }
+        writeDocumentSummary(writer, corpus -> documents[i].fileName, corpus -> documents[i].doc);
+    }
+
+    // Listing the files that could not be loaded
+    writeJSONText(writer, "],\"failedFiles\":[");
+    for (int i = 0; corpus != NULL && i < corpus -> numFailedFiles; i++) {
+        writeJSONText(writer, (i == 0) ? "" : ",");
+        writeJSONString(writer, corpus -> failedFiles[i]);
+    }
+    writeJSONText(writer, "]}");
+    return(flushJSONWriter(writer));
+}
+
+char* documentSummaryToJSON(const char* fileName, const GPXdoc* doc) {
+
+    // Error check the file name and doc for NULL
+    if (fileName == NULL || doc == NULL) {
+        fprintf(stderr, "ERROR: File name or GPXdoc is NULL\n");
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "{}");
+        return(JSONString);
+    }
+
+    // Writing the summary into the thread's scratch buffer, which is copied out at its exact size
+    StringBuffer *JSONString = getScratchBuffer();
+    JSONWriter writer;
+    initJSONWriter(&writer, &stringBufferSink, JSONString);
+    writeDocumentSummary(&writer, fileName, doc);
+    flushJSONWriter(&writer);
+
+    // Returns an allocated string of the file summary in JSON format
+    return(scratchBufferToString(JSONString));
+}
+
+static int compareFileNames(const void *first, const void *second) {
+    return(strcmp(*(char* const*)first, *(char* const*)second));
+}
+
+static char *componentName(const IndexedComponent *component) {
+
+    // Getting the name of the waypoint, route or track, empty names are shown as "None" like routeToJSON does
+    char *name = "";
+    if (component -> type == GPX_WAYPOINT) {
+        name = ((Waypoint*)component -> data) -> name;
+    }
+    else if (component -> type == GPX_ROUTE) {
+        name = ((Route*)component -> data) -> name;
+    }
+    else {
+        name = ((Track*)component -> data) -> name;
+    }
+
+    if (strcmp(name, "") == 0) {
+        return("None");
+    }
+    return(name);
+}
+
+static const char *componentTypeName(ComponentType type) {
+    if (type == GPX_WAYPOINT) {
+        return("waypoint");
+    }
+    if (type == GPX_ROUTE) {
+        return("route");
+    }
+    return("track");
+}
+
+static void appendRange(StringBuffer *ranges, int numRanges, double enter, double leave) {
+
+    // Ranges are [enter,leave] positions along the component, to a thousandth of an edge
+    appendToStringBuffer(ranges, (numRanges > 0) ? ",[" : "[");
+    appendFixedToStringBuffer(ranges, enter, 3);
+    appendToStringBuffer(ranges, ",");
+    appendFixedToStringBuffer(ranges, leave, 3);
+    appendToStringBuffer(ranges, "]");
+}
+
+static char *trackName(const Track *track) {
+
+    // Empty track names are shown as "None" like trackToJSON does
+    if (strcmp(track -> name, "") == 0) {
+        return("None");
+    }
+    return(track -> name);
+}
+
+static void *loadCorpusFiles(void *argument) {
+    CorpusLoader *loader = (CorpusLoader*)argument;
+
+    // Each thread reads all of its files with one GPXLoader, so the parser context and its dictionary are set up once per thread rather than once per file
+    GPXLoader *fileLoader = createGPXLoader(loader -> schema);
+    if (fileLoader == NULL) {
+        return(NULL);
+    }
+
+    while (TRUE) {
+        // Taking the next file nobody has started on
+        pthread_mutex_lock(&loader -> lock);
+        int file = loader -> nextFile++;
+        pthread_mutex_unlock(&loader -> lock);
+        if (file >= loader -> numFiles) {
+            break;
+        }
+
+        // Each thread writes only the slot of the file it took, so the results need no lock
+        char *filePath = malloc(strlen(loader -> directory) + 1 + strlen(loader -> fileNames[file]) + 1);
+        sprintf(filePath, "%s/%s", loader -> directory, loader -> fileNames[file]);
+        loader -> docs[file] = loadGPXdoc(fileLoader, filePath);
+        free(filePath);
+    }
+    deleteGPXLoader(fileLoader);
+
+    return(NULL);
+}
+
+static void writeDocumentSummary(JSONWriter *writer, const char *fileName, const GPXdoc *doc) {
+
+    // Writing the GPXtoJSON attributes of the file followed by its routes and tracks, all tagged with the file name
+    writeJSONText(writer, "{\"fileName\":");
+    writeJSONString(writer, fileName);
+    writeJSONText(writer, ",\"version\":");
+    writeJSONFixed(writer, doc -> version, 1);
+    writeJSONText(writer, ",\"creator\":");
+    writeJSONString(writer, doc -> creator);
+    writeJSONFormat(writer, ",\"numWaypoints\":%lld,\"numRoutes\":%lld,\"numTracks\":%lld,\"routes\":[", (long long)getLength(doc -> waypoints), (long long)getLength(doc -> routes), (long long)getLength(doc -> tracks));
+    writeComponentsWithFileName(writer, doc -> routes, &routeDataToJSON, fileName);
+    writeJSONText(writer, "],\"tracks\":[");
+    writeComponentsWithFileName(writer, doc -> tracks, &trackDataToJSON, fileName);
+    writeJSONText(writer, "]}");
+}
+
+static void writeComponentsWithFileName(JSONWriter *writer, List *list, char *(*toJSON)(const void*), const char *fileName) {
+
+    // Writing each component's JSON with the file name added as its first key, the way app.js used to add it
+    int number = 0;
+    ListIterator iterator = createIterator(list);
+    void *element;
+    while ((element = nextElement(&iterator)) != NULL) {
+        char *componentString = toJSON(element);
+        writeJSONText(writer, (number == 0) ? "{\"fileName\":" : ",{\"fileName\":");
+        writeJSONString(writer, fileName);
+        writeJSONText(writer, ",");
+        writeJSONText(writer, componentString + 1);
+        free(componentString);
+        number++;
+    }
+}
+
+static char *routeDataToJSON(const void *data) {
+    return(routeToJSON((const Route*)data));
+}
+
+static char *trackDataToJSON(const void *data) {
+    return(trackToJSON((const Track*)data));
+}
@@ -0,0 +1,139 @@
+#include "GPXParser.h"
+#include "GPXDataNames.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+// Names added at run time are kept in chunks, so neither the strings nor their slots move once other threads can see them
+#define NAME_CHUNK_SIZE 256
+#define NAME_NUM_CHUNKS ((GPX_MAX_DATA_NAMES + NAME_CHUNK_SIZE) / NAME_CHUNK_SIZE)
+
+// Strings of the names with a GPXKnownDataName id, in the order of the enum
+static const char *knownNames[GPX_NUM_KNOWN_DATA_NAMES] = {
+    NULL, "ele", "time", "magvar", "geoidheight", "cmt", "desc", "src", "link", "sym", "type", "fix",
+    "sat", "hdop", "vdop", "pdop", "ageofdgpsdata", "dgpsid", "number", "extensions"
+};
+
+// Guards the names added at run time and the hash table of their ids
+static pthread_mutex_t namesMutex = PTHREAD_MUTEX_INITIALIZER;
+static const char **nameChunks[NAME_NUM_CHUNKS];
+static int nextNameId = GPX_NUM_KNOWN_DATA_NAMES;
+static bool reportedFull = FALSE;
+
+// Open addressing table of the ids of the names added at run time, a power of two in size with 0 marking an empty slot
+static GPXNameId *nameSlots = NULL;
+static size_t numNameSlots = 0;
+
+static uint32_t hashName(const char *name);
+static bool growNameSlots(void);
+
+GPXNameId internGPXDataName(const char *name) {
+
+    // The GPX 1.1 names make up almost every name in a file, and never change, so they are found without the lock
+    GPXNameId id = findKnownGPXDataName(name);
+    if (id != GPX_DATA_NO_NAME) {
+        return(id);
+    }
+    if (memchr(name, '\0', GPX_DATA_NAME_LENGTH + 1) == NULL) {
+        fprintf(stderr, "ERROR: GPXData name is longer than %d characters\n", GPX_DATA_NAME_LENGTH);
+        return(GPX_DATA_NO_NAME);
+    }
+
+    pthread_mutex_lock(&namesMutex);
+
+    // Looking the name up among the ones added at run time, the table is never full so the probe always ends
+    uint32_t hash = hashName(name);
+    if (numNameSlots > 0) {
+        for (size_t slot = hash & (numNameSlots - 1); nameSlots[slot] != GPX_DATA_NO_NAME; slot = (slot + 1) & (numNameSlots - 1)) {
+            if (strcmp(getGPXDataName(nameSlots[slot]), name) == 0) {
+                id = nameSlots[slot];
+                pthread_mutex_unlock(&namesMutex);
+                return(id);
+            }
+        }
+    }
+
+    // Adding the name with the next id, the table is kept at most half full.  A full table only stops names from being shared,
+    // the caller stores them inline, so a long running process keeps reading files with names it has not seen before
+    if (nextNameId > GPX_MAX_DATA_NAMES) {
+        bool report = (reportedFull == FALSE);
+        reportedFull = TRUE;
+        pthread_mutex_unlock(&namesMutex);
+        if (report == TRUE) {
+            fprintf(stderr, "ERROR: More than %d different GPXData names, new names are no longer shared\n", GPX_MAX_DATA_NAMES);
+        }
+        return(GPX_DATA_INLINE_NAME);
+    }
+    int chunk = nextNameId / NAME_CHUNK_SIZE;
+    if (nameChunks[chunk] == NULL) {
+        nameChunks[chunk] = calloc(NAME_CHUNK_SIZE, sizeof(char*));
+    }
+    if (nameChunks[chunk] == NULL || ((size_t)(nextNameId - GPX_NUM_KNOWN_DATA_NAMES + 1) * 2 > numNameSlots && growNameSlots() == FALSE)) {
+        pthread_mutex_unlock(&namesMutex);
+        fprintf(stderr, "ERROR: Could not allocate the GPXData name table\n");
+        return(GPX_DATA_NO_NAME);
+    }
+    char *copy = malloc(strlen(name) + 1);
+    strcpy(copy, name);
+    id = (GPXNameId)nextNameId++;
+    nameChunks[chunk][id % NAME_CHUNK_SIZE] = copy;
+
+    size_t slot = hash & (numNameSlots - 1);
+    while (nameSlots[slot] != GPX_DATA_NO_NAME) {
+        slot = (slot + 1) & (numNameSlots - 1);
+    }
+    nameSlots[slot] = id;
+
+    pthread_mutex_unlock(&namesMutex);
+    return(id);
+}
+
+const char *getGPXDataName(GPXNameId id) {
+    if (id < GPX_NUM_KNOWN_DATA_NAMES) {
+        return(knownNames[id]);
+    }
+    return(nameChunks[id / NAME_CHUNK_SIZE][id % NAME_CHUNK_SIZE]);
+}
+
+GPXNameId findKnownGPXDataName(const char *name) {
+
+    // Comparing the first character before the rest skips nearly every name that does not match
+    for (int id = 1; id < GPX_NUM_KNOWN_DATA_NAMES; id++) {
+        if (knownNames[id][0] == name[0] && strcmp(knownNames[id], name) == 0) {
+            return((GPXNameId)id);
+        }
+    }
+    return(GPX_DATA_NO_NAME);
+}
+
+static uint32_t hashName(const char *name) {
+
+    // FNV-1a, names are short so a simple byte at a time hash is enough
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *character = (const unsigned char*)name; *character != '\0'; character++) {
+        hash = (hash ^ *character) * 16777619u;
+    }
+    return(hash);
+}
+
+static bool growNameSlots(void) {
+    size_t newNumSlots = (numNameSlots == 0) ? 64 : numNameSlots * 2;
+    GPXNameId *newSlots = calloc(newNumSlots, sizeof(GPXNameId));
+    if (newSlots == NULL) {
+        return(FALSE);
+    }
+
+    // Placing every id again, as its slot depends on the size of the table
+    for (size_t slot = 0; slot < numNameSlots; slot++) {
+        if (nameSlots[slot] != GPX_DATA_NO_NAME) {
+            size_t newSlot = hashName(getGPXDataName(nameSlots[slot])) & (newNumSlots - 1);
+            while (newSlots[newSlot] != GPX_DATA_NO_NAME) {
+                newSlot = (newSlot + 1) & (newNumSlots - 1);
+            }
+            newSlots[newSlot] = nameSlots[slot];
+        }
+    }
+    free(nameSlots);
+    nameSlots = newSlots;
+    numNameSlots = newNumSlots;
+    return(TRUE);
+}
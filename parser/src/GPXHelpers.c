@@ -1,163 +1,264 @@
 #include "GPXParser.h"
 #include "LinkedListAPI.h"
 #include "GPXHelpers.h"
+#include "GPXTime.h"
+#include "GPXJSON.h"
+#include "GPXNumber.h"
+#include "GPXLoader.h"
+#include "GPXDataNames.h"
+#include "GPXCompact.h"
+#include "GPXPool.h"
+#include <stdarg.h>
+#include <pthread.h>
+
+// Size a StringBuffer starts at, room for a small JSON object
+#define STRING_BUFFER_CAPACITY 64
+
+// Element and attribute names of GPX 1.1 the tree walk dispatches on
+typedef enum {
+    GPX_NAME_WPT,
+    GPX_NAME_RTE,
+    GPX_NAME_TRK,
+    GPX_NAME_RTEPT,
+    GPX_NAME_TRKSEG,
+    GPX_NAME_TRKPT,
+    GPX_NAME_NAME,
+    GPX_NAME_LAT,
+    GPX_NAME_LON,
+    GPX_NUM_NAMES
+} GPXNameIndex;
+
+// The names looked up in a document's dictionary, when they are interned a node's name matches by comparing pointers
+typedef struct {
+    const xmlChar *names[GPX_NUM_NAMES];
+    bool interned;
+} GPXNames;
+
+static void initGPXNames(GPXNames *names, xmlNode *node);
+static bool isGPXName(const GPXNames *names, const xmlChar *name, GPXNameIndex index);
+static bool readGPXComponent(GPXdoc *GPXdoc, xmlNode *node, const GPXNames *names);
+static Route *readRoute(xmlNode *node, const GPXNames *names);
+static Track *readTrack(xmlNode *node, const GPXNames *names);
+static Waypoint *readWaypoint(xmlNode *node, const GPXNames *names, bool packData);
+static bool packWaypointData(Waypoint *waypointStruct, xmlNode *node, const GPXNames *names);
+static GPXNameId readPackedNameId(const char *packed);
+static bool isDataBeforeName(const char *name);
+static void createScratchKey(void);
+static void freeScratchBuffer(void *data);
 
 void parseXMLTree(GPXdoc *GPXdoc, xmlNode *root_element) {
+    if (root_element == NULL) {
+        return;
+    }
+    GPXNames names;
+    initGPXNames(&names, root_element);
+
+    // Walking the tree without recursion, wpt, rte and trk elements are read whole and their subtrees are not walked again
+    // Any other element, such as gpx itself, is descended into, and the walk climbs back up through the parents once a level is done
+    int depth = 0;
+    xmlNode *node = root_element;
+    while (node != NULL) {
+        if (node -> type == XML_ELEMENT_NODE && readGPXComponent(GPXdoc, node, &names) == FALSE && node -> children != NULL) {
+            node = node -> children;
+            depth++;
+            continue;
+        }
+        while (node -> next == NULL && depth > 0) {
+            node = node -> parent;
+            depth--;
+        }
+        node = node -> next;
+    }
+}
 
-    // For loop based off Professor Dennis' "print_element_names" function in libXmlExample.c
-    for (xmlNode *node = root_element; node != NULL; node = node -> next) {
-        // Ensuring text nodes are not included
-        if (node -> type == XML_ELEMENT_NODE) {
+Waypoint *getWaypointData(xmlNode *node) {
+    GPXNames names;
+    initGPXNames(&names, node);
+    return(readWaypoint(node, &names, FALSE));
+}
 
-            // If the current children node is "wpt"
-            if (strcmp((char*)node -> name, "wpt") == 0) {
-                // Gets the information for the wpt node and adds it to the waypoints list
-                Waypoint *waypointStruct = getWaypointData(node);
-                insertBack(GPXdoc -> waypoints, waypointStruct);
-            }
+static void initGPXNames(GPXNames *names, xmlNode *node) {
+    static const char *literals[GPX_NUM_NAMES] = {"wpt", "rte", "trk", "rtept", "trkseg", "trkpt", "name", "lat", "lon"};
 
-            // If the current children node is "rte"
-            if (strcmp((char*)node -> name, "rte") == 0) {
-                // Dynamically allocates size of Route struct bytes and initializes routeStruct -> name
-                Route *routeStruct = malloc(sizeof(Route));
-                routeStruct -> name = malloc(strlen("") + 1);
-                strcpy(routeStruct -> name, "");
-
-                // Initializes a list for other data and waypoints of rte
-                List *otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
-                List *waypointList = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
-
-                // Traversing through the siblings of the children of the current node
-                for (xmlNode *siblings = node -> children; siblings != NULL; siblings = siblings -> next) {
-                    // If there is a "rtept" node, gets the wpt information
-                    if (strcmp((char*)siblings -> name, "rtept") == 0) {
-                        // Gets the waypoint information and adds it to the list of waypoints
-                        Waypoint *waypointStruct = getWaypointData(siblings);
-                        insertBack(waypointList, waypointStruct);
-                    }
-                    // Gets the name node for the rte node
-                    else if (strcmp((char*)siblings -> name, "name") == 0) {
-                        routeStruct -> name = realloc(routeStruct -> name, strlen((char*)siblings -> children -> content) + 1);
-                        strcpy(routeStruct -> name, (char*)siblings -> children -> content);
-                    }
-                    // Gets the other data for the rte node
-                    else if (siblings -> type == XML_ELEMENT_NODE) {
-                        GPXData *data = malloc(sizeof(GPXData) + (strlen((char*)siblings -> children -> content) + 1) * sizeof(char));
-                        strcpy(data -> name, (char*)siblings -> name);
-                        strcpy(data -> value, (char*)siblings -> children -> content);
-
-                        // Adding the other data into the otherData list
-                        insertBack(otherData, data);
-                    }
-                }
-                // Adds the otherData and waypoint lists into the routeStruct structure
-                routeStruct -> otherData = otherData;
-                routeStruct -> waypoints = waypointList;
+    // A parsed document keeps every element and attribute name in its dictionary, so looking the names up there once gives the exact pointers its nodes use
+    // Trees that were built without a dictionary fall back to comparing the strings
+    xmlDictPtr dict = (node -> doc != NULL) ? node -> doc -> dict : NULL;
+    names -> interned = (dict != NULL && xmlDictOwns(dict, node -> name) == 1);
+    for (int i = 0; i < GPX_NUM_NAMES; i++) {
+        names -> names[i] = names -> interned ? xmlDictLookup(dict, BAD_CAST literals[i], -1) : BAD_CAST literals[i];
+    }
+}
 
-                // Adding to the routes list
-                insertBack(GPXdoc -> routes, routeStruct);
+static bool isGPXName(const GPXNames *names, const xmlChar *name, GPXNameIndex index) {
+    if (names -> interned) {
+        return(name == names -> names[index]);
+    }
+    return(xmlStrEqual(name, names -> names[index]) == 1);
+}
+
+static bool readGPXComponent(GPXdoc *GPXdoc, xmlNode *node, const GPXNames *names) {
+
+    // Reading a wpt, rte or trk element into the GPXdoc, returns FALSE for any other element
+    if (isGPXName(names, node -> name, GPX_NAME_WPT)) {
+        insertBack(GPXdoc -> waypoints, readWaypoint(node, names, FALSE));
+    }
+    else if (isGPXName(names, node -> name, GPX_NAME_RTE)) {
+        insertBack(GPXdoc -> routes, readRoute(node, names));
+    }
+    else if (isGPXName(names, node -> name, GPX_NAME_TRK)) {
+        insertBack(GPXdoc -> tracks, readTrack(node, names));
+    }
+    else {
+        return(FALSE);
+    }
+    return(TRUE);
+}
+
+static Route *readRoute(xmlNode *node, const GPXNames *names) {
+    // Dynamically allocates size of Route struct bytes and initializes routeStruct -> name
+    Route *routeStruct = poolAllocate(POOL_ROUTE);
+    routeStruct -> name = malloc(strlen("") + 1);
+    strcpy(routeStruct -> name, "");
+
+    // Initializes a list for other data and waypoints of rte
+    List *otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
+    List *waypointList = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
+
+    // Traversing through the siblings of the children of the current node
+    for (xmlNode *siblings = node -> children; siblings != NULL; siblings = siblings -> next) {
+        // If there is a "rtept" node, gets the wpt information
+        if (isGPXName(names, siblings -> name, GPX_NAME_RTEPT)) {
+            // Gets the waypoint information and adds it to the list of waypoints
+            Waypoint *waypointStruct = readWaypoint(siblings, names, FALSE);
+            insertBack(waypointList, waypointStruct);
+        }
+        // Gets the name node for the rte node
+        else if (isGPXName(names, siblings -> name, GPX_NAME_NAME)) {
+            routeStruct -> name = realloc(routeStruct -> name, strlen((char*)siblings -> children -> content) + 1);
+            strcpy(routeStruct -> name, (char*)siblings -> children -> content);
+        }
+        // Gets the other data for the rte node
+        else if (siblings -> type == XML_ELEMENT_NODE) {
+            GPXData *data = createGPXData((char*)siblings -> name, (char*)siblings -> children -> content, strlen((char*)siblings -> children -> content));
+
+            // Adding the other data into the otherData list
+            if (data != NULL) {
+                insertBack(otherData, data);
             }
+        }
+    }
+    // Adds the otherData and waypoint lists into the routeStruct structure
+    routeStruct -> otherData = otherData;
+    routeStruct -> waypoints = waypointList;
+    return(routeStruct);
+}
+
+static Track *readTrack(xmlNode *node, const GPXNames *names) {
+    // Dynamically allocates size of Track struct bytes and initializes track -> name
+    Track *trkStruct = poolAllocate(POOL_TRACK);
+    trkStruct -> name = malloc(strlen("") + 1);
+    strcpy(trkStruct -> name, "");
 
-            // If the current children node is "trk"
-            if (strcmp((char*)node -> name, "trk") == 0) {
-                // Dynamically allocates size of Track struct bytes and initializes track -> name
-                Track *trkStruct = malloc(sizeof(Track));
-                trkStruct -> name = malloc(strlen("") + 1);
-                strcpy(trkStruct -> name, "");
-
-                // Initializes a list for other data and trackSegments of trk
-                List *trkSegList = initializeList(&trackSegmentToString, &deleteTrackSegment, &compareTrackSegments);
-                List *otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
-
-                // Traverses through the siblings of the children of the current node
-                for (xmlNode *siblings = node -> children; siblings != NULL; siblings = siblings -> next) {
-                    // Gets the name of the trk
-                    if (strcmp((char*)siblings -> name, "name") == 0) {
-                        trkStruct -> name = realloc(trkStruct -> name, strlen((char*)siblings -> children -> content) + 1);
-                        strcpy(trkStruct -> name, (char*)siblings -> children -> content);
-                    }
-                    // Gets the list of track segs
-                    else if (strcmp((char*)siblings -> name, "trkseg") == 0) {
-                        // Creates a trkseg structure and creates a waypoint list
-                        TrackSegment *trksegStruct = malloc(sizeof(TrackSegment));
-                        List *waypointList = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
-
-                        // Gets the list of track points (waypoints)
-                        for (xmlNode *childSibling = siblings -> children; childSibling != NULL; childSibling = childSibling -> next) {
-                            if (strcmp((char*)childSibling -> name, "trkpt") == 0) {
-                                // Gets the waypoint data and adds it to the waypointyList
-                                Waypoint *waypointStruct = getWaypointData(childSibling);
-                                insertBack(waypointList, waypointStruct);
-                            }
-                        }
-                        // Setting the waypoints member in the trkseg structure to waypointsList
-                        trksegStruct -> waypoints = waypointList;
-                        insertBack(trkSegList, trksegStruct);
-                    }
-                    // Gets the other data for the trk node
-                    else if (siblings -> type == XML_ELEMENT_NODE) {
-                        GPXData *data = malloc(sizeof(GPXData) + (strlen((char*)siblings -> children -> content) + 1) * sizeof(char));
-                        strcpy(data -> name, (char*)siblings -> name);
-                        strcpy(data -> value, (char*)siblings -> children -> content);
-
-                        // Adding the other data into the otherData list
-                        insertBack(otherData, data);
-                    }
+    // Initializes a list for other data and trackSegments of trk
+    List *trkSegList = initializeList(&trackSegmentToString, &deleteTrackSegment, &compareTrackSegments);
+    List *otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
+
+    // Traverses through the siblings of the children of the current node
+    for (xmlNode *siblings = node -> children; siblings != NULL; siblings = siblings -> next) {
+        // Gets the name of the trk
+        if (isGPXName(names, siblings -> name, GPX_NAME_NAME)) {
+            trkStruct -> name = realloc(trkStruct -> name, strlen((char*)siblings -> children -> content) + 1);
+            strcpy(trkStruct -> name, (char*)siblings -> children -> content);
+        }
+        // Gets the list of track segs
+        else if (isGPXName(names, siblings -> name, GPX_NAME_TRKSEG)) {
+            // Creates a trkseg structure with an empty waypoint list
+            TrackSegment *trksegStruct = createTrackSegment();
+            if (trksegStruct == NULL) {
+                continue;
+            }
+            List *waypointList = trksegStruct -> waypoints;
+
+            // Gets the list of track points (waypoints)
+            for (xmlNode *childSibling = siblings -> children; childSibling != NULL; childSibling = childSibling -> next) {
+                if (isGPXName(names, childSibling -> name, GPX_NAME_TRKPT)) {
+                    // Gets the waypoint data, packed as there are many track points, and adds it to the waypointyList
+                    Waypoint *waypointStruct = readWaypoint(childSibling, names, TRUE);
+                    insertBack(waypointList, waypointStruct);
                 }
-                // Adds the otherData list and trkseg into the trkStruct structure
-                trkStruct -> segments = trkSegList;
-                trkStruct -> otherData = otherData;
+            }
+            // Filling in the point columns of the trkseg structure
+            fillTrackSegmentColumns(trksegStruct);
+            insertBack(trkSegList, trksegStruct);
+        }
+        // Gets the other data for the trk node
+        else if (siblings -> type == XML_ELEMENT_NODE) {
+            GPXData *data = createGPXData((char*)siblings -> name, (char*)siblings -> children -> content, strlen((char*)siblings -> children -> content));
 
-                // Adding to the tracks list
-                insertBack(GPXdoc -> tracks, trkStruct);
+            // Adding the other data into the otherData list
+            if (data != NULL) {
+                insertBack(otherData, data);
             }
         }
-        // Calls on the function again to run recursively sending child of the current node
-        parseXMLTree(GPXdoc, node -> children);
     }
+    // Adds the otherData list and trkseg into the trkStruct structure
+    trkStruct -> segments = trkSegList;
+    trkStruct -> otherData = otherData;
+    return(trkStruct);
 }
 
-Waypoint *getWaypointData(xmlNode *node) {
+static Waypoint *readWaypoint(xmlNode *node, const GPXNames *names, bool packData) {
     // Dynamically allocates size of Waypoint struct bytes and initalizes the members
-    Waypoint *waypointStruct = malloc(sizeof(Waypoint));
+    Waypoint *waypointStruct = poolAllocate(POOL_WAYPOINT);
     waypointStruct -> name = malloc(strlen("") + 1);
     strcpy(waypointStruct -> name, "");
     waypointStruct -> latitude = 0;
     waypointStruct -> longitude = 0;
-
-    // Initializing the other data list
-    List *otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
+    waypointStruct -> otherData = NULL;
+    waypointStruct -> packedData = NULL;
 
     // Traversing through the attributes of the current element
     for (xmlAttr *attribute = node -> properties; attribute != NULL; attribute = attribute -> next) {
         // Gets the latitude of the waypoint node
-        if (strcmp((char*)attribute -> name, "lat") == 0) {
-            waypointStruct -> latitude = atof((char*)attribute -> children -> content);
+        if (isGPXName(names, attribute -> name, GPX_NAME_LAT)) {
+            waypointStruct -> latitude = parseDecimal((char*)attribute -> children -> content, NULL);
         }
         // Gets the longitude of the waypoint node
-        else if (strcmp((char*)attribute -> name, "lon") == 0) {
-            waypointStruct -> longitude = atof((char*)attribute -> children -> content);
+        else if (isGPXName(names, attribute -> name, GPX_NAME_LON)) {
+            waypointStruct -> longitude = parseDecimal((char*)attribute -> children -> content, NULL);
         }
     }
 
+    // Track points keep their other data packed in a single allocation instead of a list of GPXData, so the name is all that is read here
+    if (packData == TRUE) {
+        if (packWaypointData(waypointStruct, node, names) == FALSE) {
+            free(waypointStruct -> name);
+            free(waypointStruct);
+            fprintf(stderr, "Error: Other data had an empty name or value\n");
+            return(NULL);
+        }
+        return(waypointStruct);
+    }
+
+    // Initializing the other data list
+    List *otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
+
     // Traversing through the siblings of the children of the current node
     for (xmlNode *siblings = node -> children; siblings != NULL; siblings = siblings -> next) {
         // Gets the name of the waypoint node
-        if (strcmp((char*)siblings -> name, "name") == 0) {
+        if (isGPXName(names, siblings -> name, GPX_NAME_NAME)) {
             waypointStruct -> name = realloc(waypointStruct -> name, strlen((char*)siblings -> children -> content) + 1);
             strcpy(waypointStruct -> name, (char*)siblings -> children -> content);
         }
         // Gets the other data for the way point node
         else if (siblings -> type == XML_ELEMENT_NODE) {
-            GPXData *data = malloc(sizeof(GPXData) + (strlen((char*)siblings -> children -> content) + 1) * sizeof(char));
-            strcpy(data -> name, (char*)siblings -> name);
-            strcpy(data -> value, (char*)siblings -> children -> content);
-            
-            // Adds the other data into the otherData list
-            insertBack(otherData, data);
+            GPXData *data = createGPXData((char*)siblings -> name, (char*)siblings -> children -> content, strlen((char*)siblings -> children -> content));
 
-            // Error checking to make sure data values are not empty strings
-            if ((strcmp(data -> name, "") == 0) || (strcmp(data -> value, "") == 0)) {
+            // Error checking to make sure data values are not empty strings, and adding the other data into the otherData list
+            if (data != NULL) {
+                insertBack(otherData, data);
+            }
+            if (data == NULL || (strcmp(data -> name, "") == 0) || (strcmp(data -> value, "") == 0)) {
                 free(waypointStruct -> name);
                 free(waypointStruct);
                 fprintf(stderr, "Error: Other data had an empty name or value\n");
@@ -172,14 +273,223 @@ Waypoint *getWaypointData(xmlNode *node) {
     return(waypointStruct);
 }
 
-int waypointData(ListIterator waypointIterator) {
-    void *waypointElement;
+static bool packWaypointData(Waypoint *waypointStruct, xmlNode *node, const GPXNames *names) {
+
+    // Measuring the values first so the packed data takes exactly one allocation, each value follows the two bytes of its name's id
+    // and two more bytes hold the id 0 that ends the data.  A name the shared table has no room for is copied in before its value
+    size_t packedLength = 2;
+    for (xmlNode *siblings = node -> children; siblings != NULL; siblings = siblings -> next) {
+        if (isGPXName(names, siblings -> name, GPX_NAME_NAME)) {
+            waypointStruct -> name = realloc(waypointStruct -> name, strlen((char*)siblings -> children -> content) + 1);
+            strcpy(waypointStruct -> name, (char*)siblings -> children -> content);
+        }
+        else if (siblings -> type == XML_ELEMENT_NODE) {
+            // Empty names or values are not valid other data
+            if (siblings -> name[0] == '\0' || siblings -> children == NULL || siblings -> children -> content[0] == '\0') {
+                return(FALSE);
+            }
+            GPXNameId id = internGPXDataName((char*)siblings -> name);
+            if (id == GPX_DATA_NO_NAME) {
+                return(FALSE);
+            }
+            packedLength += 2 + strlen((char*)siblings -> children -> content) + 1;
+            if (id == GPX_DATA_INLINE_NAME) {
+                packedLength += strlen((char*)siblings -> name) + 1;
+            }
+        }
+    }
+
+    // Copying the id of every name, low byte first, and its value with its NULL terminator after one another
+    // The names were all interned above, so looking them up again gives the same ids, and a full table stays full
+    char *packed = malloc(packedLength);
+    char *cursor = packed;
+    for (xmlNode *siblings = node -> children; siblings != NULL; siblings = siblings -> next) {
+        if (siblings -> type == XML_ELEMENT_NODE && isGPXName(names, siblings -> name, GPX_NAME_NAME) == FALSE) {
+            GPXNameId id = internGPXDataName((char*)siblings -> name);
+            cursor[0] = (char)(id & 0xFF);
+            cursor[1] = (char)(id >> 8);
+            cursor += 2;
+            if (id == GPX_DATA_INLINE_NAME) {
+                size_t nameLength = strlen((char*)siblings -> name) + 1;
+                memcpy(cursor, siblings -> name, nameLength);
+                cursor += nameLength;
+            }
+            size_t valueLength = strlen((char*)siblings -> children -> content) + 1;
+            memcpy(cursor, siblings -> children -> content, valueLength);
+            cursor += valueLength;
+        }
+    }
+    cursor[0] = '\0';
+    cursor[1] = '\0';
+    waypointStruct -> packedData = packed;
+    return(TRUE);
+}
+
+WaypointDataIterator createWaypointDataIterator(const Waypoint *waypoint) {
+    WaypointDataIterator iterator;
+    iterator.packed = waypoint -> packedData;
+    iterator.listIterator.current = NULL;
+    if (iterator.packed == NULL && waypoint -> otherData != NULL) {
+        iterator.listIterator = createIterator(waypoint -> otherData);
+    }
+    return(iterator);
+}
+
+bool nextWaypointData(WaypointDataIterator *iterator, const char **name, const char **value) {
+
+    // Packed data ends at the id 0, and each value follows the two bytes of its name's id, and the name itself when it is inline
+    if (iterator -> packed != NULL) {
+        GPXNameId id = readPackedNameId(iterator -> packed);
+        if (id == GPX_DATA_NO_NAME) {
+            return(FALSE);
+        }
+        *name = (id == GPX_DATA_INLINE_NAME) ? iterator -> packed + 2 : getGPXDataName(id);
+        *value = (id == GPX_DATA_INLINE_NAME) ? *name + strlen(*name) + 1 : iterator -> packed + 2;
+        iterator -> packed = *value + strlen(*value) + 1;
+        return(TRUE);
+    }
+
+    GPXData *data = (GPXData*)nextElement(&iterator -> listIterator);
+    if (data == NULL) {
+        return(FALSE);
+    }
+    *name = data -> name;
+    *value = data -> value;
+    return(TRUE);
+}
+
+int numWaypointData(const Waypoint *waypoint) {
+    if (waypoint -> packedData == NULL) {
+        return((waypoint -> otherData != NULL) ? getLength(waypoint -> otherData) : 0);
+    }
+
     int numData = 0;
+    const char *name;
+    const char *value;
+    WaypointDataIterator dataIterator = createWaypointDataIterator(waypoint);
+    while (nextWaypointData(&dataIterator, &name, &value) == TRUE) {
+        numData++;
+    }
+    return(numData);
+}
+
+List *unpackWaypointData(const char *packedData) {
+    List *otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
+
+    // Creating a GPXData for each packed name and value, in the order they were in the file, the names are already interned
+    // or, when the table was full, packed inline and copied after the value the way createGPXData keeps them
+    const char *cursor = packedData;
+    while (cursor != NULL && readPackedNameId(cursor) != GPX_DATA_NO_NAME) {
+        GPXNameId id = readPackedNameId(cursor);
+        const char *inlineName = (id == GPX_DATA_INLINE_NAME) ? cursor + 2 : "";
+        size_t nameLength = (id == GPX_DATA_INLINE_NAME) ? strlen(inlineName) + 1 : 0;
+        const char *value = cursor + 2 + nameLength;
+        size_t valueLength = strlen(value);
+        GPXData *data = malloc(sizeof(GPXData) + (valueLength + 1 + nameLength) * sizeof(char));
+        memcpy(data -> value, value, valueLength + 1);
+        memcpy(data -> value + valueLength + 1, inlineName, nameLength);
+        data -> name = (id == GPX_DATA_INLINE_NAME) ? data -> value + valueLength + 1 : getGPXDataName(id);
+        insertBack(otherData, data);
+        cursor = value + valueLength + 1;
+    }
+    return(otherData);
+}
+
+GPXData *createGPXData(const char *name, const char *value, size_t valueLength) {
+
+    // Interning the name, which fails for names too long to have been stored before names were interned
+    GPXNameId id = internGPXDataName(name);
+    if (id == GPX_DATA_NO_NAME) {
+        return(NULL);
+    }
+
+    // The value is stored inline at its real length, followed by a copy of the name when the shared table had no room for it
+    // The copy lives in the same allocation, so the name is still never freed on its own
+    size_t nameLength = (id == GPX_DATA_INLINE_NAME) ? strlen(name) + 1 : 0;
+    GPXData *data = malloc(sizeof(GPXData) + (valueLength + 1 + nameLength) * sizeof(char));
+    memcpy(data -> value, value, valueLength);
+    data -> value[valueLength] = '\0';
+    memcpy(data -> value + valueLength + 1, name, nameLength);
+    data -> name = (id == GPX_DATA_INLINE_NAME) ? data -> value + valueLength + 1 : getGPXDataName(id);
+    return(data);
+}
+
+static GPXNameId readPackedNameId(const char *packed) {
+    return((GPXNameId)((unsigned char)packed[0] | ((unsigned char)packed[1] << 8)));
+}
+
+void fillTrackSegmentColumns(TrackSegment *segment) {
+    segment -> numPoints = getLength(segment -> waypoints);
+    segment -> latitudes = malloc((segment -> numPoints + 1) * sizeof(double));
+    segment -> longitudes = malloc((segment -> numPoints + 1) * sizeof(double));
+    segment -> elevations = malloc((segment -> numPoints + 1) * sizeof(double));
+    segment -> times = malloc((segment -> numPoints + 1) * sizeof(int64_t));
+    segment -> timesAscending = TRUE;
+    segment -> compact = NULL;
+
+    // A segment too large for its columns keeps only its waypoints, which every query can still read
+    if (segment -> latitudes == NULL || segment -> longitudes == NULL || segment -> elevations == NULL || segment -> times == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate the columns of a track segment of %lld points\n", (long long)segment -> numPoints);
+        free(segment -> latitudes);
+        free(segment -> longitudes);
+        free(segment -> elevations);
+        free(segment -> times);
+        segment -> numPoints = 0;
+        segment -> latitudes = NULL;
+        segment -> longitudes = NULL;
+        segment -> elevations = NULL;
+        segment -> times = NULL;
+        segment -> timesAscending = FALSE;
+        return;
+    }
+
+    // Copying the coordinates of every point and parsing its <ele> and <time> once, so queries never look at the strings again
+    int64_t point = 0;
+    ListIterator waypointIterator = createIterator(segment -> waypoints);
+    void *waypointElement;
+    while ((waypointElement = nextElement(&waypointIterator)) != NULL) {
+        Waypoint *waypointStruct = (Waypoint*)waypointElement;
+        segment -> latitudes[point] = waypointStruct -> latitude;
+        segment -> longitudes[point] = waypointStruct -> longitude;
+        getWaypointElevationAndTime(waypointStruct, &segment -> elevations[point], &segment -> times[point]);
+
+        // A missing time or a time going backwards means the times cannot be binary searched
+        if (segment -> times[point] == GPX_NO_TIME || (point > 0 && segment -> times[point] < segment -> times[point - 1])) {
+            segment -> timesAscending = FALSE;
+        }
+        point++;
+    }
+    segment -> numPoints = point;
+}
+
+void getWaypointElevationAndTime(const Waypoint *waypoint, double *elevation, int64_t *time) {
+    *elevation = NAN;
+    *time = GPX_NO_TIME;
+
+    // Names are interned, so <ele> and <time> are found by comparing pointers
+    const char *elevationName = getGPXDataName(GPX_DATA_ELE);
+    const char *timeName = getGPXDataName(GPX_DATA_TIME);
+    const char *name;
+    const char *value;
+    WaypointDataIterator dataIterator = createWaypointDataIterator(waypoint);
+    while (nextWaypointData(&dataIterator, &name, &value) == TRUE) {
+        if (name == elevationName) {
+            *elevation = parseDecimal(value, NULL);
+        }
+        else if (name == timeName) {
+            *time = parseGPXTime(value);
+        }
+    }
+}
+
+int64_t waypointData(ListIterator waypointIterator) {
+    void *waypointElement;
+    int64_t numData = 0;
 
     // Gets the number of children of waypoints in the waypoint list
     while((waypointElement = nextElement(&waypointIterator)) != NULL) {
         Waypoint *waypointStruct = (Waypoint*)waypointElement;
-        numData += getLength(waypointStruct -> otherData);
+        numData += numWaypointData(waypointStruct);
         if (strcmp(waypointStruct -> name, "") != 0) {
             numData++;
         }        
@@ -202,8 +512,10 @@ xmlDoc *GPXdocToxmlDoc(GPXdoc *GPXDocStruct) {
     xmlDocPtr doc = NULL;  
     xmlNodePtr root_node = NULL;
 
-    // Initializing the libxml library
-    LIBXML_TEST_VERSION
+    // Initializing the libxml library, which only happens on the first call and is safe to do from several threads at once
+    if (requireGPXLibrary() == FALSE) {
+        return(NULL);
+    }
 
     // Creating an XML tree and GPX node then setting the GPX node as the root node for the created XML tree
     doc = xmlNewDoc(BAD_CAST "1.0");
@@ -215,8 +527,8 @@ xmlDoc *GPXdocToxmlDoc(GPXdoc *GPXDocStruct) {
     xmlSetNs(root_node, nsPtr);
 
     // Creating a variable to hold the GPX version in the GPXDocStruct
-    char version[256] = "";
-    sprintf(version, "%.1f", GPXDocStruct -> version);
+    char version[GPX_NUMBER_STRING_LENGTH] = "";
+    formatFixedDouble(GPXDocStruct -> version, 1, version);
 
     // Setting the version and creator attributes in the GPX node
     xmlNewProp(root_node, BAD_CAST "version", BAD_CAST version);
@@ -278,8 +590,13 @@ xmlDoc *GPXdocToxmlDoc(GPXdoc *GPXDocStruct) {
             // Getting the trackSegment struct for the current trackSegment element in the list of track segments
             TrackSegment *trackSegmentStruct = (TrackSegment*)trackSegmentElement;
 
-            // Adding the list of waypoints found in the trackSegmentStruct as children of the trackSegmentNode
-            addListOfWaypointsToParentNode(trackSegmentNode, trackSegmentStruct -> waypoints, "trkpt");
+            // Adding the list of waypoints found in the trackSegmentStruct as children of the trackSegmentNode, compacted segments only have their columns left
+            if (trackSegmentStruct -> compact != NULL) {
+                addCompactPointsToParentNode(trackSegmentNode, trackSegmentStruct);
+            }
+            else {
+                addListOfWaypointsToParentNode(trackSegmentNode, trackSegmentStruct -> waypoints, "trkpt");
+            }
         }
     }
 
@@ -300,23 +617,54 @@ void addListOfWaypointsToParentNode(xmlNodePtr parentNode, List *waypointList, c
         // Getting the waypoint struct for the current waypoint element in the list of waypoints
         Waypoint *waypointStruct = (Waypoint*)waypointElement;
 
-        // Creating variables to hold the longitude and latitude values in the waypoint struct
-        char longitude[256] = "";
-        char latitude[256] = "";
-        sprintf(longitude, "%f", waypointStruct -> longitude);
-        sprintf(latitude, "%f", waypointStruct -> latitude);
+        // Creating variables to hold the longitude and latitude values in the waypoint struct, written with every digit needed to read them back exactly
+        // Values closer to 0 than 1e-12 would need exponent notation, which the schema does not allow, and are written as 0
+        char longitude[GPX_NUMBER_STRING_LENGTH] = "";
+        char latitude[GPX_NUMBER_STRING_LENGTH] = "";
+        formatShortestDouble((fabs(waypointStruct -> longitude) < 1e-12) ? 0 : waypointStruct -> longitude, longitude);
+        formatShortestDouble((fabs(waypointStruct -> latitude) < 1e-12) ? 0 : waypointStruct -> latitude, latitude);
 
         // Setting the longitude and latitude values to attributes in the waypoint node
         xmlNewProp(waypointNode, BAD_CAST "lat", BAD_CAST latitude);
         xmlNewProp(waypointNode, BAD_CAST "lon", BAD_CAST longitude);
 
-        // If the waypoint struct has a name thats not an empty string, adds it as a child to the waypointNode
-        if (strcmp(waypointStruct -> name, "") != 0) {
-            xmlNewChild(waypointNode, NULL, BAD_CAST "name", BAD_CAST waypointStruct -> name);
-        }
+        // Adds the name and otherData in the waypointStruct to the waypointNode, whether or not the data is still packed
+        addWaypointDataToParentNode(waypointNode, waypointStruct);
+    }
+}
 
-        // Adds the list of otherData in the waypointStruct to the waypointNode
-        addListOfOtherDataToParentNode(waypointNode, waypointStruct -> otherData);
+void addCompactPointsToParentNode(xmlNodePtr parentNode, const TrackSegment *segment) {
+
+    // Writing a trkpt for every point of the compacted segment, with the <ele> and <time> parsed into its columns
+    SegmentCursor cursor;
+    openSegmentCursor(&cursor, segment);
+    while (nextSegmentRun(&cursor) > 0) {
+        for (int64_t i = 0; i < cursor.numPoints; i++) {
+            int64_t point = cursor.firstPoint + i;
+            xmlNodePtr waypointNode = xmlNewChild(parentNode, NULL, BAD_CAST "trkpt", BAD_CAST "");
+
+            // Coordinates are written the same way addListOfWaypointsToParentNode writes them
+            char longitude[GPX_NUMBER_STRING_LENGTH] = "";
+            char latitude[GPX_NUMBER_STRING_LENGTH] = "";
+            formatShortestDouble((fabs(cursor.longitudes[i]) < 1e-12) ? 0 : cursor.longitudes[i], longitude);
+            formatShortestDouble((fabs(cursor.latitudes[i]) < 1e-12) ? 0 : cursor.latitudes[i], latitude);
+            xmlNewProp(waypointNode, BAD_CAST "lat", BAD_CAST latitude);
+            xmlNewProp(waypointNode, BAD_CAST "lon", BAD_CAST longitude);
+
+            // The schema puts <ele> before <time>.  Like the coordinates it must stay out of exponent notation, so values closer to 0
+            // than 1e-12 are written as 0 and values past 1e20, which no elevation reaches, are written as 1e20 with the same sign
+            if (!isnan(segment -> elevations[point])) {
+                double value = segment -> elevations[point];
+                value = (fabs(value) < 1e-12) ? 0 : fmax(-1e20, fmin(value, 1e20));
+                char elevation[GPX_NUMBER_STRING_LENGTH] = "";
+                formatShortestDouble(value, elevation);
+                xmlNewChild(waypointNode, NULL, BAD_CAST "ele", BAD_CAST elevation);
+            }
+            if (segment -> times[point] != GPX_NO_TIME) {
+                char time[GPX_TIME_STRING_LENGTH];
+                xmlNewChild(waypointNode, NULL, BAD_CAST "time", BAD_CAST formatGPXTime(segment -> times[point], time));
+            }
+        }
     }
 }
 
@@ -364,7 +712,6 @@ bool validateXmlTreeWithSchema(xmlDoc *doc, char *gpxSchemaFile) {
     // If the contextPtr is NULL, xmlSchemaNewParserCtxt meaning an invalid Schema file
     if (contextPtr == NULL) {
         xmlSchemaFreeParserCtxt(contextPtr);
-        xmlSchemaCleanupTypes();
         return(FALSE);
     }
 
@@ -390,19 +737,280 @@ bool validateXmlTreeWithSchema(xmlDoc *doc, char *gpxSchemaFile) {
     // Checks to make sure validation worked, any value other than 0 means the validation failed
     if (validationReturnValue != 0) {
         fprintf(stderr, "xmlTree failed to validate with Schema file: %s\n", gpxSchemaFile);
-        xmlSchemaCleanupTypes();
         xmlSchemaFreeValidCtxt(validContextPointer);
         return(FALSE);
     }
 
-    // Freeing the valid context pointer, cleaning the Schema and XML parsers and dumping the memory
-    xmlSchemaCleanupTypes();
+    // Freeing the valid context pointer, the Schema type library stays initialized for the other threads validating at the same time
     xmlSchemaFreeValidCtxt(validContextPointer);
 
     // Returns TRUE for a valid xmlTree
     return(TRUE);
 }
 
+bool validGPXdocConstraints(GPXdoc *doc) {
+
+    // Error check to ensure GPXdoc is not NULL
+    if (doc == NULL) {
+        fprintf(stderr, "ERROR: GPXDoc is NULL\n");
+        return(FALSE);
+    }
+
+    // Error checking the namespace for NULL or empty
+    if (doc -> namespace == NULL || (strcmp(doc -> namespace, "") == 0)) {
+        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+        return(FALSE);
+    }
+
+    // Error checking the creator for NULL or empty
+    if (doc -> creator == NULL || (strcmp(doc -> creator, "") == 0)) {
+        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+        return(FALSE);
+    }
+
+    // Error checking all the list for NULL
+    if (doc -> waypoints == NULL || doc -> routes == NULL || doc -> tracks == NULL) {
+        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+        return(FALSE);
+    }
+
+    // Checking the list of waypoints in the GPXdoc struct for any invalid members
+    if (validWaypointConstraints(doc -> waypoints) == 0) {
+        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+        return(FALSE); 
+    }
+
+    // Checking the list of routes in the GPXdoc struct for any invalid members
+    void *routeElement;
+    ListIterator routeIterator = createIterator(doc -> routes);
+    while ((routeElement = nextElement(&routeIterator)) != NULL) {
+
+        // Getting the route struct for the current routeElement
+        Route *routeStruct = (Route*)routeElement;
+
+        // Error check name in routeStruct for NULL
+        if (routeStruct -> name == NULL) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }
+
+        // Error check the list of waypoints and list of otherData for NULL
+        if (routeStruct -> waypoints == NULL || routeStruct -> otherData == NULL) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }
+
+        // Error check to ensure list of waypoints have valid members
+        if (validWaypointConstraints(routeStruct -> waypoints) == 0) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }
+
+        // Error check to ensure list of otherData have valid members
+        if (validOtherDataConstraints(routeStruct -> otherData) == 0) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }  
+    }
+    
+    // Checking the list of tracks in the GPXdoc struct for any invalid members
+    void *trackElement;
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+
+        // Getting the track struct for the current trackElement
+        Track *trackStruct = (Track*)trackElement;
+
+        // Error check name in the trackStruct for NULL
+        if (trackStruct -> name == NULL) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }
+
+        // Error check the list of segments and list of otherData for NULL
+        if (trackStruct -> segments == NULL || trackStruct -> otherData == NULL) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }
+
+        // Error check to ensure the list of segments have valid members
+        void *trackSegmentElement;
+        ListIterator trackSegmentIterator = createIterator(trackStruct -> segments);
+        while ((trackSegmentElement = nextElement(&trackSegmentIterator)) != NULL) {
+
+            // Getting the track segment struct for the current trackSegmentElement
+            TrackSegment *trackSegmentStruct = (TrackSegment*)trackSegmentElement;
+
+            // Error check the list of waypoints in the trackSegmentStruct for NULL
+            if (trackSegmentStruct -> waypoints == NULL) {
+                fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+                return(FALSE);
+            }
+
+            // Error check to ensure the list of waypoints have valid members
+            if (validWaypointConstraints(trackSegmentStruct -> waypoints) == 0) {
+                fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+                return(FALSE);
+            }
+        }
+
+        // Error check to ensure the list of otherData have valid members
+        if (validOtherDataConstraints(trackStruct -> otherData) == 0) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }
+    }
+
+    // Return TRUE meaning that the GPXdoc struct meets the requirements in the header file
+    return(TRUE);
+}
+
+xmlSchemaPtr parseSchemaFile(char *gpxSchemaFile) {
+
+    // Error checking the Schema file name
+    if (gpxSchemaFile == NULL || (strcmp(gpxSchemaFile, "") == 0)) {
+        fprintf(stderr, "ERROR: Empty/NULL Schema File Name\n");
+        return(NULL);
+    }
+
+    // The schema types have to be set up before two threads parse schemas at once
+    if (requireGPXLibrary() == FALSE) {
+        return(NULL);
+    }
+
+    // Creating an XML Schemas parse context for the Schema file, NULL means the Schema file is invalid
+    xmlSchemaParserCtxtPtr contextPtr = xmlSchemaNewParserCtxt(gpxSchemaFile);
+    if (contextPtr == NULL) {
+        return(NULL);
+    }
+    xmlSchemaSetParserErrors(contextPtr, (xmlSchemaValidityErrorFunc)fprintf, (xmlSchemaValidityWarningFunc)fprintf, stderr);
+
+    // Building the XML Schema structure once, it is only read while validating so several threads can share it
+    xmlSchemaPtr schemaPtr = xmlSchemaParse(contextPtr);
+    xmlSchemaFreeParserCtxt(contextPtr);
+
+    return(schemaPtr);
+}
+
+bool validateXmlTreeWithParsedSchema(xmlDoc *doc, xmlSchemaPtr schema) {
+
+    if (doc == NULL || schema == NULL) {
+        fprintf(stderr, "ERROR: Invalid xml Tree or Schema\n");
+        return(FALSE);
+    }
+
+    // Validating with a context of our own, no global libxml state is cleaned up so other threads can keep parsing
+    xmlSchemaValidCtxtPtr validContextPointer = xmlSchemaNewValidCtxt(schema);
+    xmlSchemaSetValidErrors(validContextPointer, (xmlSchemaValidityErrorFunc)fprintf, (xmlSchemaValidityWarningFunc)fprintf, stderr);
+    int validationReturnValue = xmlSchemaValidateDoc(validContextPointer, doc);
+    xmlSchemaFreeValidCtxt(validContextPointer);
+
+    // Any value other than 0 means the validation failed
+    return(validationReturnValue == 0);
+}
+
+GPXdoc *xmlTreeToGPXdoc(xmlDoc *doc) {
+
+    // Declaring the GPXdoc structure and initializing its members
+    GPXdoc *GPXDocStruct = malloc(sizeof(GPXdoc));
+    GPXDocStruct -> version = 0;
+    GPXDocStruct -> creator = NULL;
+    strcpy(GPXDocStruct -> namespace, "");
+    GPXDocStruct -> waypoints = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
+    GPXDocStruct -> routes = initializeList(&routeToString, &deleteRoute, &compareRoutes);
+    GPXDocStruct -> tracks = initializeList(&trackToString, &deleteTrack, &compareTracks);
+
+    // Gets the root element node in the doc, it must have a namespace
+    xmlNode *root_element = xmlDocGetRootElement(doc);
+    if (root_element == NULL || root_element -> ns == NULL || root_element -> ns -> href == NULL) {
+        fprintf(stderr, "Error: Name space is empty\n");
+        deleteGPXdoc(GPXDocStruct);
+        return(NULL);
+    }
+
+    // Traversing through the attributes of the GPX Node and storing them in the GPXDoc structure
+    for (xmlAttr *attribute = root_element -> properties; attribute != NULL; attribute = attribute -> next) {
+        if (strcmp((char*)attribute -> name, "version") == 0) {
+            GPXDocStruct -> version = parseDecimal((char*)attribute -> children -> content, NULL);
+        }
+        if (strcmp((char*)attribute -> name, "creator") == 0) {
+            free(GPXDocStruct -> creator);
+            GPXDocStruct -> creator = malloc(strlen((char*)attribute -> children -> content) + 1);
+            strcpy(GPXDocStruct -> creator, (char*)attribute -> children -> content);
+        }
+    }
+
+    // Ensuring the creator and name space are not empty
+    if (GPXDocStruct -> creator == NULL || strcmp(GPXDocStruct -> creator, "") == 0) {
+        fprintf(stderr, "Error: Creator is empty or NULL\n");
+        deleteGPXdoc(GPXDocStruct);
+        return(NULL);
+    }
+    if (strlen((char*)root_element -> ns -> href) == 0 || strlen((char*)root_element -> ns -> href) >= sizeof(GPXDocStruct -> namespace)) {
+        fprintf(stderr, "Error: Name space is empty\n");
+        deleteGPXdoc(GPXDocStruct);
+        return(NULL);
+    }
+    strcpy(GPXDocStruct -> namespace, (char*)root_element -> ns -> href);
+
+    // Traversing through the XML tree below the GPX node to fetch all the information in the tree
+    parseXMLTree(GPXDocStruct, root_element -> children);
+
+    return(GPXDocStruct);
+}
+
+GPXdoc *loadValidGPXdoc(char *fileName, xmlSchemaPtr schema) {
+
+    if (schema == NULL) {
+        fprintf(stderr, "ERROR: Invalid xml Tree or Schema\n");
+        return(NULL);
+    }
+
+    // Loading a single file with a loader of its own, callers loading many files keep a GPXLoader instead
+    GPXLoader *loader = createGPXLoader(schema);
+    if (loader == NULL) {
+        return(NULL);
+    }
+    GPXdoc *GPXDocStruct = loadGPXdoc(loader, fileName);
+    deleteGPXLoader(loader);
+
+    return(GPXDocStruct);
+}
+
+void addWaypointDataToParentNode(xmlNodePtr parentNode, const Waypoint *waypoint) {
+
+    // The schema puts <ele>, <time>, <magvar> and <geoidheight> before <name>, so they are added first
+    const char *name;
+    const char *value;
+    WaypointDataIterator dataIterator = createWaypointDataIterator(waypoint);
+    while (nextWaypointData(&dataIterator, &name, &value) == TRUE) {
+        if (isDataBeforeName(name) == TRUE) {
+            xmlNewChild(parentNode, NULL, BAD_CAST name, BAD_CAST value);
+        }
+    }
+
+    // If the waypoint has a name thats not an empty string, adds it as a child to the parent node
+    if (strcmp(waypoint -> name, "") != 0) {
+        xmlNewChild(parentNode, NULL, BAD_CAST "name", BAD_CAST waypoint -> name);
+    }
+
+    // Adding every other name and value in the order they were read
+    dataIterator = createWaypointDataIterator(waypoint);
+    while (nextWaypointData(&dataIterator, &name, &value) == TRUE) {
+        if (isDataBeforeName(name) == FALSE) {
+            xmlNewChild(parentNode, NULL, BAD_CAST name, BAD_CAST value);
+        }
+    }
+}
+
+static bool isDataBeforeName(const char *name) {
+
+    // The known names are numbered in schema order, so the ones before <name> are a range of ids
+    // Only the known names are looked at, writing a document never adds its names to the shared table
+    GPXNameId id = findKnownGPXDataName(name);
+    return(id >= GPX_DATA_ELE && id <= GPX_DATA_GEOIDHEIGHT);
+}
+
 bool validWaypointConstraints(List *waypointList) {
 
     // Traversing through the list of waypoints
@@ -413,14 +1021,14 @@ bool validWaypointConstraints(List *waypointList) {
         // Getting the waypoint struct for the current waypointElement
         Waypoint *waypointStruct = (Waypoint*)waypointElement;
 
-        // Error checking the name and list of otherData for NULL
-        if (waypointStruct -> name == NULL || waypointStruct -> otherData == NULL) {
+        // Error checking the name and list of otherData for NULL, the list may only be missing while the data is packed
+        if (waypointStruct -> name == NULL || (waypointStruct -> otherData == NULL && waypointStruct -> packedData == NULL)) {
             fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
             return(FALSE);
         }
 
-        // Checking the list of otherData in the waypoint struct for any invalid members
-        if (validOtherDataConstraints(waypointStruct -> otherData) == 0) {
+        // Checking the otherData in the waypoint struct for any invalid members
+        if (validWaypointDataConstraints(waypointStruct) == 0) {
             fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
             return(FALSE);
         }
@@ -451,18 +1059,41 @@ bool validOtherDataConstraints(List *otherDataList) {
     return(TRUE);
 }
 
+bool validWaypointDataConstraints(const Waypoint *waypoint) {
+
+    // Checking every name and value of the waypoint for empty strings, whether or not they are still packed
+    const char *name;
+    const char *value;
+    WaypointDataIterator dataIterator = createWaypointDataIterator(waypoint);
+    while (nextWaypointData(&dataIterator, &name, &value) == TRUE) {
+        if (strcmp(name, "") == 0 || strcmp(value, "") == 0) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            return(FALSE);
+        }
+    }
+
+    // Returns TRUE if the otherData meets all the constraints of the GPXHeader.h file
+    return(TRUE);
+}
+
 // Haversine formula comes from https://www.movable-type.co.uk/scripts/latlong.html2
 float calculateHaversineFormula(Waypoint *waypoint1, Waypoint *waypoint2) {
 
-    // Storing the longitude/latitude of the first waypoint in variables in radians
-    float radiansLongitude1 = (M_PI / 180) * waypoint1 -> longitude;
-    float radiansLatitude1 = (M_PI / 180) * waypoint1 -> latitude;
+    // Returning the distance between waypoint1 and waypoint2 in meters
+    return(haversineDistance(waypoint1 -> latitude, waypoint1 -> longitude, waypoint2 -> latitude, waypoint2 -> longitude));
+}
+
+float haversineDistance(double latitude1, double longitude1, double latitude2, double longitude2) {
+
+    // Storing the longitude/latitude of the first point in variables in radians
+    float radiansLongitude1 = (M_PI / 180) * longitude1;
+    float radiansLatitude1 = (M_PI / 180) * latitude1;
 
-    // Storing the longitude/latitude of the second waypoint in variables in radians
-    float radiansLongitude2 = (M_PI / 180) * waypoint2 -> longitude;
-    float radiansLatitude2 = (M_PI / 180) * waypoint2 -> latitude;
+    // Storing the longitude/latitude of the second point in variables in radians
+    float radiansLongitude2 = (M_PI / 180) * longitude2;
+    float radiansLatitude2 = (M_PI / 180) * latitude2;
 
-    // Calculating the change in the longitudes/latitudes of the first and second waypoints and dividing by 2
+    // Calculating the change in the longitudes/latitudes of the first and second points and dividing by 2
     float changeInLongitude = (radiansLongitude2 - radiansLongitude1) / 2;
     float changeInLatitude = (radiansLatitude2 - radiansLatitude1) / 2;
 
@@ -472,58 +1103,167 @@ float calculateHaversineFormula(Waypoint *waypoint1, Waypoint *waypoint2) {
     float firstTerm = pow(changeInLatitude, 2);
     float lastTerm = pow(changeInLongitude, 2);
 
-    // Cos both latitudes in waypoint1 and waypoint2
-    float cosWaypoint1 = cos(radiansLatitude1);
-    float cosWaypoint2 = cos(radiansLatitude2);
+    // Cos both latitudes of the first and second points
+    float cosPoint1 = cos(radiansLatitude1);
+    float cosPoint2 = cos(radiansLatitude2);
 
     // Calculating a
-    float a = cosWaypoint1 * cosWaypoint2 * lastTerm;
+    float a = cosPoint1 * cosPoint2 * lastTerm;
     a += firstTerm;
 
     // Calculating c
     float c = atan2(sqrt(a), sqrt(1-a));
     c *= 2;
 
-    // Calculating d which is the distance betweeen waypoint1 and waypoint2 in meters
+    // Calculating d which is the distance betweeen the two points in meters
     float d = 6371000 * c;
 
-    // Returning the distance between waypoint1 and waypoint2 in meters
+    // Returning the distance between the two points in meters
     return(d);
 }
 
-float lengthOfWaypoints(List *waypoints) {
+void dummyDelete(void *data) {
+    return;
+}
+
+void initStringBuffer(StringBuffer *buffer) {
 
-    // Variable Declaration
-    float waypointLength = 0;
-    void *waypointElement1;
-    void *waypointElement2;
+    // Starting with room for a small JSON object, the buffer doubles whenever it runs out of space
+    buffer -> capacity = STRING_BUFFER_CAPACITY;
+    buffer -> length = 0;
+    buffer -> string = malloc(buffer -> capacity);
+    buffer -> string[0] = '\0';
+}
 
-    // Creating a list iterator for the list of waypoints found in the route
-    ListIterator waypointIterator = createIterator(waypoints);
+void appendToStringBuffer(StringBuffer *buffer, const char *text) {
 
-    // Pair of waypoints to compute the distance between
-    waypointElement1 = nextElement(&waypointIterator);
-    waypointElement2 = nextElement(&waypointIterator);
+    // Growing the buffer until the text and the NULL terminator fit
+    size_t textLength = strlen(text);
+    if (buffer -> length + textLength + 1 > buffer -> capacity) {
+        while (buffer -> length + textLength + 1 > buffer -> capacity) {
+            buffer -> capacity *= 2;
+        }
+        buffer -> string = realloc(buffer -> string, buffer -> capacity);
+    }
 
-    // Traversing through the list of waypoints, calculating the total distance between the list of waypoints
-    while (waypointElement2 != NULL) {
+    // Copying the text to the end of the string, including its NULL terminator
+    memcpy(buffer -> string + buffer -> length, text, textLength + 1);
+    buffer -> length += textLength;
+}
 
-        // Creating two waypoint struct variables
-        Waypoint *waypoint1 = (Waypoint*)waypointElement1;
-        Waypoint *waypoint2 = (Waypoint*)waypointElement2;
+void appendBytesToStringBuffer(StringBuffer *buffer, const char *bytes, size_t numBytes) {
 
-        // Calculating the length between the two waypoints
-        waypointLength += calculateHaversineFormula(waypoint1, waypoint2);
+    // Growing the buffer until the bytes and the NULL terminator fit
+    if (buffer -> length + numBytes + 1 > buffer -> capacity) {
+        while (buffer -> length + numBytes + 1 > buffer -> capacity) {
+            buffer -> capacity *= 2;
+        }
+        buffer -> string = realloc(buffer -> string, buffer -> capacity);
+    }
 
-        // Moving onto the next pair of variables in the list of waypoints
-        waypointElement1 = waypointElement2;
-        waypointElement2 = nextElement(&waypointIterator);
+    // Copying the bytes, which need not be NULL terminated, and terminating the string after them
+    memcpy(buffer -> string + buffer -> length, bytes, numBytes);
+    buffer -> length += numBytes;
+    buffer -> string[buffer -> length] = '\0';
+}
+
+bool stringBufferSink(void *context, const char *bytes, size_t length) {
+
+    // Sink for a JSONWriter that collects its whole output in a StringBuffer
+    appendBytesToStringBuffer((StringBuffer*)context, bytes, length);
+    return(TRUE);
+}
+
+void appendJSONStringToStringBuffer(StringBuffer *buffer, const char *text) {
+
+    // Appends text quoted and escaped as a JSON string
+    escapeJSONString(text, &stringBufferSink, buffer);
+}
+
+void appendFixedToStringBuffer(StringBuffer *buffer, double value, int decimals) {
+
+    // Appends value with a fixed number of decimals, like "%.Nf" without going through printf
+    char number[GPX_NUMBER_STRING_LENGTH];
+    appendBytesToStringBuffer(buffer, number, formatFixedDouble(value, decimals, number));
+}
+
+void appendFormatToStringBuffer(StringBuffer *buffer, const char *format, ...) {
+
+    // Finding out how long the formatted text is
+    va_list arguments;
+    va_start(arguments, format);
+    int textLength = vsnprintf(NULL, 0, format, arguments);
+    va_end(arguments);
+
+    if (textLength < 0) {
+        return;
     }
 
-    // Returns the total length of the list of waypoints in meters
-    return(waypointLength);
+    // Growing the buffer until the formatted text and the NULL terminator fit
+    if (buffer -> length + textLength + 1 > buffer -> capacity) {
+        while (buffer -> length + textLength + 1 > buffer -> capacity) {
+            buffer -> capacity *= 2;
+        }
+        buffer -> string = realloc(buffer -> string, buffer -> capacity);
+    }
+
+    // Formatting the text straight into the end of the buffer
+    va_start(arguments, format);
+    vsnprintf(buffer -> string + buffer -> length, textLength + 1, format, arguments);
+    va_end(arguments);
+    buffer -> length += textLength;
 }
 
-void dummyDelete(void *data) {
-    return;
-}
\ No newline at end of file
+// Largest scratch buffer a thread keeps between calls, one grown past it for a large result is shrunk back to the starting size
+#define SCRATCH_BUFFER_LIMIT (64 * 1024)
+
+// Each thread builds its results in its own buffer, so the space grown for one call is reused by the next instead of being reallocated
+static _Thread_local StringBuffer scratchBuffer = { NULL, 0, 0 };
+
+// Key whose destructor frees the scratch buffer of a thread when it exits
+static pthread_key_t scratchKey;
+static pthread_once_t scratchKeyOnce = PTHREAD_ONCE_INIT;
+
+StringBuffer *getScratchBuffer(void) {
+
+    // Allocating the buffer the first time the thread uses it and registering it for the exit destructor, afterwards it is only emptied
+    if (scratchBuffer.string == NULL) {
+        pthread_once(&scratchKeyOnce, &createScratchKey);
+        pthread_setspecific(scratchKey, &scratchBuffer);
+        initStringBuffer(&scratchBuffer);
+    }
+    scratchBuffer.length = 0;
+    scratchBuffer.string[0] = '\0';
+    return(&scratchBuffer);
+}
+
+char *scratchBufferToString(StringBuffer *buffer) {
+
+    // Copying the result into an allocation of its exact size, which is what the caller owns and frees
+    char *string = malloc(buffer -> length + 1);
+    memcpy(string, buffer -> string, buffer -> length + 1);
+
+    // Shrinking a buffer that grew past the limit back to the starting size, so the thread does not keep its largest result for good
+    if (buffer -> capacity > SCRATCH_BUFFER_LIMIT) {
+        char *shrunk = realloc(buffer -> string, STRING_BUFFER_CAPACITY);
+        if (shrunk != NULL) {
+            buffer -> string = shrunk;
+            buffer -> capacity = STRING_BUFFER_CAPACITY;
+        }
+        buffer -> length = 0;
+        buffer -> string[0] = '\0';
+    }
+    return(string);
+}
+
+static void createScratchKey(void) {
+    pthread_key_create(&scratchKey, &freeScratchBuffer);
+}
+
+static void freeScratchBuffer(void *data) {
+    StringBuffer *buffer = (StringBuffer*)data;
+    free(buffer -> string);
+    buffer -> string = NULL;
+    buffer -> length = 0;
+    buffer -> capacity = 0;
+}
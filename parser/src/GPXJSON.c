@@ -0,0 +1,1093 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXJSON.h"
+#include "GPXNumber.h"
+#include "GPXCompact.h"
+#include "GPXPool.h"
+#include <stdarg.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// States of the reader, what it expects to find next
+typedef enum {
+    EXPECT_VALUE,
+    EXPECT_KEY,
+    EXPECT_SEPARATOR
+} ReaderState;
+
+// Position of the reader in the JSON string along with the buffer strings are decoded into
+typedef struct {
+    const char *position;
+    StringBuffer text;
+    JSONCallback callback;
+    void *context;
+} JSONReader;
+
+// Kinds of containers the builder can be in, FRAME_SKIP is anything it does not know about and ignores
+typedef enum {
+    FRAME_GPX,
+    FRAME_WAYPOINT,
+    FRAME_ROUTE,
+    FRAME_WAYPOINT_LIST,
+    FRAME_ROUTE_LIST,
+    FRAME_OTHER_DATA_LIST,
+    FRAME_OTHER_DATA,
+    FRAME_SKIP
+} FrameKind;
+
+// An open container, target is the struct being filled, or the list that receives its elements
+typedef struct {
+    FrameKind kind;
+    void *target;
+    bool hasLatitude;
+    bool hasLongitude;
+} BuilderFrame;
+
+// State of a conversion from JSON to the GPX structs, one frame for each open container
+typedef struct {
+    FrameKind rootKind;
+    void *root;
+    BuilderFrame frames[MAX_JSON_DEPTH];
+    int depth;
+    char key[256];
+    bool failed;
+} JSONBuilder;
+
+static void skipWhitespace(JSONReader *reader);
+static bool readString(JSONReader *reader);
+static bool readNumber(JSONReader *reader, double *number);
+static bool readLiteral(JSONReader *reader, const char *literal);
+static void appendCodePoint(StringBuffer *buffer, unsigned int codePoint);
+static int readHexDigits(const char *position);
+static void *buildFromJSON(const char *json, FrameKind rootKind);
+static bool builderCallback(void *context, JSONEvent event, const JSONValue *value);
+static bool openBuilderFrame(JSONBuilder *builder, JSONEvent event);
+static void setBuilderScalar(JSONBuilder *builder, JSONEvent event, const JSONValue *value);
+static bool readCoordinate(JSONEvent event, const JSONValue *value, double *coordinate);
+static void *createEmptyComponent(FrameKind kind);
+static void deleteBuiltRoot(FrameKind kind, void *root);
+static bool writeToFileDescriptor(void *context, const char *bytes, size_t length);
+static bool writeToWriter(void *context, const char *bytes, size_t length);
+static size_t findJSONEscape(const char *text, size_t length);
+static size_t JSONEscapeSequence(unsigned char character, char *sequence);
+static void writeWaypointCoordinates(JSONWriter *writer, List *waypoints);
+static void writeCoordinatePair(JSONWriter *writer, const char *separator, double longitude, double latitude);
+static void writeSegmentCoordinates(JSONWriter *writer, TrackSegment *segment);
+
+bool readJSON(const char *json, JSONCallback callback, void *context) {
+
+    // Error check the string and callback for NULL
+    if (json == NULL || callback == NULL) {
+        fprintf(stderr, "ERROR: JSON string or callback is NULL\n");
+        return(FALSE);
+    }
+
+    JSONReader reader;
+    reader.position = json;
+    reader.callback = callback;
+    reader.context = context;
+    initStringBuffer(&reader.text);
+
+    // Containers that are open, '{' or '[', the reader never recurses so the depth is only limited by this stack
+    char containers[MAX_JSON_DEPTH];
+    int depth = 0;
+    ReaderState state = EXPECT_VALUE;
+    bool valid = FALSE;
+
+    JSONValue value;
+    value.number = 0;
+    while (TRUE) {
+        skipWhitespace(&reader);
+        char character = *reader.position;
+
+        if (state == EXPECT_VALUE) {
+            value.text = NULL;
+            value.length = 0;
+
+            // Opening an object or array, an empty one is closed straight away
+            if (character == '{' || character == '[') {
+                if (depth == MAX_JSON_DEPTH) {
+                    fprintf(stderr, "ERROR: JSON is nested deeper than %d\n", MAX_JSON_DEPTH);
+                    break;
+                }
+                bool isObject = (character == '{');
+                containers[depth++] = character;
+                reader.position++;
+                if (!callback(context, isObject ? JSON_OBJECT_START : JSON_ARRAY_START, &value)) {
+                    break;
+                }
+
+                skipWhitespace(&reader);
+                if (*reader.position == (isObject ? '}' : ']')) {
+                    reader.position++;
+                    depth--;
+                    if (!callback(context, isObject ? JSON_OBJECT_END : JSON_ARRAY_END, &value)) {
+                        break;
+                    }
+                    state = EXPECT_SEPARATOR;
+                }
+                else {
+                    state = isObject ? EXPECT_KEY : EXPECT_VALUE;
+                }
+                continue;
+            }
+
+            // Reading a scalar value
+            JSONEvent event;
+            if (character == '"') {
+                if (!readString(&reader)) {
+                    break;
+                }
+                event = JSON_STRING;
+            }
+            else if (character == '-' || (character >= '0' && character <= '9')) {
+                if (!readNumber(&reader, &value.number)) {
+                    break;
+                }
+                event = JSON_NUMBER;
+            }
+            else if (readLiteral(&reader, "true")) {
+                event = JSON_TRUE;
+            }
+            else if (readLiteral(&reader, "false")) {
+                event = JSON_FALSE;
+            }
+            else if (readLiteral(&reader, "null")) {
+                event = JSON_NULL;
+            }
+            else {
+                break;
+            }
+            value.text = reader.text.string;
+            value.length = reader.text.length;
+            if (!callback(context, event, &value)) {
+                break;
+            }
+            state = EXPECT_SEPARATOR;
+        }
+        else if (state == EXPECT_KEY) {
+
+            // A key is a string followed by a colon
+            if (character != '"' || !readString(&reader)) {
+                break;
+            }
+            value.text = reader.text.string;
+            value.length = reader.text.length;
+            if (!callback(context, JSON_KEY, &value)) {
+                break;
+            }
+            skipWhitespace(&reader);
+            if (*reader.position != ':') {
+                break;
+            }
+            reader.position++;
+            state = EXPECT_VALUE;
+        }
+        else {
+
+            // After the outermost value only whitespace may follow
+            if (depth == 0) {
+                valid = (character == '\0');
+                break;
+            }
+
+            // A comma leads to the next member or element, otherwise the innermost container has to be closed
+            value.text = NULL;
+            value.length = 0;
+            if (character == ',') {
+                reader.position++;
+                state = (containers[depth - 1] == '{') ? EXPECT_KEY : EXPECT_VALUE;
+            }
+            else if ((character == '}' && containers[depth - 1] == '{') || (character == ']' && containers[depth - 1] == '[')) {
+                reader.position++;
+                depth--;
+                if (!callback(context, (character == '}') ? JSON_OBJECT_END : JSON_ARRAY_END, &value)) {
+                    break;
+                }
+            }
+            else {
+                break;
+            }
+        }
+    }
+
+    free(reader.text.string);
+    return(valid);
+}
+
+static void skipWhitespace(JSONReader *reader) {
+    while (*reader -> position == ' ' || *reader -> position == '\t' || *reader -> position == '\n' || *reader -> position == '\r') {
+        reader -> position++;
+    }
+}
+
+static bool readString(JSONReader *reader) {
+
+    // Skipping the opening quote and emptying the buffer the string is decoded into
+    const char *position = reader -> position + 1;
+    reader -> text.length = 0;
+    reader -> text.string[0] = '\0';
+
+    while (TRUE) {
+
+        // Copying the run of characters up to the next quote, escape or control character in one go
+        const char *runStart = position;
+        while (*position != '"' && *position != '\\' && (unsigned char)*position >= 0x20) {
+            position++;
+        }
+        appendBytesToStringBuffer(&reader -> text, runStart, position - runStart);
+
+        if (*position == '"') {
+            reader -> position = position + 1;
+            return(TRUE);
+        }
+
+        // Control characters, including the end of the string, are not allowed inside a JSON string
+        if (*position != '\\') {
+            fprintf(stderr, "ERROR: Unterminated JSON string\n");
+            return(FALSE);
+        }
+
+        // Decoding the escape sequence
+        char escaped = position[1];
+        position += 2;
+        switch (escaped) {
+            case '"': appendBytesToStringBuffer(&reader -> text, "\"", 1); break;
+            case '\\': appendBytesToStringBuffer(&reader -> text, "\\", 1); break;
+            case '/': appendBytesToStringBuffer(&reader -> text, "/", 1); break;
+            case 'b': appendBytesToStringBuffer(&reader -> text, "\b", 1); break;
+            case 'f': appendBytesToStringBuffer(&reader -> text, "\f", 1); break;
+            case 'n': appendBytesToStringBuffer(&reader -> text, "\n", 1); break;
+            case 'r': appendBytesToStringBuffer(&reader -> text, "\r", 1); break;
+            case 't': appendBytesToStringBuffer(&reader -> text, "\t", 1); break;
+            case 'u': {
+                int codePoint = readHexDigits(position);
+                if (codePoint < 0) {
+                    fprintf(stderr, "ERROR: Invalid \\u escape in JSON string\n");
+                    return(FALSE);
+                }
+                position += 4;
+
+                // A high surrogate has to be followed by the escaped low surrogate it pairs with
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    int lowSurrogate = (position[0] == '\\' && position[1] == 'u') ? readHexDigits(position + 2) : -1;
+                    if (lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF) {
+                        fprintf(stderr, "ERROR: Unpaired surrogate in JSON string\n");
+                        return(FALSE);
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    position += 6;
+                }
+                else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    fprintf(stderr, "ERROR: Unpaired surrogate in JSON string\n");
+                    return(FALSE);
+                }
+                appendCodePoint(&reader -> text, codePoint);
+                break;
+            }
+            default:
+                fprintf(stderr, "ERROR: Invalid escape in JSON string\n");
+                return(FALSE);
+        }
+    }
+}
+
+static bool readNumber(JSONReader *reader, double *number) {
+
+    // Checking the number against the JSON grammar, -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    const char *start = reader -> position;
+    const char *position = start;
+    if (*position == '-') {
+        position++;
+    }
+    if (*position == '0') {
+        position++;
+    }
+    else if (*position >= '1' && *position <= '9') {
+        while (*position >= '0' && *position <= '9') {
+            position++;
+        }
+    }
+    else {
+        return(FALSE);
+    }
+    if (*position == '.') {
+        position++;
+        if (*position < '0' || *position > '9') {
+            return(FALSE);
+        }
+        while (*position >= '0' && *position <= '9') {
+            position++;
+        }
+    }
+    if (*position == 'e' || *position == 'E') {
+        position++;
+        if (*position == '+' || *position == '-') {
+            position++;
+        }
+        if (*position < '0' || *position > '9') {
+            return(FALSE);
+        }
+        while (*position >= '0' && *position <= '9') {
+            position++;
+        }
+    }
+
+    // Keeping the text of the number as written and converting it, the grammar has already been checked so it is read straight from the JSON
+    reader -> text.length = 0;
+    appendBytesToStringBuffer(&reader -> text, start, position - start);
+    *number = parseDecimal(start, NULL);
+    reader -> position = position;
+    return(TRUE);
+}
+
+static bool readLiteral(JSONReader *reader, const char *literal) {
+    size_t length = strlen(literal);
+    if (strncmp(reader -> position, literal, length) != 0) {
+        return(FALSE);
+    }
+    reader -> position += length;
+    reader -> text.length = 0;
+    appendBytesToStringBuffer(&reader -> text, literal, length);
+    return(TRUE);
+}
+
+static void appendCodePoint(StringBuffer *buffer, unsigned int codePoint) {
+
+    // Encoding the code point as one to four bytes of UTF-8
+    char bytes[4];
+    size_t length;
+    if (codePoint < 0x80) {
+        bytes[0] = codePoint;
+        length = 1;
+    }
+    else if (codePoint < 0x800) {
+        bytes[0] = 0xC0 | (codePoint >> 6);
+        bytes[1] = 0x80 | (codePoint & 0x3F);
+        length = 2;
+    }
+    else if (codePoint < 0x10000) {
+        bytes[0] = 0xE0 | (codePoint >> 12);
+        bytes[1] = 0x80 | ((codePoint >> 6) & 0x3F);
+        bytes[2] = 0x80 | (codePoint & 0x3F);
+        length = 3;
+    }
+    else {
+        bytes[0] = 0xF0 | (codePoint >> 18);
+        bytes[1] = 0x80 | ((codePoint >> 12) & 0x3F);
+        bytes[2] = 0x80 | ((codePoint >> 6) & 0x3F);
+        bytes[3] = 0x80 | (codePoint & 0x3F);
+        length = 4;
+    }
+    appendBytesToStringBuffer(buffer, bytes, length);
+}
+
+static int readHexDigits(const char *position) {
+
+    // Reading exactly four hex digits, -1 if any of them is not one
+    int codePoint = 0;
+    for (int i = 0; i < 4; i++) {
+        char digit = position[i];
+        codePoint <<= 4;
+        if (digit >= '0' && digit <= '9') {
+            codePoint |= digit - '0';
+        }
+        else if (digit >= 'a' && digit <= 'f') {
+            codePoint |= digit - 'a' + 10;
+        }
+        else if (digit >= 'A' && digit <= 'F') {
+            codePoint |= digit - 'A' + 10;
+        }
+        else {
+            return(-1);
+        }
+    }
+    return(codePoint);
+}
+
+GPXdoc* JSONtoGPX(const char* gpxString) {
+
+    // Error check gpxString for NULL
+    if (gpxString == NULL) {
+        fprintf(stderr, "ERORR: gpxString is NULL\n");
+        return(NULL);
+    }
+
+    // Reads {"version":..,"creator":..} in any order, along with optional "waypoints" and "routes" arrays
+    return((GPXdoc*)buildFromJSON(gpxString, FRAME_GPX));
+}
+
+Waypoint* JSONtoWaypoint(const char* gpxString) {
+
+    // Error check gpxString for NULL
+    if (gpxString == NULL) {
+        fprintf(stderr, "ERROR: gpxString is NULL\n");
+        return(NULL);
+    }
+
+    // Reads {"lat":..,"lon":..} in any order, along with an optional "name" and "otherData"
+    return((Waypoint*)buildFromJSON(gpxString, FRAME_WAYPOINT));
+}
+
+Route* JSONtoRoute(const char* gpxString) {
+
+    // Error check gpxString for NULL
+    if (gpxString == NULL) {
+        fprintf(stderr, "ERROR: gpxString is NULL\n");
+        return(NULL);
+    }
+
+    // Reads {"name":..} along with optional "points" and "otherData"
+    return((Route*)buildFromJSON(gpxString, FRAME_ROUTE));
+}
+
+List *JSONtoWaypointList(const char *json) {
+
+    // Error check json for NULL
+    if (json == NULL) {
+        fprintf(stderr, "ERROR: JSON string is NULL\n");
+        return(NULL);
+    }
+    return((List*)buildFromJSON(json, FRAME_WAYPOINT_LIST));
+}
+
+List *JSONtoRouteList(const char *json) {
+
+    // Error check json for NULL
+    if (json == NULL) {
+        fprintf(stderr, "ERROR: JSON string is NULL\n");
+        return(NULL);
+    }
+    return((List*)buildFromJSON(json, FRAME_ROUTE_LIST));
+}
+
+static void *buildFromJSON(const char *json, FrameKind rootKind) {
+    JSONBuilder builder;
+    builder.rootKind = rootKind;
+    builder.root = NULL;
+    builder.depth = 0;
+    builder.key[0] = '\0';
+    builder.failed = FALSE;
+
+    // Building the structs while the JSON is read, anything that was built is freed again if the JSON turns out to be unusable
+    bool valid = readJSON(json, &builderCallback, &builder);
+    if (!valid || builder.failed || builder.root == NULL) {
+        fprintf(stderr, "ERROR: Invalid JSON for a GPX component\n");
+        deleteBuiltRoot(rootKind, builder.root);
+        return(NULL);
+    }
+    return(builder.root);
+}
+
+static bool builderCallback(void *context, JSONEvent event, const JSONValue *value) {
+    JSONBuilder *builder = (JSONBuilder*)context;
+
+    switch (event) {
+        case JSON_OBJECT_START:
+        case JSON_ARRAY_START:
+            return(openBuilderFrame(builder, event));
+
+        case JSON_OBJECT_END:
+        case JSON_ARRAY_END: {
+
+            // A waypoint is only usable once both of its coordinates were given
+            BuilderFrame *frame = &builder -> frames[--builder -> depth];
+            if (frame -> kind == FRAME_WAYPOINT && !(frame -> hasLatitude && frame -> hasLongitude)) {
+                fprintf(stderr, "ERROR: JSON waypoint is missing its lat or lon\n");
+                builder -> failed = TRUE;
+                return(FALSE);
+            }
+            return(TRUE);
+        }
+
+        case JSON_KEY:
+            strncpy(builder -> key, value -> text, sizeof(builder -> key) - 1);
+            builder -> key[sizeof(builder -> key) - 1] = '\0';
+            return(TRUE);
+
+        default:
+
+            // The outermost value has to be an object or an array
+            if (builder -> depth == 0) {
+                builder -> failed = TRUE;
+                return(FALSE);
+            }
+            setBuilderScalar(builder, event, value);
+            return(TRUE);
+    }
+}
+
+static bool openBuilderFrame(JSONBuilder *builder, JSONEvent event) {
+    bool isObject = (event == JSON_OBJECT_START);
+    BuilderFrame *frame = &builder -> frames[builder -> depth];
+    frame -> target = NULL;
+    frame -> hasLatitude = FALSE;
+    frame -> hasLongitude = FALSE;
+
+    // The outermost container is the component asked for, or the list of them
+    if (builder -> depth == 0) {
+        FrameKind rootKind = builder -> rootKind;
+        bool isList = (rootKind == FRAME_WAYPOINT_LIST || rootKind == FRAME_ROUTE_LIST);
+        if (!isList && !isObject) {
+            builder -> failed = TRUE;
+            return(FALSE);
+        }
+        builder -> root = createEmptyComponent(rootKind);
+
+        // A single object given for a list is read as a list of one
+        if (isList && isObject) {
+            frame -> kind = (rootKind == FRAME_WAYPOINT_LIST) ? FRAME_WAYPOINT : FRAME_ROUTE;
+            frame -> target = createEmptyComponent(frame -> kind);
+            insertBack((List*)builder -> root, frame -> target);
+        }
+        else {
+            frame -> kind = rootKind;
+            frame -> target = builder -> root;
+        }
+        builder -> depth++;
+        return(TRUE);
+    }
+
+    // Otherwise what the container is depends on the one it is in and the key it was given under
+    BuilderFrame *parent = &builder -> frames[builder -> depth - 1];
+    const char *key = builder -> key;
+    frame -> kind = FRAME_SKIP;
+    switch (parent -> kind) {
+        case FRAME_WAYPOINT_LIST:
+        case FRAME_ROUTE_LIST:
+            if (isObject) {
+                frame -> kind = (parent -> kind == FRAME_WAYPOINT_LIST) ? FRAME_WAYPOINT : FRAME_ROUTE;
+                frame -> target = createEmptyComponent(frame -> kind);
+                insertBack((List*)parent -> target, frame -> target);
+            }
+            break;
+
+        case FRAME_OTHER_DATA_LIST:
+            if (isObject) {
+                frame -> kind = FRAME_OTHER_DATA;
+                frame -> target = parent -> target;
+            }
+            break;
+
+        case FRAME_GPX: {
+            GPXdoc *doc = (GPXdoc*)parent -> target;
+            if (!isObject && strcmp(key, "waypoints") == 0) {
+                frame -> kind = FRAME_WAYPOINT_LIST;
+                frame -> target = doc -> waypoints;
+            }
+            else if (!isObject && strcmp(key, "routes") == 0) {
+                frame -> kind = FRAME_ROUTE_LIST;
+                frame -> target = doc -> routes;
+            }
+            break;
+        }
+
+        case FRAME_WAYPOINT:
+        case FRAME_ROUTE: {
+            List *otherData = (parent -> kind == FRAME_WAYPOINT) ? ((Waypoint*)parent -> target) -> otherData : ((Route*)parent -> target) -> otherData;
+            if (strcmp(key, "otherData") == 0) {
+                frame -> kind = isObject ? FRAME_OTHER_DATA : FRAME_OTHER_DATA_LIST;
+                frame -> target = otherData;
+            }
+            else if (parent -> kind == FRAME_ROUTE && !isObject && (strcmp(key, "points") == 0 || strcmp(key, "waypoints") == 0)) {
+                frame -> kind = FRAME_WAYPOINT_LIST;
+                frame -> target = ((Route*)parent -> target) -> waypoints;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+    builder -> depth++;
+    return(TRUE);
+}
+
+static void setBuilderScalar(JSONBuilder *builder, JSONEvent event, const JSONValue *value) {
+    BuilderFrame *frame = &builder -> frames[builder -> depth - 1];
+    const char *key = builder -> key;
+
+    switch (frame -> kind) {
+        case FRAME_GPX: {
+            GPXdoc *doc = (GPXdoc*)frame -> target;
+            double version;
+            if (strcmp(key, "version") == 0 && readCoordinate(event, value, &version)) {
+                doc -> version = version;
+            }
+            else if (strcmp(key, "creator") == 0 && event == JSON_STRING) {
+                free(doc -> creator);
+                doc -> creator = malloc(value -> length + 1);
+                memcpy(doc -> creator, value -> text, value -> length + 1);
+            }
+            break;
+        }
+
+        case FRAME_WAYPOINT: {
+            Waypoint *waypoint = (Waypoint*)frame -> target;
+            if (strcmp(key, "lat") == 0) {
+                frame -> hasLatitude = readCoordinate(event, value, &waypoint -> latitude);
+            }
+            else if (strcmp(key, "lon") == 0) {
+                frame -> hasLongitude = readCoordinate(event, value, &waypoint -> longitude);
+            }
+            else if (strcmp(key, "name") == 0 && event == JSON_STRING) {
+                free(waypoint -> name);
+                waypoint -> name = malloc(value -> length + 1);
+                memcpy(waypoint -> name, value -> text, value -> length + 1);
+            }
+            break;
+        }
+
+        case FRAME_ROUTE: {
+            Route *route = (Route*)frame -> target;
+            if (strcmp(key, "name") == 0 && event == JSON_STRING) {
+                free(route -> name);
+                route -> name = malloc(value -> length + 1);
+                memcpy(route -> name, value -> text, value -> length + 1);
+            }
+            break;
+        }
+
+        case FRAME_OTHER_DATA: {
+
+            // Each member becomes a GPXData, numbers keep the text they were written with
+            if (event == JSON_STRING || event == JSON_NUMBER) {
+                GPXData *data = createGPXData(key, value -> text, value -> length);
+                if (data != NULL) {
+                    insertBack((List*)frame -> target, data);
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static bool readCoordinate(JSONEvent event, const JSONValue *value, double *coordinate) {
+
+    // Coordinates are numbers, or strings that hold nothing but a number as the forms of the web page send them
+    if (event == JSON_NUMBER) {
+        *coordinate = value -> number;
+        return(TRUE);
+    }
+    if (event == JSON_STRING && value -> length > 0) {
+        char *end;
+        double number = parseDecimal(value -> text, &end);
+        if (end == value -> text + value -> length) {
+            *coordinate = number;
+            return(TRUE);
+        }
+    }
+    return(FALSE);
+}
+
+static void *createEmptyComponent(FrameKind kind) {
+    switch (kind) {
+        case FRAME_GPX: {
+            GPXdoc *doc = malloc(sizeof(GPXdoc));
+            strcpy(doc -> namespace, "http://www.topografix.com/GPX/1/1");
+            doc -> version = 0;
+            doc -> creator = malloc(1);
+            strcpy(doc -> creator, "");
+            doc -> waypoints = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
+            doc -> routes = initializeList(&routeToString, &deleteRoute, &compareRoutes);
+            doc -> tracks = initializeList(&trackToString, &deleteTrack, &compareTracks);
+            return(doc);
+        }
+
+        case FRAME_WAYPOINT:
+            return(createWaypoint());
+
+        case FRAME_ROUTE: {
+            Route *route = poolAllocate(POOL_ROUTE);
+            route -> name = malloc(1);
+            strcpy(route -> name, "");
+            route -> waypoints = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
+            route -> otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
+            return(route);
+        }
+
+        case FRAME_WAYPOINT_LIST:
+            return(initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints));
+
+        case FRAME_ROUTE_LIST:
+            return(initializeList(&routeToString, &deleteRoute, &compareRoutes));
+
+        default:
+            return(NULL);
+    }
+}
+
+static void deleteBuiltRoot(FrameKind kind, void *root) {
+    if (root == NULL) {
+        return;
+    }
+    switch (kind) {
+        case FRAME_GPX:
+            deleteGPXdoc((GPXdoc*)root);
+            break;
+        case FRAME_WAYPOINT:
+            deleteWaypoint(root);
+            break;
+        case FRAME_ROUTE:
+            deleteRoute(root);
+            break;
+        default:
+            freeList((List*)root);
+            break;
+    }
+}
+
+void initJSONWriter(JSONWriter *writer, JSONSink sink, void *context) {
+    writer -> length = 0;
+    writer -> sink = sink;
+    writer -> context = context;
+    writer -> fileDescriptor = -1;
+    writer -> failed = FALSE;
+}
+
+void initJSONFileWriter(JSONWriter *writer, int fileDescriptor) {
+    initJSONWriter(writer, &writeToFileDescriptor, &writer -> fileDescriptor);
+    writer -> fileDescriptor = fileDescriptor;
+}
+
+void writeJSONText(JSONWriter *writer, const char *text) {
+    writeJSONBytes(writer, text, strlen(text));
+}
+
+void writeJSONBytes(JSONWriter *writer, const char *bytes, size_t length) {
+    if (writer -> failed) {
+        return;
+    }
+
+    // Filling the chunk, and passing it to the sink each time it is full
+    while (length > 0) {
+        size_t numCopied = JSON_WRITER_CHUNK - writer -> length;
+        if (numCopied > length) {
+            numCopied = length;
+        }
+        memcpy(writer -> chunk + writer -> length, bytes, numCopied);
+        writer -> length += numCopied;
+        bytes += numCopied;
+        length -= numCopied;
+
+        if (writer -> length == JSON_WRITER_CHUNK && !flushJSONWriter(writer)) {
+            return;
+        }
+    }
+}
+
+void writeJSONFormat(JSONWriter *writer, const char *format, ...) {
+    if (writer -> failed) {
+        return;
+    }
+
+    // Formatting straight into the chunk when the text fits in the space left
+    va_list arguments;
+    va_start(arguments, format);
+    size_t space = JSON_WRITER_CHUNK - writer -> length;
+    int textLength = vsnprintf(writer -> chunk + writer -> length, space, format, arguments);
+    va_end(arguments);
+    if (textLength < 0) {
+        return;
+    }
+    if ((size_t)textLength < space) {
+        writer -> length += textLength;
+        return;
+    }
+
+    // Otherwise formatting it again into memory of its own, which is only ever as large as the one piece of text
+    char *text = malloc(textLength + 1);
+    va_start(arguments, format);
+    vsnprintf(text, textLength + 1, format, arguments);
+    va_end(arguments);
+    writeJSONBytes(writer, text, textLength);
+    free(text);
+}
+
+void writeJSONFixed(JSONWriter *writer, double value, int decimals) {
+    char number[GPX_NUMBER_STRING_LENGTH];
+    writeJSONBytes(writer, number, formatFixedDouble(value, decimals, number));
+}
+
+bool flushJSONWriter(JSONWriter *writer) {
+    if (!writer -> failed && writer -> length > 0) {
+        writer -> failed = !writer -> sink(writer -> context, writer -> chunk, writer -> length);
+    }
+    writer -> length = 0;
+    return(!writer -> failed);
+}
+
+static bool writeToFileDescriptor(void *context, const char *bytes, size_t length) {
+    int fileDescriptor = *(int*)context;
+
+    // Writing until every byte has been taken, a write can take only part of them or be interrupted by a signal
+    while (length > 0) {
+        ssize_t numWritten = write(fileDescriptor, bytes, length);
+        if (numWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "ERROR: could not write JSON to file descriptor %d\n", fileDescriptor);
+            return(FALSE);
+        }
+        bytes += numWritten;
+        length -= numWritten;
+    }
+    return(TRUE);
+}
+
+bool escapeJSONString(const char *text, JSONSink sink, void *context) {
+    if (text == NULL) {
+        text = "";
+    }
+    if (!sink(context, "\"", 1)) {
+        return(FALSE);
+    }
+
+    // Passing each run of characters that need no escape to the sink in one piece, with the escape of the character that ended it after
+    size_t length = strlen(text);
+    size_t start = 0;
+    while (start < length) {
+        size_t end = start + findJSONEscape(text + start, length - start);
+        if (end > start && !sink(context, text + start, end - start)) {
+            return(FALSE);
+        }
+        if (end == length) {
+            break;
+        }
+        char sequence[8];
+        if (!sink(context, sequence, JSONEscapeSequence((unsigned char)text[end], sequence))) {
+            return(FALSE);
+        }
+        start = end + 1;
+    }
+    return(sink(context, "\"", 1));
+}
+
+void writeJSONString(JSONWriter *writer, const char *text) {
+    escapeJSONString(text, &writeToWriter, writer);
+}
+
+static bool writeToWriter(void *context, const char *bytes, size_t length) {
+    JSONWriter *writer = (JSONWriter*)context;
+    writeJSONBytes(writer, bytes, length);
+    return(!writer -> failed);
+}
+
+static size_t findJSONEscape(const char *text, size_t length) {
+
+    // Returns the index of the first quote, backslash or control character, or length if there is none
+    // Whole blocks are checked at once with the widest vector instructions the build targets, only the tail is checked a byte at a time
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i quotes32 = _mm256_set1_epi8('"');
+    const __m256i backslashes32 = _mm256_set1_epi8('\\');
+    const __m256i controls32 = _mm256_set1_epi8(0x1F);
+    for (; i + 32 <= length; i += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(text + i));
+
+        //A byte is a control character when it is unchanged by an unsigned min with 0x1F
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, quotes32), _mm256_cmpeq_epi8(bytes, backslashes32)),
+            _mm256_cmpeq_epi8(_mm256_min_epu8(bytes, controls32), bytes));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask != 0) {
+            return(i + __builtin_ctz(mask));
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i quotes = _mm_set1_epi8('"');
+    const __m128i backslashes = _mm_set1_epi8('\\');
+    const __m128i controls = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(text + i));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, quotes), _mm_cmpeq_epi8(bytes, backslashes)),
+            _mm_cmpeq_epi8(_mm_min_epu8(bytes, controls), bytes));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (mask != 0) {
+            return(i + __builtin_ctz(mask));
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16_t quotes = vdupq_n_u8('"');
+    const uint8x16_t backslashes = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(0x20);
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t bytes = vld1q_u8((const uint8_t*)(text + i));
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(bytes, quotes), vceqq_u8(bytes, backslashes)), vcltq_u8(bytes, space));
+        if (vmaxvq_u8(special) != 0) {
+            break;
+        }
+    }
+#else
+    // Without vector instructions 8 bytes are checked at once in a 64 bit word, a byte's high bit is set in the result when it could match
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t highs = 0x8080808080808080ULL;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        memcpy(&word, text + i, 8);
+        uint64_t quotes = word ^ (ones * '"');
+        uint64_t backslashes = word ^ (ones * '\\');
+        uint64_t special = ((quotes - ones) & ~quotes) | ((backslashes - ones) & ~backslashes) | ((word - ones * 0x20) & ~word);
+        if ((special & highs) != 0) {
+            break;
+        }
+    }
+#endif
+
+    // Finding the exact character in the block that matched, or checking the tail
+    for (; i < length; i++) {
+        unsigned char character = (unsigned char)text[i];
+        if (character == '"' || character == '\\' || character < 0x20) {
+            return(i);
+        }
+    }
+    return(length);
+}
+
+static size_t JSONEscapeSequence(unsigned char character, char *sequence) {
+
+    // Characters with a short escape use it, every other control character is written as \u00XX
+    switch (character) {
+        case '"': strcpy(sequence, "\\\""); return(2);
+        case '\\': strcpy(sequence, "\\\\"); return(2);
+        case '\n': strcpy(sequence, "\\n"); return(2);
+        case '\r': strcpy(sequence, "\\r"); return(2);
+        case '\t': strcpy(sequence, "\\t"); return(2);
+        case '\b': strcpy(sequence, "\\b"); return(2);
+        case '\f': strcpy(sequence, "\\f"); return(2);
+        default:
+            sprintf(sequence, "\\u%04x", character);
+            return(6);
+    }
+}
+
+void writeRouteListJSON(JSONWriter *writer, const List *list) {
+    writeJSONText(writer, "[");
+
+    // Writing each route as routeToJSON formats it, only one route's string exists at a time
+    int number = 0;
+    void *routeElement;
+    ListIterator routeIterator = createIterator((List*)list);
+    while (list != NULL && (routeElement = nextElement(&routeIterator)) != NULL) {
+        char *routeString = routeToJSON((Route*)routeElement);
+        writeJSONText(writer, (number++ == 0) ? "" : ",");
+        writeJSONText(writer, routeString);
+        free(routeString);
+    }
+    writeJSONText(writer, "]");
+}
+
+void writeTrackListJSON(JSONWriter *writer, const List *list) {
+    writeJSONText(writer, "[");
+
+    // Writing each track as trackToJSON formats it, only one track's string exists at a time
+    int number = 0;
+    void *trackElement;
+    ListIterator trackIterator = createIterator((List*)list);
+    while (list != NULL && (trackElement = nextElement(&trackIterator)) != NULL) {
+        char *trackString = trackToJSON((Track*)trackElement);
+        writeJSONText(writer, (number++ == 0) ? "" : ",");
+        writeJSONText(writer, trackString);
+        free(trackString);
+    }
+    writeJSONText(writer, "]");
+}
+
+void writeDocGeoJSON(JSONWriter *writer, const GPXdoc *doc) {
+    writeJSONText(writer, "{\"type\":\"FeatureCollection\",\"features\":[");
+    int numFeatures = 0;
+
+    // Each waypoint is a Point
+    void *element;
+    ListIterator waypointIterator = createIterator(doc -> waypoints);
+    while ((element = nextElement(&waypointIterator)) != NULL) {
+        Waypoint *waypoint = (Waypoint*)element;
+        writeJSONText(writer, (numFeatures++ == 0) ? "{\"type\":\"Feature\",\"properties\":{\"type\":\"waypoint\",\"name\":" : ",{\"type\":\"Feature\",\"properties\":{\"type\":\"waypoint\",\"name\":");
+        writeJSONString(writer, waypoint -> name);
+        writeJSONText(writer, "},\"geometry\":{\"type\":\"Point\",\"coordinates\":");
+        writeCoordinatePair(writer, "", waypoint -> longitude, waypoint -> latitude);
+        writeJSONText(writer, "}}");
+    }
+
+    // Each route is a LineString through its waypoints
+    ListIterator routeIterator = createIterator(doc -> routes);
+    while ((element = nextElement(&routeIterator)) != NULL) {
+        Route *route = (Route*)element;
+        writeJSONText(writer, (numFeatures++ == 0) ? "{\"type\":\"Feature\",\"properties\":{\"type\":\"route\",\"name\":" : ",{\"type\":\"Feature\",\"properties\":{\"type\":\"route\",\"name\":");
+        writeJSONString(writer, route -> name);
+        writeJSONText(writer, "},\"geometry\":{\"type\":\"LineString\",\"coordinates\":");
+        writeWaypointCoordinates(writer, route -> waypoints);
+        writeJSONText(writer, "}}");
+    }
+
+    // Each track is a MultiLineString with a line for every segment
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    while ((element = nextElement(&trackIterator)) != NULL) {
+        Track *track = (Track*)element;
+        writeJSONText(writer, (numFeatures++ == 0) ? "{\"type\":\"Feature\",\"properties\":{\"type\":\"track\",\"name\":" : ",{\"type\":\"Feature\",\"properties\":{\"type\":\"track\",\"name\":");
+        writeJSONString(writer, track -> name);
+        writeJSONText(writer, "},\"geometry\":{\"type\":\"MultiLineString\",\"coordinates\":[");
+        int numSegments = 0;
+        void *segmentElement;
+        ListIterator segmentIterator = createIterator(track -> segments);
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            writeJSONText(writer, (numSegments++ == 0) ? "" : ",");
+            writeSegmentCoordinates(writer, (TrackSegment*)segmentElement);
+        }
+        writeJSONText(writer, "]}}");
+    }
+    writeJSONText(writer, "]}");
+}
+
+static void writeWaypointCoordinates(JSONWriter *writer, List *waypoints) {
+
+    // Coordinates are [longitude,latitude] as GeoJSON orders them
+    writeJSONText(writer, "[");
+    int number = 0;
+    void *element;
+    ListIterator iterator = createIterator(waypoints);
+    while ((element = nextElement(&iterator)) != NULL) {
+        Waypoint *waypoint = (Waypoint*)element;
+        writeCoordinatePair(writer, (number++ == 0) ? "" : ",", waypoint -> longitude, waypoint -> latitude);
+    }
+    writeJSONText(writer, "]");
+}
+
+static void writeSegmentCoordinates(JSONWriter *writer, TrackSegment *segment) {
+
+    // Reading the points with a segment cursor, which covers columns, compacted segments and bare waypoint lists alike
+    writeJSONText(writer, "[");
+    SegmentCursor cursor;
+    openSegmentCursor(&cursor, segment);
+    while (nextSegmentRun(&cursor) > 0) {
+        for (int64_t i = 0; i < cursor.numPoints; i++) {
+            writeCoordinatePair(writer, (cursor.firstPoint + i == 0) ? "" : ",", cursor.longitudes[i], cursor.latitudes[i]);
+        }
+    }
+    writeJSONText(writer, "]");
+}
+
+static void writeCoordinatePair(JSONWriter *writer, const char *separator, double longitude, double latitude) {
+
+    // Formatting [longitude,latitude] with 6 decimals, about 10 centimetres, into one piece that is written at once
+    char pair[2 * GPX_NUMBER_STRING_LENGTH + 4];
+    int length = strlen(separator);
+    memcpy(pair, separator, length);
+    pair[length++] = '[';
+    length += formatFixedDouble(longitude, 6, pair + length);
+    pair[length++] = ',';
+    length += formatFixedDouble(latitude, 6, pair + length);
+    pair[length++] = ']';
+    writeJSONBytes(writer, pair, length);
+}
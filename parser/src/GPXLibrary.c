@@ -0,0 +1,91 @@
+#include "GPXParser.h"
+#include "GPXHelpers.h"
+#include "GPXLibrary.h"
+#include "GPXPool.h"
+#include <stdlib.h>
+#include <pthread.h>
+#include <libxml/xmlschemastypes.h>
+
+// Guards the state below, libxml2 only protects its own initialization in some of its versions
+static pthread_mutex_t libraryMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Number of gpx_library_init calls that have not been matched by gpx_library_shutdown yet
+static int libraryUsers = 0;
+
+// Whether libxml2's global state is set up, either by gpx_library_init or by the first function that needed it
+static bool libraryInitialized = FALSE;
+
+// Whether files are parsed without libxml2's size limits, set by gpx_set_huge_documents
+static bool hugeDocuments = FALSE;
+
+static bool initializeLibxml(void);
+
+bool gpx_library_init(void) {
+    pthread_mutex_lock(&libraryMutex);
+    bool initialized = initializeLibxml();
+    if (initialized == TRUE) {
+        libraryUsers++;
+    }
+    pthread_mutex_unlock(&libraryMutex);
+    return(initialized);
+}
+
+void gpx_library_shutdown(void) {
+    pthread_mutex_lock(&libraryMutex);
+
+    // Only the call matching the last gpx_library_init still in effect frees the global state, which frees the schema types too
+    if (libraryUsers > 0) {
+        libraryUsers--;
+        if (libraryUsers == 0 && libraryInitialized == TRUE) {
+            xmlCleanupParser();
+            libraryInitialized = FALSE;
+        }
+    }
+    pthread_mutex_unlock(&libraryMutex);
+
+    // The calling thread's pooled structs go back to malloc too, other threads free theirs when they exit
+    trimGPXPools();
+}
+
+void gpx_set_huge_documents(bool enabled) {
+    pthread_mutex_lock(&libraryMutex);
+    hugeDocuments = enabled;
+    pthread_mutex_unlock(&libraryMutex);
+}
+
+int getGPXParseOptions(void) {
+
+    // Every parser call takes its options from here, so a file is parsed the same way whichever function reads it
+    pthread_mutex_lock(&libraryMutex);
+    int options = (hugeDocuments == TRUE) ? (XML_PARSE_HUGE | XML_PARSE_NONET) : 0;
+    pthread_mutex_unlock(&libraryMutex);
+    return(options);
+}
+
+bool requireGPXLibrary(void) {
+    pthread_mutex_lock(&libraryMutex);
+    bool initialized = initializeLibxml();
+    pthread_mutex_unlock(&libraryMutex);
+    return(initialized);
+}
+
+static bool initializeLibxml(void) {
+    if (libraryInitialized == TRUE) {
+        return(TRUE);
+    }
+
+    // Setting up the parser's global state first, which the version string is part of
+    xmlInitParser();
+
+    // The libxml2 loaded at run time must have the major version the library was built with, and be at least as new
+    int runtimeVersion = atoi(xmlParserVersion);
+    if (runtimeVersion / 10000 != LIBXML_VERSION / 10000 || runtimeVersion < LIBXML_VERSION) {
+        fprintf(stderr, "ERROR: libxml2 %d is not compatible with the %d the library was built with\n", runtimeVersion, LIBXML_VERSION);
+        return(FALSE);
+    }
+
+    // Setting up the built in schema types here, as libxml2 sets them up lazily without a lock the first time a schema is parsed
+    xmlSchemaInitTypes();
+    libraryInitialized = TRUE;
+    return(TRUE);
+}
@@ -0,0 +1,107 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXLoader.h"
+
+static bool validateWithLoader(GPXLoader *loader, xmlDoc *doc);
+
+GPXLoader* createGPXLoader(xmlSchemaPtr schema) {
+
+    // Initializing libxml is only done once however many loaders are created, and makes the contexts below safe to use on any thread
+    if (requireGPXLibrary() == FALSE) {
+        return(NULL);
+    }
+
+    GPXLoader *loader = malloc(sizeof(GPXLoader));
+    loader -> parserContext = xmlNewParserCtxt();
+    loader -> schema = schema;
+    loader -> validContext = NULL;
+    loader -> numLoads = 0;
+    if (loader -> parserContext == NULL) {
+        fprintf(stderr, "ERROR: Could not create a parser context\n");
+        free(loader);
+        return(NULL);
+    }
+
+    // The validation context is kept along with the parser context, it is set up again by every validation
+    if (schema != NULL) {
+        loader -> validContext = xmlSchemaNewValidCtxt(schema);
+        if (loader -> validContext == NULL) {
+            fprintf(stderr, "ERROR: Could not create a schema validation context\n");
+            xmlFreeParserCtxt(loader -> parserContext);
+            free(loader);
+            return(NULL);
+        }
+        xmlSchemaSetValidErrors(loader -> validContext, (xmlSchemaValidityErrorFunc)fprintf, (xmlSchemaValidityWarningFunc)fprintf, stderr);
+    }
+
+    return(loader);
+}
+
+void deleteGPXLoader(GPXLoader* loader) {
+    if (loader == NULL) {
+        return;
+    }
+    if (loader -> validContext != NULL) {
+        xmlSchemaFreeValidCtxt(loader -> validContext);
+    }
+    xmlFreeParserCtxt(loader -> parserContext);
+    free(loader);
+}
+
+GPXdoc* loadGPXdoc(GPXLoader* loader, char* fileName) {
+
+    if (loader == NULL || fileName == NULL || strcmp(fileName, "") == 0) {
+        fprintf(stderr, "ERROR: Invalid loader or file name\n");
+        return(NULL);
+    }
+
+    // Starting over with a fresh context once the dictionary has grown large, names are only ever added to it
+    if (xmlDictSize(loader -> parserContext -> dict) > LOADER_DICT_LIMIT) {
+        xmlParserCtxtPtr parserContext = xmlNewParserCtxt();
+        if (parserContext != NULL) {
+            xmlFreeParserCtxt(loader -> parserContext);
+            loader -> parserContext = parserContext;
+        }
+    }
+
+    // Reading the file with the loader's context, which resets it and keeps its dictionary, the tree refers to the dictionary until it is freed
+    loader -> numLoads++;
+    xmlDoc *doc = xmlCtxtReadFile(loader -> parserContext, fileName, NULL, getGPXParseOptions());
+    if (doc == NULL) {
+        fprintf(stderr, "ERROR: XML file: %s was not parsable\n", fileName);
+        return(NULL);
+    }
+    if (validateWithLoader(loader, doc) == FALSE) {
+        fprintf(stderr, "GPX file: %s failed to validate with Schema file\n", fileName);
+        xmlFreeDoc(doc);
+        return(NULL);
+    }
+
+    // Creating the GPXdoc from the tree, the tree is not needed afterwards
+    GPXdoc *GPXDocStruct = xmlTreeToGPXdoc(doc);
+    xmlFreeDoc(doc);
+    if (GPXDocStruct == NULL || loader -> schema == NULL) {
+        return(GPXDocStruct);
+    }
+
+    // Validating the GPXdoc the same way validateGPXDoc does, by validating the tree it converts back to and checking the header file requirements
+    xmlDoc *xmlTree = GPXdocToxmlDoc(GPXDocStruct);
+    bool valid = validateWithLoader(loader, xmlTree);
+    xmlFreeDoc(xmlTree);
+    if (valid == FALSE || validGPXdocConstraints(GPXDocStruct) == FALSE) {
+        deleteGPXdoc(GPXDocStruct);
+        return(NULL);
+    }
+
+    return(GPXDocStruct);
+}
+
+static bool validateWithLoader(GPXLoader *loader, xmlDoc *doc) {
+
+    // Every tree is valid for a loader without a schema, any value other than 0 means the validation failed
+    if (loader -> validContext == NULL) {
+        return(TRUE);
+    }
+    return(xmlSchemaValidateDoc(loader -> validContext, doc) == 0);
+}
@@ -0,0 +1,427 @@
+// strtod_l is a GNU extension in glibc
+#define _GNU_SOURCE
+#include "GPXParser.h"
+#include "GPXNumber.h"
+#include <stdint.h>
+#include <math.h>
+#include <ctype.h>
+#include <locale.h>
+#include <pthread.h>
+#if defined(__APPLE__)
+#include <xlocale.h>
+#endif
+
+// A floating point number with a 64 bit significand, value = significand * 2^exponent
+typedef struct {
+    uint64_t significand;
+    int exponent;
+} DiyFp;
+
+// Cached normalized powers of ten 10^-348, 10^-340, ..., 10^340, the first power in the table is at CACHED_POWER_FIRST
+#define CACHED_POWER_FIRST -348
+static const DiyFp cachedPowers[] = {
+    {0xfa8fd5a0081c0288ULL, -1220}, {0xbaaee17fa23ebf76ULL, -1193}, {0x8b16fb203055ac76ULL, -1166},
+    {0xcf42894a5dce35eaULL, -1140}, {0x9a6bb0aa55653b2dULL, -1113}, {0xe61acf033d1a45dfULL, -1087},
+    {0xab70fe17c79ac6caULL, -1060}, {0xff77b1fcbebcdc4fULL, -1034}, {0xbe5691ef416bd60cULL, -1007},
+    {0x8dd01fad907ffc3cULL, -980}, {0xd3515c2831559a83ULL, -954}, {0x9d71ac8fada6c9b5ULL, -927},
+    {0xea9c227723ee8bcbULL, -901}, {0xaecc49914078536dULL, -874}, {0x823c12795db6ce57ULL, -847},
+    {0xc21094364dfb5637ULL, -821}, {0x9096ea6f3848984fULL, -794}, {0xd77485cb25823ac7ULL, -768},
+    {0xa086cfcd97bf97f4ULL, -741}, {0xef340a98172aace5ULL, -715}, {0xb23867fb2a35b28eULL, -688},
+    {0x84c8d4dfd2c63f3bULL, -661}, {0xc5dd44271ad3cdbaULL, -635}, {0x936b9fcebb25c996ULL, -608},
+    {0xdbac6c247d62a584ULL, -582}, {0xa3ab66580d5fdaf6ULL, -555}, {0xf3e2f893dec3f126ULL, -529},
+    {0xb5b5ada8aaff80b8ULL, -502}, {0x87625f056c7c4a8bULL, -475}, {0xc9bcff6034c13053ULL, -449},
+    {0x964e858c91ba2655ULL, -422}, {0xdff9772470297ebdULL, -396}, {0xa6dfbd9fb8e5b88fULL, -369},
+    {0xf8a95fcf88747d94ULL, -343}, {0xb94470938fa89bcfULL, -316}, {0x8a08f0f8bf0f156bULL, -289},
+    {0xcdb02555653131b6ULL, -263}, {0x993fe2c6d07b7facULL, -236}, {0xe45c10c42a2b3b06ULL, -210},
+    {0xaa242499697392d3ULL, -183}, {0xfd87b5f28300ca0eULL, -157}, {0xbce5086492111aebULL, -130},
+    {0x8cbccc096f5088ccULL, -103}, {0xd1b71758e219652cULL, -77}, {0x9c40000000000000ULL, -50},
+    {0xe8d4a51000000000ULL, -24}, {0xad78ebc5ac620000ULL, 3}, {0x813f3978f8940984ULL, 30},
+    {0xc097ce7bc90715b3ULL, 56}, {0x8f7e32ce7bea5c70ULL, 83}, {0xd5d238a4abe98068ULL, 109},
+    {0x9f4f2726179a2245ULL, 136}, {0xed63a231d4c4fb27ULL, 162}, {0xb0de65388cc8ada8ULL, 189},
+    {0x83c7088e1aab65dbULL, 216}, {0xc45d1df942711d9aULL, 242}, {0x924d692ca61be758ULL, 269},
+    {0xda01ee641a708deaULL, 295}, {0xa26da3999aef774aULL, 322}, {0xf209787bb47d6b85ULL, 348},
+    {0xb454e4a179dd1877ULL, 375}, {0x865b86925b9bc5c2ULL, 402}, {0xc83553c5c8965d3dULL, 428},
+    {0x952ab45cfa97a0b3ULL, 455}, {0xde469fbd99a05fe3ULL, 481}, {0xa59bc234db398c25ULL, 508},
+    {0xf6c69a72a3989f5cULL, 534}, {0xb7dcbf5354e9beceULL, 561}, {0x88fcf317f22241e2ULL, 588},
+    {0xcc20ce9bd35c78a5ULL, 614}, {0x98165af37b2153dfULL, 641}, {0xe2a0b5dc971f303aULL, 667},
+    {0xa8d9d1535ce3b396ULL, 694}, {0xfb9b7cd9a4a7443cULL, 720}, {0xbb764c4ca7a44410ULL, 747},
+    {0x8bab8eefb6409c1aULL, 774}, {0xd01fef10a657842cULL, 800}, {0x9b10a4e5e9913129ULL, 827},
+    {0xe7109bfba19c0c9dULL, 853}, {0xac2820d9623bf429ULL, 880}, {0x80444b5e7aa7cf85ULL, 907},
+    {0xbf21e44003acdd2dULL, 933}, {0x8e679c2f5e44ff8fULL, 960}, {0xd433179d9c8cb841ULL, 986},
+    {0x9e19db92b4e31ba9ULL, 1013}, {0xeb96bf6ebadf77d9ULL, 1039}, {0xaf87023b9bf0ee6bULL, 1066}
+};
+
+static const uint64_t powersOfTen[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+// Powers of ten that are exact in a double
+static const double exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// The C locale used for the numbers parseDecimal hands to strtod, created the first time one is needed
+static locale_t numericLocale;
+static pthread_once_t numericLocaleOnce = PTHREAD_ONCE_INIT;
+
+static DiyFp multiplyDiyFp(DiyFp first, DiyFp second);
+static DiyFp normalizeDiyFp(DiyFp value);
+static DiyFp cachedPowerFor(int exponent, int *decimalExponent);
+static int grisu2(double value, char *digits, int *decimalExponent);
+static void roundGrisuDigit(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance);
+static int writeShortestDigits(const char *digits, int length, int decimalExponent, char *string);
+static int writeUnsigned(uint64_t value, char *string);
+static void createNumericLocale(void);
+
+int formatShortestDouble(double value, char *string) {
+    int length = 0;
+
+    // Numbers with no decimal form are written the way printf writes them
+    if (isnan(value)) {
+        strcpy(string, "nan");
+        return(3);
+    }
+    if (signbit(value)) {
+        string[length++] = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        strcpy(string + length, "inf");
+        return(length + 3);
+    }
+    if (value == 0) {
+        strcpy(string, "0");
+        return(1);
+    }
+
+    char digits[20];
+    int decimalExponent = 0;
+    int numDigits = grisu2(value, digits, &decimalExponent);
+    return(length + writeShortestDigits(digits, numDigits, decimalExponent, string + length));
+}
+
+int formatFixedDouble(double value, int decimals, char *string) {
+    double magnitude = fabs(value);
+    double power = (double)powersOfTen[decimals];
+    double scaled = magnitude * power;
+
+    // Only values whose scaled digits are an exact integer in a double can be rounded exactly, which covers every coordinate, length and time
+    if (!isfinite(value) || scaled >= 9007199254740992.0) {
+        return(formatShortestDouble(value, string));
+    }
+
+    // The product is scaled plus error exactly, so the distance from the halfway point between two integers has the right sign even when it is tiny
+    double error = fma(magnitude, power, -scaled);
+    double whole = floor(scaled);
+    double halfway = (scaled - whole - 0.5) + error;
+    uint64_t rounded = (uint64_t)whole;
+    if (halfway > 0 || (halfway == 0 && (rounded & 1) == 1)) {
+        rounded++;
+    }
+
+    // Writing the sign, the integer digits, then the decimals with their leading zeros
+    int length = 0;
+    if (signbit(value)) {
+        string[length++] = '-';
+    }
+    length += writeUnsigned(rounded / powersOfTen[decimals], string + length);
+    if (decimals > 0) {
+        uint64_t fraction = rounded % powersOfTen[decimals];
+        string[length++] = '.';
+        for (int i = decimals - 1; i >= 0; i--) {
+            string[length + i] = '0' + fraction % 10;
+            fraction /= 10;
+        }
+        length += decimals;
+    }
+    string[length] = '\0';
+    return(length);
+}
+
+double parseDecimal(const char *string, char **end) {
+    const char *position = string;
+    while (isspace((unsigned char)*position)) {
+        position++;
+    }
+    const char *start = position;
+    bool negative = (*position == '-');
+    if (*position == '-' || *position == '+') {
+        position++;
+    }
+
+    // Gathering up to 19 significant digits, the decimal point only moves the exponent
+    uint64_t mantissa = 0;
+    int numSignificant = 0;
+    int exponent = 0;
+    bool hasDigits = FALSE;
+    bool truncated = FALSE;
+    while (*position >= '0' && *position <= '9') {
+        if (numSignificant < 19) {
+            mantissa = mantissa * 10 + (*position - '0');
+            numSignificant += (mantissa != 0);
+        }
+        else {
+            exponent++;
+            truncated |= (*position != '0');
+        }
+        hasDigits = TRUE;
+        position++;
+    }
+    if (*position == '.') {
+        position++;
+        while (*position >= '0' && *position <= '9') {
+            if (numSignificant < 19) {
+                mantissa = mantissa * 10 + (*position - '0');
+                numSignificant += (mantissa != 0);
+                exponent--;
+            }
+            else {
+                truncated |= (*position != '0');
+            }
+            hasDigits = TRUE;
+            position++;
+        }
+    }
+    if (hasDigits == FALSE) {
+        if (end != NULL) {
+            *end = (char*)string;
+        }
+        return(0);
+    }
+
+    // The exponent is only part of the number when digits follow the e
+    if (*position == 'e' || *position == 'E') {
+        const char *exponentStart = position + 1;
+        bool negativeExponent = (*exponentStart == '-');
+        if (*exponentStart == '-' || *exponentStart == '+') {
+            exponentStart++;
+        }
+        if (*exponentStart >= '0' && *exponentStart <= '9') {
+            int written = 0;
+            for (position = exponentStart; *position >= '0' && *position <= '9'; position++) {
+                if (written < 100000) {
+                    written = written * 10 + (*position - '0');
+                }
+            }
+            exponent += negativeExponent ? -written : written;
+        }
+    }
+    if (end != NULL) {
+        *end = (char*)position;
+    }
+
+    // Clinger's fast path, a mantissa below 2^53 and a power of ten up to 10^22 are both exact so one rounding gives the right double
+    if (truncated == FALSE && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = (exponent < 0) ? value / exactPowersOfTen[-exponent] : value * exactPowersOfTen[exponent];
+        return(negative ? -value : value);
+    }
+
+    // Everything else goes through strtod, in the C locale so a comma decimal locale cannot stop it at the point
+    pthread_once(&numericLocaleOnce, &createNumericLocale);
+    return(strtod_l(start, NULL, numericLocale));
+}
+
+static void createNumericLocale(void) {
+    numericLocale = newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+}
+
+static DiyFp multiplyDiyFp(DiyFp first, DiyFp second) {
+
+    // Keeping the upper 64 bits of the 128 bit product, rounded
+    DiyFp product;
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 full = (unsigned __int128)first.significand * second.significand;
+    product.significand = (uint64_t)(full >> 64) + (((uint64_t)full >> 63) & 1);
+#else
+    uint64_t a = first.significand >> 32, b = first.significand & 0xFFFFFFFF;
+    uint64_t c = second.significand >> 32, d = second.significand & 0xFFFFFFFF;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF) + (1ULL << 31);
+    product.significand = ac + (ad >> 32) + (bc >> 32) + (middle >> 32);
+#endif
+    product.exponent = first.exponent + second.exponent + 64;
+    return(product);
+}
+
+static DiyFp normalizeDiyFp(DiyFp value) {
+    int shift = __builtin_clzll(value.significand);
+    value.significand <<= shift;
+    value.exponent -= shift;
+    return(value);
+}
+
+static DiyFp cachedPowerFor(int exponent, int *decimalExponent) {
+
+    // Picking the cached power that brings the product's binary exponent into the range digit generation works in
+    double estimate = (-61 - exponent) * 0.30102999566398114 + 347;
+    int k = (int)estimate;
+    if (estimate - k > 0.0) {
+        k++;
+    }
+    int index = (k >> 3) + 1;
+    *decimalExponent = -(CACHED_POWER_FIRST + index * 8);
+    return(cachedPowers[index]);
+}
+
+static int grisu2(double value, char *digits, int *decimalExponent) {
+
+    // Splitting the double into its significand and exponent, value must be finite and positive
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biasedExponent = (int)((bits >> 52) & 0x7FF);
+    DiyFp v;
+    v.significand = bits & 0xFFFFFFFFFFFFFULL;
+    if (biasedExponent != 0) {
+        v.significand += 1ULL << 52;
+        v.exponent = biasedExponent - 1075;
+    }
+    else {
+        v.exponent = -1074;
+    }
+
+    // The boundaries halfway to the neighbouring doubles, any number strictly between them reads back as value
+    DiyFp plus = {(v.significand << 1) + 1, v.exponent - 1};
+    plus = normalizeDiyFp(plus);
+    DiyFp minus;
+    if (v.significand == (1ULL << 52)) {
+        minus.significand = (v.significand << 2) - 1;
+        minus.exponent = v.exponent - 2;
+    }
+    else {
+        minus.significand = (v.significand << 1) - 1;
+        minus.exponent = v.exponent - 1;
+    }
+    minus.significand <<= minus.exponent - plus.exponent;
+    minus.exponent = plus.exponent;
+
+    // Scaling value and its boundaries by a cached power of ten, then narrowing the boundaries by one unit for the rounding error
+    DiyFp power = cachedPowerFor(plus.exponent, decimalExponent);
+    DiyFp w = multiplyDiyFp(normalizeDiyFp(v), power);
+    DiyFp upper = multiplyDiyFp(plus, power);
+    DiyFp lower = multiplyDiyFp(minus, power);
+    lower.significand++;
+    upper.significand--;
+
+    // Generating digits of the upper boundary until what is left is within the boundaries
+    uint64_t delta = upper.significand - lower.significand;
+    int shift = -upper.exponent;
+    uint64_t one = 1ULL << shift;
+    uint64_t distance = upper.significand - w.significand;
+    uint32_t integral = (uint32_t)(upper.significand >> shift);
+    uint64_t fractional = upper.significand & (one - 1);
+    int length = 0;
+
+    int kappa = 1;
+    while (kappa < 10 && integral >= powersOfTen[kappa]) {
+        kappa++;
+    }
+    while (kappa > 0) {
+        uint32_t digit = integral / (uint32_t)powersOfTen[kappa - 1];
+        integral %= (uint32_t)powersOfTen[kappa - 1];
+        if (digit != 0 || length != 0) {
+            digits[length++] = '0' + digit;
+        }
+        kappa--;
+        uint64_t rest = ((uint64_t)integral << shift) + fractional;
+        if (rest <= delta) {
+            *decimalExponent += kappa;
+            roundGrisuDigit(digits, length, delta, rest, powersOfTen[kappa] << shift, distance);
+            return(length);
+        }
+    }
+    while (TRUE) {
+        fractional *= 10;
+        delta *= 10;
+        char digit = (char)(fractional >> shift);
+        if (digit != 0 || length != 0) {
+            digits[length++] = '0' + digit;
+        }
+        fractional &= one - 1;
+        kappa--;
+        if (fractional < delta) {
+            *decimalExponent += kappa;
+            roundGrisuDigit(digits, length, delta, fractional, one, distance * (-kappa < 20 ? powersOfTen[-kappa] : 0));
+            return(length);
+        }
+    }
+}
+
+static void roundGrisuDigit(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance) {
+
+    // Moving the last digit down while that brings the number closer to value and keeps it inside the boundaries
+    while (rest < distance && delta - rest >= tenKappa && (rest + tenKappa < distance || distance - rest > rest + tenKappa - distance)) {
+        digits[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static int writeShortestDigits(const char *digits, int length, int decimalExponent, char *string) {
+
+    // The number is 0.digits * 10^point
+    int point = length + decimalExponent;
+    int position = 0;
+
+    if (point > 21 || point < -11) {
+
+        // Exponent notation, d.ddde-7
+        string[position++] = digits[0];
+        if (length > 1) {
+            string[position++] = '.';
+            memcpy(string + position, digits + 1, length - 1);
+            position += length - 1;
+        }
+        int exponent = point - 1;
+        string[position++] = 'e';
+        if (exponent < 0) {
+            string[position++] = '-';
+            exponent = -exponent;
+        }
+        else {
+            string[position++] = '+';
+        }
+        position += writeUnsigned(exponent, string + position);
+    }
+    else if (point <= 0) {
+
+        // Only decimals, 0.000ddd, which is at most 11 zeros so the string fits with all 17 digits
+        string[position++] = '0';
+        string[position++] = '.';
+        memset(string + position, '0', -point);
+        position += -point;
+        memcpy(string + position, digits, length);
+        position += length;
+    }
+    else if (point >= length) {
+
+        // Only integer digits, ddd000
+        memcpy(string, digits, length);
+        memset(string + length, '0', point - length);
+        position = point;
+    }
+    else {
+        memcpy(string, digits, point);
+        string[point] = '.';
+        memcpy(string + point + 1, digits + point, length - point);
+        position = length + 1;
+    }
+    string[position] = '\0';
+    return(position);
+}
+
+static int writeUnsigned(uint64_t value, char *string) {
+    char reversed[20];
+    int length = 0;
+    do {
+        reversed[length++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    for (int i = 0; i < length; i++) {
+        string[i] = reversed[length - 1 - i];
+    }
+    string[length] = '\0';
+    return(length);
+}
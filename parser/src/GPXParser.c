@@ -1,6 +1,27 @@
 #include "GPXParser.h"
 #include "LinkedListAPI.h"
 #include "GPXHelpers.h"
+#include "GPXCorpus.h"
+#include "GPXStats.h"
+#include "GPXQuery.h"
+#include "GPXBatch.h"
+#include "GPXJSON.h"
+#include "GPXNumber.h"
+#include "GPXCompact.h"
+#include "GPXPool.h"
+#include "GPXVisit.h"
+#include "GPXScan.h"
+
+// Lengths compared by the scans of numberOfRoutesWithLengthFromFile and numberOfTracksWithLengthFromFile
+typedef struct {
+    ComponentType type;
+    float len;
+    float delta;
+    int64_t numComponents;
+} LengthMatch;
+
+static bool countLengthMatch(void *context, const ScannedComponent *component);
+static int64_t numberWithLengthFromFile(char *fileName, ComponentType type, float len, float delta);
 
 GPXdoc* createGPXdoc(char* fileName) {
 
@@ -10,8 +31,10 @@ GPXdoc* createGPXdoc(char* fileName) {
         return(NULL);
     }
 
-    // Initializes the libxml library
-    LIBXML_TEST_VERSION
+    // Initializes the libxml library, which only happens on the first call and is safe to do from several threads at once
+    if (requireGPXLibrary() == FALSE) {
+        return(NULL);
+    }
 
     // Declaring the GPXdoc structure and allocating size of GPXdoc structure bytes of data and initializing version
     GPXdoc *GPXDocStructure = malloc(sizeof(GPXdoc));
@@ -26,8 +49,8 @@ GPXdoc* createGPXdoc(char* fileName) {
     xmlDoc *doc = NULL;
     xmlNode *root_element = NULL;
 
-    // Parses the file and returns doc
-    doc = xmlReadFile(fileName, NULL, 0);
+    // Parses the file, without libxml2's size limits in huge document mode, and returns doc
+    doc = xmlReadFile(fileName, NULL, getGPXParseOptions());
 
     // Error checks to ensure the doc was parsable
     if (doc == NULL) {
@@ -37,7 +60,6 @@ GPXdoc* createGPXdoc(char* fileName) {
         freeList(GPXDocStructure -> tracks);
         free(GPXDocStructure);
         xmlFreeDoc(doc);
-        xmlCleanupParser();
         return(NULL);
     }
 
@@ -48,7 +70,7 @@ GPXdoc* createGPXdoc(char* fileName) {
     for (xmlAttr *attribute = root_element -> properties; attribute != NULL; attribute = attribute -> next) {
         // If the name is equal to version, gets the content of that attribute
         if (strcmp((char*)attribute -> name, "version") == 0) {
-            GPXDocStructure -> version = atof((char*)attribute -> children -> content);
+            GPXDocStructure -> version = parseDecimal((char*)attribute -> children -> content, NULL);
         }
         // If the name is equal to content, mallocs the creator pointer and gets the content
         if (strcmp((char*)attribute -> name, "creator") == 0) {
@@ -63,7 +85,6 @@ GPXdoc* createGPXdoc(char* fileName) {
                 freeList(GPXDocStructure -> tracks);
                 free(GPXDocStructure);
                 xmlFreeDoc(doc);
-                xmlCleanupParser();
                 fprintf(stderr, "Error: Creator is empty or NULL\n");
                 return(NULL);
             }
@@ -78,7 +99,6 @@ GPXdoc* createGPXdoc(char* fileName) {
         freeList(GPXDocStructure -> tracks);
         free(GPXDocStructure);
         xmlFreeDoc(doc);
-        xmlCleanupParser();
         fprintf(stderr, "Error: Name space is empty\n");
         return(NULL);
     }
@@ -87,9 +107,8 @@ GPXdoc* createGPXdoc(char* fileName) {
     root_element = root_element -> children;
     parseXMLTree(GPXDocStructure, root_element);
 
-    // Freeing the doc and cleaning up the parser
+    // Freeing the doc, libxml's global state is left alone as other threads may be using it
     xmlFreeDoc(doc);
-    xmlCleanupParser();
 
     // Returns the pointer to the GPXdoc structure
     return(GPXDocStructure);
@@ -128,7 +147,7 @@ void deleteGPXdoc(GPXdoc* doc) {
 }
 
 // Iterator structure similar to Professor Dennis' in StructListDemo
-int getNumWaypoints(const GPXdoc* doc) {
+int64_t getNumWaypoints(const GPXdoc* doc) {
     if (doc == NULL) {
         return(0);
     }
@@ -136,7 +155,7 @@ int getNumWaypoints(const GPXdoc* doc) {
     return(getLength(doc -> waypoints));
 }
 
-int getNumRoutes(const GPXdoc* doc) {
+int64_t getNumRoutes(const GPXdoc* doc) {
     if (doc == NULL) {
         return(0);
     }
@@ -144,7 +163,7 @@ int getNumRoutes(const GPXdoc* doc) {
     return(getLength(doc -> routes));
 }
 
-int getNumTracks(const GPXdoc* doc) {
+int64_t getNumTracks(const GPXdoc* doc) {
     if (doc == NULL) {
         return(0);
     }
@@ -152,20 +171,15 @@ int getNumTracks(const GPXdoc* doc) {
     return(getLength(doc -> tracks));
 }
 
-int getNumSegments(const GPXdoc* doc) {
+int64_t getNumSegments(const GPXdoc* doc) {
     if (doc == NULL) {
         return(0);
     }
-    int numSegments = 0;
-
-    // Creating a void pointer and list iterator for the track list
-    void *trackElement;
-    ListIterator trackIterator = createIterator(doc -> tracks);
+    int64_t numSegments = 0;
 
-    // Traverses through the track list with the iterator and gets the number of segments in each track element
-    while ((trackElement = nextElement(&trackIterator)) != NULL) {
-        // Creates a track struct with the data and gets the number of elements in the segments list and adds it to the numSegments variable
-        Track *trackStruct = (Track*)trackElement;
+    // Traverses through the track list and gets the number of segments in each track
+    const Track *trackStruct;
+    GPX_FOR_EACH_TRACK(trackStruct, doc) {
         numSegments += getLength(trackStruct -> segments);
     }
 
@@ -173,11 +187,11 @@ int getNumSegments(const GPXdoc* doc) {
     return(numSegments);
 }
 
-int getNumGPXData(const GPXdoc* doc) {
+int64_t getNumGPXData(const GPXdoc* doc) {
     if (doc == NULL) {
         return(0);
     }
-    int numData = 0;
+    int64_t numData = 0;
 
     // Gets the number of children of waypoints in the waypoint list
     ListIterator waypointIterator = createIterator(doc -> waypoints);
@@ -222,6 +236,13 @@ int getNumGPXData(const GPXdoc* doc) {
             TrackSegment *trksegStruct = (TrackSegment*)segmentElement;
             ListIterator trksegWaypointIterator = createIterator(trksegStruct -> waypoints);
             numData += waypointData(trksegWaypointIterator);
+
+            // A compacted segment has no waypoints left, only the elevations and times kept in its columns
+            if (trksegStruct -> compact != NULL) {
+                for (int64_t i = 0; i < trksegStruct -> compact -> numPoints; i++) {
+                    numData += !isnan(trksegStruct -> elevations[i]) + (trksegStruct -> times[i] != GPX_NO_TIME);
+                }
+            }
         }
     }
     // Returns the numData
@@ -233,12 +254,9 @@ Waypoint* getWaypoint(const GPXdoc* doc, char* name) {
         return(NULL);
     }
 
-    // Makes an iterator to iterate through the list of waypoints
-    void *waypointElement;
-    ListIterator waypointIterator = createIterator(doc -> waypoints);
-    while ((waypointElement = nextElement(&waypointIterator)) != NULL) {
-        // Creates a waypoint struct and compares its name member to the name parameter
-        Waypoint *waypointStruct = (Waypoint*)waypointElement;
+    // Iterates through the list of waypoints and compares each name member to the name parameter
+    Waypoint *waypointStruct;
+    GPX_FOR_EACH_WAYPOINT(waypointStruct, doc) {
         if (strcmp(waypointStruct -> name, name) == 0) {
             // If they are equal returns the waypoint struct
             return(waypointStruct);
@@ -253,12 +271,9 @@ Track* getTrack(const GPXdoc* doc, char* name) {
         return(NULL);
     }
 
-    // Makes an iterator to iterate through the list of tracks
-    void *trackElement;
-    ListIterator trackIterator = createIterator(doc -> tracks);
-    while ((trackElement = nextElement(&trackIterator)) != NULL) {
-        // Creates a track struct and compares its name member to the name parameter
-        Track *trackStruct = (Track*)trackElement;
+    // Iterates through the list of tracks and compares each name member to the name parameter
+    Track *trackStruct;
+    GPX_FOR_EACH_TRACK(trackStruct, doc) {
         if (strcmp(trackStruct -> name, name) == 0) {
             // If they are equal returns the track struct
             return(trackStruct);
@@ -273,12 +288,9 @@ Route* getRoute(const GPXdoc* doc, char* name) {
         return(NULL);
     }
 
-    // Makes an iterator to iterate through the list of routes
-    void *routeElement;
-    ListIterator routeIterator = createIterator(doc -> routes);
-    while ((routeElement = nextElement(&routeIterator)) != NULL) {
-        // Creates a route struct and compares its name member to the name parameter
-        Route *routeStruct = (Route*)routeElement;
+    // Iterates through the list of routes and compares each name member to the name parameter
+    Route *routeStruct;
+    GPX_FOR_EACH_ROUTE(routeStruct, doc) {
         if (strcmp(routeStruct -> name, name) == 0) {
             // If they are equal returns the route struct
             return(routeStruct);
@@ -288,6 +300,23 @@ Route* getRoute(const GPXdoc* doc, char* name) {
     return(NULL);
 }
 
+List* getWaypointOtherData(Waypoint* waypoint) {
+    if (waypoint == NULL) {
+        return(NULL);
+    }
+
+    // Expanding packed data into a list of GPXData once, after which the waypoint is like any other
+    if (waypoint -> packedData != NULL) {
+        if (waypoint -> otherData != NULL) {
+            freeList(waypoint -> otherData);
+        }
+        waypoint -> otherData = unpackWaypointData(waypoint -> packedData);
+        free(waypoint -> packedData);
+        waypoint -> packedData = NULL;
+    }
+    return(waypoint -> otherData);
+}
+
 // These print/delete/compare functions are based off Professor Dennis' from StructListDemo
 char *gpxDataToString(void *data) {
     if (data == NULL) {
@@ -319,7 +348,14 @@ int compareGpxData(const void *first, const void *second) {
     if (first == NULL || second == NULL) {
         return(1);
     }
-    return(0);
+
+    // Names are interned, so equal names are the same pointer and only different names need their strings compared
+    const GPXData *firstData = (const GPXData*)first;
+    const GPXData *secondData = (const GPXData*)second;
+    if (firstData -> name != secondData -> name) {
+        return(strcmp(firstData -> name, secondData -> name));
+    }
+    return(strcmp(firstData -> value, secondData -> value));
 }
 
 char *waypointToString(void *data) {
@@ -331,8 +367,12 @@ char *waypointToString(void *data) {
     char *string;
     Waypoint *waypointStruct = (Waypoint*)data;
 
-    // Creating a string pointer for the otherData list
-    char *otherDataString = toString(waypointStruct -> otherData);
+    // Creating a string pointer for the otherData list, packed data is expanded into a list that is only kept for the string
+    List *otherDataList = (waypointStruct -> packedData != NULL) ? unpackWaypointData(waypointStruct -> packedData) : waypointStruct -> otherData;
+    char *otherDataString = toString(otherDataList);
+    if (otherDataList != waypointStruct -> otherData) {
+        freeList(otherDataList);
+    }
 
     // Allocates memory for the name and other data list in the waypoint struct
     // +1 for NULL terminator, in Professor Dennis' example he represented an integer with 20 bytes and a double is 2x an ineger so +40 for each double
@@ -345,6 +385,23 @@ char *waypointToString(void *data) {
     return(string);
 }
 
+Waypoint* createWaypoint(void) {
+    Waypoint *waypointStruct = poolAllocate(POOL_WAYPOINT);
+    if (waypointStruct == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate a waypoint\n");
+        return(NULL);
+    }
+
+    // Every member deleteWaypoint frees is set, packed data is only ever filled in by the parser
+    waypointStruct -> name = malloc(1);
+    strcpy(waypointStruct -> name, "");
+    waypointStruct -> latitude = 0;
+    waypointStruct -> longitude = 0;
+    waypointStruct -> otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
+    waypointStruct -> packedData = NULL;
+    return(waypointStruct);
+}
+
 void deleteWaypoint(void *data) {
     if (data == NULL) {
         return;
@@ -355,8 +412,11 @@ void deleteWaypoint(void *data) {
 
     // Freeing any members allocated in the waypoint structure and then freeing the structure itself
     free(waypointStruct -> name);
-    freeList(waypointStruct -> otherData);
-    free(waypointStruct);
+    if (waypointStruct -> otherData != NULL) {
+        freeList(waypointStruct -> otherData);
+    }
+    free(waypointStruct -> packedData);
+    poolRelease(POOL_WAYPOINT, waypointStruct);
 }
 
 int compareWaypoints(const void *first, const void *second) {
@@ -401,7 +461,7 @@ void deleteRoute(void *data) {
     free(routeStruct -> name);
     freeList(routeStruct -> waypoints);
     freeList(routeStruct -> otherData);
-    free(routeStruct);
+    poolRelease(POOL_ROUTE, routeStruct);
 }
 
 int compareRoutes(const void *first, const void *second) {
@@ -432,6 +492,25 @@ char *trackSegmentToString(void *data) {
     return(string);
 }
 
+TrackSegment* createTrackSegment(void) {
+    TrackSegment *trkSeg = poolAllocate(POOL_TRACK_SEGMENT);
+    if (trkSeg == NULL) {
+        fprintf(stderr, "ERROR: Could not allocate a track segment\n");
+        return(NULL);
+    }
+
+    // Every member deleteTrackSegment frees starts out NULL, the parser fills in the columns once the points are read
+    trkSeg -> waypoints = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
+    trkSeg -> numPoints = 0;
+    trkSeg -> latitudes = NULL;
+    trkSeg -> longitudes = NULL;
+    trkSeg -> elevations = NULL;
+    trkSeg -> times = NULL;
+    trkSeg -> timesAscending = FALSE;
+    trkSeg -> compact = NULL;
+    return(trkSeg);
+}
+
 void deleteTrackSegment(void *data) {
     if (data == NULL) {
         return;
@@ -442,7 +521,12 @@ void deleteTrackSegment(void *data) {
 
     // Freeing the members of tracksegment and the structure itself
     freeList(trkSeg -> waypoints);
-    free(trkSeg);
+    free(trkSeg -> latitudes);
+    free(trkSeg -> longitudes);
+    free(trkSeg -> elevations);
+    free(trkSeg -> times);
+    deleteCompactCoordinates(trkSeg -> compact);
+    poolRelease(POOL_TRACK_SEGMENT, trkSeg);
 }
 
 int compareTrackSegments(const void *first, const void *second) {
@@ -487,7 +571,7 @@ void deleteTrack(void *data) {
     free(trackStruct -> name);
     freeList(trackStruct -> segments);
     freeList(trackStruct -> otherData);
-    free(trackStruct);
+    poolRelease(POOL_TRACK, trackStruct);
 }
 
 int compareTracks(const void *first, const void *second) {
@@ -509,8 +593,10 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
         return(NULL);
     }
 
-    // Initializing the libxml library
-    LIBXML_TEST_VERSION
+    // Initializing the libxml library, which only happens on the first call and is safe to do from several threads at once
+    if (requireGPXLibrary() == FALSE) {
+        return(NULL);
+    }
 
     // Declaring the GPXdoc structure and allocating size of GPXdoc structure bytes of data and initializing version
     GPXdoc *GPXDocStruct = malloc(sizeof(GPXdoc));
@@ -525,8 +611,8 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
     xmlDoc *doc = NULL;
     xmlNode *root_element = NULL;
 
-    // Parses the XML file and returns an xmlDoc pointer to an XML tree
-    doc = xmlReadFile(fileName, NULL, 0);
+    // Parses the XML file, without libxml2's size limits in huge document mode, and returns an xmlDoc pointer to an XML tree
+    doc = xmlReadFile(fileName, NULL, getGPXParseOptions());
 
     // Error checks to ensure the XML file was parsable
     if (doc == NULL) {
@@ -536,7 +622,6 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
         freeList(GPXDocStruct -> tracks);
         free(GPXDocStruct);
         xmlFreeDoc(doc);
-        xmlCleanupParser();
         return(NULL);
     }
 
@@ -548,8 +633,6 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
         freeList(GPXDocStruct -> tracks);
         free(GPXDocStruct);
         xmlFreeDoc(doc);
-        xmlCleanupParser();
-        xmlMemoryDump();
         return(NULL);
     }
 
@@ -560,7 +643,7 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
     for (xmlAttr *attribute = root_element -> properties; attribute != NULL; attribute = attribute -> next) {
         // If the name is equal to version, gets the content of that attribute
         if (strcmp((char*)attribute -> name, "version") == 0) {
-            GPXDocStruct -> version = atof((char*)attribute -> children -> content);
+            GPXDocStruct -> version = parseDecimal((char*)attribute -> children -> content, NULL);
         }
         // If the name is equal to content, mallocs the creator pointer and gets the content
         if (strcmp((char*)attribute -> name, "creator") == 0) {
@@ -571,8 +654,6 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
             if ((strcmp(GPXDocStruct -> creator, "") == 0) || GPXDocStruct -> creator == NULL) {
                 deleteGPXdoc(GPXDocStruct);
                 xmlFreeDoc(doc);
-                xmlCleanupParser();
-                xmlMemoryDump();
                 fprintf(stderr, "Error: Creator is empty or NULL\n");
                 return(NULL);
             }
@@ -583,8 +664,6 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
     if (strcmp(GPXDocStruct -> namespace, "") == 0) {
         deleteGPXdoc(GPXDocStruct);
         xmlFreeDoc(doc);
-        xmlCleanupParser();
-        xmlMemoryDump();
         fprintf(stderr, "Error: Name space is empty\n");
         return(NULL);
     }
@@ -593,10 +672,8 @@ GPXdoc* createValidGPXdoc(char* fileName, char* gpxSchemaFile) {
     root_element = root_element -> children;
     parseXMLTree(GPXDocStruct, root_element);
 
-    // Freeing the xmlDoc pointer, cleaning up the Schemas type library as well as the XML parser and dumps any memory associated with the Schema
+    // Freeing the xmlDoc pointer, libxml's global state is left alone as other threads may be using it
     xmlFreeDoc(doc);
-    xmlCleanupParser();
-    xmlMemoryDump();
 
     // Returns a valid GPXdoc structure
     return(GPXDocStruct);
@@ -621,121 +698,14 @@ bool validateGPXDoc(GPXdoc* doc, char* gpxSchemaFile) {
     // Calls the validateXmlTreeWithSchema to check the validity of the xmlTree with the Schema file, a return value of 0 indicates an invalid xmlTree against the Schema file
     if (validateXmlTreeWithSchema(xmlTree, gpxSchemaFile) == 0) {
         xmlFreeDoc(xmlTree);
-        xmlCleanupParser();
         return(FALSE);
     }
 
-    // Freeing the xmlTree created to check its validity and cleaning up the XML parser as the below checks do not rely on the XML library
+    // Freeing the xmlTree created to check its validity as the below checks do not rely on the XML library
     xmlFreeDoc(xmlTree);
-    xmlCleanupParser();
-
-    // Error checking the namespace for NULL or empty
-    if (doc -> namespace == NULL || (strcmp(doc -> namespace, "") == 0)) {
-        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-        return(FALSE);
-    }
-
-    // Error checking the creator for NULL or empty
-    if (doc -> creator == NULL || (strcmp(doc -> creator, "") == 0)) {
-        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-        return(FALSE);
-    }
-
-    // Error checking all the list for NULL
-    if (doc -> waypoints == NULL || doc -> routes == NULL || doc -> tracks == NULL) {
-        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-        return(FALSE);
-    }
-
-    // Checking the list of waypoints in the GPXdoc struct for any invalid members
-    if (validWaypointConstraints(doc -> waypoints) == 0) {
-        fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-        return(FALSE); 
-    }
-
-    // Checking the list of routes in the GPXdoc struct for any invalid members
-    void *routeElement;
-    ListIterator routeIterator = createIterator(doc -> routes);
-    while ((routeElement = nextElement(&routeIterator)) != NULL) {
-
-        // Getting the route struct for the current routeElement
-        Route *routeStruct = (Route*)routeElement;
-
-        // Error check name in routeStruct for NULL
-        if (routeStruct -> name == NULL) {
-            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-            return(FALSE);
-        }
 
-        // Error check the list of waypoints and list of otherData for NULL
-        if (routeStruct -> waypoints == NULL || routeStruct -> otherData == NULL) {
-            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-            return(FALSE);
-        }
-
-        // Error check to ensure list of waypoints have valid members
-        if (validWaypointConstraints(routeStruct -> waypoints) == 0) {
-            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-            return(FALSE);
-        }
-
-        // Error check to ensure list of otherData have valid members
-        if (validOtherDataConstraints(routeStruct -> otherData) == 0) {
-            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-            return(FALSE);
-        }  
-    }
-    
-    // Checking the list of tracks in the GPXdoc struct for any invalid members
-    void *trackElement;
-    ListIterator trackIterator = createIterator(doc -> tracks);
-    while ((trackElement = nextElement(&trackIterator)) != NULL) {
-
-        // Getting the track struct for the current trackElement
-        Track *trackStruct = (Track*)trackElement;
-
-        // Error check name in the trackStruct for NULL
-        if (trackStruct -> name == NULL) {
-            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-            return(FALSE);
-        }
-
-        // Error check the list of segments and list of otherData for NULL
-        if (trackStruct -> segments == NULL || trackStruct -> otherData == NULL) {
-            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-            return(FALSE);
-        }
-
-        // Error check to ensure the list of segments have valid members
-        void *trackSegmentElement;
-        ListIterator trackSegmentIterator = createIterator(trackStruct -> segments);
-        while ((trackSegmentElement = nextElement(&trackSegmentIterator)) != NULL) {
-
-            // Getting the track segment struct for the current trackSegmentElement
-            TrackSegment *trackSegmentStruct = (TrackSegment*)trackSegmentElement;
-
-            // Error check the list of waypoints in the trackSegmentStruct for NULL
-            if (trackSegmentStruct -> waypoints == NULL) {
-                fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-                return(FALSE);
-            }
-
-            // Error check to ensure the list of waypoints have valid members
-            if (validWaypointConstraints(trackSegmentStruct -> waypoints) == 0) {
-                fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-                return(FALSE);
-            }
-        }
-
-        // Error check to ensure the list of otherData have valid members
-        if (validOtherDataConstraints(trackStruct -> otherData) == 0) {
-            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
-            return(FALSE);
-        }
-    }
-
-    // Return TRUE meaning that the GPXdoc struct is valid by the Schema file and the requirements in the header file
-    return(TRUE);
+    // Checking the GPXdoc struct against the requirements of the header file
+    return(validGPXdocConstraints(doc));
 }
 
 bool writeGPXdoc(GPXdoc* doc, char* fileName) {
@@ -770,10 +740,8 @@ bool writeGPXdoc(GPXdoc* doc, char* fileName) {
     // Writing the XML tree to the inputted fileName
     xmlSaveFormatFileEnc(fileName, xmlTree, "UTF-8", 1);
     
-    // Freeing the xmlTree created and cleaning up the xml parser and dumping the memory
+    // Freeing the xmlTree created
     xmlFreeDoc(xmlTree);
-    xmlCleanupParser();
-    xmlMemoryDump();
 
     // Returns TRUE if no errors were encountered and the file was written to correctly
     return(TRUE);
@@ -787,8 +755,10 @@ float getRouteLen(const Route *rt) {
         return(0);
     }
     
-    // Getting the total length of the list of waypoints found in the rt struct
-    float routeLength = lengthOfWaypoints(rt -> waypoints);
+    // Getting the total length of the points of the rt struct
+    PointIterator pointIterator;
+    openRoutePoints(&pointIterator, rt);
+    float routeLength = lengthOfPoints(&pointIterator);
     
     // Returns the total length of the route
     return(routeLength);
@@ -805,16 +775,14 @@ float getTrackLen(const Track *tr) {
     // Variable Declaration
     float trackLength = 0;
 
-    // Traversing the list of segments found in the tr struct
-    void *trackSegmentElement;
-    ListIterator trackSegmentIterator = createIterator(tr -> segments);
-    while((trackSegmentElement = nextElement(&trackSegmentIterator)) != NULL) {
-
-        // Getting the TrackSegment struct for the current trackSegmentElement
-        TrackSegment *trackSegmentStruct = (TrackSegment*)trackSegmentElement;
+    // Traversing the list of segments found in the tr struct, the segments are not joined to each other
+    const TrackSegment *trackSegmentStruct;
+    PointIterator pointIterator;
+    GPX_FOR_EACH_SEGMENT(trackSegmentStruct, tr) {
 
-        // Calculating the length of the list of waypoints found in the trackSegmentStruct
-        trackLength += lengthOfWaypoints(trackSegmentStruct -> waypoints);
+        // Calculating the length of the points of the trackSegmentStruct, which may be compacted
+        openSegmentPoints(&pointIterator, trackSegmentStruct);
+        trackLength += lengthOfPoints(&pointIterator);
     }
 
     // Returns the total length of the track
@@ -850,7 +818,7 @@ float round10(float len) {
     return(roundedLen);
 }
 
-int numRoutesWithLength(const GPXdoc* doc, float len, float delta) {
+int64_t numRoutesWithLength(const GPXdoc* doc, float len, float delta) {
 
     // Error check for a NULL doc or negative len or delta
     if (doc == NULL || len < 0 || delta < 0) {
@@ -859,15 +827,11 @@ int numRoutesWithLength(const GPXdoc* doc, float len, float delta) {
     }
 
     // Variable to keep track of the number of routes that match the inputted length
-    int numRoutes = 0;
+    int64_t numRoutes = 0;
 
     // Traversing through the list of routes in the GPXdoc structure
-    void *routeElement;
-    ListIterator routeIterator = createIterator(doc -> routes);
-    while ((routeElement = nextElement(&routeIterator))!= NULL) {
-
-        // Getting the routeStruct for the current routeElement
-        Route *routeStruct = (Route*)routeElement;
+    const Route *routeStruct;
+    GPX_FOR_EACH_ROUTE(routeStruct, doc) {
 
         // Gets the length of the current routeStruct and computing the difference in the length of the current routeStruct and inputted length
         float routeLength = getRouteLen(routeStruct);
@@ -883,7 +847,7 @@ int numRoutesWithLength(const GPXdoc* doc, float len, float delta) {
     return(numRoutes);
 }
 
-int numTracksWithLength(const GPXdoc* doc, float len, float delta) {
+int64_t numTracksWithLength(const GPXdoc* doc, float len, float delta) {
 
     // Error check for a NULL doc or negative len or delta
     if (doc == NULL || len < 0 || delta < 0) {
@@ -892,15 +856,11 @@ int numTracksWithLength(const GPXdoc* doc, float len, float delta) {
     }
 
     // Variable to keep track of the number of tracks that match the inputted length
-    int numTracks = 0;
+    int64_t numTracks = 0;
 
     // Traversing through the list of tracks in the GPXdoc structure
-    void *trackElement;
-    ListIterator trackIterator = createIterator(doc -> tracks);
-    while ((trackElement = nextElement(&trackIterator)) != NULL) {
-
-        // Getting the track struct for the current trackElement
-        Track *trackStruct = (Track*)trackElement;
+    const Track *trackStruct;
+    GPX_FOR_EACH_TRACK(trackStruct, doc) {
 
         // Gets the length of the current trackStruct and computing the difference in the length of the current trackStruct and inputted length
         float trackLength = getTrackLen(trackStruct);
@@ -929,12 +889,13 @@ bool isLoopRoute(const Route* route, float delta) {
         return(FALSE);
     }
 
-    // Getting the waypoint structures for the first and last waypoints in the list of waypoints
-    Waypoint *firstWaypoint = (Waypoint*)getFromFront(route -> waypoints);
-    Waypoint *lastWaypoint = (Waypoint*)getFromBack(route -> waypoints);
+    // Getting the first and last points of the route
+    GPXPoint firstPoint;
+    GPXPoint lastPoint;
+    getRouteEnds(route, &firstPoint, &lastPoint);
 
     // Calculating the distance between the first and last waypoint in meters
-    float distanceBetween = calculateHaversineFormula(firstWaypoint, lastWaypoint);
+    float distanceBetween = haversineDistance(firstPoint.latitude, firstPoint.longitude, lastPoint.latitude, lastPoint.longitude);
 
     // If the distance between the first and last waypoint is inside of the delta tolerance, they are the same and a closed loop is formed with this route
     if (distanceBetween <= delta) {
@@ -954,16 +915,12 @@ bool isLoopTrack(const Track *tr, float delta) {
     }
 
     // Variable to hold the number of waypoints in the track
-    int numWaypoints = 0;
-
-    // Traversing through the list of segments in the tr struct
-    void *trackSegmentElement;
-    ListIterator trackSegmentIterator = createIterator(tr -> segments);
-    while ((trackSegmentElement = nextElement(&trackSegmentIterator)) != NULL) {
+    int64_t numWaypoints = 0;
 
-        // Counting the number of waypoints in the list of waypoints in the trackSegment
-        TrackSegment *trackSegmentStruct = (TrackSegment*)trackSegmentElement;
-        numWaypoints += getLength(trackSegmentStruct -> waypoints);
+    // Traversing through the list of segments in the tr struct, counting the points of each
+    const TrackSegment *trackSegmentStruct;
+    GPX_FOR_EACH_SEGMENT(trackSegmentStruct, tr) {
+        numWaypoints += getSegmentNumPoints(trackSegmentStruct);
     }
 
     // If the total number of waypoints in the track is less than 4, a loop cannot be formed
@@ -971,16 +928,16 @@ bool isLoopTrack(const Track *tr, float delta) {
         return(FALSE);
     }
 
-    // Getting the first and last track segments in the list of track segments
-    TrackSegment *firstSegment = (TrackSegment*)getFromFront(tr -> segments);
-    TrackSegment *lastSegment = (TrackSegment*)getFromBack(tr -> segments);
-
-    // Getting the first waypoint of the first segment and the last waypoint of the last segment
-    Waypoint *firstWaypoint = (Waypoint*)getFromFront(firstSegment -> waypoints);
-    Waypoint *lastWaypoint = (Waypoint*)getFromBack(lastSegment -> waypoints);
+    // Getting the first point of the first segment and the last point of the last segment
+    // The first or last segment can be empty, then there is no end point to compare
+    GPXPoint firstPoint;
+    GPXPoint lastPoint;
+    if (getTrackEnds(tr, &firstPoint, &lastPoint) == FALSE) {
+        return(FALSE);
+    }
 
     // Calculating the distance between the first and last waypoint in meters
-    float distanceBetween = calculateHaversineFormula(firstWaypoint, lastWaypoint);
+    float distanceBetween = haversineDistance(firstPoint.latitude, firstPoint.longitude, lastPoint.latitude, lastPoint.longitude);
 
     // If the distance between the first and last waypoint is inside of the delta tolerance, they are the same and a closed loop is formed with this route
     if (distanceBetween <= delta) {
@@ -999,53 +956,38 @@ List* getRoutesBetween(const GPXdoc* doc, float sourceLat, float sourceLong, flo
         return(NULL);
     }
 
-    // Creating a waypoint with the source longitude/latitude values
-    Waypoint *sourceWaypoint = malloc(sizeof(Waypoint));
-    sourceWaypoint -> longitude = sourceLong;
-    sourceWaypoint -> latitude = sourceLat;
-
-    // Creating a waypoint with the dest longitude/latitude values
-    Waypoint *destWaypoint = malloc(sizeof(Waypoint));
-    destWaypoint -> longitude = destLong;
-    destWaypoint -> latitude = destLat;
-
-    // Creating a list to hold routes between the specified locations
-    List *routesBetweenList = initializeList(&routeToString, &dummyDelete, &compareRoutes);
+    // Creating a list to hold routes between the specified locations, it is only allocated once a route is found
+    List *routesBetweenList = NULL;
 
-    void *routeElement;
-    ListIterator routeIterator = createIterator(doc -> routes);
-    while ((routeElement = nextElement(&routeIterator)) != NULL) {
+    const Route *routeStruct;
+    GPXPoint firstPoint;
+    GPXPoint lastPoint;
+    GPX_FOR_EACH_ROUTE(routeStruct, doc) {
 
-        // Getting the routeStruct of the current routeElement
-        Route *routeStruct = (Route*)routeElement;
-
-        // Gets the first and last waypoint of the routeStruct
-        Waypoint *firstWaypoint = (Waypoint*)getFromFront(routeStruct -> waypoints);
-        Waypoint *lastWaypoint = (Waypoint*)getFromBack(routeStruct -> waypoints);
+        // Gets the first and last point of the routeStruct, a route without points has no ends to compare
+        if (getRouteEnds(routeStruct, &firstPoint, &lastPoint) == FALSE) {
+            continue;
+        }
 
-        // Calculating the difference between the first waypoint and the source waypoint and the difference between the last waypoint and dest waypoint
-        int sourceDifference = calculateHaversineFormula(firstWaypoint, sourceWaypoint);
-        int destDifference = calculateHaversineFormula(lastWaypoint, destWaypoint);
+        // Calculating the difference between the first point and the source and the difference between the last point and dest
+        int sourceDifference = haversineDistance(firstPoint.latitude, firstPoint.longitude, sourceLat, sourceLong);
+        int destDifference = haversineDistance(lastPoint.latitude, lastPoint.longitude, destLat, destLong);
 
         // If both the sourceDifference and destDifference is less than delta, means the route has the same start and end locations
         if (sourceDifference <= delta && destDifference <= delta) {
-            insertBack(routesBetweenList, routeStruct);
+            if (routesBetweenList == NULL) {
+                routesBetweenList = initializeList(&routeToString, &dummyDelete, &compareRoutes);
+            }
+            insertBack(routesBetweenList, (Route*)routeStruct);
         }
     }
 
-    // If there are no routes between the specified location, frees the list, source/dest waypoints and returns NULL
-    if (getLength(routesBetweenList) == 0) {
+    // If there are no routes between the specified location, returns NULL
+    if (routesBetweenList == NULL) {
         printf("No routes between specified location\n");
-        freeList(routesBetweenList);
-        free(sourceWaypoint);
-        free(destWaypoint);
         return(NULL);
     }
 
-    // Freeing the waypoints created for the source and dest longitude/latitudes
-    free(sourceWaypoint);
-    free(destWaypoint);
-
     // Returns the list of routes between the specified locations
     return(routesBetweenList);
 }
@@ -1058,57 +1000,38 @@ List* getTracksBetween(const GPXdoc* doc, float sourceLat, float sourceLong, flo
         return(NULL);
     }
 
-    // Creating a waypoint with the source longitude/latitude values
-    Waypoint *sourceWaypoint = malloc(sizeof(Waypoint));
-    sourceWaypoint -> longitude = sourceLong;
-    sourceWaypoint -> latitude = sourceLat;
-
-    // Creating a waypoint with the dest longitude/latitude values
-    Waypoint  *destWaypoint = malloc(sizeof(Waypoint));
-    destWaypoint -> longitude = destLong;
-    destWaypoint -> latitude = destLat;
-
-    // Creating a list to hold tracks between the specified locations
-    List *tracksBetweenList = initializeList(&trackToString, &dummyDelete, &compareTracks);
-
-    void *trackElement;
-    ListIterator trackIterator = createIterator(doc -> tracks);
-    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+    // Creating a list to hold tracks between the specified locations, it is only allocated once a track is found
+    List *tracksBetweenList = NULL;
 
-        // Getting the trackStruct for the current trackElement
-        Track *trackStruct = (Track*)trackElement;
+    const Track *trackStruct;
+    GPXPoint firstPoint;
+    GPXPoint lastPoint;
+    GPX_FOR_EACH_TRACK(trackStruct, doc) {
 
-        // Gets the first and last trackSegments of the trackStruct
-        TrackSegment *firstSegment = (TrackSegment*)getFromFront(trackStruct -> segments);
-        TrackSegment *lastSegment = (TrackSegment*)getFromBack(trackStruct -> segments);
-
-        // Gets the first waypoint of the firstSegment and the last waypoint of the lastSegment
-        Waypoint *firstWaypoint = (Waypoint*)getFromFront(firstSegment -> waypoints);
-        Waypoint *lastWaypoint = (Waypoint*)getFromBack(lastSegment -> waypoints);
+        // Gets the first point of the first segment and the last point of the last segment, a track without them has no ends to compare
+        if (getTrackEnds(trackStruct, &firstPoint, &lastPoint) == FALSE) {
+            continue;
+        }
 
-        // Calculating the difference between the first waypoint and the source waypoint and the difference between the last waypoint and dest waypoint
-        int sourceDifference = calculateHaversineFormula(firstWaypoint, sourceWaypoint);
-        int destDifference = calculateHaversineFormula(lastWaypoint, destWaypoint);
+        // Calculating the difference between the first point and the source and the difference between the last point and dest
+        int sourceDifference = haversineDistance(firstPoint.latitude, firstPoint.longitude, sourceLat, sourceLong);
+        int destDifference = haversineDistance(lastPoint.latitude, lastPoint.longitude, destLat, destLong);
 
         // If both the sourceDifference and destDifference is less than delta, means the track has the same start and end locations
         if (sourceDifference <= delta && destDifference <= delta) {
-            insertBack(tracksBetweenList, trackStruct);
+            if (tracksBetweenList == NULL) {
+                tracksBetweenList = initializeList(&trackToString, &dummyDelete, &compareTracks);
+            }
+            insertBack(tracksBetweenList, (Track*)trackStruct);
         }
     }
 
-    // If there are no tracks between the specified locations, frees the list, source/dest waypoints and returns NULL
-    if (getLength(tracksBetweenList) == 0) {
+    // If there are no tracks between the specified locations, returns NULL
+    if (tracksBetweenList == NULL) {
         printf("No tracks between specified location\n");
-        freeList(tracksBetweenList);
-        free(sourceWaypoint);
-        free(destWaypoint);
         return(NULL);
     }
 
-    // Freeing the waypoints created for the source and dest longitude/latitudes
-    free(sourceWaypoint);
-    free(destWaypoint);
-
     // Returns the list of tracks between the specified locations
     return(tracksBetweenList);
 }
@@ -1141,12 +1064,17 @@ char* routeToJSON(const Route *rt) {
         loop = "false";
     }
 
-    // Allocating memory for the JSONString and entering values of the route into the string with the proper JSON format
-    char *JSONString = malloc(41 + strlen(name) + 1 + 16 + 16 + strlen(loop) + 1);
-    sprintf(JSONString, "{\"name\":\"%s\",\"numPoints\":%d,\"len\":%.1f,\"loop\":%s}", name, getLength(rt -> waypoints), round10(getRouteLen(rt)), loop);
+    // Entering values of the route into the string with the proper JSON format, the name is escaped as it can hold any character
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "{\"name\":");
+    appendJSONStringToStringBuffer(&JSONString, name);
+    char length[GPX_NUMBER_STRING_LENGTH];
+    formatFixedDouble(round10(getRouteLen(rt)), 1, length);
+    appendFormatToStringBuffer(&JSONString, ",\"numPoints\":%lld,\"len\":%s,\"loop\":%s}", (long long)getLength(rt -> waypoints), length, loop);
 
     // Returns an allocated string of the route in JSON format
-    return(JSONString);
+    return(JSONString.string);
 }
 
 char* trackToJSON(const Track *tr) {
@@ -1178,21 +1106,26 @@ char* trackToJSON(const Track *tr) {
     }
 
     // Getting the number of waypoints in the track
-    int numPoints = 0;
+    int64_t numPoints = 0;
     void *segmentElement;
     ListIterator segmentIterator = createIterator(tr -> segments);
     while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
         TrackSegment *segmentStruct = (TrackSegment*)segmentElement;
 
-        numPoints += getLength(segmentStruct -> waypoints);
+        numPoints += getSegmentNumPoints(segmentStruct);
     }
 
-    // Allocating memory for the JSONString and entering values of the track into the string with the proper JSON format
-    char *JSONString = malloc(27 + strlen(name) + 1 + 16 + strlen(loop) + 1 + 100);
-    sprintf(JSONString, "{\"name\":\"%s\",\"numPoints\":%d,\"len\":%.1f,\"loop\":%s}", name, numPoints,round10(getTrackLen(tr)), loop);
+    // Entering values of the track into the string with the proper JSON format, the name is escaped as it can hold any character
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "{\"name\":");
+    appendJSONStringToStringBuffer(&JSONString, name);
+    char length[GPX_NUMBER_STRING_LENGTH];
+    formatFixedDouble(round10(getTrackLen(tr)), 1, length);
+    appendFormatToStringBuffer(&JSONString, ",\"numPoints\":%lld,\"len\":%s,\"loop\":%s}", (long long)numPoints, length, loop);
 
     // Returns an allocated string of the track in JSON format
-    return(JSONString);
+    return(JSONString.string);
 }
 
 char* routeListToJSON(const List *list) {
@@ -1205,42 +1138,21 @@ char* routeListToJSON(const List *list) {
         return(JSONString);
     }
 
-    // Allocating the JSONString to initially 2 bytes, 1 for the '[', character 1 for the NULL terminating character
-    char *JSONString = malloc(2);
-    strcpy(JSONString, "[");
-
-    // Traversing through the list of routes
-    void *routeElement;
-    ListIterator routeIterator = createIterator((List*)list);
-    while ((routeElement = nextElement(&routeIterator)) != NULL) {
-
-        // Getting the routeStruct for the current routeElement
-        Route *routeStruct = (Route*)routeElement;
-
-        // Getting the string for the above route in JSON format
-        char *routeString = routeToJSON(routeStruct);
-
-        // Reallocating enough memory for the current JSONString as well as enough memory for the new route string in JSON format
-        JSONString = realloc(JSONString, strlen(JSONString) + 1 + strlen(routeString) + 1 + 2);
-
-        // Adding the new routeString onto the list of routes in JSON string format
-        strcat(JSONString, routeString);
-        strcat(JSONString, ",");
-
-        // Freeing the string for current route
-        free(routeString);
-    }
-
-    // Replaces the last comma that would be present due to the above loop with the ending ']' character for a JSON object
-    JSONString[strlen(JSONString)-1] = ']';
+    // Writing the list of routes in JSON format into a string, one route at a time
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    JSONWriter writer;
+    initJSONWriter(&writer, &stringBufferSink, &JSONString);
+    writeRouteListJSON(&writer, list);
+    flushJSONWriter(&writer);
 
     // Returns an allocated string of the list of routes in JSON format
-    return(JSONString);
+    return(JSONString.string);
 }
 
 char* trackListToJSON(const List *list) {
 
-    // Error check for NULL or empty list
+    // Error check for a NULL or empty list
     if (list == NULL || getLength((List*)list) == 0) {
         fprintf(stderr, "ERROR: Empty or NULL Track list\n");
         char *JSONString = malloc(3);
@@ -1248,37 +1160,16 @@ char* trackListToJSON(const List *list) {
         return(JSONString);
     }
 
-    // Allocating the JSONString to initially 2 bytes, 1 for the '[' character, 1 for the NULL terminating character
-    char *JSONString = malloc(2);
-    strcpy(JSONString, "[");
-
-    // Traversing through the list of tracks
-    void *trackElement;
-    ListIterator trackIterator = createIterator((List*)list);
-    while ((trackElement = nextElement(&trackIterator)) != NULL) {
-
-        // Getting the trackStruct for the current trackElement
-        Track *trackStruct = (Track*)trackElement;
-
-        // Getting the string for the above track in JSON format
-        char *trackString = trackToJSON(trackStruct);
-
-        // Reallocating enough memory for the current JSONString as well as enough memory for the new track string in JSON format
-        JSONString = realloc(JSONString, strlen(JSONString) + 1 + strlen(trackString) + 1 + 2);
-
-        // Adding the new trackString onto the list of tracks in JSON string format
-        strcat(JSONString, trackString);
-        strcat(JSONString, ",");
-        
-        // Freeing the string for the current track
-        free(trackString);
-    }
-
-    // Replaces the last comma that would be present due to the above loop with the ending ']' character for a JSON object
-    JSONString[strlen(JSONString)-1] = ']';
+    // Writing the list of tracks in JSON format into a string, one track at a time
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    JSONWriter writer;
+    initJSONWriter(&writer, &stringBufferSink, &JSONString);
+    writeTrackListJSON(&writer, list);
+    flushJSONWriter(&writer);
 
     // Returns an allocated string of the list of tracks in JSON format
-    return(JSONString);
+    return(JSONString.string);
 }
 
 char* GPXtoJSON(const GPXdoc* gpx) {
@@ -1291,12 +1182,17 @@ char* GPXtoJSON(const GPXdoc* gpx) {
         return(JSONString);
     }
 
-    // Allocating memory for the JSONString and entering values of the GPXdoc into the string with the proper JSON format
-    char *JSONString = malloc(110 + 16 + strlen(gpx -> creator) + 1 + 32);
-    sprintf(JSONString, "{\"version\":%.1f,\"creator\":\"%s\",\"numWaypoints\":%d,\"numRoutes\":%d,\"numTracks\":%d}", gpx -> version, gpx -> creator, getLength(gpx -> waypoints), getLength(gpx -> routes), getLength(gpx -> tracks));
+    // Entering values of the GPXdoc into the string with the proper JSON format, with the creator escaped
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "{\"version\":");
+    appendFixedToStringBuffer(&JSONString, gpx -> version, 1);
+    appendToStringBuffer(&JSONString, ",\"creator\":");
+    appendJSONStringToStringBuffer(&JSONString, gpx -> creator);
+    appendFormatToStringBuffer(&JSONString, ",\"numWaypoints\":%lld,\"numRoutes\":%lld,\"numTracks\":%lld}", (long long)getLength(gpx -> waypoints), (long long)getLength(gpx -> routes), (long long)getLength(gpx -> tracks));
 
     // Returns an allocated string of the GPXdoc in JSON format
-    return(JSONString);
+    return(JSONString.string);
 }
 
 void addWaypoint(Route *rt, Waypoint *pt) {
@@ -1323,175 +1219,6 @@ void addRoute(GPXdoc* doc, Route* rt) {
     insertBack(doc -> routes, rt);
 }
 
-GPXdoc* JSONtoGPX(const char* gpxString) {
-
-    // Error check gpxString for NULL
-    if (gpxString == NULL) {
-        fprintf(stderr, "ERORR: gpxString is NULL\n");
-        return(NULL);
-    }
-
-    // Variables to be used to parse the gpxString for values required for the GPXdoc structure   
-    int i = 0;
-    int endingIndex = 0;
-
-    // Cutting off any characters before first occurrence of the ':' character and moving up one character to remove the ':' character from the string
-    char *firstOccurrence = strchr(gpxString, ':');
-    firstOccurrence = firstOccurrence + 1;
-
-    // Traversing through the firstOccurrence string and finding the index of the first comma which will denote the end of the version value
-    for (i = 0; i < strlen(firstOccurrence); i++) {
-        if (firstOccurrence[i] == ',') {
-            endingIndex = i;
-        }
-    }
-
-    // Storing the firstOccurence string in versionString up to the comma exclusively 
-    char versionString[1024] = "";
-    strncpy(versionString, firstOccurrence, endingIndex);
-
-    // Getting the version value as a double by using the atof function on versionString
-    double version = atof(versionString);
-
-    // Cutting off any characters before the second occurrence of the ':' character and moving up one character to remove the ':' and '"' character from the string
-    char *secondOccurrence = strrchr(gpxString, ':');
-    secondOccurrence = secondOccurrence + 2;
-
-    // Traversing through the secondOccurrence string and finding the index of the first '"' which will denote the end of the creator value
-    for (i = 0; i < strlen(secondOccurrence); i++) {
-        if (secondOccurrence[i] == '"') {
-            endingIndex = i;
-        }
-    }
-
-    // Storing the secondOccurrence string in creator up to the '"'
-    char creator[1024] = "";
-    strncpy(creator, secondOccurrence, endingIndex);
-    
-    // Declaring a GPXdoc structure and allocating size of GPXdoc structure bytes of memory
-    GPXdoc *docStruct = malloc(sizeof(GPXdoc));
-
-    // Initializing the namespace and version
-    strcpy(docStruct -> namespace, "http://www.topografix.com/GPX/1/1");
-    docStruct -> version = version;
-
-    // Allocating memory to the creator and setting its value to the creator value in the JSON string
-    docStruct -> creator = malloc(strlen(creator) + 1);
-    strcpy(docStruct -> creator, creator);
-
-    // Initializing the lists in the docStruct
-    docStruct -> waypoints = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
-    docStruct -> routes = initializeList(&routeToString, &deleteRoute, &compareRoutes);
-    docStruct -> tracks = initializeList(&trackToString, &deleteTrack, &compareTracks);
-
-    // Returns the docStruct filled with contents from the JSON string
-    return(docStruct);
-}
-
-Waypoint* JSONtoWaypoint(const char* gpxString) {
-
-    // Error check gpxString for NULL
-    if (gpxString == NULL) {
-        fprintf(stderr, "ERROR: gpxString is NULL\n");
-        return(NULL);
-    }
-
-    // Variables to be used to parse the gpxString for values required for the GPXdoc structure   
-    int i = 0;
-    int endingIndex = 0;
-
-    // Cutting off any characters before first occurrence of the ':' character and moving up one character to remove the '"' character from the string
-    char *firstOccurrence = strchr(gpxString, ':');
-    firstOccurrence = firstOccurrence + 2;
-
-    // Traversing through the firstOccurrence string and finding the index of the first comma which will denote the end of the latitude value
-    for (i = 0; i < strlen(firstOccurrence); i++) {
-        if (firstOccurrence[i] == ',') {
-            endingIndex = i - 1;
-        }
-    }
-
-    // Storing the firstOccurrence string up to the comma and storing the float value in latitude with the atof funciton
-    char latitudeString[1024] = "";
-    strncpy(latitudeString, firstOccurrence, endingIndex);
-    double latitude = atof(latitudeString);
-
-    // Cutting off any characters before the second occurrence of ':' and moving up one character to remove the '"' character
-    char *secondOccurrence = strrchr(gpxString, ':');
-    secondOccurrence = secondOccurrence + 2;
-
-    // Traversing through the secondOccurrence string and finding the index of the '}' character which will denote the end of the longitude value
-    for (i = 0; i < strlen(secondOccurrence); i++) {
-        if (secondOccurrence[i] == '}') {
-            endingIndex = i - 1;
-        }
-    }
-
-    // Storing the secondOccurrence string up to the '}' character and storing the float value in longitude with the atof function
-    char longitudeString[1024] = "";
-    strncpy(longitudeString, secondOccurrence, endingIndex);
-    double longitude = atof(longitudeString);
-
-    // Declaring a Waypoint structure and allocating size of Waypoint structure bytes of memory to it
-    Waypoint *waypointStruct = malloc(sizeof(Waypoint));
-
-    // Initializing a list of otherData in the waypointStruct
-    waypointStruct -> otherData  = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
-
-    // Allocating memory to the name member in the waypointStruct and setting its value to an empty string
-    waypointStruct -> name = malloc(1);
-    strcpy(waypointStruct -> name, "");
-
-    // Initializing the longitude and latitude values of the waypointStruct to the values found in the JSON string
-    waypointStruct -> longitude = longitude;
-    waypointStruct -> latitude = latitude;
-
-    // Returns the waypointStruct filled with contents from the JSON string
-    return(waypointStruct);
-}
-
-Route* JSONtoRoute(const char* gpxString) {
-
-    // Error check gpxString for NULL
-    if (gpxString == NULL) {
-        fprintf(stderr, "ERROR: gpxString is NULL\n");
-        return(NULL);
-    }
-
-    // Variables to be used to parse the gpxString for values required for the GPXdoc structure   
-    int i = 0;
-    int endingIndex = 0;
-
-    // Cutting off any characters before first occurrence of the ':' character and moving up two characters to remove the ':' and '"' characters from the string
-    char *firstOccurrence = strchr(gpxString, ':');
-    firstOccurrence = firstOccurrence + 2;
-
-    // Traversing through the firstOccurrence string and finding the index of the first comma which will denote the end of the latitude value
-    for (i = 0; i < strlen(firstOccurrence); i++) {
-        if (firstOccurrence[i] == '"') {
-            endingIndex = i;
-        }
-    }
-
-    // Storing the firstOccurrence string up to the '"' character
-    char name[1024] = "";
-    strncpy(name, firstOccurrence, endingIndex);
-
-    // Declaring a Route structure and allocating size of Route structure bytes of memory
-    Route *routeStruct = malloc(sizeof(Route));
-
-    // Allocating memory to the name member and settings its value found in the JSON string
-    routeStruct -> name = malloc(strlen(name) + 1);
-    strcpy(routeStruct -> name, name);
-
-    // Initializing a list of waypoints and otherData for the members found in the Route structure
-    routeStruct -> waypoints = initializeList(&waypointToString, &deleteWaypoint, &compareWaypoints);
-    routeStruct -> otherData = initializeList(&gpxDataToString, &deleteGpxData, &compareGpxData);
-
-    // Returns the routeStruct filled with contents from the JSON string
-    return(routeStruct);
-}
-
 // Function to take in a GPX file name and return the GPX node as a JSON string
 char *GPXFiletoJSON(char *fileName);
 char *GPXFiletoJSON(char *fileName) {
@@ -1592,12 +1319,36 @@ char *GPXDataToJSON(const GPXData *data) {
         return(JSONString);
     }
 
-    // Allocating memory to the string +1 NULL terminator, enough memory for the JSON characters and, enough memory for the name and value and storing the values in the string
-    char *JSONString = malloc(30 + strlen(data -> name) + strlen(data -> value));
-    sprintf(JSONString, "{\"%s\":\"%s\"}", data -> name, data -> value);
+    // Storing the name and value in the string, both escaped as values such as descriptions often span several lines
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "{");
+    appendJSONStringToStringBuffer(&JSONString, data -> name);
+    appendToStringBuffer(&JSONString, ":");
+    appendJSONStringToStringBuffer(&JSONString, data -> value);
+    appendToStringBuffer(&JSONString, "}");
 
     // Returns an allocated string of the GPXdata in JSON fromat
-    return(JSONString);
+    return(JSONString.string);
+}
+
+// Function that adds a list of GPXData in JSON format to the end of a string buffer
+void appendGPXDataListToBuffer(StringBuffer *buffer, const List *list);
+void appendGPXDataListToBuffer(StringBuffer *buffer, const List *list) {
+    appendToStringBuffer(buffer, "[");
+
+    // Traversing through the list of other data, adding each GPXData with a comma before all but the first
+    bool first = TRUE;
+    void *dataElement;
+    ListIterator dataIterator = createIterator((List*)list);
+    while ((dataElement = nextElement(&dataIterator)) != NULL) {
+        char *dataString = GPXDataToJSON((GPXData*)dataElement);
+        appendToStringBuffer(buffer, first ? "" : ",");
+        appendToStringBuffer(buffer, dataString);
+        free(dataString);
+        first = FALSE;
+    }
+    appendToStringBuffer(buffer, "]");
 }
 
 // Function to take in a GPX file name, returning an an array of GPXdata
@@ -1612,37 +1363,11 @@ char *GPXDataListToJSON(const List *list) {
         return(JSONString);
     }
 
-    // Allocating the JSONString to initially 2 bytes, 1 for the '[', character 1 for the NULL terminator
-    char *JSONString = malloc(2);
-    strcpy(JSONString, "[");
-
-    // Traversing through the list of other data
-    void *dataElement;
-    ListIterator dataIterator = createIterator((List*)list);
-    while ((dataElement = nextElement(&dataIterator)) != NULL) {
-
-        // Getting the GPXData for the current dataElement
-        GPXData *dataStruct = (GPXData*)dataElement;
-
-        // Getting the string for the above GPXData in JSON format
-        char *dataString = GPXDataToJSON(dataStruct);
-
-        // Reallocating enough memory for the current JSONString as well as enough memory for the new data stirng in JSON format
-        JSONString = realloc(JSONString, strlen(JSONString) + 1 + strlen(dataString) + 1 + 2);
-
-        // Adding the new dataString onto the list of GPXData in JSON string format
-        strcat(JSONString, dataString);
-        strcat(JSONString, ",");
-
-        // Freeing the string for current data
-        free(dataString);
-    }
-
-    // Replaces the last comma that would be present due to the above loop with the ending ']' character for a JSON object
-    JSONString[strlen(JSONString)-1] = ']';
-
     // Returns an allocated string of the list of GPXData in JSON format
-    return(JSONString);
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendGPXDataListToBuffer(&JSONString, list);
+    return(JSONString.string);
 }
 
 // Function to take in a GPX file name, returning an array of an array of JSONStrings holding GPXData for each route
@@ -1651,12 +1376,13 @@ char *GPXFiletoRouteGPXDataListJSON(char *fileName) {
     // Creates a GPXdoc structure and validates against the gpx.xsd file
     GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
 
-    // Creating a JSONString for an array of list of GPXData in each route and allocating 2 bytes for NULL terminator and '[' character
-    char *JSONString = malloc(2);
-    strcpy(JSONString, "[");
+    // Building the array of lists of GPXData in each route in the thread's scratch buffer
+    StringBuffer *JSONString = getScratchBuffer();
+    appendToStringBuffer(JSONString, "[");
 
     // Validates the file against the GPXParser.h and gpx.xsd schema file
     // If the validation is TRUE, means that the file is valid and gets the JSONString for the other data in each route
+    // Else file is invalid and returns an empty array
     if (validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == TRUE) {
         
         // Traversing through the list of routes
@@ -1664,33 +1390,14 @@ char *GPXFiletoRouteGPXDataListJSON(char *fileName) {
         ListIterator routeIterator = createIterator((List*)GPXDocStruct -> routes);
         while ((routeElement = nextElement(&routeIterator)) != NULL) {
 
-            // Getting the routeStruct for the current routeElement
-            Route *routeStruct = (Route*)routeElement;
-
-            // Getting the data string for the route in JSON format
-            char *dataString = GPXDataListToJSON(routeStruct -> otherData);
-
-            // Reallocating enough memory for the current JSONString as well as enough memory for the new GPXData string in JSON format
-            JSONString = realloc(JSONString, strlen(JSONString) + 1 + strlen(dataString) + 1 + 2);
-
-            // Adding the new dataString onto the array of dataStrings in JSON string format
-            strcat(JSONString, dataString);
-            strcat(JSONString, ",");
-
-            // Freeing the string for the current data
-            free(dataString);
+            // Adding the data of the current route in JSON format to the array
+            appendToStringBuffer(JSONString, (JSONString -> length == 1) ? "" : ",");
+            appendGPXDataListToBuffer(JSONString, ((Route*)routeElement) -> otherData);
         }
-
-        // Replaces the last comma with the ending ']' for the JSON format
-        JSONString[strlen(JSONString)-1] = ']';
-    }
-    // Else file is invalid and returns an empty array
-    else {
-        JSONString = malloc(3);
-        strcpy(JSONString, "[]");
     }
+    appendToStringBuffer(JSONString, "]");
     deleteGPXdoc(GPXDocStruct);
-    return(JSONString);
+    return(scratchBufferToString(JSONString));
 }
 
 // Function to take in a GPX file name, returning an array of an array of JSONStrings holding GPXData for each track
@@ -1699,12 +1406,13 @@ char *GPXFiletoTrackGPXDataListJSON(char *fileName) {
     // Creates a GPXdoc structure and validates against the gpx.xsd file
     GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
 
-    // Creating a JSONString for an array of list of GPXData in each track and allocating 2 bytes for NULL terminator and "[" character
-    char *JSONString = malloc(2);
-    strcpy(JSONString, "[");
+    // Building the array of lists of GPXData in each track in the thread's scratch buffer
+    StringBuffer *JSONString = getScratchBuffer();
+    appendToStringBuffer(JSONString, "[");
 
     // Validates the file against the GPXParser.h and gpx.xsd schema file
     // If the validation is TRUE, means that the file is valid and gets the JSONString for the other data in each track
+    // Else file is invalid and returns an empty array
     if (validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == TRUE) {
 
         // Traversing through the list of tracks
@@ -1712,33 +1420,14 @@ char *GPXFiletoTrackGPXDataListJSON(char *fileName) {
         ListIterator trackIterator = createIterator((List*)GPXDocStruct -> tracks);
         while ((trackElement = nextElement(&trackIterator)) != NULL) {
 
-            // Getting the trackStruct for the current trackElement
-            Track *trackStruct = (Track*)trackElement;
-
-            // Getting the data stirng for the track in JSON format
-            char *dataString = GPXDataListToJSON(trackStruct -> otherData);
-
-            // Reallocating enough memory for the current JSONString as well as enough memory for the new GPXData string in JSON format
-            JSONString = realloc(JSONString, strlen(JSONString) + 1 + strlen(dataString) + 1 + 2);
-
-            // Adding the new dataString onto the array of dataStrings in JSON string format
-            strcat(JSONString, dataString);
-            strcat(JSONString, ",");
-
-            // Freeing the string for the current data
-            free(dataString);
+            // Adding the data of the current track in JSON format to the array
+            appendToStringBuffer(JSONString, (JSONString -> length == 1) ? "" : ",");
+            appendGPXDataListToBuffer(JSONString, ((Track*)trackElement) -> otherData);
         }
-
-        // Replaces the last comma with the ending ']' for the JSON format
-        JSONString[strlen(JSONString)-1] = ']';
-    }
-    // Else file is invalid and returns an empty array
-    else {
-        JSONString = malloc(3);
-        strcpy(JSONString, "[]");
     }
+    appendToStringBuffer(JSONString, "]");
     deleteGPXdoc(GPXDocStruct);
-    return(JSONString);
+    return(scratchBufferToString(JSONString));
 }
 
 // Function to take in a GPX file name, new name, component type and number, will go into the GPX file changing the name of the component specified by the user
@@ -1921,13 +1610,52 @@ int addWaypointToRoute(char *fileName, char *waypointJSON) {
     return(1);
 }
 
+// Adds every route of a JSON array of routes, each with its points, to the end of the specified file with a single load and write
+// Returns 1 for success, and 0 if the JSON could not be read, or the file was invalid before or after adding the routes
+int addRoutesToFile(char *fileName, char *routesJSON);
+int addRoutesToFile(char *fileName, char *routesJSON) {
+    // Reading all the routes first, so nothing is loaded if the JSON is unusable
+    List *routes = JSONtoRouteList(routesJSON);
+    if (routes == NULL) {
+        return(0);
+    }
+
+    // Creates a GPXdoc structure and validates against the gpx.xsd file
+    GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
+    if (GPXDocStruct == NULL) {
+        fprintf(stderr, "Invalid GPXdoc\n");
+        freeList(routes);
+        return(0);
+    }
+
+    // Moving the routes into the GPXdoc, which owns them from then on, and freeing the list that held them
+    void *routeElement;
+    ListIterator routeIterator = createIterator(routes);
+    while ((routeElement = nextElement(&routeIterator)) != NULL) {
+        addRoute(GPXDocStruct, (Route*)routeElement);
+    }
+    routes -> deleteData = &dummyDelete;
+    freeList(routes);
+
+    // Validates the GPXdoc with the new routes against the GPXParser.h and gpx.xsd schema file, then writes it back to the file
+    int returnValue = 0;
+    if (validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == TRUE && writeGPXdoc(GPXDocStruct, fileName) == TRUE) {
+        returnValue = 1;
+    }
+    else {
+        fprintf(stderr, "Adding routes to the file failed\n");
+    }
+    deleteGPXdoc(GPXDocStruct);
+    return(returnValue);
+}
+
 // Function that returns a list of JSON strings containing the routes between for that particular file
 char *routeListOfRoutesBetween(char *fileName, float sourceLat, float sourceLong, float destLat, float destLong, float delta);
 char *routeListOfRoutesBetween(char *fileName, float sourceLat, float sourceLong, float destLat, float destLong, float delta) {
     // Creates a GPXdoc structure and validates against the gpx.xsd file
     GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
 
-    char *routesBetweenString = "";
+    char *routesBetweenString = NULL;
 
     // Validates the file against GPXParser.h and gpx.xsd schema file
     // If the validation is TRUE, means that the file is valid and gets the list of routes that are between the user inputs
@@ -1936,12 +1664,17 @@ char *routeListOfRoutesBetween(char *fileName, float sourceLat, float sourceLong
         // Gets the list of routes between the points and stores it as a JSON string
         List *routesBetween = getRoutesBetween(GPXDocStruct, sourceLat, sourceLong, destLat, destLong, delta);
         routesBetweenString = routeListToJSON(routesBetween);
+
+        // Frees the list, the routes in it still belong to the GPXdoc
+        if (routesBetween != NULL) {
+            freeList(routesBetween);
+        }
     }
-    // Else file is invalid and returns an empty object
+    // Else file is invalid and returns an empty array, allocated like every other result so the caller can always free it
     else {
         fprintf(stderr, "Invalid GPXdoc\n");
-        deleteGPXdoc(GPXDocStruct);
-        return(routesBetweenString);
+        routesBetweenString = malloc(3);
+        strcpy(routesBetweenString, "[]");
     }
     // If everything is successful, deletes the GPXdoc and returns the JSON string containing the routes between
     deleteGPXdoc(GPXDocStruct);
@@ -1954,7 +1687,7 @@ char *trackListOfRoutesBetween(char *fileName, float sourceLat, float sourceLong
     // Creates a GPXdoc structure and validates against the gpx.xsd file
     GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
 
-    char *tracksBetweenString = "";
+    char *tracksBetweenString = NULL;
 
     // Validates the file against GPXParser.h and gpx.xsd schema file
     // If the validation is TRUE, means that the file is valid and gets the list of tracks that are between the user inputs
@@ -1962,60 +1695,435 @@ char *trackListOfRoutesBetween(char *fileName, float sourceLat, float sourceLong
 
         // Gets the list of tracks between the points and stores it as a JSON string
         List *tracksBetween = getTracksBetween(GPXDocStruct, sourceLat, sourceLong, destLat, destLong, delta);
-        tracksBetweenString = routeListToJSON(tracksBetween);
+        tracksBetweenString = trackListToJSON(tracksBetween);
+
+        // Frees the list, the tracks in it still belong to the GPXdoc
+        if (tracksBetween != NULL) {
+            freeList(tracksBetween);
+        }
     }
-    // Else file is invalid and returns an empty object
+    // Else file is invalid and returns an empty array, allocated like every other result so the caller can always free it
     else {
         fprintf(stderr, "Invalid GPXdoc\n");
-        deleteGPXdoc(GPXDocStruct);
-        return(tracksBetweenString);
+        tracksBetweenString = malloc(3);
+        strcpy(tracksBetweenString, "[]");
     }
     // If everything is successful, deletes the GPXdoc and returns the JSON string containing the tracks between
     deleteGPXdoc(GPXDocStruct);
     return(tracksBetweenString);
 }
 
-int numberOfRoutesWithLengthFromFile(char *fileName, float len, float delta) {
+// Function that returns a list of JSON strings containing the routes passing near the source, and through the dest afterwards when throughDest is 1
+char *routeListOfRoutesAlong(char *fileName, float sourceLat, float sourceLong, float destLat, float destLong, float distance, int throughDest);
+char *routeListOfRoutesAlong(char *fileName, float sourceLat, float sourceLong, float destLat, float destLong, float distance, int throughDest) {
     // Creates a GPXdoc structure and validates against the gpx.xsd file
     GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
-    int numRoutes = 0;
 
-    // Validates the file against the GPXParser.h and gpx.xsd schema file
-    // If the validation is TRUE, means that the file is valid and gets the number of routes with the length inputted
+    char *routesAlongString = NULL;
+
+    // Validates the file against GPXParser.h and gpx.xsd schema file
+    // If the validation is TRUE, means that the file is valid and gets the list of routes whose path passes the user inputs
     if (validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == TRUE) {
-        numRoutes += numRoutesWithLength(GPXDocStruct, len, delta);
+        List *routesAlong = NULL;
+        if (throughDest == 1) {
+            routesAlong = getRoutesThrough(GPXDocStruct, sourceLat, sourceLong, destLat, destLong, distance);
+        }
+        else {
+            routesAlong = getRoutesNear(GPXDocStruct, sourceLat, sourceLong, distance);
+        }
+
+        // Converts the list to a JSON string then frees the list, the routes in it still belong to the GPXdoc
+        routesAlongString = routeListToJSON(routesAlong);
+        freeList(routesAlong);
     }
-    // Else file is invalid and returns 0 for invalid
+    // Else file is invalid and returns an empty array
     else {
-        fprintf(stderr, "ERROR: Invalid GPXdoc");
-        deleteGPXdoc(GPXDocStruct);
-        return(0);
+        fprintf(stderr, "Invalid GPXdoc\n");
+        routesAlongString = malloc(3);
+        strcpy(routesAlongString, "[]");
     }
-
-    // Returns the number of routes and deletes the GPXdoc
     deleteGPXdoc(GPXDocStruct);
-    return(numRoutes);
+    return(routesAlongString);
 }
 
-int numberOfTracksWithLengthFromFile(char *fileName, float len, float delta) {
+// Function that returns a list of JSON strings containing the tracks passing near the source, and through the dest afterwards when throughDest is 1
+char *trackListOfTracksAlong(char *fileName, float sourceLat, float sourceLong, float destLat, float destLong, float distance, int throughDest);
+char *trackListOfTracksAlong(char *fileName, float sourceLat, float sourceLong, float destLat, float destLong, float distance, int throughDest) {
     // Creates a GPXdoc structure and validates against the gpx.xsd file
     GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
-    int numTracks = 0;
 
-    // Validates the file against the GPXParser.h and gpx.xsd schema file
-    // If the validation is TRUE, means that the file is valid and gets the number of tracks with the length inputted
+    char *tracksAlongString = NULL;
+
+    // Validates the file against GPXParser.h and gpx.xsd schema file
+    // If the validation is TRUE, means that the file is valid and gets the list of tracks whose path passes the user inputs
     if (validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == TRUE) {
-        numTracks += numTracksWithLength(GPXDocStruct, len, delta);
+        List *tracksAlong = NULL;
+        if (throughDest == 1) {
+            tracksAlong = getTracksThrough(GPXDocStruct, sourceLat, sourceLong, destLat, destLong, distance);
+        }
+        else {
+            tracksAlong = getTracksNear(GPXDocStruct, sourceLat, sourceLong, distance);
+        }
+
+        // Converts the list to a JSON string then frees the list, the tracks in it still belong to the GPXdoc
+        tracksAlongString = trackListToJSON(tracksAlong);
+        freeList(tracksAlong);
     }
-    // Else file is invalid and returns 0 for invalid
+    // Else file is invalid and returns an empty array
     else {
+        fprintf(stderr, "Invalid GPXdoc\n");
+        tracksAlongString = malloc(3);
+        strcpy(tracksAlongString, "[]");
+    }
+    deleteGPXdoc(GPXDocStruct);
+    return(tracksAlongString);
+}
+
+// Function that returns the JSON array of motion statistics for every track in the file, negative settings use the defaults
+char *trackStatsOfFile(char *fileName, float stopSpeed, float hysteresis);
+char *trackStatsOfFile(char *fileName, float stopSpeed, float hysteresis) {
+    // Creates a GPXdoc structure and validates against the gpx.xsd file
+    GPXdoc *GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
+
+    // If the file is invalid, returns an empty array
+    if (validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == FALSE) {
         fprintf(stderr, "ERROR: Invalid GPXdoc");
         deleteGPXdoc(GPXDocStruct);
-        return(0);
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Building the array in the thread's scratch buffer
+    StringBuffer *JSONString = getScratchBuffer();
+    appendToStringBuffer(JSONString, "[");
+
+    // Adding the statistics of each track to the array
+    void *trackElement;
+    ListIterator trackIterator = createIterator(GPXDocStruct -> tracks);
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+        char *statsString = trackStatsToJSON((Track*)trackElement, (stopSpeed < 0) ? DEFAULT_STOP_SPEED : stopSpeed, (hysteresis < 0) ? DEFAULT_ELEVATION_HYSTERESIS : hysteresis);
+        appendToStringBuffer(JSONString, (JSONString -> length == 1) ? "" : ",");
+        appendToStringBuffer(JSONString, statsString);
+        free(statsString);
     }
+    appendToStringBuffer(JSONString, "]");
 
-    // Returns the number of tracks and deletes the GPXdoc
     deleteGPXdoc(GPXDocStruct);
-    return(numTracks);
+    return(scratchBufferToString(JSONString));
+}
+
+// Function that loads every file in the directory once and returns the attributes, routes and tracks of each valid file and the names of the failed files
+char *summaryOfDirectory(char *directory);
+char *summaryOfDirectory(char *directory) {
+    // Creates a corpus of all the valid GPX files in the directory
+    GPXCorpus *corpus = createGPXCorpus(directory, "parser/src/gpx.xsd");
+
+    // Gets the summary of the files and frees the corpus, a directory that could not be read is summarized as empty
+    char *JSONString = corpusSummaryToJSON(corpus);
+    deleteGPXCorpus(corpus);
+    return(JSONString);
+}
+
+// Function that returns the summary of one file of the directory, or an empty object if the file is invalid
+char *summaryOfFile(char *directory, char *fileName);
+char *summaryOfFile(char *directory, char *fileName) {
+    // Parses the schema, the file is only scanned with it, the listing needs no GPXdoc
+    xmlSchemaPtr schema = parseSchemaFile("parser/src/gpx.xsd");
+    if (schema == NULL) {
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "{}");
+        return(JSONString);
+    }
+
+    // Gets the summary of the file, or an empty object if the file is invalid
+    char *filePath = malloc(strlen(directory) + 1 + strlen(fileName) + 1);
+    sprintf(filePath, "%s/%s", directory, fileName);
+    char *JSONString = scanSummaryToJSON(filePath, fileName, schema);
+    xmlSchemaFree(schema);
+    free(filePath);
+    return(JSONString);
+}
+
+// Function that writes the summary of summaryOfDirectory to an open file descriptor as it is produced, instead of returning it as one string
+// Returns 1 for success, and 0 if the summary could not be written
+int writeSummaryOfDirectory(char *directory, int fileDescriptor);
+int writeSummaryOfDirectory(char *directory, int fileDescriptor) {
+    // Creates a corpus of all the valid GPX files in the directory and writes its summary one chunk at a time
+    GPXCorpus *corpus = createGPXCorpus(directory, "parser/src/gpx.xsd");
+    JSONWriter writer;
+    initJSONFileWriter(&writer, fileDescriptor);
+    bool written = writeCorpusSummary(&writer, corpus);
+    deleteGPXCorpus(corpus);
+    return(written ? 1 : 0);
+}
+
+// Function that writes the waypoints, routes and tracks of a file as GeoJSON to a writer, an invalid file is an empty FeatureCollection
+bool writeGeometryOfFile(char *fileName, JSONWriter *writer);
+bool writeGeometryOfFile(char *fileName, JSONWriter *writer) {
+    // Parses the schema and loads the file with it, the same checks as createValidGPXdoc and validateGPXDoc
+    xmlSchemaPtr schema = parseSchemaFile("parser/src/gpx.xsd");
+    GPXdoc *GPXDocStruct = (schema != NULL) ? loadValidGPXdoc(fileName, schema) : NULL;
+    xmlSchemaFree(schema);
+
+    if (GPXDocStruct == NULL) {
+        fprintf(stderr, "Invalid GPXdoc\n");
+        writeJSONText(writer, "{\"type\":\"FeatureCollection\",\"features\":[]}");
+    }
+    else {
+        writeDocGeoJSON(writer, GPXDocStruct);
+        deleteGPXdoc(GPXDocStruct);
+    }
+    return(flushJSONWriter(writer));
+}
+
+// Function that returns the GeoJSON of writeGeometryOfFile as a string
+char *geometryOfFile(char *fileName);
+char *geometryOfFile(char *fileName) {
+    StringBuffer *JSONString = getScratchBuffer();
+    JSONWriter writer;
+    initJSONWriter(&writer, &stringBufferSink, JSONString);
+    writeGeometryOfFile(fileName, &writer);
+    return(scratchBufferToString(JSONString));
+}
+
+// Function that loads every file in the directory and returns the JSON array of waypoints, routes and tracks inside or crossing the polygon
+char *geofenceOfDirectory(char *directory, char *polygonJSON);
+char *geofenceOfDirectory(char *directory, char *polygonJSON) {
+    // Creates a corpus of all the valid GPX files in the directory
+    GPXCorpus *corpus = createGPXCorpus(directory, "parser/src/gpx.xsd");
+
+    // If the directory could not be read, returns an empty array
+    if (corpus == NULL) {
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Gets the components touching the polygon and frees the corpus
+    char *JSONString = corpusGeofenceToJSON(corpus, polygonJSON);
+    deleteGPXCorpus(corpus);
+    return(JSONString);
+}
+
+// Function that loads every file in the directory and returns the JSON array of tracks recorded at some point between the two ISO 8601 times
+char *tracksActiveInDirectory(char *directory, char *startTime, char *endTime);
+char *tracksActiveInDirectory(char *directory, char *startTime, char *endTime) {
+    // Parses the times of the window and creates a corpus of all the valid GPX files in the directory
+    int64_t windowStart = parseGPXTime(startTime);
+    int64_t windowEnd = parseGPXTime(endTime);
+    GPXCorpus *corpus = NULL;
+    if (windowStart != GPX_NO_TIME && windowEnd != GPX_NO_TIME) {
+        corpus = createGPXCorpus(directory, "parser/src/gpx.xsd");
+    }
+
+    // If a time is invalid or the directory could not be read, returns an empty array
+    if (corpus == NULL) {
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Gets the active tracks and frees the corpus
+    char *JSONString = corpusTracksActiveToJSON(corpus, windowStart, windowEnd);
+    deleteGPXCorpus(corpus);
+    return(JSONString);
+}
+
+// Function that loads every file in the directory and returns the JSON array of tracks with the runs of points recorded between the two ISO 8601 times
+char *pointsInTimeWindowOfDirectory(char *directory, char *startTime, char *endTime);
+char *pointsInTimeWindowOfDirectory(char *directory, char *startTime, char *endTime) {
+    // Parses the times of the window and creates a corpus of all the valid GPX files in the directory
+    int64_t windowStart = parseGPXTime(startTime);
+    int64_t windowEnd = parseGPXTime(endTime);
+    GPXCorpus *corpus = NULL;
+    if (windowStart != GPX_NO_TIME && windowEnd != GPX_NO_TIME) {
+        corpus = createGPXCorpus(directory, "parser/src/gpx.xsd");
+    }
+
+    // If a time is invalid or the directory could not be read, returns an empty array
+    if (corpus == NULL) {
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Gets the points in the window and frees the corpus
+    char *JSONString = corpusPointsInTimeWindowToJSON(corpus, windowStart, windowEnd);
+    deleteGPXCorpus(corpus);
+    return(JSONString);
+}
+
+// Function that returns the JSON array of waypoints, routes and tracks in the file matching the filter expression
+char *queryFile(char *fileName, char *expression);
+char *queryFile(char *fileName, char *expression) {
+    // Compiles the expression and creates a GPXdoc structure, validating it against the gpx.xsd file
+    GPXQuery *query = createGPXQuery(expression);
+    GPXdoc *GPXDocStruct = NULL;
+    if (query != NULL) {
+        GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
+    }
+
+    // If the expression or the file is invalid, returns an empty array
+    if (query == NULL || validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == FALSE) {
+        deleteGPXQuery(query);
+        deleteGPXdoc(GPXDocStruct);
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Gets the matching components and frees the query and GPXdoc
+    char *JSONString = queryDocToJSON(query, GPXDocStruct);
+    deleteGPXQuery(query);
+    deleteGPXdoc(GPXDocStruct);
+    return(JSONString);
+}
+
+// Function that loads every file in the directory and returns the JSON array of waypoints, routes and tracks matching the filter expression
+char *queryDirectory(char *directory, char *expression);
+char *queryDirectory(char *directory, char *expression) {
+    // Compiles the expression and creates a corpus of all the valid GPX files in the directory
+    GPXQuery *query = createGPXQuery(expression);
+    GPXCorpus *corpus = NULL;
+    if (query != NULL) {
+        corpus = createGPXCorpus(directory, "parser/src/gpx.xsd");
+    }
 
-}
\ No newline at end of file
+    // If the expression is invalid or the directory could not be read, returns an empty array
+    if (corpus == NULL) {
+        deleteGPXQuery(query);
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Gets the matching components and frees the query and corpus
+    char *JSONString = corpusQueryToJSON(query, corpus);
+    deleteGPXQuery(query);
+    deleteGPXCorpus(corpus);
+    return(JSONString);
+}
+
+// Function that loads the file once and returns the JSON array of results of every query in the semicolon separated list
+char *batchFile(char *fileName, char *queries);
+char *batchFile(char *fileName, char *queries) {
+    // Reads the queries and creates a GPXdoc structure, validating it against the gpx.xsd file
+    GPXBatch *batch = createGPXBatch(queries);
+    GPXdoc *GPXDocStruct = NULL;
+    if (batch != NULL) {
+        GPXDocStruct = createValidGPXdoc(fileName, "parser/src/gpx.xsd");
+    }
+
+    // If the queries are missing or the file is invalid, returns an empty array
+    if (batch == NULL || validateGPXDoc(GPXDocStruct, "parser/src/gpx.xsd") == FALSE) {
+        deleteGPXBatch(batch);
+        deleteGPXdoc(GPXDocStruct);
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Runs every query over the GPXdoc and frees the batch and GPXdoc
+    char *JSONString = batchDocToJSON(batch, GPXDocStruct);
+    deleteGPXBatch(batch);
+    deleteGPXdoc(GPXDocStruct);
+    return(JSONString);
+}
+
+// Function that loads every file in the directory once and returns the JSON array of results of every query in the semicolon separated list
+char *batchDirectory(char *directory, char *queries);
+char *batchDirectory(char *directory, char *queries) {
+    // Reads the queries and creates a corpus of all the valid GPX files in the directory
+    GPXBatch *batch = createGPXBatch(queries);
+    GPXCorpus *corpus = NULL;
+    if (batch != NULL) {
+        corpus = createGPXCorpus(directory, "parser/src/gpx.xsd");
+    }
+
+    // If the queries are missing or the directory could not be read, returns an empty array
+    if (corpus == NULL) {
+        deleteGPXBatch(batch);
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Runs every query over the corpus and frees the batch and corpus
+    char *JSONString = corpusBatchToJSON(batch, corpus);
+    deleteGPXBatch(batch);
+    deleteGPXCorpus(corpus);
+    return(JSONString);
+}
+
+static bool countLengthMatch(void *context, const ScannedComponent *component) {
+    LengthMatch *match = (LengthMatch*)context;
+
+    // The difference is taken the way numRoutesWithLength and numTracksWithLength take it
+    float differenceInLength = abs(component -> length - match -> len);
+    if (component -> type == match -> type && differenceInLength <= match -> delta) {
+        match -> numComponents++;
+    }
+    return(TRUE);
+}
+
+static int64_t numberWithLengthFromFile(char *fileName, ComponentType type, float len, float delta) {
+    if (len < 0 || delta < 0) {
+        fprintf(stderr, "ERROR: len or delta is negative\n");
+        return(0);
+    }
+
+    // Scans the file against the gpx.xsd schema file, the lengths are worked out as the points are read and no GPXdoc is created
+    xmlSchemaPtr schema = parseSchemaFile("parser/src/gpx.xsd");
+    LengthMatch match = { type, len, delta, 0 };
+    GPXScan scan;
+    bool valid = (schema != NULL) && scanGPXFile(fileName, schema, &scan, &countLengthMatch, &match);
+    if (schema != NULL) {
+        clearGPXScan(&scan);
+        xmlSchemaFree(schema);
+    }
+
+    // If the file is invalid returns 0, the matches counted before the problem was found do not count
+    if (valid == FALSE) {
+        fprintf(stderr, "ERROR: Invalid GPXdoc");
+        return(0);
+    }
+    return(match.numComponents);
+}
+
+int64_t numberOfRoutesWithLengthFromFile(char *fileName, float len, float delta) {
+    return(numberWithLengthFromFile(fileName, GPX_ROUTE, len, delta));
+}
+
+int64_t numberOfTracksWithLengthFromFile(char *fileName, float len, float delta) {
+    return(numberWithLengthFromFile(fileName, GPX_TRACK, len, delta));
+}
+// Function that frees a string returned by any of the functions above, callers outside of C must release results with it
+// so they are given back to the allocator that made them
+void gpx_free(char *string);
+void gpx_free(char *string) {
+    free(string);
+}
+
+// Function that copies a string returned by any of the functions above into a buffer owned and reused by the caller, then frees it
+// Returns the length of the string, if the string and its NULL terminator do not fit nothing is copied or freed so the caller can
+// grow its buffer and call again with the same string
+int gpx_copy_result(char *result, char *buffer, int bufferLength);
+int gpx_copy_result(char *result, char *buffer, int bufferLength) {
+
+    // Error check for a NULL result, which is copied as an empty string
+    if (result == NULL) {
+        if (buffer != NULL && bufferLength > 0) {
+            buffer[0] = '\0';
+        }
+        return(0);
+    }
+
+    int resultLength = strlen(result);
+    if (buffer == NULL || resultLength + 1 > bufferLength) {
+        return(resultLength);
+    }
+    memcpy(buffer, result, resultLength + 1);
+    free(result);
+    return(resultLength);
+}
@@ -0,0 +1,140 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXPool.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+// Most free blocks a thread keeps for each class, blocks released past it are freed right away
+// Building with -DGPX_NO_POOLS keeps none, so every block goes straight back to free where memory checkers can see it
+#ifdef GPX_NO_POOLS
+    #define POOL_MAX_BLOCKS 0
+#else
+    #define POOL_MAX_BLOCKS 16384
+#endif
+
+// Number of blocks a thread releases between two trims of its free lists
+#define POOL_TRIM_PERIOD 65536
+
+// A free block holds the next free block of its list in its first bytes
+typedef struct PoolBlock {
+    struct PoolBlock *next;
+} PoolBlock;
+
+typedef struct {
+    PoolBlock *freeBlocks;
+    int numFree;
+
+    // Fewest free blocks the list held since the last trim, that many were not needed during the whole period
+    int lowWater;
+} Pool;
+
+typedef struct {
+    Pool pools[NUM_POOL_CLASSES];
+    int releasesSinceTrim;
+
+    // Whether the thread exit destructor knows about these pools yet
+    bool registered;
+} ThreadPools;
+
+// Size of the struct of each class, in the order of the enum
+static const size_t classSizes[NUM_POOL_CLASSES] = {
+    sizeof(Waypoint), sizeof(Route), sizeof(Track), sizeof(TrackSegment), sizeof(List), sizeof(Node)
+};
+
+// Each thread allocates from its own free lists, so neither side takes a lock
+static _Thread_local ThreadPools threadPools;
+
+// Key whose destructor frees the free blocks of a thread when it exits
+static pthread_key_t poolKey;
+static pthread_once_t poolKeyOnce = PTHREAD_ONCE_INIT;
+
+static void createPoolKey(void);
+static void freeThreadPools(void *data);
+static void trimThreadPools(ThreadPools *thread);
+
+void *poolAllocate(GPXPoolClass sizeClass) {
+    Pool *pool = &threadPools.pools[sizeClass];
+    PoolBlock *block = pool -> freeBlocks;
+    if (block == NULL) {
+        return(malloc(classSizes[sizeClass]));
+    }
+
+    pool -> freeBlocks = block -> next;
+    pool -> numFree--;
+    if (pool -> numFree < pool -> lowWater) {
+        pool -> lowWater = pool -> numFree;
+    }
+    return(block);
+}
+
+void poolRelease(GPXPoolClass sizeClass, void *block) {
+    if (block == NULL) {
+        return;
+    }
+
+    // The first block a thread keeps makes it register for the exit destructor, threads that never release never register
+    ThreadPools *thread = &threadPools;
+    if (thread -> registered == FALSE) {
+        pthread_once(&poolKeyOnce, &createPoolKey);
+        pthread_setspecific(poolKey, thread);
+        thread -> registered = TRUE;
+    }
+
+    Pool *pool = &thread -> pools[sizeClass];
+    if (pool -> numFree >= POOL_MAX_BLOCKS) {
+        free(block);
+    }
+    else {
+        PoolBlock *freeBlock = (PoolBlock*)block;
+        freeBlock -> next = pool -> freeBlocks;
+        pool -> freeBlocks = freeBlock;
+        pool -> numFree++;
+    }
+
+    // Trimming every so many releases, so a thread that parsed one very large document does not keep its blocks forever
+    if (++thread -> releasesSinceTrim >= POOL_TRIM_PERIOD) {
+        trimThreadPools(thread);
+    }
+}
+
+void trimGPXPools(void) {
+    freeThreadPools(&threadPools);
+}
+
+static void createPoolKey(void) {
+    pthread_key_create(&poolKey, &freeThreadPools);
+}
+
+static void freeThreadPools(void *data) {
+    ThreadPools *thread = (ThreadPools*)data;
+    for (int sizeClass = 0; sizeClass < NUM_POOL_CLASSES; sizeClass++) {
+        Pool *pool = &thread -> pools[sizeClass];
+        while (pool -> freeBlocks != NULL) {
+            PoolBlock *next = pool -> freeBlocks -> next;
+            free(pool -> freeBlocks);
+            pool -> freeBlocks = next;
+        }
+        pool -> numFree = 0;
+        pool -> lowWater = 0;
+    }
+    thread -> releasesSinceTrim = 0;
+
+    // A block released later in the thread's exit, by another destructor, registers the pools again
+    thread -> registered = FALSE;
+}
+
+static void trimThreadPools(ThreadPools *thread) {
+
+    // Freeing the blocks that stayed in a list through the whole period, the rest were used and are likely to be used again
+    for (int sizeClass = 0; sizeClass < NUM_POOL_CLASSES; sizeClass++) {
+        Pool *pool = &thread -> pools[sizeClass];
+        for (int i = 0; i < pool -> lowWater && pool -> freeBlocks != NULL; i++) {
+            PoolBlock *next = pool -> freeBlocks -> next;
+            free(pool -> freeBlocks);
+            pool -> freeBlocks = next;
+            pool -> numFree--;
+        }
+        pool -> lowWater = pool -> numFree;
+    }
+    thread -> releasesSinceTrim = 0;
+}
@@ -0,0 +1,568 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXQuery.h"
+#include "GPXNumber.h"
+#include "GPXCompact.h"
+#include <limits.h>
+
+// Tolerance used for the loop flag, the same one routeToJSON and trackToJSON use
+#define QUERY_LOOP_DELTA 10
+
+static bool parseQueryTerm(GPXQuery *query, const char *key, const char *value);
+static bool parseRange(const char *value, double *minimum, double *maximum);
+static bool parseTimeRange(const char *value, int64_t *startTime, int64_t *endTime);
+static int64_t queryPointCount(QueryComponent *component);
+static bool queryIsLoop(const QueryComponent *component);
+static BoundingBox queryBoundingBox(QueryComponent *component);
+static float queryLength(QueryComponent *component);
+static const char *queryName(const QueryComponent *component);
+static void appendQueryComponent(StringBuffer *JSONString, QueryComponent *component, const char *fileName, int number);
+static void queryListToJSON(const GPXQuery *query, StringBuffer *JSONString, List *list, ComponentType type);
+
+GPXQuery *createGPXQuery(const char *expression) {
+
+    // Error check the expression for NULL
+    if (expression == NULL) {
+        fprintf(stderr, "ERROR: Query expression is NULL\n");
+        return(NULL);
+    }
+
+    // Starting from a query without any predicate, which every component matches
+    GPXQuery *query = malloc(sizeof(GPXQuery));
+    query -> types = QUERY_WAYPOINTS | QUERY_ROUTES | QUERY_TRACKS;
+    query -> name = NULL;
+    query -> namePrefix = FALSE;
+    query -> minPoints = -1;
+    query -> maxPoints = -1;
+    query -> loop = -1;
+    query -> hasBox = FALSE;
+    query -> hasTime = FALSE;
+    query -> startTime = 0;
+    query -> endTime = 0;
+    query -> hasLength = FALSE;
+    query -> minLength = -1;
+    query -> maxLength = -1;
+
+    // Copying each key:value term out of the expression and adding its predicate to the query
+    size_t expressionLength = strlen(expression);
+    char *key = malloc(expressionLength + 1);
+    char *value = malloc(expressionLength + 1);
+    const char *cursor = expression;
+    bool valid = TRUE;
+    while (valid == TRUE) {
+        while (*cursor == ' ' || *cursor == '\t' || *cursor == '\n') {
+            cursor++;
+        }
+        if (*cursor == '\0') {
+            break;
+        }
+
+        // The key runs up to the colon
+        size_t keyLength = 0;
+        while (*cursor != ':' && *cursor != ' ' && *cursor != '\0') {
+            key[keyLength++] = *cursor++;
+        }
+        key[keyLength] = '\0';
+        if (*cursor != ':') {
+            fprintf(stderr, "ERROR: Query term %s has no value\n", key);
+            valid = FALSE;
+            break;
+        }
+        cursor++;
+
+        // The value runs up to the next space, or to the closing quote when it is quoted
+        size_t valueLength = 0;
+        if (*cursor == '"') {
+            cursor++;
+            while (*cursor != '"' && *cursor != '\0') {
+                value[valueLength++] = *cursor++;
+            }
+            if (*cursor != '"') {
+                fprintf(stderr, "ERROR: Query value of %s is missing its closing quote\n", key);
+                valid = FALSE;
+                break;
+            }
+            cursor++;
+        }
+        else {
+            while (*cursor != ' ' && *cursor != '\t' && *cursor != '\n' && *cursor != '\0') {
+                value[valueLength++] = *cursor++;
+            }
+        }
+        value[valueLength] = '\0';
+
+        valid = parseQueryTerm(query, key, value);
+    }
+    free(key);
+    free(value);
+
+    if (valid == FALSE) {
+        deleteGPXQuery(query);
+        return(NULL);
+    }
+    return(query);
+}
+
+void deleteGPXQuery(GPXQuery *query) {
+    if (query == NULL) {
+        return;
+    }
+
+    // Freeing the name of the query and the query itself
+    free(query -> name);
+    free(query);
+}
+
+void initQueryComponent(QueryComponent *component, void *data, ComponentType type) {
+    component -> data = data;
+    component -> type = type;
+    component -> numPoints = -1;
+    component -> hasBox = FALSE;
+    component -> hasLength = FALSE;
+    component -> length = 0;
+}
+
+bool componentMatchesQuery(const GPXQuery *query, QueryComponent *component) {
+
+    // The type and name only need the component itself
+    if ((query -> types & (1 << component -> type)) == 0) {
+        return(FALSE);
+    }
+    if (query -> name != NULL) {
+        const char *name = (component -> type == GPX_WAYPOINT) ? ((Waypoint*)component -> data) -> name :
+            (component -> type == GPX_ROUTE) ? ((Route*)component -> data) -> name : ((Track*)component -> data) -> name;
+        if (query -> namePrefix == TRUE && strncmp(name, query -> name, strlen(query -> name)) != 0) {
+            return(FALSE);
+        }
+        if (query -> namePrefix == FALSE && strcmp(name, query -> name) != 0) {
+            return(FALSE);
+        }
+    }
+
+    // Point counts are cached by the index, or are a list length away
+    if (query -> minPoints >= 0 || query -> maxPoints >= 0) {
+        int64_t numPoints = queryPointCount(component);
+        if ((query -> minPoints >= 0 && numPoints < query -> minPoints) || (query -> maxPoints >= 0 && numPoints > query -> maxPoints)) {
+            return(FALSE);
+        }
+    }
+
+    // The loop flag only compares the first and last points
+    if (query -> loop >= 0 && (queryIsLoop(component) ? 1 : 0) != query -> loop) {
+        return(FALSE);
+    }
+
+    // Bounding boxes are cached by the index, otherwise they take one pass over the points without any trigonometry
+    if (query -> hasBox == TRUE) {
+        if (queryPointCount(component) == 0 || boxesIntersect(queryBoundingBox(component), query -> box) == FALSE) {
+            return(FALSE);
+        }
+    }
+
+    // Time spans take a look at the ends of each segment when its times are in order
+    if (query -> hasTime == TRUE) {
+        int64_t trackStart, trackEnd;
+        if (component -> type != GPX_TRACK || getTrackTimeRange((Track*)component -> data, &trackStart, &trackEnd) == FALSE) {
+            return(FALSE);
+        }
+        if (trackStart > query -> endTime || trackEnd < query -> startTime) {
+            return(FALSE);
+        }
+    }
+
+    // The length needs the haversine formula for every pair of points, so it is checked last
+    if (query -> hasLength == TRUE) {
+        float length = queryLength(component);
+        if ((query -> minLength >= 0 && length < query -> minLength) || (query -> maxLength >= 0 && length > query -> maxLength)) {
+            return(FALSE);
+        }
+    }
+
+    return(TRUE);
+}
+
+char *queryDocToJSON(const GPXQuery *query, const GPXdoc *doc) {
+
+    // Error check the query and doc for NULL
+    if (query == NULL || doc == NULL) {
+        fprintf(stderr, "ERROR: GPXQuery or GPXdoc is NULL\n");
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // Checking and writing out the waypoints, routes and tracks in one pass, lists of types the query excludes are skipped
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "[");
+    if ((query -> types & QUERY_WAYPOINTS) != 0) {
+        queryListToJSON(query, &JSONString, doc -> waypoints, GPX_WAYPOINT);
+    }
+    if ((query -> types & QUERY_ROUTES) != 0) {
+        queryListToJSON(query, &JSONString, doc -> routes, GPX_ROUTE);
+    }
+    if ((query -> types & QUERY_TRACKS) != 0) {
+        queryListToJSON(query, &JSONString, doc -> tracks, GPX_TRACK);
+    }
+    appendToStringBuffer(&JSONString, "]");
+
+    // Returns an allocated string of the matching components in JSON format
+    return(JSONString.string);
+}
+
+char *corpusQueryToJSON(const GPXQuery *query, GPXCorpus *corpus) {
+
+    // Error check the query and corpus for NULL
+    if (query == NULL || corpus == NULL) {
+        fprintf(stderr, "ERROR: GPXQuery or GPXCorpus is NULL\n");
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "[]");
+        return(JSONString);
+    }
+
+    // The index lists every component of the corpus with its point count and bounding box already worked out
+    SpatialIndex *index = getCorpusSpatialIndex(corpus);
+
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "[");
+    for (int i = 0; i < index -> numComponents; i++) {
+        const IndexedComponent *indexed = &index -> components[i];
+        QueryComponent component;
+        initQueryComponent(&component, indexed -> data, indexed -> type);
+        component.numPoints = indexed -> numPoints;
+        component.hasBox = TRUE;
+        component.box = indexed -> box;
+
+        if (componentMatchesQuery(query, &component) == TRUE) {
+            appendQueryComponent(&JSONString, &component, corpus -> documents[indexed -> document].fileName, indexed -> position + 1);
+        }
+    }
+    appendToStringBuffer(&JSONString, "]");
+
+    // Returns an allocated string of the matching components in JSON format
+    return(JSONString.string);
+}
+
+static bool parseQueryTerm(GPXQuery *query, const char *key, const char *value) {
+
+    // Reading the value of the term the way its key needs
+    if (strcmp(key, "type") == 0) {
+        if (*value == '\0') {
+            fprintf(stderr, "ERROR: Query type list is empty\n");
+            return(FALSE);
+        }
+        query -> types = 0;
+        const char *cursor = value;
+        while (*cursor != '\0') {
+            size_t typeLength = strcspn(cursor, ",");
+            if (typeLength == 8 && strncmp(cursor, "waypoint", 8) == 0) {
+                query -> types |= QUERY_WAYPOINTS;
+            }
+            else if (typeLength == 5 && strncmp(cursor, "route", 5) == 0) {
+                query -> types |= QUERY_ROUTES;
+            }
+            else if (typeLength == 5 && strncmp(cursor, "track", 5) == 0) {
+                query -> types |= QUERY_TRACKS;
+            }
+            else {
+                fprintf(stderr, "ERROR: Unknown query type %s\n", cursor);
+                return(FALSE);
+            }
+            cursor += typeLength;
+            if (*cursor == ',') {
+                cursor++;
+            }
+        }
+        return(TRUE);
+    }
+    if (strcmp(key, "name") == 0) {
+        size_t nameLength = strlen(value);
+        free(query -> name);
+        query -> name = malloc(nameLength + 1);
+        strcpy(query -> name, value);
+        query -> namePrefix = (nameLength > 0 && value[nameLength - 1] == '*');
+        if (query -> namePrefix == TRUE) {
+            query -> name[nameLength - 1] = '\0';
+        }
+        return(TRUE);
+    }
+    if (strcmp(key, "points") == 0) {
+        double minimum, maximum;
+        if (parseRange(value, &minimum, &maximum) == FALSE || minimum > INT_MAX || maximum > INT_MAX) {
+            fprintf(stderr, "ERROR: Invalid query point range %s\n", value);
+            return(FALSE);
+        }
+        query -> minPoints = (minimum < 0) ? -1 : (int)ceil(minimum);
+        query -> maxPoints = (maximum < 0) ? -1 : (int)floor(maximum);
+        return(TRUE);
+    }
+    if (strcmp(key, "loop") == 0) {
+        if (strcmp(value, "true") == 0) {
+            query -> loop = 1;
+        }
+        else if (strcmp(value, "false") == 0) {
+            query -> loop = 0;
+        }
+        else {
+            fprintf(stderr, "ERROR: Invalid query loop flag %s\n", value);
+            return(FALSE);
+        }
+        return(TRUE);
+    }
+    if (strcmp(key, "bbox") == 0) {
+        double corners[4];
+        const char *cursor = value;
+        for (int i = 0; i < 4; i++) {
+            char *end;
+            corners[i] = parseDecimal(cursor, &end);
+            if (end == cursor || !isfinite(corners[i]) || (i < 3 && *end != ',') || (i == 3 && *end != '\0')) {
+                fprintf(stderr, "ERROR: Invalid query bounding box %s\n", value);
+                return(FALSE);
+            }
+            cursor = end + 1;
+        }
+        query -> hasBox = TRUE;
+        query -> box.minLatitude = fmin(corners[0], corners[2]);
+        query -> box.minLongitude = fmin(corners[1], corners[3]);
+        query -> box.maxLatitude = fmax(corners[0], corners[2]);
+        query -> box.maxLongitude = fmax(corners[1], corners[3]);
+        return(TRUE);
+    }
+    if (strcmp(key, "time") == 0) {
+        if (parseTimeRange(value, &query -> startTime, &query -> endTime) == FALSE) {
+            fprintf(stderr, "ERROR: Invalid query time range %s\n", value);
+            return(FALSE);
+        }
+        query -> hasTime = TRUE;
+        return(TRUE);
+    }
+    if (strcmp(key, "len") == 0) {
+        if (parseRange(value, &query -> minLength, &query -> maxLength) == FALSE) {
+            fprintf(stderr, "ERROR: Invalid query length range %s\n", value);
+            return(FALSE);
+        }
+        query -> hasLength = TRUE;
+        return(TRUE);
+    }
+
+    fprintf(stderr, "ERROR: Unknown query term %s\n", key);
+    return(FALSE);
+}
+
+static bool parseRange(const char *value, double *minimum, double *maximum) {
+
+    // A range is MIN..MAX with either end left out, or a single number that is both ends, open ends are -1
+    // The ends have to be finite, an infinite end is written by leaving it out
+    *minimum = -1;
+    *maximum = -1;
+    const char *dots = strstr(value, "..");
+    char *end;
+    if (dots == NULL) {
+        *minimum = parseDecimal(value, &end);
+        *maximum = *minimum;
+        return(end != value && *end == '\0' && *minimum >= 0 && isfinite(*minimum));
+    }
+
+    // The minimum is copied out so parseDecimal cannot read the first dot of ".." as a decimal point
+    if (dots != value) {
+        char *start = malloc(dots - value + 1);
+        memcpy(start, value, dots - value);
+        start[dots - value] = '\0';
+        *minimum = parseDecimal(start, &end);
+        bool validMinimum = (*end == '\0' && *minimum >= 0 && isfinite(*minimum));
+        free(start);
+        if (validMinimum == FALSE) {
+            return(FALSE);
+        }
+    }
+    if (dots[2] != '\0') {
+        *maximum = parseDecimal(dots + 2, &end);
+        if (*end != '\0' || *maximum < 0 || !isfinite(*maximum)) {
+            return(FALSE);
+        }
+    }
+    return(TRUE);
+}
+
+static bool parseTimeRange(const char *value, int64_t *startTime, int64_t *endTime) {
+
+    // A time range is START..END with either end left out, open ends reach as far as times can go
+    const char *dots = strstr(value, "..");
+    if (dots == NULL) {
+        return(FALSE);
+    }
+
+    *startTime = INT64_MIN + 1;
+    *endTime = INT64_MAX;
+    if (dots != value) {
+        char *start = malloc(dots - value + 1);
+        memcpy(start, value, dots - value);
+        start[dots - value] = '\0';
+        *startTime = parseGPXTime(start);
+        free(start);
+        if (*startTime == GPX_NO_TIME) {
+            return(FALSE);
+        }
+    }
+    if (dots[2] != '\0') {
+        *endTime = parseGPXTime(dots + 2);
+        if (*endTime == GPX_NO_TIME) {
+            return(FALSE);
+        }
+    }
+    return(TRUE);
+}
+
+static int64_t queryPointCount(QueryComponent *component) {
+    if (component -> numPoints >= 0) {
+        return(component -> numPoints);
+    }
+
+    // Waypoints are a single point, routes and tracks keep their point counts in their lists
+    if (component -> type == GPX_WAYPOINT) {
+        component -> numPoints = 1;
+    }
+    else if (component -> type == GPX_ROUTE) {
+        component -> numPoints = getLength(((Route*)component -> data) -> waypoints);
+    }
+    else {
+        component -> numPoints = 0;
+        ListIterator segmentIterator = createIterator(((Track*)component -> data) -> segments);
+        void *segmentElement;
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            component -> numPoints += getSegmentNumPoints((TrackSegment*)segmentElement);
+        }
+    }
+    return(component -> numPoints);
+}
+
+static bool queryIsLoop(const QueryComponent *component) {
+    if (component -> type == GPX_ROUTE) {
+        return(isLoopRoute((Route*)component -> data, QUERY_LOOP_DELTA));
+    }
+    if (component -> type == GPX_TRACK) {
+        return(isLoopTrack((Track*)component -> data, QUERY_LOOP_DELTA));
+    }
+    return(FALSE);
+}
+
+static BoundingBox queryBoundingBox(QueryComponent *component) {
+    if (component -> hasBox == TRUE) {
+        return(component -> box);
+    }
+
+    // Widening the box over every point of the component, tracks are read with a segment cursor
+    BoundingBox box = {90, 180, -90, -180};
+    if (component -> type == GPX_WAYPOINT) {
+        Waypoint *waypoint = (Waypoint*)component -> data;
+        box.minLatitude = box.maxLatitude = waypoint -> latitude;
+        box.minLongitude = box.maxLongitude = waypoint -> longitude;
+    }
+    else if (component -> type == GPX_ROUTE) {
+        ListIterator waypointIterator = createIterator(((Route*)component -> data) -> waypoints);
+        void *waypointElement;
+        while ((waypointElement = nextElement(&waypointIterator)) != NULL) {
+            Waypoint *waypoint = (Waypoint*)waypointElement;
+            box.minLatitude = fmin(box.minLatitude, waypoint -> latitude);
+            box.maxLatitude = fmax(box.maxLatitude, waypoint -> latitude);
+            box.minLongitude = fmin(box.minLongitude, waypoint -> longitude);
+            box.maxLongitude = fmax(box.maxLongitude, waypoint -> longitude);
+        }
+    }
+    else {
+        ListIterator segmentIterator = createIterator(((Track*)component -> data) -> segments);
+        void *segmentElement;
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            SegmentCursor cursor;
+            openSegmentCursor(&cursor, (TrackSegment*)segmentElement);
+            while (nextSegmentRun(&cursor) > 0) {
+                for (int64_t i = 0; i < cursor.numPoints; i++) {
+                    box.minLatitude = fmin(box.minLatitude, cursor.latitudes[i]);
+                    box.maxLatitude = fmax(box.maxLatitude, cursor.latitudes[i]);
+                    box.minLongitude = fmin(box.minLongitude, cursor.longitudes[i]);
+                    box.maxLongitude = fmax(box.maxLongitude, cursor.longitudes[i]);
+                }
+            }
+        }
+    }
+
+    component -> hasBox = TRUE;
+    component -> box = box;
+    return(box);
+}
+
+static float queryLength(QueryComponent *component) {
+    if (component -> hasLength == TRUE) {
+        return(component -> length);
+    }
+
+    // Using the same length functions as routeToJSON and trackToJSON, a waypoint has no length
+    if (component -> type == GPX_ROUTE) {
+        component -> length = getRouteLen((Route*)component -> data);
+    }
+    else if (component -> type == GPX_TRACK) {
+        component -> length = getTrackLen((Track*)component -> data);
+    }
+    else {
+        component -> length = 0;
+    }
+    component -> hasLength = TRUE;
+    return(component -> length);
+}
+
+static const char *queryName(const QueryComponent *component) {
+
+    // Getting the name of the waypoint, route or track, empty names are shown as "None" like routeToJSON does
+    const char *name = "";
+    if (component -> type == GPX_WAYPOINT) {
+        name = ((Waypoint*)component -> data) -> name;
+    }
+    else if (component -> type == GPX_ROUTE) {
+        name = ((Route*)component -> data) -> name;
+    }
+    else {
+        name = ((Track*)component -> data) -> name;
+    }
+
+    if (strcmp(name, "") == 0) {
+        return("None");
+    }
+    return(name);
+}
+
+static void appendQueryComponent(StringBuffer *JSONString, QueryComponent *component, const char *fileName, int number) {
+    static const char *typeNames[] = {"waypoint", "route", "track"};
+
+    // Separating the object from the previous match, the buffer only holds "[" before the first one
+    appendToStringBuffer(JSONString, (JSONString -> length == 1) ? "{" : ",{");
+    if (fileName != NULL) {
+        appendToStringBuffer(JSONString, "\"fileName\":");
+        appendJSONStringToStringBuffer(JSONString, fileName);
+        appendToStringBuffer(JSONString, ",");
+    }
+
+    // Writing the fields in the same format as routeToJSON, reusing whatever the predicates already worked out
+    appendFormatToStringBuffer(JSONString, "\"type\":\"%s\",\"number\":%d,\"name\":", typeNames[component -> type], number);
+    appendJSONStringToStringBuffer(JSONString, queryName(component));
+    char length[GPX_NUMBER_STRING_LENGTH];
+    formatFixedDouble(round10(queryLength(component)), 1, length);
+    appendFormatToStringBuffer(JSONString, ",\"numPoints\":%lld,\"len\":%s,\"loop\":%s}", (long long)queryPointCount(component), length, queryIsLoop(component) ? "true" : "false");
+}
+
+static void queryListToJSON(const GPXQuery *query, StringBuffer *JSONString, List *list, ComponentType type) {
+
+    // Checking each component of the list against the query and writing out the matches
+    int number = 1;
+    ListIterator iterator = createIterator(list);
+    void *element;
+    while ((element = nextElement(&iterator)) != NULL) {
+        QueryComponent component;
+        initQueryComponent(&component, element, type);
+        if (componentMatchesQuery(query, &component) == TRUE) {
+            appendQueryComponent(JSONString, &component, NULL, number);
+        }
+        number++;
+    }
+}
@@ -0,0 +1,534 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXJSON.h"
+#include "GPXNumber.h"
+#include "GPXScan.h"
+#include <libxml/xmlreader.h>
+
+// What the text of the element the scan is waiting on is used for
+typedef enum {
+    SCAN_VALUE_NONE,
+    SCAN_VALUE_COMPONENT_NAME,
+    SCAN_VALUE_POINT_NAME,
+    SCAN_VALUE_DATA
+} ScanValue;
+
+// Everything the scan remembers between two nodes of the reader, none of it grows with the size of the file
+typedef struct {
+    GPXScan *scan;
+    ScanCallback onComponent;
+    void *context;
+    bool readRoot;
+
+    //Depth of the wpt, rte or trk element being read and its summary so far, the depth is -1 between components
+    int componentDepth;
+    ScannedComponent component;
+    char *name;
+    int64_t numData;
+
+    //Depth of the trkseg element being read, -1 outside of one, and what is known of the segment so far
+    int segmentDepth;
+    int64_t segmentPoints;
+    float segmentLength;
+    bool firstSegmentHasPoints;
+    int64_t lastSegmentPoints;
+
+    //Depth of the wpt, rtept or trkpt element being read, -1 outside of one, and its coordinates
+    int pointDepth;
+    double latitude;
+    double longitude;
+    bool pointHasName;
+
+    //The point before the current one in the route or segment, and the first point of the component
+    bool hasPrevious;
+    double previousLatitude;
+    double previousLongitude;
+    double firstLatitude;
+    double firstLongitude;
+
+    //Depth of the element whose first child holds the value the scan is waiting on
+    ScanValue value;
+    int valueDepth;
+
+    bool valid;
+} ScanState;
+
+// The routes and tracks of a file written by scanSummaryToJSON as they are scanned, they come after the counts of the file
+typedef struct {
+    const char *fileName;
+    StringBuffer routes;
+    StringBuffer tracks;
+} ScanSummary;
+
+static void initScanState(ScanState *state, GPXScan *scan, ScanCallback onComponent, void *context);
+static bool readRootElement(ScanState *state, xmlTextReaderPtr reader);
+static void startElement(ScanState *state, xmlTextReaderPtr reader, int depth);
+static void readPointCoordinates(ScanState *state, xmlTextReaderPtr reader);
+static void readValue(ScanState *state, const char *value);
+static bool endElement(ScanState *state, int depth);
+static void endPoint(ScanState *state);
+static void endSegment(ScanState *state);
+static bool endComponent(ScanState *state);
+static void extendBox(BoundingBox *box, bool empty, double latitude, double longitude);
+static bool appendScannedComponent(void *context, const ScannedComponent *component);
+
+bool scanGPXFile(char *fileName, xmlSchemaPtr schema, GPXScan *scan, ScanCallback onComponent, void *context) {
+    scan -> version = 0;
+    scan -> creator = NULL;
+    scan -> numWaypoints = 0;
+    scan -> numRoutes = 0;
+    scan -> numTracks = 0;
+    scan -> numSegments = 0;
+    scan -> numGPXData = 0;
+    scan -> hasBox = FALSE;
+
+    if (fileName == NULL || strcmp(fileName, "") == 0) {
+        fprintf(stderr, "ERROR: Invalid file name\n");
+        return(FALSE);
+    }
+    if (requireGPXLibrary() == FALSE) {
+        return(FALSE);
+    }
+
+    // Opening the file a node at a time, the schema has to be set before the first node is read
+    xmlTextReaderPtr reader = xmlReaderForFile(fileName, NULL, getGPXParseOptions());
+    if (reader == NULL) {
+        fprintf(stderr, "ERROR: XML file: %s was not parsable\n", fileName);
+        return(FALSE);
+    }
+    if (schema != NULL && xmlTextReaderSetSchema(reader, schema) != 0) {
+        fprintf(stderr, "ERROR: Invalid xml Tree or Schema\n");
+        xmlFreeTextReader(reader);
+        return(FALSE);
+    }
+
+    ScanState state;
+    initScanState(&state, scan, onComponent, context);
+    int result = 0;
+    while (state.valid == TRUE && (result = xmlTextReaderRead(reader)) == 1) {
+        int type = xmlTextReaderNodeType(reader);
+        int depth = xmlTextReaderDepth(reader);
+
+        // A value is the content of the element's first child, the way the tree is read, and an element without children has an empty one
+        if (state.value != SCAN_VALUE_NONE) {
+            bool content = (depth == state.valueDepth + 1 && (type == XML_READER_TYPE_TEXT || type == XML_READER_TYPE_CDATA || type == XML_READER_TYPE_COMMENT ||
+                                                              type == XML_READER_TYPE_WHITESPACE || type == XML_READER_TYPE_SIGNIFICANT_WHITESPACE));
+            const xmlChar *value = content ? xmlTextReaderConstValue(reader) : NULL;
+            readValue(&state, (value != NULL) ? (const char*)value : "");
+            if (content) {
+                continue;
+            }
+        }
+
+        if (type == XML_READER_TYPE_ELEMENT) {
+            if (state.readRoot == FALSE) {
+                state.readRoot = TRUE;
+                state.valid = readRootElement(&state, reader);
+                continue;
+            }
+            startElement(&state, reader, depth);
+
+            // Empty elements have no end tag of their own, so they end as soon as they start
+            if (xmlTextReaderIsEmptyElement(reader) == 1) {
+                if (state.value != SCAN_VALUE_NONE) {
+                    readValue(&state, "");
+                }
+                if (endElement(&state, depth) == FALSE) {
+                    break;
+                }
+            }
+        }
+        else if (type == XML_READER_TYPE_END_ELEMENT && endElement(&state, depth) == FALSE) {
+            break;
+        }
+    }
+    free(state.name);
+
+    // The file is valid once the reader got to its end, the schema found nothing wrong and every header file requirement was met
+    bool valid = state.valid;
+    if (valid == TRUE && result != 0) {
+        if (result == -1) {
+            fprintf(stderr, "ERROR: XML file: %s was not parsable\n", fileName);
+        }
+        valid = FALSE;
+    }
+    if (valid == TRUE && schema != NULL && xmlTextReaderIsValid(reader) != 1) {
+        fprintf(stderr, "GPX file: %s failed to validate with Schema file\n", fileName);
+        valid = FALSE;
+    }
+    if (valid == TRUE && state.readRoot == FALSE) {
+        fprintf(stderr, "Error: Name space is empty\n");
+        valid = FALSE;
+    }
+    xmlFreeTextReader(reader);
+
+    return(valid);
+}
+
+void clearGPXScan(GPXScan *scan) {
+    free(scan -> creator);
+    scan -> creator = NULL;
+}
+
+char *scannedComponentToJSON(const ScannedComponent *component) {
+
+    // Writing the component the way routeToJSON and trackToJSON write a component of a GPXdoc, the name is escaped as it can hold any character
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "{\"name\":");
+    appendJSONStringToStringBuffer(&JSONString, (strcmp(component -> name, "") == 0) ? "None" : component -> name);
+    char length[GPX_NUMBER_STRING_LENGTH];
+    formatFixedDouble(round10(component -> length), 1, length);
+    appendFormatToStringBuffer(&JSONString, ",\"numPoints\":%lld,\"len\":%s,\"loop\":%s}", (long long)component -> numPoints, length, component -> loop ? "true" : "false");
+
+    // Returns an allocated string of the component in JSON format
+    return(JSONString.string);
+}
+
+char *scanSummaryToJSON(char *filePath, const char *fileName, xmlSchemaPtr schema) {
+    if (filePath == NULL || fileName == NULL) {
+        fprintf(stderr, "ERROR: File name is NULL\n");
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "{}");
+        return(JSONString);
+    }
+
+    // The routes and tracks are written into buffers of their own as they are scanned
+    ScanSummary summary;
+    summary.fileName = fileName;
+    initStringBuffer(&summary.routes);
+    initStringBuffer(&summary.tracks);
+    GPXScan scan;
+    bool valid = scanGPXFile(filePath, schema, &scan, &appendScannedComponent, &summary);
+
+    // If the file is invalid, returns an empty object
+    if (valid == FALSE) {
+        clearGPXScan(&scan);
+        free(summary.routes.string);
+        free(summary.tracks.string);
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "{}");
+        return(JSONString);
+    }
+
+    // Writing the same summary documentSummaryToJSON writes for the GPXdoc of the file
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "{\"fileName\":");
+    appendJSONStringToStringBuffer(&JSONString, fileName);
+    appendToStringBuffer(&JSONString, ",\"version\":");
+    appendFixedToStringBuffer(&JSONString, scan.version, 1);
+    appendToStringBuffer(&JSONString, ",\"creator\":");
+    appendJSONStringToStringBuffer(&JSONString, scan.creator);
+    appendFormatToStringBuffer(&JSONString, ",\"numWaypoints\":%lld,\"numRoutes\":%lld,\"numTracks\":%lld,\"routes\":[", (long long)scan.numWaypoints, (long long)scan.numRoutes, (long long)scan.numTracks);
+    appendBytesToStringBuffer(&JSONString, summary.routes.string, summary.routes.length);
+    appendToStringBuffer(&JSONString, "],\"tracks\":[");
+    appendBytesToStringBuffer(&JSONString, summary.tracks.string, summary.tracks.length);
+    appendToStringBuffer(&JSONString, "]}");
+    clearGPXScan(&scan);
+    free(summary.routes.string);
+    free(summary.tracks.string);
+
+    // Returns an allocated string of the file summary in JSON format
+    return(JSONString.string);
+}
+
+static void initScanState(ScanState *state, GPXScan *scan, ScanCallback onComponent, void *context) {
+    memset(state, 0, sizeof(ScanState));
+    state -> scan = scan;
+    state -> onComponent = onComponent;
+    state -> context = context;
+    state -> readRoot = FALSE;
+    state -> componentDepth = -1;
+    state -> segmentDepth = -1;
+    state -> pointDepth = -1;
+    state -> name = NULL;
+    state -> value = SCAN_VALUE_NONE;
+    state -> valid = TRUE;
+}
+
+static bool readRootElement(ScanState *state, xmlTextReaderPtr reader) {
+
+    // The root element must have a namespace that fits the array the GPXdoc keeps it in
+    const xmlChar *namespace = xmlTextReaderConstNamespaceUri(reader);
+    if (namespace == NULL || xmlStrlen(namespace) == 0 || xmlStrlen(namespace) >= (int)sizeof(((GPXdoc*)NULL) -> namespace)) {
+        fprintf(stderr, "Error: Name space is empty\n");
+        return(FALSE);
+    }
+
+    // Reading the version and creator attributes of the root, then moving back to the element itself
+    while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        const char *name = (const char*)xmlTextReaderConstLocalName(reader);
+        const char *value = (const char*)xmlTextReaderConstValue(reader);
+        if (name == NULL || value == NULL) {
+            continue;
+        }
+        if (strcmp(name, "version") == 0) {
+            state -> scan -> version = parseDecimal(value, NULL);
+        }
+        else if (strcmp(name, "creator") == 0) {
+            free(state -> scan -> creator);
+            state -> scan -> creator = malloc(strlen(value) + 1);
+            strcpy(state -> scan -> creator, value);
+        }
+    }
+    xmlTextReaderMoveToElement(reader);
+
+    if (state -> scan -> creator == NULL || strcmp(state -> scan -> creator, "") == 0) {
+        fprintf(stderr, "Error: Creator is empty or NULL\n");
+        return(FALSE);
+    }
+    return(TRUE);
+}
+
+static void startElement(ScanState *state, xmlTextReaderPtr reader, int depth) {
+    const char *name = (const char*)xmlTextReaderConstLocalName(reader);
+    if (name == NULL) {
+        return;
+    }
+
+    // Outside of a component every wpt, rte and trk starts one, whatever it is nested in, the way the tree is walked
+    if (state -> componentDepth == -1) {
+        ComponentType type;
+        if (strcmp(name, "wpt") == 0) {
+            type = GPX_WAYPOINT;
+        }
+        else if (strcmp(name, "rte") == 0) {
+            type = GPX_ROUTE;
+        }
+        else if (strcmp(name, "trk") == 0) {
+            type = GPX_TRACK;
+        }
+        else {
+            return;
+        }
+        state -> componentDepth = depth;
+        state -> component.type = type;
+        state -> component.numPoints = 0;
+        state -> component.numSegments = 0;
+        state -> component.length = 0;
+        state -> component.loop = FALSE;
+        state -> numData = 0;
+        state -> hasPrevious = FALSE;
+        state -> firstSegmentHasPoints = FALSE;
+        state -> lastSegmentPoints = 0;
+        free(state -> name);
+        state -> name = NULL;
+
+        // A waypoint is a point of its own
+        if (type == GPX_WAYPOINT) {
+            state -> pointDepth = depth;
+            readPointCoordinates(state, reader);
+        }
+        return;
+    }
+
+    // Children of a point are its name and its other data, anything below them is not read
+    if (state -> pointDepth != -1) {
+        if (depth == state -> pointDepth + 1) {
+            state -> value = (strcmp(name, "name") == 0) ? SCAN_VALUE_POINT_NAME : SCAN_VALUE_DATA;
+            state -> valueDepth = depth;
+        }
+        return;
+    }
+
+    // Children of a segment are its track points, any other element of the segment is not read
+    if (state -> segmentDepth != -1) {
+        if (depth == state -> segmentDepth + 1 && strcmp(name, "trkpt") == 0) {
+            state -> pointDepth = depth;
+            readPointCoordinates(state, reader);
+        }
+        return;
+    }
+
+    // Children of a route or track are its name, its points or segments, and its other data
+    if (depth != state -> componentDepth + 1) {
+        return;
+    }
+    if (state -> component.type == GPX_ROUTE && strcmp(name, "rtept") == 0) {
+        state -> pointDepth = depth;
+        readPointCoordinates(state, reader);
+    }
+    else if (state -> component.type == GPX_TRACK && strcmp(name, "trkseg") == 0) {
+        state -> segmentDepth = depth;
+        state -> segmentPoints = 0;
+        state -> segmentLength = 0;
+        state -> hasPrevious = FALSE;
+    }
+    else {
+        state -> value = (strcmp(name, "name") == 0) ? SCAN_VALUE_COMPONENT_NAME : SCAN_VALUE_DATA;
+        state -> valueDepth = depth;
+    }
+}
+
+static void readPointCoordinates(ScanState *state, xmlTextReaderPtr reader) {
+    state -> latitude = 0;
+    state -> longitude = 0;
+    state -> pointHasName = FALSE;
+
+    // Reading the lat and lon attributes, then moving back to the element so its children are read next
+    while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+        const char *name = (const char*)xmlTextReaderConstLocalName(reader);
+        const char *value = (const char*)xmlTextReaderConstValue(reader);
+        if (name == NULL || value == NULL) {
+            continue;
+        }
+        if (strcmp(name, "lat") == 0) {
+            state -> latitude = parseDecimal(value, NULL);
+        }
+        else if (strcmp(name, "lon") == 0) {
+            state -> longitude = parseDecimal(value, NULL);
+        }
+    }
+    xmlTextReaderMoveToElement(reader);
+}
+
+static void readValue(ScanState *state, const char *value) {
+    ScanValue kind = state -> value;
+    state -> value = SCAN_VALUE_NONE;
+
+    // Only the last name counts, as the GPXdoc keeps only the last one
+    if (kind == SCAN_VALUE_POINT_NAME) {
+        state -> pointHasName = (strcmp(value, "") != 0);
+    }
+    else if (kind == SCAN_VALUE_COMPONENT_NAME) {
+        free(state -> name);
+        state -> name = malloc(strlen(value) + 1);
+        strcpy(state -> name, value);
+    }
+
+    // Other data with an empty value does not meet the requirements of the header file
+    else if (kind == SCAN_VALUE_DATA) {
+        if (strcmp(value, "") == 0) {
+            fprintf(stderr, "GPXdoc does not meet the requirements of the header file\n");
+            state -> valid = FALSE;
+        }
+        state -> numData++;
+    }
+}
+
+static bool endElement(ScanState *state, int depth) {
+    if (depth == state -> pointDepth) {
+        endPoint(state);
+        state -> pointDepth = -1;
+    }
+    if (depth == state -> segmentDepth) {
+        endSegment(state);
+        state -> segmentDepth = -1;
+    }
+    if (depth == state -> componentDepth) {
+        state -> componentDepth = -1;
+        return(endComponent(state));
+    }
+    return(TRUE);
+}
+
+static void endPoint(ScanState *state) {
+    if (state -> pointHasName == TRUE) {
+        state -> numData++;
+    }
+    extendBox(&state -> scan -> box, state -> scan -> hasBox == FALSE, state -> latitude, state -> longitude);
+    state -> scan -> hasBox = TRUE;
+    if (state -> component.type == GPX_WAYPOINT) {
+        return;
+    }
+    extendBox(&state -> component.box, state -> component.numPoints == 0, state -> latitude, state -> longitude);
+
+    // Routes add up the length of every edge, tracks only of the edges inside a segment
+    if (state -> hasPrevious == TRUE) {
+        float distance = haversineDistance(state -> previousLatitude, state -> previousLongitude, state -> latitude, state -> longitude);
+        if (state -> component.type == GPX_ROUTE) {
+            state -> component.length += distance;
+        }
+        else {
+            state -> segmentLength += distance;
+        }
+    }
+    if (state -> component.numPoints == 0) {
+        state -> firstLatitude = state -> latitude;
+        state -> firstLongitude = state -> longitude;
+    }
+    state -> hasPrevious = TRUE;
+    state -> previousLatitude = state -> latitude;
+    state -> previousLongitude = state -> longitude;
+    state -> component.numPoints++;
+    state -> segmentPoints++;
+}
+
+static void endSegment(ScanState *state) {
+
+    // Each segment's length is summed on its own before it is added to the track, as getTrackLen sums it
+    state -> component.length += state -> segmentLength;
+    if (state -> component.numSegments == 0) {
+        state -> firstSegmentHasPoints = (state -> segmentPoints > 0);
+    }
+    state -> lastSegmentPoints = state -> segmentPoints;
+    state -> component.numSegments++;
+    state -> hasPrevious = FALSE;
+}
+
+static bool endComponent(ScanState *state) {
+    GPXScan *scan = state -> scan;
+    if (state -> component.type == GPX_WAYPOINT) {
+        scan -> numWaypoints++;
+        scan -> numGPXData += state -> numData;
+        return(TRUE);
+    }
+
+    // The name of a route or track is counted as data when it is not empty
+    const char *name = (state -> name != NULL) ? state -> name : "";
+    scan -> numGPXData += state -> numData + (strcmp(name, "") != 0);
+
+    // The ends are compared the way isLoopRoute and isLoopTrack compare them, a track whose first or last segment is empty is not a loop
+    bool hasEnds = (state -> component.type == GPX_ROUTE) || (state -> firstSegmentHasPoints == TRUE && state -> lastSegmentPoints > 0);
+    state -> component.loop = FALSE;
+    if (state -> component.numPoints >= 4 && hasEnds == TRUE) {
+        float distanceBetween = haversineDistance(state -> firstLatitude, state -> firstLongitude, state -> previousLatitude, state -> previousLongitude);
+        state -> component.loop = (distanceBetween <= SCAN_LOOP_DELTA);
+    }
+
+    if (state -> component.type == GPX_ROUTE) {
+        state -> component.position = scan -> numRoutes++;
+    }
+    else {
+        state -> component.position = scan -> numTracks++;
+        scan -> numSegments += state -> component.numSegments;
+    }
+    state -> component.name = name;
+
+    // Handing the summary to the callback, the name is freed when the next component starts or the scan ends
+    if (state -> onComponent != NULL && state -> onComponent(state -> context, &state -> component) == FALSE) {
+        state -> valid = FALSE;
+        return(FALSE);
+    }
+    return(TRUE);
+}
+
+static void extendBox(BoundingBox *box, bool empty, double latitude, double longitude) {
+    if (empty == TRUE) {
+        box -> minLatitude = latitude;
+        box -> maxLatitude = latitude;
+        box -> minLongitude = longitude;
+        box -> maxLongitude = longitude;
+        return;
+    }
+    box -> minLatitude = fmin(box -> minLatitude, latitude);
+    box -> maxLatitude = fmax(box -> maxLatitude, latitude);
+    box -> minLongitude = fmin(box -> minLongitude, longitude);
+    box -> maxLongitude = fmax(box -> maxLongitude, longitude);
+}
+
+static bool appendScannedComponent(void *context, const ScannedComponent *component) {
+    ScanSummary *summary = (ScanSummary*)context;
+    StringBuffer *buffer = (component -> type == GPX_ROUTE) ? &summary -> routes : &summary -> tracks;
+
+    // Each component is tagged with the file name, the way writeComponentsWithFileName tags the components of a GPXdoc
+    char *componentString = scannedComponentToJSON(component);
+    appendToStringBuffer(buffer, (component -> position == 0) ? "{\"fileName\":" : ",{\"fileName\":");
+    appendJSONStringToStringBuffer(buffer, summary -> fileName);
+    appendToStringBuffer(buffer, ",");
+    appendToStringBuffer(buffer, componentString + 1);
+    free(componentString);
+    return(TRUE);
+}
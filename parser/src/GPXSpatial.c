@@ -0,0 +1,977 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXSpatial.h"
+#include "GPXNumber.h"
+#include "GPXCompact.h"
+
+// Largest number of grid rows or columns, keeps the cell arrays bounded for very spread out documents
+#define MAX_GRID_SIDE 1024
+
+// A search for the components passing near a source and, for a through search, near a destination further along.
+// Holds the earliest position passing the source and the latest passing the destination of the component being checked
+typedef struct {
+    bool through;
+    double distance;
+    double latitudes[2];
+    double longitudes[2];
+    BoundingBox boxes[2];
+    double sourcePass;
+    double destPass;
+} PathSearch;
+
+static void addComponentToIndex(SpatialIndex *index, void *data, ComponentType type, int document, int position);
+static void addPointToIndex(SpatialIndex *index, double latitude, double longitude, int order);
+static void addEdgeToIndex(SpatialIndex *index, double latitude1, double longitude1, double latitude2, double longitude2, int order);
+static void addWaypointListToIndex(SpatialIndex *index, List *waypoints, int firstOrder);
+static void addSegmentToIndex(SpatialIndex *index, const TrackSegment *segment, int firstOrder);
+static void addWaypointsToIndex(SpatialIndex *index, const GPXdoc *doc, int document);
+static void addRoutesToIndex(SpatialIndex *index, const GPXdoc *doc, int document);
+static void addTracksToIndex(SpatialIndex *index, const GPXdoc *doc, int document);
+static int gridRow(const SpatialIndex *index, double latitude);
+static int gridColumn(const SpatialIndex *index, double longitude);
+static List *componentsAlongPath(const GPXdoc *doc, ComponentType type, bool through, double sourceLat, double sourceLong, double destLat, double destLong, double distance);
+static bool validPathSearch(double sourceLat, double sourceLong, double destLat, double destLong, double distance);
+static void searchPathEdge(PathSearch *search, double latitude1, double longitude1, double latitude2, double longitude2, int order);
+static void searchPathWaypoints(PathSearch *search, List *waypoints, int firstOrder);
+static int searchPathSegment(PathSearch *search, const TrackSegment *segment, int firstOrder);
+static bool pathSearchMatched(const PathSearch *search);
+static int compareEdgeNumbers(const void *first, const void *second);
+static int compareFractions(const void *first, const void *second);
+static const char *skipJSONWhitespace(const char *cursor);
+
+SpatialIndex *createSpatialIndex(void) {
+
+    // Allocating the index with empty component and edge arrays, the grid is only created by buildSpatialIndex
+    SpatialIndex *index = malloc(sizeof(SpatialIndex));
+    index -> components = NULL;
+    index -> numComponents = 0;
+    index -> componentCapacity = 0;
+    index -> edges = NULL;
+    index -> numEdges = 0;
+    index -> edgeCapacity = 0;
+    index -> rows = 0;
+    index -> columns = 0;
+    index -> cellHeight = 0;
+    index -> cellWidth = 0;
+    index -> cellStart = NULL;
+    index -> cellEdges = NULL;
+
+    return(index);
+}
+
+void deleteSpatialIndex(SpatialIndex *index) {
+    if (index == NULL) {
+        return;
+    }
+
+    // Freeing the arrays owned by the index and the index itself, the indexed components belong to their GPXdoc
+    free(index -> components);
+    free(index -> edges);
+    free(index -> cellStart);
+    free(index -> cellEdges);
+    free(index);
+}
+
+void addDocToSpatialIndex(SpatialIndex *index, const GPXdoc *doc, int document) {
+
+    // Error check the index and doc for NULL
+    if (index == NULL || doc == NULL) {
+        fprintf(stderr, "ERROR: SpatialIndex or GPXdoc is NULL\n");
+        return;
+    }
+
+    // Registering every waypoint, route and track of the doc
+    addWaypointsToIndex(index, doc, document);
+    addRoutesToIndex(index, doc, document);
+    addTracksToIndex(index, doc, document);
+}
+
+void buildSpatialIndex(SpatialIndex *index) {
+
+    // Error check the index for NULL
+    if (index == NULL) {
+        fprintf(stderr, "ERROR: SpatialIndex is NULL\n");
+        return;
+    }
+
+    // Throwing away any grid from a previous build
+    free(index -> cellStart);
+    free(index -> cellEdges);
+    index -> cellStart = NULL;
+    index -> cellEdges = NULL;
+    index -> rows = 0;
+    index -> columns = 0;
+
+    if (index -> numEdges == 0) {
+        return;
+    }
+
+    // Getting the extent of all the edges in the index
+    BoundingBox extent = index -> edges[0].box;
+    for (int i = 1; i < index -> numEdges; i++) {
+        BoundingBox box = index -> edges[i].box;
+        extent.minLatitude = fmin(extent.minLatitude, box.minLatitude);
+        extent.minLongitude = fmin(extent.minLongitude, box.minLongitude);
+        extent.maxLatitude = fmax(extent.maxLatitude, box.maxLatitude);
+        extent.maxLongitude = fmax(extent.maxLongitude, box.maxLongitude);
+    }
+    index -> extent = extent;
+
+    // Sizing the cells so that there is roughly one cell per edge, a flat extent still gets a non zero cell size
+    double height = fmax(extent.maxLatitude - extent.minLatitude, 1e-9);
+    double width = fmax(extent.maxLongitude - extent.minLongitude, 1e-9);
+    double cellSize = sqrt((height * width) / index -> numEdges);
+    int rows = (int)ceil(height / cellSize);
+    int columns = (int)ceil(width / cellSize);
+    index -> rows = (rows < 1) ? 1 : (rows > MAX_GRID_SIDE) ? MAX_GRID_SIDE : rows;
+    index -> columns = (columns < 1) ? 1 : (columns > MAX_GRID_SIDE) ? MAX_GRID_SIDE : columns;
+    index -> cellHeight = height / index -> rows;
+    index -> cellWidth = width / index -> columns;
+
+    // Counting how many edges overlap each cell, shifted by one so the counts become the start offsets below
+    int numCells = index -> rows * index -> columns;
+    index -> cellStart = calloc(numCells + 1, sizeof(int));
+    for (int i = 0; i < index -> numEdges; i++) {
+        BoundingBox box = index -> edges[i].box;
+        for (int row = gridRow(index, box.minLatitude); row <= gridRow(index, box.maxLatitude); row++) {
+            for (int column = gridColumn(index, box.minLongitude); column <= gridColumn(index, box.maxLongitude); column++) {
+                index -> cellStart[row * index -> columns + column + 1]++;
+            }
+        }
+    }
+
+    // Turning the counts into offsets into the cellEdges array
+    for (int cell = 0; cell < numCells; cell++) {
+        index -> cellStart[cell + 1] += index -> cellStart[cell];
+    }
+
+    // Placing every edge in all the cells its bounding box overlaps, edges stay in ascending order inside a cell
+    int *fill = malloc(numCells * sizeof(int));
+    memcpy(fill, index -> cellStart, numCells * sizeof(int));
+    index -> cellEdges = malloc(index -> cellStart[numCells] * sizeof(int));
+    for (int i = 0; i < index -> numEdges; i++) {
+        BoundingBox box = index -> edges[i].box;
+        for (int row = gridRow(index, box.minLatitude); row <= gridRow(index, box.maxLatitude); row++) {
+            for (int column = gridColumn(index, box.minLongitude); column <= gridColumn(index, box.maxLongitude); column++) {
+                index -> cellEdges[fill[row * index -> columns + column]++] = i;
+            }
+        }
+    }
+    free(fill);
+}
+
+void searchSpatialIndex(const SpatialIndex *index, double latitude, double longitude, double distance, double *firstPass, double *lastPass) {
+
+    // Error check the index for NULL and make sure it has been built
+    if (index == NULL || index -> cellStart == NULL) {
+        return;
+    }
+
+    // Only cells overlapping the box around the search point can hold edges within the distance
+    BoundingBox searchBox = boxAroundPoint(latitude, longitude, distance);
+    if (boxesIntersect(searchBox, index -> extent) == FALSE) {
+        return;
+    }
+
+    int firstRow = gridRow(index, searchBox.minLatitude);
+    int lastRow = gridRow(index, searchBox.maxLatitude);
+    int firstColumn = gridColumn(index, searchBox.minLongitude);
+    int lastColumn = gridColumn(index, searchBox.maxLongitude);
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            int cell = row * index -> columns + column;
+
+            for (int i = index -> cellStart[cell]; i < index -> cellStart[cell + 1]; i++) {
+                const IndexedEdge *edge = &index -> edges[index -> cellEdges[i]];
+
+                // An edge spanning several cells is only looked at in the first cell it shares with the search box
+                int edgeRow = gridRow(index, edge -> box.minLatitude);
+                int edgeColumn = gridColumn(index, edge -> box.minLongitude);
+                if (row != ((edgeRow > firstRow) ? edgeRow : firstRow) || column != ((edgeColumn > firstColumn) ? edgeColumn : firstColumn)) {
+                    continue;
+                }
+
+                // Cheap bounding box rejection before the exact point to edge distance
+                if (boxesIntersect(searchBox, edge -> box) == FALSE) {
+                    continue;
+                }
+
+                double fraction = 0;
+                if (distanceToEdge(latitude, longitude, edge, &fraction) > distance) {
+                    continue;
+                }
+
+                // Recording the earliest and latest position along the component path that passes within the distance
+                double position = edge -> order + fraction;
+                if (firstPass != NULL && (firstPass[edge -> component] < 0 || position < firstPass[edge -> component])) {
+                    firstPass[edge -> component] = position;
+                }
+                if (lastPass != NULL && position > lastPass[edge -> component]) {
+                    lastPass[edge -> component] = position;
+                }
+            }
+        }
+    }
+}
+
+int candidateEdgesInBox(const SpatialIndex *index, BoundingBox box, int **edges) {
+
+    *edges = NULL;
+
+    // Error check the index for NULL and make sure it has been built
+    if (index == NULL || index -> cellStart == NULL || boxesIntersect(box, index -> extent) == FALSE) {
+        return(0);
+    }
+
+    int firstRow = gridRow(index, box.minLatitude);
+    int lastRow = gridRow(index, box.maxLatitude);
+    int firstColumn = gridColumn(index, box.minLongitude);
+    int lastColumn = gridColumn(index, box.maxLongitude);
+
+    int numCandidates = 0;
+    int capacity = 64;
+    int *candidates = malloc(capacity * sizeof(int));
+
+    for (int row = firstRow; row <= lastRow; row++) {
+        for (int column = firstColumn; column <= lastColumn; column++) {
+            int cell = row * index -> columns + column;
+
+            for (int i = index -> cellStart[cell]; i < index -> cellStart[cell + 1]; i++) {
+                const IndexedEdge *edge = &index -> edges[index -> cellEdges[i]];
+
+                // An edge spanning several cells is only taken from the first cell it shares with the box
+                int edgeRow = gridRow(index, edge -> box.minLatitude);
+                int edgeColumn = gridColumn(index, edge -> box.minLongitude);
+                if (row != ((edgeRow > firstRow) ? edgeRow : firstRow) || column != ((edgeColumn > firstColumn) ? edgeColumn : firstColumn)) {
+                    continue;
+                }
+
+                // Only edges whose own bounding box overlaps are candidates
+                if (boxesIntersect(box, edge -> box) == FALSE) {
+                    continue;
+                }
+
+                if (numCandidates == capacity) {
+                    capacity *= 2;
+                    candidates = realloc(candidates, capacity * sizeof(int));
+                }
+                candidates[numCandidates++] = index -> cellEdges[i];
+            }
+        }
+    }
+
+    // Edges are numbered component by component in path order, so sorting the numbers puts the candidates in path order
+    qsort(candidates, numCandidates, sizeof(int), &compareEdgeNumbers);
+
+    *edges = candidates;
+    return(numCandidates);
+}
+
+bool boxesIntersect(BoundingBox box1, BoundingBox box2) {
+
+    // Two boxes overlap unless one lies completely to one side of the other
+    if (box1.maxLatitude < box2.minLatitude || box2.maxLatitude < box1.minLatitude) {
+        return(FALSE);
+    }
+    if (box1.maxLongitude < box2.minLongitude || box2.maxLongitude < box1.minLongitude) {
+        return(FALSE);
+    }
+    return(TRUE);
+}
+
+BoundingBox boxAroundPoint(double latitude, double longitude, double distance) {
+
+    // Converting the distance in meters to degrees of latitude, and to degrees of longitude which get narrower towards the poles
+    double latitudeDegrees = (distance / EARTH_RADIUS) * (180 / M_PI);
+    double longitudeDegrees = latitudeDegrees / fmax(cos(latitude * (M_PI / 180)), 1e-6);
+
+    BoundingBox box;
+    box.minLatitude = latitude - latitudeDegrees;
+    box.maxLatitude = latitude + latitudeDegrees;
+    box.minLongitude = longitude - longitudeDegrees;
+    box.maxLongitude = longitude + longitudeDegrees;
+    return(box);
+}
+
+// Distance in meters from a point to the closest point of an edge, using an equirectangular projection centered on the point
+// which is accurate to well under a meter for the search distances used when looking for paths
+double distanceToEdge(double latitude, double longitude, const IndexedEdge *edge, double *fraction) {
+
+    // Meters per degree of latitude and of longitude around the point
+    double metersLatitude = EARTH_RADIUS * (M_PI / 180);
+    double metersLongitude = metersLatitude * cos(latitude * (M_PI / 180));
+
+    // Projecting both ends of the edge into meters relative to the point
+    double x1 = (edge -> longitude1 - longitude) * metersLongitude;
+    double y1 = (edge -> latitude1 - latitude) * metersLatitude;
+    double x2 = (edge -> longitude2 - longitude) * metersLongitude;
+    double y2 = (edge -> latitude2 - latitude) * metersLatitude;
+
+    // Finding how far along the edge the point projects, clamped to the ends of the edge
+    double dx = x2 - x1;
+    double dy = y2 - y1;
+    double lengthSquared = dx * dx + dy * dy;
+    double t = 0;
+    if (lengthSquared > 0) {
+        t = -(x1 * dx + y1 * dy) / lengthSquared;
+        t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+    }
+
+    if (fraction != NULL) {
+        *fraction = t;
+    }
+
+    // Returning the length of the vector from the point to its projection on the edge
+    return(hypot(x1 + t * dx, y1 + t * dy));
+}
+
+Polygon *JSONtoPolygon(const char *ringsJSON) {
+
+    // Error check ringsJSON for NULL
+    if (ringsJSON == NULL) {
+        fprintf(stderr, "ERROR: Polygon JSON string is NULL\n");
+        return(NULL);
+    }
+
+    // A whole GeoJSON Polygon geometry is accepted as well as a bare list of rings
+    const char *cursor = skipJSONWhitespace(ringsJSON);
+    if (*cursor == '{') {
+        cursor = strstr(cursor, "\"coordinates\"");
+        if (cursor == NULL || (cursor = strchr(cursor, '[')) == NULL) {
+            fprintf(stderr, "ERROR: Polygon JSON object has no coordinates\n");
+            return(NULL);
+        }
+    }
+    if (*cursor != '[') {
+        fprintf(stderr, "ERROR: Polygon JSON is not a list of rings\n");
+        return(NULL);
+    }
+
+    // Allocating the polygon with room for a few rings and points, both grow as they are read
+    Polygon *polygon = malloc(sizeof(Polygon));
+    int ringCapacity = 4;
+    int pointCapacity = 64;
+    polygon -> numRings = 0;
+    polygon -> numPoints = 0;
+    polygon -> ringStart = malloc((ringCapacity + 1) * sizeof(int));
+    polygon -> latitudes = malloc(pointCapacity * sizeof(double));
+    polygon -> longitudes = malloc(pointCapacity * sizeof(double));
+    polygon -> ringStart[0] = 0;
+
+    // Reading every ring, each ring is a list of [longitude, latitude] positions as in GeoJSON
+    cursor = skipJSONWhitespace(cursor + 1);
+    while (*cursor == '[') {
+        cursor = skipJSONWhitespace(cursor + 1);
+
+        while (*cursor == '[') {
+            char *end = NULL;
+            double longitude = parseDecimal(cursor + 1, &end);
+            cursor = skipJSONWhitespace(end);
+            if (end == NULL || *cursor != ',') {
+                break;
+            }
+            double latitude = parseDecimal(cursor + 1, &end);
+            if (end == cursor + 1) {
+                break;
+            }
+
+            // Skipping an altitude or any other extra value in the position
+            cursor = strchr(end, ']');
+            if (cursor == NULL) {
+                break;
+            }
+
+            if (polygon -> numPoints == pointCapacity) {
+                pointCapacity *= 2;
+                polygon -> latitudes = realloc(polygon -> latitudes, pointCapacity * sizeof(double));
+                polygon -> longitudes = realloc(polygon -> longitudes, pointCapacity * sizeof(double));
+            }
+            polygon -> latitudes[polygon -> numPoints] = latitude;
+            polygon -> longitudes[polygon -> numPoints] = longitude;
+            polygon -> numPoints++;
+
+            cursor = skipJSONWhitespace(cursor + 1);
+            if (*cursor == ',') {
+                cursor = skipJSONWhitespace(cursor + 1);
+            }
+        }
+
+        // Every position of the ring has to be read up to its closing bracket
+        if (cursor == NULL || *cursor != ']') {
+            break;
+        }
+
+        // Rings with less than 3 points do not enclose anything and are dropped
+        if (polygon -> numPoints - polygon -> ringStart[polygon -> numRings] < 3) {
+            polygon -> numPoints = polygon -> ringStart[polygon -> numRings];
+        }
+        else {
+            if (polygon -> numRings == ringCapacity) {
+                ringCapacity *= 2;
+                polygon -> ringStart = realloc(polygon -> ringStart, (ringCapacity + 1) * sizeof(int));
+            }
+            polygon -> numRings++;
+            polygon -> ringStart[polygon -> numRings] = polygon -> numPoints;
+        }
+
+        cursor = skipJSONWhitespace(cursor + 1);
+        if (*cursor == ',') {
+            cursor = skipJSONWhitespace(cursor + 1);
+        }
+    }
+
+    // Anything other than the closing bracket of the ring list means the JSON was malformed
+    if (cursor == NULL || *cursor != ']' || polygon -> numRings == 0) {
+        fprintf(stderr, "ERROR: Polygon JSON is malformed or has no ring with at least 3 points\n");
+        deletePolygon(polygon);
+        return(NULL);
+    }
+
+    // Getting the bounding box of the polygon, holes lie inside the outer ring so only its points matter
+    polygon -> box.minLatitude = polygon -> box.maxLatitude = polygon -> latitudes[0];
+    polygon -> box.minLongitude = polygon -> box.maxLongitude = polygon -> longitudes[0];
+    for (int i = 1; i < polygon -> numPoints; i++) {
+        polygon -> box.minLatitude = fmin(polygon -> box.minLatitude, polygon -> latitudes[i]);
+        polygon -> box.maxLatitude = fmax(polygon -> box.maxLatitude, polygon -> latitudes[i]);
+        polygon -> box.minLongitude = fmin(polygon -> box.minLongitude, polygon -> longitudes[i]);
+        polygon -> box.maxLongitude = fmax(polygon -> box.maxLongitude, polygon -> longitudes[i]);
+    }
+
+    return(polygon);
+}
+
+void deletePolygon(Polygon *polygon) {
+    if (polygon == NULL) {
+        return;
+    }
+
+    // Freeing the point and ring arrays and then the polygon itself
+    free(polygon -> ringStart);
+    free(polygon -> latitudes);
+    free(polygon -> longitudes);
+    free(polygon);
+}
+
+bool pointInPolygon(const Polygon *polygon, double latitude, double longitude) {
+
+    // Points outside the bounding box can not be inside
+    if (latitude < polygon -> box.minLatitude || latitude > polygon -> box.maxLatitude || longitude < polygon -> box.minLongitude || longitude > polygon -> box.maxLongitude) {
+        return(FALSE);
+    }
+
+    // Casting a ray towards increasing longitude and counting how many ring edges it crosses, holes flip the result back
+    bool inside = FALSE;
+    for (int ring = 0; ring < polygon -> numRings; ring++) {
+        int first = polygon -> ringStart[ring];
+        int last = polygon -> ringStart[ring + 1] - 1;
+
+        for (int i = first, j = last; i <= last; j = i++) {
+            double latitudeI = polygon -> latitudes[i];
+            double latitudeJ = polygon -> latitudes[j];
+            if ((latitudeI > latitude) != (latitudeJ > latitude)) {
+                double crossing = polygon -> longitudes[i] + (latitude - latitudeI) * (polygon -> longitudes[j] - polygon -> longitudes[i]) / (latitudeJ - latitudeI);
+                if (longitude < crossing) {
+                    inside = !inside;
+                }
+            }
+        }
+    }
+
+    return(inside);
+}
+
+// Splits an edge at every place it crosses the polygon boundary and returns the pieces that are inside the polygon,
+// as fractions of the way from the first to the second end of the edge
+int clipEdgeToPolygon(const Polygon *polygon, const IndexedEdge *edge, double *enter, double *leave, int maxPieces) {
+
+    // A single point edge is either inside or not
+    if (edge -> latitude1 == edge -> latitude2 && edge -> longitude1 == edge -> longitude2) {
+        if (maxPieces > 0 && pointInPolygon(polygon, edge -> latitude1, edge -> longitude1) == TRUE) {
+            enter[0] = 0;
+            leave[0] = 0;
+            return(1);
+        }
+        return(0);
+    }
+
+    // Small polygons use a stack array for the crossing fractions, larger ones fall back to the heap
+    double stackFractions[256];
+    double *fractions = stackFractions;
+    if (polygon -> numPoints + 2 > 256) {
+        fractions = malloc((polygon -> numPoints + 2) * sizeof(double));
+    }
+
+    // The ends of the edge always split it
+    int numFractions = 0;
+    fractions[numFractions++] = 0;
+    fractions[numFractions++] = 1;
+
+    // Finding where the edge crosses each ring edge, as a fraction along the edge
+    double edgeLongitude = edge -> longitude2 - edge -> longitude1;
+    double edgeLatitude = edge -> latitude2 - edge -> latitude1;
+    for (int ring = 0; ring < polygon -> numRings; ring++) {
+        int first = polygon -> ringStart[ring];
+        int last = polygon -> ringStart[ring + 1] - 1;
+
+        for (int i = first, j = last; i <= last; j = i++) {
+            double ringLongitude = polygon -> longitudes[i] - polygon -> longitudes[j];
+            double ringLatitude = polygon -> latitudes[i] - polygon -> latitudes[j];
+            double denominator = edgeLongitude * ringLatitude - edgeLatitude * ringLongitude;
+
+            // Parallel edges never cross at a single point
+            if (denominator == 0) {
+                continue;
+            }
+
+            double startLongitude = polygon -> longitudes[j] - edge -> longitude1;
+            double startLatitude = polygon -> latitudes[j] - edge -> latitude1;
+            double t = (startLongitude * ringLatitude - startLatitude * ringLongitude) / denominator;
+            double u = (startLongitude * edgeLatitude - startLatitude * edgeLongitude) / denominator;
+            if (t > 0 && t < 1 && u >= 0 && u <= 1) {
+                fractions[numFractions++] = t;
+            }
+        }
+    }
+
+    qsort(fractions, numFractions, sizeof(double), &compareFractions);
+
+    // Each piece between two crossings is entirely inside or outside, so testing its middle decides it
+    int numPieces = 0;
+    for (int i = 0; i + 1 < numFractions; i++) {
+        double start = fractions[i];
+        double end = fractions[i + 1];
+        if (end <= start) {
+            continue;
+        }
+
+        double middle = (start + end) / 2;
+        if (pointInPolygon(polygon, edge -> latitude1 + middle * edgeLatitude, edge -> longitude1 + middle * edgeLongitude) == FALSE) {
+            continue;
+        }
+
+        // Joining the piece to the previous one when they touch
+        if (numPieces > 0 && leave[numPieces - 1] == start) {
+            leave[numPieces - 1] = end;
+        }
+        else if (numPieces < maxPieces) {
+            enter[numPieces] = start;
+            leave[numPieces] = end;
+            numPieces++;
+        }
+    }
+
+    if (fractions != stackFractions) {
+        free(fractions);
+    }
+    return(numPieces);
+}
+
+List* getRoutesNear(const GPXdoc* doc, float latitude, float longitude, float distance) {
+    return(componentsAlongPath(doc, GPX_ROUTE, FALSE, latitude, longitude, 0, 0, distance));
+}
+
+List* getTracksNear(const GPXdoc* doc, float latitude, float longitude, float distance) {
+    return(componentsAlongPath(doc, GPX_TRACK, FALSE, latitude, longitude, 0, 0, distance));
+}
+
+List* getRoutesThrough(const GPXdoc* doc, float sourceLat, float sourceLong, float destLat, float destLong, float distance) {
+    return(componentsAlongPath(doc, GPX_ROUTE, TRUE, sourceLat, sourceLong, destLat, destLong, distance));
+}
+
+List* getTracksThrough(const GPXdoc* doc, float sourceLat, float sourceLong, float destLat, float destLong, float distance) {
+    return(componentsAlongPath(doc, GPX_TRACK, TRUE, sourceLat, sourceLong, destLat, destLong, distance));
+}
+
+static List *componentsAlongPath(const GPXdoc *doc, ComponentType type, bool through, double sourceLat, double sourceLong, double destLat, double destLong, double distance) {
+
+    // Error check the GPXdoc structure for NULL, the distance for a negative value and every argument for NaN or infinity,
+    // which would make every distance comparison false and let every component match
+    if (doc == NULL || validPathSearch(sourceLat, sourceLong, destLat, destLong, distance) == FALSE) {
+        fprintf(stderr, "ERROR: GPXdoc structure is NULL or distance is negative or a coordinate or distance is not a number\n");
+        return(NULL);
+    }
+
+    // A single document is searched in one pass over its edges, each rejected by its bounding box before the exact distance.
+    // Building a SpatialIndex would walk every edge as well, so the index is only used by the corpus queries that share one
+    PathSearch search;
+    search.through = through;
+    search.distance = distance;
+    search.latitudes[0] = sourceLat;
+    search.longitudes[0] = sourceLong;
+    search.latitudes[1] = destLat;
+    search.longitudes[1] = destLong;
+    search.boxes[0] = boxAroundPoint(sourceLat, sourceLong, distance);
+    search.boxes[1] = boxAroundPoint(destLat, destLong, distance);
+
+    // Creating a list that only references the matching components, they still belong to the doc
+    List *componentList = NULL;
+    if (type == GPX_ROUTE) {
+        componentList = initializeList(&routeToString, &dummyDelete, &compareRoutes);
+        void *routeElement;
+        ListIterator routeIterator = createIterator(doc -> routes);
+        while ((routeElement = nextElement(&routeIterator)) != NULL) {
+            search.sourcePass = -1;
+            search.destPass = -1;
+            searchPathWaypoints(&search, ((Route*)routeElement) -> waypoints, 0);
+            if (pathSearchMatched(&search) == TRUE) {
+                insertBack(componentList, routeElement);
+            }
+        }
+    }
+    else {
+        componentList = initializeList(&trackToString, &dummyDelete, &compareTracks);
+        void *trackElement;
+        ListIterator trackIterator = createIterator(doc -> tracks);
+        while ((trackElement = nextElement(&trackIterator)) != NULL) {
+            search.sourcePass = -1;
+            search.destPass = -1;
+
+            // Segments are not joined to each other but their point positions carry on, as they do in the index
+            int numPoints = 0;
+            void *segmentElement;
+            ListIterator segmentIterator = createIterator(((Track*)trackElement) -> segments);
+            while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+                numPoints += searchPathSegment(&search, (TrackSegment*)segmentElement, numPoints);
+            }
+            if (pathSearchMatched(&search) == TRUE) {
+                insertBack(componentList, trackElement);
+            }
+        }
+    }
+
+    // Like getRoutesBetween and getTracksBetween, NULL is returned when nothing matched
+    if (getLength(componentList) == 0) {
+        freeList(componentList);
+        return(NULL);
+    }
+
+    return(componentList);
+}
+
+int searchPathInSpatialIndex(const SpatialIndex *index, ComponentType type, bool through, double sourceLat, double sourceLong, double destLat, double destLong, double distance, int **components) {
+
+    *components = NULL;
+
+    // Error check the index for NULL and the arguments the way componentsAlongPath checks them
+    if (index == NULL || validPathSearch(sourceLat, sourceLong, destLat, destLong, distance) == FALSE) {
+        fprintf(stderr, "ERROR: SpatialIndex is NULL or distance is negative or a coordinate or distance is not a number\n");
+        return(0);
+    }
+
+    // Positions along each component where it passes the source and the destination, -1 when it never does
+    double *sourcePass = malloc((index -> numComponents + 1) * sizeof(double));
+    double *destPass = malloc((index -> numComponents + 1) * sizeof(double));
+    for (int i = 0; i < index -> numComponents; i++) {
+        sourcePass[i] = -1;
+        destPass[i] = -1;
+    }
+
+    // The source has to be passed as early as possible and the destination as late as possible for an in order match
+    searchSpatialIndex(index, sourceLat, sourceLong, distance, sourcePass, NULL);
+    if (through == TRUE) {
+        searchSpatialIndex(index, destLat, destLong, distance, NULL, destPass);
+    }
+
+    // Listing the matching components of the type asked for, in the order they were added to the index
+    int numMatches = 0;
+    int *matches = malloc((index -> numComponents + 1) * sizeof(int));
+    for (int i = 0; i < index -> numComponents; i++) {
+        if (index -> components[i].type != type || sourcePass[i] < 0) {
+            continue;
+        }
+        if (through == TRUE && (destPass[i] < 0 || destPass[i] < sourcePass[i])) {
+            continue;
+        }
+        matches[numMatches++] = i;
+    }
+
+    free(sourcePass);
+    free(destPass);
+    *components = matches;
+    return(numMatches);
+}
+
+static bool validPathSearch(double sourceLat, double sourceLong, double destLat, double destLong, double distance) {
+    return(distance >= 0 && isfinite(distance) && isfinite(sourceLat) && isfinite(sourceLong) && isfinite(destLat) && isfinite(destLong));
+}
+
+static void searchPathEdge(PathSearch *search, double latitude1, double longitude1, double latitude2, double longitude2, int order) {
+
+    // The edge is laid out the way addEdgeToIndex stores it, so the distances are the ones searchSpatialIndex works out
+    IndexedEdge edge;
+    edge.latitude1 = latitude1;
+    edge.longitude1 = longitude1;
+    edge.latitude2 = latitude2;
+    edge.longitude2 = longitude2;
+    edge.box.minLatitude = fmin(latitude1, latitude2);
+    edge.box.maxLatitude = fmax(latitude1, latitude2);
+    edge.box.minLongitude = fmin(longitude1, longitude2);
+    edge.box.maxLongitude = fmax(longitude1, longitude2);
+
+    // Recording the earliest position passing the source and, for a through search, the latest passing the destination
+    double fraction = 0;
+    if (boxesIntersect(search -> boxes[0], edge.box) == TRUE && distanceToEdge(search -> latitudes[0], search -> longitudes[0], &edge, &fraction) <= search -> distance) {
+        if (search -> sourcePass < 0 || order + fraction < search -> sourcePass) {
+            search -> sourcePass = order + fraction;
+        }
+    }
+    if (search -> through == TRUE && boxesIntersect(search -> boxes[1], edge.box) == TRUE && distanceToEdge(search -> latitudes[1], search -> longitudes[1], &edge, &fraction) <= search -> distance) {
+        if (order + fraction > search -> destPass) {
+            search -> destPass = order + fraction;
+        }
+    }
+}
+
+static void searchPathWaypoints(PathSearch *search, List *waypoints, int firstOrder) {
+
+    // Checking the edge between every pair of consecutive waypoints, the edges addWaypointListToIndex adds
+    void *waypointElement;
+    Waypoint *previous = NULL;
+    int order = firstOrder;
+    ListIterator waypointIterator = createIterator(waypoints);
+    while ((waypointElement = nextElement(&waypointIterator)) != NULL) {
+        Waypoint *waypoint = (Waypoint*)waypointElement;
+        if (previous != NULL) {
+            searchPathEdge(search, previous -> latitude, previous -> longitude, waypoint -> latitude, waypoint -> longitude, order - 1);
+        }
+        previous = waypoint;
+        order++;
+    }
+
+    // A list with a single waypoint is checked as a point
+    if (order - firstOrder == 1) {
+        searchPathEdge(search, previous -> latitude, previous -> longitude, previous -> latitude, previous -> longitude, firstOrder);
+    }
+}
+
+static int searchPathSegment(PathSearch *search, const TrackSegment *segment, int firstOrder) {
+
+    // Checking the edge between every pair of consecutive points, the edges addSegmentToIndex adds
+    double previousLatitude = 0;
+    double previousLongitude = 0;
+    int order = firstOrder;
+    SegmentCursor cursor;
+    openSegmentCursor(&cursor, segment);
+    while (nextSegmentRun(&cursor) > 0) {
+        for (int64_t i = 0; i < cursor.numPoints; i++) {
+            if (order > firstOrder) {
+                searchPathEdge(search, previousLatitude, previousLongitude, cursor.latitudes[i], cursor.longitudes[i], order - 1);
+            }
+            previousLatitude = cursor.latitudes[i];
+            previousLongitude = cursor.longitudes[i];
+            order++;
+        }
+    }
+
+    // A segment with a single point is checked as a point
+    if (order - firstOrder == 1) {
+        searchPathEdge(search, previousLatitude, previousLongitude, previousLatitude, previousLongitude, firstOrder);
+    }
+    return(order - firstOrder);
+}
+
+static bool pathSearchMatched(const PathSearch *search) {
+
+    // The source has to be passed, and for a through search the destination has to be passed at or after it
+    if (search -> sourcePass < 0) {
+        return(FALSE);
+    }
+    return(search -> through == FALSE || search -> destPass >= search -> sourcePass);
+}
+
+static void addComponentToIndex(SpatialIndex *index, void *data, ComponentType type, int document, int position) {
+
+    // Growing the component array when it is full
+    if (index -> numComponents == index -> componentCapacity) {
+        index -> componentCapacity = (index -> componentCapacity == 0) ? 16 : index -> componentCapacity * 2;
+        index -> components = realloc(index -> components, index -> componentCapacity * sizeof(IndexedComponent));
+    }
+
+    // The component starts with no edges, its box is widened as edges are added
+    IndexedComponent *component = &index -> components[index -> numComponents];
+    component -> data = data;
+    component -> type = type;
+    component -> document = document;
+    component -> position = position;
+    component -> firstEdge = index -> numEdges;
+    component -> numEdges = 0;
+    component -> numPoints = 0;
+    component -> box.minLatitude = 0;
+    component -> box.minLongitude = 0;
+    component -> box.maxLatitude = 0;
+    component -> box.maxLongitude = 0;
+    index -> numComponents++;
+}
+
+static void addEdgeToIndex(SpatialIndex *index, double latitude1, double longitude1, double latitude2, double longitude2, int order) {
+
+    // Growing the edge array when it is full
+    if (index -> numEdges == index -> edgeCapacity) {
+        index -> edgeCapacity = (index -> edgeCapacity == 0) ? 64 : index -> edgeCapacity * 2;
+        index -> edges = realloc(index -> edges, index -> edgeCapacity * sizeof(IndexedEdge));
+    }
+
+    // Storing the ends of the edge and its bounding box
+    IndexedEdge *edge = &index -> edges[index -> numEdges];
+    edge -> latitude1 = latitude1;
+    edge -> longitude1 = longitude1;
+    edge -> latitude2 = latitude2;
+    edge -> longitude2 = longitude2;
+    edge -> order = order;
+    edge -> component = index -> numComponents - 1;
+    edge -> box.minLatitude = fmin(latitude1, latitude2);
+    edge -> box.maxLatitude = fmax(latitude1, latitude2);
+    edge -> box.minLongitude = fmin(longitude1, longitude2);
+    edge -> box.maxLongitude = fmax(longitude1, longitude2);
+    index -> numEdges++;
+
+    // Widening the bounding box of the component that owns the edge
+    IndexedComponent *component = &index -> components[edge -> component];
+    if (component -> numEdges == 0) {
+        component -> box = edge -> box;
+    }
+    else {
+        component -> box.minLatitude = fmin(component -> box.minLatitude, edge -> box.minLatitude);
+        component -> box.maxLatitude = fmax(component -> box.maxLatitude, edge -> box.maxLatitude);
+        component -> box.minLongitude = fmin(component -> box.minLongitude, edge -> box.minLongitude);
+        component -> box.maxLongitude = fmax(component -> box.maxLongitude, edge -> box.maxLongitude);
+    }
+    component -> numEdges++;
+}
+
+static void addPointToIndex(SpatialIndex *index, double latitude, double longitude, int order) {
+
+    // A lone point is stored as an edge that starts and ends on it
+    addEdgeToIndex(index, latitude, longitude, latitude, longitude, order);
+}
+
+static void addWaypointListToIndex(SpatialIndex *index, List *waypoints, int firstOrder) {
+
+    // Adding an edge between every pair of consecutive waypoints in the list
+    void *waypointElement;
+    Waypoint *previous = NULL;
+    int order = firstOrder;
+    ListIterator waypointIterator = createIterator(waypoints);
+    while ((waypointElement = nextElement(&waypointIterator)) != NULL) {
+        Waypoint *waypoint = (Waypoint*)waypointElement;
+        if (previous != NULL) {
+            addEdgeToIndex(index, previous -> latitude, previous -> longitude, waypoint -> latitude, waypoint -> longitude, order - 1);
+        }
+        previous = waypoint;
+        order++;
+    }
+
+    // A list with a single waypoint still has to be findable
+    if (getLength(waypoints) == 1) {
+        addPointToIndex(index, previous -> latitude, previous -> longitude, firstOrder);
+    }
+
+    index -> components[index -> numComponents - 1].numPoints += getLength(waypoints);
+}
+
+static void addSegmentToIndex(SpatialIndex *index, const TrackSegment *segment, int firstOrder) {
+
+    // Adding an edge between every pair of consecutive points, the last point of a run is carried over to the next one
+    double previousLatitude = 0;
+    double previousLongitude = 0;
+    int order = firstOrder;
+    SegmentCursor cursor;
+    openSegmentCursor(&cursor, segment);
+    while (nextSegmentRun(&cursor) > 0) {
+        for (int64_t i = 0; i < cursor.numPoints; i++) {
+            if (order > firstOrder) {
+                addEdgeToIndex(index, previousLatitude, previousLongitude, cursor.latitudes[i], cursor.longitudes[i], order - 1);
+            }
+            previousLatitude = cursor.latitudes[i];
+            previousLongitude = cursor.longitudes[i];
+            order++;
+        }
+    }
+
+    // A segment with a single point still has to be findable
+    if (order - firstOrder == 1) {
+        addPointToIndex(index, previousLatitude, previousLongitude, firstOrder);
+    }
+
+    index -> components[index -> numComponents - 1].numPoints += order - firstOrder;
+}
+
+static void addWaypointsToIndex(SpatialIndex *index, const GPXdoc *doc, int document) {
+
+    // Every waypoint in the doc is its own single point component
+    void *waypointElement;
+    int position = 0;
+    ListIterator waypointIterator = createIterator(doc -> waypoints);
+    while ((waypointElement = nextElement(&waypointIterator)) != NULL) {
+        Waypoint *waypoint = (Waypoint*)waypointElement;
+        addComponentToIndex(index, waypoint, GPX_WAYPOINT, document, position++);
+        addPointToIndex(index, waypoint -> latitude, waypoint -> longitude, 0);
+        index -> components[index -> numComponents - 1].numPoints = 1;
+    }
+}
+
+static void addRoutesToIndex(SpatialIndex *index, const GPXdoc *doc, int document) {
+
+    // Adding the path of every route in the doc
+    void *routeElement;
+    int position = 0;
+    ListIterator routeIterator = createIterator(doc -> routes);
+    while ((routeElement = nextElement(&routeIterator)) != NULL) {
+        Route *route = (Route*)routeElement;
+        addComponentToIndex(index, route, GPX_ROUTE, document, position++);
+        addWaypointListToIndex(index, route -> waypoints, 0);
+    }
+}
+
+static void addTracksToIndex(SpatialIndex *index, const GPXdoc *doc, int document) {
+
+    // Adding the path of every track in the doc, segments are not joined to each other but their point positions carry on
+    void *trackElement;
+    int position = 0;
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+        Track *track = (Track*)trackElement;
+        addComponentToIndex(index, track, GPX_TRACK, document, position++);
+
+        void *segmentElement;
+        ListIterator segmentIterator = createIterator(track -> segments);
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            addSegmentToIndex(index, (TrackSegment*)segmentElement, index -> components[index -> numComponents - 1].numPoints);
+        }
+    }
+}
+
+static int gridRow(const SpatialIndex *index, double latitude) {
+
+    // Clamping to the grid so coordinates outside the extent map onto the border cells
+    int row = (int)floor((latitude - index -> extent.minLatitude) / index -> cellHeight);
+    return((row < 0) ? 0 : (row >= index -> rows) ? index -> rows - 1 : row);
+}
+
+static int gridColumn(const SpatialIndex *index, double longitude) {
+
+    // Clamping to the grid so coordinates outside the extent map onto the border cells
+    int column = (int)floor((longitude - index -> extent.minLongitude) / index -> cellWidth);
+    return((column < 0) ? 0 : (column >= index -> columns) ? index -> columns - 1 : column);
+}
+
+static int compareEdgeNumbers(const void *first, const void *second) {
+    int edge1 = *(const int*)first;
+    int edge2 = *(const int*)second;
+    return((edge1 > edge2) - (edge1 < edge2));
+}
+
+static int compareFractions(const void *first, const void *second) {
+    double fraction1 = *(const double*)first;
+    double fraction2 = *(const double*)second;
+    return((fraction1 > fraction2) - (fraction1 < fraction2));
+}
+
+static const char *skipJSONWhitespace(const char *cursor) {
+    while (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r') {
+        cursor++;
+    }
+    return(cursor);
+}
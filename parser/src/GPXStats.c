@@ -0,0 +1,276 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXSpatial.h"
+#include "GPXStats.h"
+#include "GPXCompact.h"
+
+static void initMotionStats(MotionStats *stats);
+static void nextPointElevationAndTime(const TrackSegment *segment, int64_t point, ListIterator *waypointIterator, double *elevation, int64_t *time);
+static void appendMotionStats(StringBuffer *JSONString, const MotionStats *stats);
+static void appendOptionalNumber(StringBuffer *JSONString, const char *key, bool present, int decimals, double value);
+
+void getSegmentStats(const TrackSegment *segment, double stopSpeed, double hysteresis, MotionStats *stats) {
+    initMotionStats(stats);
+    if (segment == NULL || getSegmentNumPoints(segment) == 0) {
+        return;
+    }
+
+    // Coordinates are read a run at a time so compacted segments are decoded as they are scanned
+    SegmentCursor cursor;
+    openSegmentCursor(&cursor, segment);
+    nextSegmentRun(&cursor);
+    stats -> numPoints = getSegmentNumPoints(segment);
+
+    // Segments built through the API or too large for their columns have no elevation and time columns,
+    // their points' <ele> and <time> are read from the waypoints alongside the cursor instead
+    ListIterator waypointIterator;
+    waypointIterator.current = NULL;
+    if (segment -> elevations == NULL && segment -> waypoints != NULL) {
+        waypointIterator = createIterator(segment -> waypoints);
+    }
+    double elevation;
+    int64_t time;
+    nextPointElevationAndTime(segment, 0, &waypointIterator, &elevation, &time);
+
+    // The cosine of each latitude is needed by both edges the point belongs to, so it is carried over to the next edge
+    double previousLatitude = cursor.latitudes[0] * (M_PI / 180);
+    double previousLongitude = cursor.longitudes[0] * (M_PI / 180);
+    double previousCos = cos(previousLatitude);
+
+    // Elevations are measured against the last counted elevation, so noise smaller than the hysteresis is ignored
+    double referenceElevation = elevation;
+
+    double distance = 0;
+    double movingDistance = 0;
+    double movingTime = 0;
+    double maxSpeed = 0;
+    double elevationGain = 0;
+    double elevationLoss = 0;
+    int64_t startTime = time;
+    int64_t endTime = time;
+    int64_t previousTime = time;
+    bool hasTime = FALSE;
+
+    // The first point of the first run only starts the first edge
+    int64_t point = 1;
+    do {
+        for (; point < cursor.numPoints; point++) {
+            int64_t i = cursor.firstPoint + point;
+
+            // Haversine distance of the edge ending at this point, the same formula as calculateHaversineFormula
+            double latitude = cursor.latitudes[point] * (M_PI / 180);
+            double longitude = cursor.longitudes[point] * (M_PI / 180);
+            double currentCos = cos(latitude);
+            double sinLatitude = sin((latitude - previousLatitude) / 2);
+            double sinLongitude = sin((longitude - previousLongitude) / 2);
+            double a = sinLatitude * sinLatitude + previousCos * currentCos * sinLongitude * sinLongitude;
+            double edgeLength = 2 * EARTH_RADIUS * atan2(sqrt(a), sqrt(1 - a));
+            distance += edgeLength;
+            previousLatitude = latitude;
+            previousLongitude = longitude;
+            previousCos = currentCos;
+
+            // Speed of the edge when both of its points have times in order, edges slower than the stop speed are not moving
+            nextPointElevationAndTime(segment, i, &waypointIterator, &elevation, &time);
+            if (time != GPX_NO_TIME && previousTime != GPX_NO_TIME && time >= previousTime) {
+                hasTime = TRUE;
+                double seconds = (time - previousTime) / 1000.0;
+                if (seconds > 0) {
+                    double speed = edgeLength / seconds;
+                    if (speed >= stopSpeed) {
+                        movingTime += seconds;
+                        movingDistance += edgeLength;
+                    }
+                    maxSpeed = fmax(maxSpeed, speed);
+                }
+            }
+            if (time != GPX_NO_TIME) {
+                if (startTime == GPX_NO_TIME || time < startTime) {
+                    startTime = time;
+                }
+                if (endTime == GPX_NO_TIME || time > endTime) {
+                    endTime = time;
+                }
+            }
+            previousTime = time;
+
+            // Counting the climb or descent once it reaches the hysteresis, then measuring from the new elevation
+            if (isnan(elevation)) {
+                continue;
+            }
+            if (isnan(referenceElevation)) {
+                referenceElevation = elevation;
+            }
+            else if (elevation - referenceElevation >= hysteresis) {
+                elevationGain += elevation - referenceElevation;
+                referenceElevation = elevation;
+            }
+            else if (referenceElevation - elevation >= hysteresis) {
+                elevationLoss += referenceElevation - elevation;
+                referenceElevation = elevation;
+            }
+        }
+        point = 0;
+    } while (nextSegmentRun(&cursor) > 0);
+
+    stats -> distance = distance;
+    stats -> movingDistance = movingDistance;
+    stats -> movingTime = movingTime;
+    stats -> maxSpeed = maxSpeed;
+    stats -> elevationGain = elevationGain;
+    stats -> elevationLoss = elevationLoss;
+    stats -> startTime = startTime;
+    stats -> endTime = endTime;
+    stats -> hasTime = hasTime;
+    stats -> hasElevation = !isnan(referenceElevation);
+    if (startTime != GPX_NO_TIME) {
+        stats -> duration = (endTime - startTime) / 1000.0;
+    }
+}
+
+static void nextPointElevationAndTime(const TrackSegment *segment, int64_t point, ListIterator *waypointIterator, double *elevation, int64_t *time) {
+    if (segment -> elevations != NULL) {
+        *elevation = segment -> elevations[point];
+        *time = segment -> times[point];
+        return;
+    }
+
+    // The waypoints are in the same order as the points the cursor hands out, a point without a waypoint has neither
+    Waypoint *waypoint = (Waypoint*)nextElement(waypointIterator);
+    if (waypoint == NULL) {
+        *elevation = NAN;
+        *time = GPX_NO_TIME;
+        return;
+    }
+    getWaypointElevationAndTime(waypoint, elevation, time);
+}
+
+void getTrackStats(const Track *track, double stopSpeed, double hysteresis, MotionStats *stats, MotionStats *segmentStats) {
+    initMotionStats(stats);
+    if (track == NULL) {
+        return;
+    }
+
+    // Adding up the statistics of every segment
+    int segmentNumber = 0;
+    ListIterator segmentIterator = createIterator(track -> segments);
+    void *segmentElement;
+    while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+        MotionStats segment;
+        getSegmentStats((TrackSegment*)segmentElement, stopSpeed, hysteresis, &segment);
+        if (segmentStats != NULL) {
+            segmentStats[segmentNumber] = segment;
+        }
+        segmentNumber++;
+
+        stats -> numPoints += segment.numPoints;
+        stats -> distance += segment.distance;
+        stats -> movingTime += segment.movingTime;
+        stats -> movingDistance += segment.movingDistance;
+        stats -> maxSpeed = fmax(stats -> maxSpeed, segment.maxSpeed);
+        stats -> elevationGain += segment.elevationGain;
+        stats -> elevationLoss += segment.elevationLoss;
+        stats -> hasTime = (stats -> hasTime == TRUE || segment.hasTime == TRUE);
+        stats -> hasElevation = (stats -> hasElevation == TRUE || segment.hasElevation == TRUE);
+        if (segment.startTime != GPX_NO_TIME) {
+            if (stats -> startTime == GPX_NO_TIME || segment.startTime < stats -> startTime) {
+                stats -> startTime = segment.startTime;
+            }
+            if (stats -> endTime == GPX_NO_TIME || segment.endTime > stats -> endTime) {
+                stats -> endTime = segment.endTime;
+            }
+        }
+    }
+
+    // The track duration includes any pauses between its segments
+    if (stats -> startTime != GPX_NO_TIME) {
+        stats -> duration = (stats -> endTime - stats -> startTime) / 1000.0;
+    }
+}
+
+char *trackStatsToJSON(const Track *track, double stopSpeed, double hysteresis) {
+
+    // Error check the track for NULL
+    if (track == NULL) {
+        fprintf(stderr, "ERROR: Track is NULL\n");
+        char *JSONString = malloc(3);
+        strcpy(JSONString, "{}");
+        return(JSONString);
+    }
+
+    // Computing the statistics of the track and of each of its segments in one pass over the points
+    int64_t numSegments = getLength(track -> segments);
+    MotionStats stats;
+    MotionStats *segmentStats = malloc((numSegments + 1) * sizeof(MotionStats));
+    getTrackStats(track, stopSpeed, hysteresis, &stats, segmentStats);
+
+    // Empty names are shown as "None" like trackToJSON does
+    char *name = track -> name;
+    if (strcmp(name, "") == 0) {
+        name = "None";
+    }
+
+    StringBuffer JSONString;
+    initStringBuffer(&JSONString);
+    appendToStringBuffer(&JSONString, "{\"name\":");
+    appendJSONStringToStringBuffer(&JSONString, name);
+    appendToStringBuffer(&JSONString, ",");
+    appendMotionStats(&JSONString, &stats);
+    appendToStringBuffer(&JSONString, ",\"segments\":[");
+    for (int i = 0; i < numSegments; i++) {
+        appendToStringBuffer(&JSONString, (i == 0) ? "{" : ",{");
+        appendMotionStats(&JSONString, &segmentStats[i]);
+        appendToStringBuffer(&JSONString, "}");
+    }
+    appendToStringBuffer(&JSONString, "]}");
+    free(segmentStats);
+
+    // Returns an allocated string of the track statistics in JSON format
+    return(JSONString.string);
+}
+
+static void initMotionStats(MotionStats *stats) {
+    stats -> numPoints = 0;
+    stats -> distance = 0;
+    stats -> duration = 0;
+    stats -> movingTime = 0;
+    stats -> movingDistance = 0;
+    stats -> maxSpeed = 0;
+    stats -> elevationGain = 0;
+    stats -> elevationLoss = 0;
+    stats -> startTime = GPX_NO_TIME;
+    stats -> endTime = GPX_NO_TIME;
+    stats -> hasTime = FALSE;
+    stats -> hasElevation = FALSE;
+}
+
+static void appendMotionStats(StringBuffer *JSONString, const MotionStats *stats) {
+
+    // Speeds and pace are only known when there is time spent on the path
+    bool hasDuration = (stats -> hasTime == TRUE && stats -> duration > 0);
+    bool isMoving = (stats -> hasTime == TRUE && stats -> movingTime > 0 && stats -> movingDistance > 0);
+
+    appendFormatToStringBuffer(JSONString, "\"numPoints\":%lld,\"len\":", (long long)stats -> numPoints);
+    appendFixedToStringBuffer(JSONString, stats -> distance, 1);
+    appendOptionalNumber(JSONString, "duration", stats -> hasTime, 1, stats -> duration);
+    appendOptionalNumber(JSONString, "movingTime", stats -> hasTime, 1, stats -> movingTime);
+    appendOptionalNumber(JSONString, "averageSpeed", hasDuration, 2, hasDuration ? stats -> distance / stats -> duration : 0);
+    appendOptionalNumber(JSONString, "movingSpeed", isMoving, 2, isMoving ? stats -> movingDistance / stats -> movingTime : 0);
+    appendOptionalNumber(JSONString, "maxSpeed", stats -> hasTime, 2, stats -> maxSpeed);
+    appendOptionalNumber(JSONString, "pace", isMoving, 1, isMoving ? stats -> movingTime / (stats -> movingDistance / 1000) : 0);
+    appendOptionalNumber(JSONString, "elevationGain", stats -> hasElevation, 1, stats -> elevationGain);
+    appendOptionalNumber(JSONString, "elevationLoss", stats -> hasElevation, 1, stats -> elevationLoss);
+}
+
+static void appendOptionalNumber(StringBuffer *JSONString, const char *key, bool present, int decimals, double value) {
+
+    // Writing ,"key":value or ,"key":null when the value is not known
+    appendFormatToStringBuffer(JSONString, ",\"%s\":", key);
+    if (present == TRUE) {
+        appendFixedToStringBuffer(JSONString, value, decimals);
+    }
+    else {
+        appendToStringBuffer(JSONString, "null");
+    }
+}
@@ -0,0 +1,530 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXTime.h"
+
+#define MILLISECONDS_PER_DAY 86400000LL
+
+// Largest year parseGPXTime accepts, either way from year 0.  Its milliseconds since the epoch still fit in an int64_t,
+// which runs out a little past year 292277026, and formatGPXTime clamps to it so the two stay in step
+#define GPX_MAX_YEAR 292000000
+
+// A time paired with the position of the track it belongs to, used to sort the time index
+typedef struct {
+    int64_t time;
+    int position;
+} TimeKey;
+
+static const char *readDigits(const char *cursor, int numDigits, int *value);
+static int64_t daysFromCivil(int64_t year, int month, int day);
+static void civilFromDays(int64_t days, int64_t *year, int *month, int *day);
+static int daysInMonth(int64_t year, int month);
+static void addTrackToTimeIndex(TimeIndex *index, Track *track, int document, int position);
+static int64_t firstTimeAtLeast(const int64_t *times, int64_t numPoints, int64_t time);
+static int compareTimeKeys(const void *first, const void *second);
+static int compareMatchNumbers(const void *first, const void *second);
+
+int64_t parseGPXTime(const char *string) {
+    if (string == NULL) {
+        return(GPX_NO_TIME);
+    }
+
+    // Skipping the whitespace that the XML content may keep around the value
+    const char *cursor = string;
+    while (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r') {
+        cursor++;
+    }
+
+    // Reading the year, it has at least 4 digits and may be negative
+    bool negativeYear = FALSE;
+    if (*cursor == '-') {
+        negativeYear = TRUE;
+        cursor++;
+    }
+    int64_t year = 0;
+    int numYearDigits = 0;
+    while (*cursor >= '0' && *cursor <= '9' && numYearDigits < 9) {
+        year = year * 10 + (*cursor - '0');
+        cursor++;
+        numYearDigits++;
+    }
+    if (numYearDigits < 4 || year > GPX_MAX_YEAR) {
+        return(GPX_NO_TIME);
+    }
+    if (negativeYear == TRUE) {
+        year = -year;
+    }
+
+    // Reading the fixed width date and time fields and their separators
+    int month, day, hour, minute, second;
+    if (*cursor++ != '-' || (cursor = readDigits(cursor, 2, &month)) == NULL || *cursor++ != '-' || (cursor = readDigits(cursor, 2, &day)) == NULL) {
+        return(GPX_NO_TIME);
+    }
+    if (*cursor++ != 'T' || (cursor = readDigits(cursor, 2, &hour)) == NULL || *cursor++ != ':' || (cursor = readDigits(cursor, 2, &minute)) == NULL) {
+        return(GPX_NO_TIME);
+    }
+    if (*cursor++ != ':' || (cursor = readDigits(cursor, 2, &second)) == NULL) {
+        return(GPX_NO_TIME);
+    }
+
+    // Checking the field ranges, 24:00:00 is the end of the day and a leap second is allowed
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) {
+        return(GPX_NO_TIME);
+    }
+    if (hour > 24 || minute > 59 || second > 60 || (hour == 24 && (minute != 0 || second != 0))) {
+        return(GPX_NO_TIME);
+    }
+
+    // Reading the fraction of a second, only the first three digits matter
+    int milliseconds = 0;
+    if (*cursor == '.') {
+        cursor++;
+        if (*cursor < '0' || *cursor > '9') {
+            return(GPX_NO_TIME);
+        }
+        int scale = 100;
+        while (*cursor >= '0' && *cursor <= '9') {
+            milliseconds += (*cursor - '0') * scale;
+            scale /= 10;
+            cursor++;
+        }
+    }
+
+    // Reading the zone, a time without one is taken as UTC
+    int zoneMinutes = 0;
+    if (*cursor == 'Z') {
+        cursor++;
+    }
+    else if (*cursor == '+' || *cursor == '-') {
+        int sign = (*cursor == '-') ? -1 : 1;
+        int zoneHours, zoneRest;
+        cursor++;
+        if ((cursor = readDigits(cursor, 2, &zoneHours)) == NULL || *cursor++ != ':' || (cursor = readDigits(cursor, 2, &zoneRest)) == NULL) {
+            return(GPX_NO_TIME);
+        }
+        if (zoneHours > 14 || zoneRest > 59) {
+            return(GPX_NO_TIME);
+        }
+        zoneMinutes = sign * (zoneHours * 60 + zoneRest);
+    }
+
+    // Anything other than trailing whitespace makes the string invalid
+    while (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r') {
+        cursor++;
+    }
+    if (*cursor != '\0') {
+        return(GPX_NO_TIME);
+    }
+
+    // Converting to milliseconds since the epoch, the zone offset is taken away to get UTC
+    int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + (minute - zoneMinutes) * 60 + second;
+    return(seconds * 1000 + milliseconds);
+}
+
+char *formatGPXTime(int64_t time, char *buffer) {
+
+    // Splitting the time into whole days and the milliseconds into the day, rounding the days down for times before 1970
+    int64_t days = time / MILLISECONDS_PER_DAY;
+    int64_t dayMilliseconds = time % MILLISECONDS_PER_DAY;
+    if (dayMilliseconds < 0) {
+        dayMilliseconds += MILLISECONDS_PER_DAY;
+        days--;
+    }
+
+    int64_t year;
+    int month, day;
+    civilFromDays(days, &year, &month, &day);
+    int hour = (int)(dayMilliseconds / 3600000);
+    int minute = (int)(dayMilliseconds / 60000 % 60);
+    int second = (int)(dayMilliseconds / 1000 % 60);
+    int milliseconds = (int)(dayMilliseconds % 1000);
+
+    // Years are kept to the ones parseGPXTime accepts, which also bounds the length of the string
+    if (year > GPX_MAX_YEAR) {
+        year = GPX_MAX_YEAR;
+    }
+    else if (year < -GPX_MAX_YEAR) {
+        year = -GPX_MAX_YEAR;
+    }
+
+    // The sign of the year is written before its 4 digit padding
+    const char *sign = (year < 0) ? "-" : "";
+    int yearDigits = (int)((year < 0) ? -year : year);
+    if (milliseconds == 0) {
+        snprintf(buffer, GPX_TIME_STRING_LENGTH, "%s%04d-%02d-%02dT%02d:%02d:%02dZ", sign, yearDigits, month, day, hour, minute, second);
+    }
+    else {
+        snprintf(buffer, GPX_TIME_STRING_LENGTH, "%s%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", sign, yearDigits, month, day, hour, minute, second, milliseconds);
+    }
+    return(buffer);
+}
+
+bool getTrackTimeRange(const Track *track, int64_t *startTime, int64_t *endTime) {
+    if (track == NULL) {
+        return(FALSE);
+    }
+
+    // Taking the smallest and largest time of every segment, the ends of an ascending segment are enough
+    bool found = FALSE;
+    ListIterator segmentIterator = createIterator(track -> segments);
+    void *segmentElement;
+    while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+        TrackSegment *segment = (TrackSegment*)segmentElement;
+        if (segment -> times == NULL || segment -> numPoints == 0) {
+            continue;
+        }
+
+        int64_t segmentStart = GPX_NO_TIME;
+        int64_t segmentEnd = GPX_NO_TIME;
+        if (segment -> timesAscending == TRUE) {
+            segmentStart = segment -> times[0];
+            segmentEnd = segment -> times[segment -> numPoints - 1];
+        }
+        else {
+            for (int64_t i = 0; i < segment -> numPoints; i++) {
+                int64_t time = segment -> times[i];
+                if (time == GPX_NO_TIME) {
+                    continue;
+                }
+                if (segmentStart == GPX_NO_TIME || time < segmentStart) {
+                    segmentStart = time;
+                }
+                if (segmentEnd == GPX_NO_TIME || time > segmentEnd) {
+                    segmentEnd = time;
+                }
+            }
+            if (segmentStart == GPX_NO_TIME) {
+                continue;
+            }
+        }
+
+        if (found == FALSE || segmentStart < *startTime) {
+            *startTime = segmentStart;
+        }
+        if (found == FALSE || segmentEnd > *endTime) {
+            *endTime = segmentEnd;
+        }
+        found = TRUE;
+    }
+
+    return(found);
+}
+
+int pointsInTimeWindow(const TrackSegment *segment, int64_t startTime, int64_t endTime, int64_t **runs) {
+    *runs = NULL;
+    if (segment == NULL || segment -> times == NULL || startTime > endTime) {
+        return(0);
+    }
+
+    // Ascending times put every point of the window in one run, found with two binary searches
+    if (segment -> timesAscending == TRUE) {
+        int64_t first = firstTimeAtLeast(segment -> times, segment -> numPoints, startTime);
+        int64_t last = ((endTime == INT64_MAX) ? segment -> numPoints : firstTimeAtLeast(segment -> times, segment -> numPoints, endTime + 1)) - 1;
+        if (first > last) {
+            return(0);
+        }
+        *runs = malloc(2 * sizeof(int64_t));
+        (*runs)[0] = first;
+        (*runs)[1] = last;
+        return(1);
+    }
+
+    // Otherwise scanning every point, a point outside the window or without a time ends the current run
+    int numRuns = 0;
+    int runCapacity = 0;
+    int64_t i = 0;
+    while (i < segment -> numPoints) {
+        int64_t time = segment -> times[i];
+        if (time == GPX_NO_TIME || time < startTime || time > endTime) {
+            i++;
+            continue;
+        }
+
+        int64_t first = i;
+        while (i + 1 < segment -> numPoints && segment -> times[i + 1] != GPX_NO_TIME && segment -> times[i + 1] >= startTime && segment -> times[i + 1] <= endTime) {
+            i++;
+        }
+        if (numRuns == runCapacity) {
+            runCapacity = (runCapacity == 0) ? 4 : runCapacity * 2;
+            *runs = realloc(*runs, 2 * runCapacity * sizeof(int64_t));
+        }
+        (*runs)[2 * numRuns] = first;
+        (*runs)[2 * numRuns + 1] = i;
+        numRuns++;
+        i++;
+    }
+
+    return(numRuns);
+}
+
+List* getTracksActiveBetween(const GPXdoc* doc, int64_t startTime, int64_t endTime) {
+
+    // Error check the GPXdoc structure for NULL and the window for being backwards
+    if (doc == NULL || startTime > endTime) {
+        fprintf(stderr, "ERROR: GPXdoc structure is NULL or the time window ends before it starts\n");
+        return(NULL);
+    }
+
+    // Creating a list that only references the matching tracks, they still belong to the doc
+    List *trackList = initializeList(&trackToString, &dummyDelete, &compareTracks);
+
+    // A track is active when its time span overlaps the window
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    void *trackElement;
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+        Track *track = (Track*)trackElement;
+        int64_t trackStart, trackEnd;
+        if (getTrackTimeRange(track, &trackStart, &trackEnd) == TRUE && trackStart <= endTime && trackEnd >= startTime) {
+            insertBack(trackList, track);
+        }
+    }
+
+    // Returns NULL if no tracks were active, the same as the other get...Between functions
+    if (getLength(trackList) == 0) {
+        freeList(trackList);
+        return(NULL);
+    }
+    return(trackList);
+}
+
+TimeIndex *createTimeIndex(void) {
+
+    // Allocating an empty index, the sorted orders are only created by buildTimeIndex
+    TimeIndex *index = malloc(sizeof(TimeIndex));
+    index -> tracks = NULL;
+    index -> numTracks = 0;
+    index -> trackCapacity = 0;
+    index -> byStart = NULL;
+    index -> byEnd = NULL;
+
+    return(index);
+}
+
+void deleteTimeIndex(TimeIndex *index) {
+    if (index == NULL) {
+        return;
+    }
+
+    // Freeing the arrays owned by the index and the index itself, the tracks belong to their GPXdoc
+    free(index -> tracks);
+    free(index -> byStart);
+    free(index -> byEnd);
+    free(index);
+}
+
+void addDocToTimeIndex(TimeIndex *index, const GPXdoc *doc, int document) {
+
+    // Error check the index and doc for NULL
+    if (index == NULL || doc == NULL) {
+        fprintf(stderr, "ERROR: TimeIndex or GPXdoc is NULL\n");
+        return;
+    }
+
+    // Registering every track of the doc, tracks without any timed point are left out by addTrackToTimeIndex
+    int position = 0;
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    void *trackElement;
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+        addTrackToTimeIndex(index, (Track*)trackElement, document, position);
+        position++;
+    }
+}
+
+void buildTimeIndex(TimeIndex *index) {
+
+    // Error check the index for NULL
+    if (index == NULL) {
+        fprintf(stderr, "ERROR: TimeIndex is NULL\n");
+        return;
+    }
+
+    // Throwing away the orders from a previous build
+    free(index -> byStart);
+    free(index -> byEnd);
+    index -> byStart = malloc((index -> numTracks + 1) * sizeof(int));
+    index -> byEnd = malloc((index -> numTracks + 1) * sizeof(int));
+
+    // Sorting the track positions once by start time and once by end time
+    TimeKey *keys = malloc((index -> numTracks + 1) * sizeof(TimeKey));
+    for (int i = 0; i < index -> numTracks; i++) {
+        keys[i].time = index -> tracks[i].startTime;
+        keys[i].position = i;
+    }
+    qsort(keys, index -> numTracks, sizeof(TimeKey), &compareTimeKeys);
+    for (int i = 0; i < index -> numTracks; i++) {
+        index -> byStart[i] = keys[i].position;
+    }
+
+    for (int i = 0; i < index -> numTracks; i++) {
+        keys[i].time = index -> tracks[i].endTime;
+        keys[i].position = i;
+    }
+    qsort(keys, index -> numTracks, sizeof(TimeKey), &compareTimeKeys);
+    for (int i = 0; i < index -> numTracks; i++) {
+        index -> byEnd[i] = keys[i].position;
+    }
+    free(keys);
+}
+
+int tracksActiveInTimeIndex(const TimeIndex *index, int64_t startTime, int64_t endTime, int **matches) {
+    *matches = NULL;
+
+    // Error check the index for NULL and make sure it has been built
+    if (index == NULL || index -> byStart == NULL || startTime > endTime) {
+        return(0);
+    }
+
+    // Tracks starting after the window are the tail of byStart, tracks ending before it are the head of byEnd
+    int low = 0;
+    int high = index -> numTracks;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (index -> tracks[index -> byStart[middle]].startTime <= endTime) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    int numStartedBefore = low;
+
+    low = 0;
+    high = index -> numTracks;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (index -> tracks[index -> byEnd[middle]].endTime < startTime) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    int numEndedBefore = low;
+
+    // Checking the other end of the span for whichever of the two candidate sets is smaller
+    int numMatches = 0;
+    if (numStartedBefore <= index -> numTracks - numEndedBefore) {
+        *matches = malloc((numStartedBefore + 1) * sizeof(int));
+        for (int i = 0; i < numStartedBefore; i++) {
+            int position = index -> byStart[i];
+            if (index -> tracks[position].endTime >= startTime) {
+                (*matches)[numMatches++] = position;
+            }
+        }
+    }
+    else {
+        *matches = malloc((index -> numTracks - numEndedBefore + 1) * sizeof(int));
+        for (int i = numEndedBefore; i < index -> numTracks; i++) {
+            int position = index -> byEnd[i];
+            if (index -> tracks[position].startTime <= endTime) {
+                (*matches)[numMatches++] = position;
+            }
+        }
+    }
+
+    // Putting the matches back in the order the tracks were added
+    if (numMatches == 0) {
+        free(*matches);
+        *matches = NULL;
+        return(0);
+    }
+    qsort(*matches, numMatches, sizeof(int), &compareMatchNumbers);
+
+    return(numMatches);
+}
+
+static void addTrackToTimeIndex(TimeIndex *index, Track *track, int document, int position) {
+    int64_t startTime, endTime;
+    if (getTrackTimeRange(track, &startTime, &endTime) == FALSE) {
+        return;
+    }
+
+    // Growing the track array by doubling it when it is full
+    if (index -> numTracks == index -> trackCapacity) {
+        index -> trackCapacity = (index -> trackCapacity == 0) ? 16 : index -> trackCapacity * 2;
+        index -> tracks = realloc(index -> tracks, index -> trackCapacity * sizeof(TimedTrack));
+    }
+
+    TimedTrack *timedTrack = &index -> tracks[index -> numTracks++];
+    timedTrack -> track = track;
+    timedTrack -> document = document;
+    timedTrack -> position = position;
+    timedTrack -> startTime = startTime;
+    timedTrack -> endTime = endTime;
+}
+
+static const char *readDigits(const char *cursor, int numDigits, int *value) {
+
+    // Reading exactly numDigits decimal digits, NULL if any of them is not a digit
+    *value = 0;
+    for (int i = 0; i < numDigits; i++) {
+        if (cursor[i] < '0' || cursor[i] > '9') {
+            return(NULL);
+        }
+        *value = *value * 10 + (cursor[i] - '0');
+    }
+    return(cursor + numDigits);
+}
+
+static int64_t daysFromCivil(int64_t year, int month, int day) {
+
+    // Days since 1970-01-01 in the proleptic Gregorian calendar, counting years from March so the leap day is last
+    year -= (month <= 2);
+    int64_t era = ((year >= 0) ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return(era * 146097 + dayOfEra - 719468);
+}
+
+static void civilFromDays(int64_t days, int64_t *year, int *month, int *day) {
+
+    // The inverse of daysFromCivil
+    days += 719468;
+    int64_t era = ((days >= 0) ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthFromMarch = (5 * dayOfYear + 2) / 153;
+    *day = (int)(dayOfYear - (153 * monthFromMarch + 2) / 5 + 1);
+    *month = (int)((monthFromMarch < 10) ? monthFromMarch + 3 : monthFromMarch - 9);
+    *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+static int daysInMonth(int64_t year, int month) {
+    static const int monthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)) {
+        return(29);
+    }
+    return(monthDays[month - 1]);
+}
+
+static int64_t firstTimeAtLeast(const int64_t *times, int64_t numPoints, int64_t time) {
+
+    // Binary search for the first point at or after the time, numPoints if there is none
+    int64_t low = 0;
+    int64_t high = numPoints;
+    while (low < high) {
+        int64_t middle = low + (high - low) / 2;
+        if (times[middle] < time) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return(low);
+}
+
+static int compareTimeKeys(const void *first, const void *second) {
+    const TimeKey *firstKey = (const TimeKey*)first;
+    const TimeKey *secondKey = (const TimeKey*)second;
+    if (firstKey -> time != secondKey -> time) {
+        return((firstKey -> time < secondKey -> time) ? -1 : 1);
+    }
+    return(firstKey -> position - secondKey -> position);
+}
+
+static int compareMatchNumbers(const void *first, const void *second) {
+    return(*(const int*)first - *(const int*)second);
+}
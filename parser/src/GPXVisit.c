@@ -0,0 +1,227 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXVisit.h"
+
+static void startSegment(PointIterator *iterator, const TrackSegment *segment);
+static void setWaypointPoint(GPXPoint *point, const Waypoint *waypoint, int64_t index);
+static bool getSegmentEnd(const TrackSegment *segment, bool last, GPXPoint *point);
+static bool visitPoints(PointIterator *iterator, const GPXVisitor *visitor, void *context, ComponentType type);
+
+void openRoutePoints(PointIterator *iterator, const Route *route) {
+    iterator -> waypointNode = route -> waypoints -> head;
+    iterator -> segment = NULL;
+    iterator -> segmentNode = NULL;
+    iterator -> index = 0;
+}
+
+void openSegmentPoints(PointIterator *iterator, const TrackSegment *segment) {
+    iterator -> segmentNode = NULL;
+    iterator -> index = 0;
+    startSegment(iterator, segment);
+}
+
+void openTrackPoints(PointIterator *iterator, const Track *track) {
+
+    // Segments are started one at a time by nextPoint, as the previous one runs out of points
+    iterator -> waypointNode = NULL;
+    iterator -> segment = NULL;
+    iterator -> segmentNode = track -> segments -> head;
+    iterator -> index = 0;
+}
+
+bool nextPoint(PointIterator *iterator, GPXPoint *point) {
+    while (TRUE) {
+
+        // Points of routes and of segments without columns come straight from their waypoints
+        if (iterator -> waypointNode != NULL) {
+            setWaypointPoint(point, (const Waypoint*)iterator -> waypointNode -> data, iterator -> index++);
+            iterator -> waypointNode = iterator -> waypointNode -> next;
+            return(TRUE);
+        }
+
+        // Points of segments with columns or compacted coordinates come from the cursor's current run
+        if (iterator -> segment != NULL) {
+            const TrackSegment *segment = iterator -> segment;
+            if (iterator -> runPosition < iterator -> cursor.numPoints) {
+                int64_t position = iterator -> cursor.firstPoint + iterator -> runPosition;
+                point -> latitude = iterator -> cursor.latitudes[iterator -> runPosition];
+                point -> longitude = iterator -> cursor.longitudes[iterator -> runPosition];
+                point -> elevation = (segment -> elevations != NULL) ? segment -> elevations[position] : NAN;
+                point -> time = (segment -> times != NULL) ? segment -> times[position] : GPX_NO_TIME;
+                point -> index = iterator -> index++;
+                point -> waypoint = NULL;
+                iterator -> runPosition++;
+                return(TRUE);
+            }
+            if (nextSegmentRun(&iterator -> cursor) > 0) {
+                iterator -> runPosition = 0;
+                continue;
+            }
+            iterator -> segment = NULL;
+        }
+
+        // Moving on to the next segment of the track, if there is one
+        if (iterator -> segmentNode == NULL) {
+            return(FALSE);
+        }
+        startSegment(iterator, (const TrackSegment*)iterator -> segmentNode -> data);
+        iterator -> segmentNode = iterator -> segmentNode -> next;
+    }
+}
+
+float lengthOfPoints(PointIterator *iterator) {
+
+    // Summing the float length of each edge, in order, so the total is the same however the points are stored
+    float length = 0;
+    bool first = TRUE;
+    double previousLatitude = 0;
+    double previousLongitude = 0;
+    GPXPoint point;
+    GPX_FOR_EACH_POINT(point, *iterator) {
+        if (first == FALSE) {
+            length += haversineDistance(previousLatitude, previousLongitude, point.latitude, point.longitude);
+        }
+        first = FALSE;
+        previousLatitude = point.latitude;
+        previousLongitude = point.longitude;
+    }
+    return(length);
+}
+
+bool getRouteEnds(const Route *route, GPXPoint *first, GPXPoint *last) {
+    int64_t numPoints = getLength(route -> waypoints);
+    if (numPoints == 0) {
+        return(FALSE);
+    }
+    setWaypointPoint(first, (const Waypoint*)getFromFront(route -> waypoints), 0);
+    setWaypointPoint(last, (const Waypoint*)getFromBack(route -> waypoints), numPoints - 1);
+    return(TRUE);
+}
+
+bool getTrackEnds(const Track *track, GPXPoint *first, GPXPoint *last) {
+    const TrackSegment *firstSegment = (const TrackSegment*)getFromFront(track -> segments);
+    const TrackSegment *lastSegment = (const TrackSegment*)getFromBack(track -> segments);
+    if (firstSegment == NULL || getSegmentEnd(firstSegment, FALSE, first) == FALSE || getSegmentEnd(lastSegment, TRUE, last) == FALSE) {
+        return(FALSE);
+    }
+
+    // The last point's index counts the points of every segment before the last one
+    const TrackSegment *segment;
+    GPX_FOR_EACH_SEGMENT(segment, track) {
+        if (segment != lastSegment) {
+            last -> index += getSegmentNumPoints(segment);
+        }
+    }
+    return(TRUE);
+}
+
+bool visitGPXdoc(const GPXdoc *doc, const GPXVisitor *visitor, void *context) {
+    int position = 0;
+    const Waypoint *waypoint;
+    if (visitor -> waypoint != NULL) {
+        GPX_FOR_EACH_WAYPOINT(waypoint, doc) {
+            if (visitor -> waypoint(context, waypoint, position++) == FALSE) {
+                return(FALSE);
+            }
+        }
+    }
+
+    // Each route is followed by its points
+    position = 0;
+    const Route *route;
+    PointIterator iterator;
+    GPX_FOR_EACH_ROUTE(route, doc) {
+        if (visitor -> route != NULL && visitor -> route(context, route, position) == FALSE) {
+            return(FALSE);
+        }
+        position++;
+        openRoutePoints(&iterator, route);
+        if (visitPoints(&iterator, visitor, context, GPX_ROUTE) == FALSE) {
+            return(FALSE);
+        }
+    }
+
+    // Each track is followed by its segments, each segment by its points, whose indexes carry on across the segments
+    position = 0;
+    const Track *track;
+    GPX_FOR_EACH_TRACK(track, doc) {
+        if (visitor -> track != NULL && visitor -> track(context, track, position) == FALSE) {
+            return(FALSE);
+        }
+        position++;
+
+        int segmentPosition = 0;
+        int64_t firstIndex = 0;
+        const TrackSegment *segment;
+        GPX_FOR_EACH_SEGMENT(segment, track) {
+            if (visitor -> segment != NULL && visitor -> segment(context, track, segment, segmentPosition) == FALSE) {
+                return(FALSE);
+            }
+            segmentPosition++;
+            openSegmentPoints(&iterator, segment);
+            iterator.index = firstIndex;
+            if (visitPoints(&iterator, visitor, context, GPX_TRACK) == FALSE) {
+                return(FALSE);
+            }
+            firstIndex += getSegmentNumPoints(segment);
+        }
+    }
+    return(TRUE);
+}
+
+static void startSegment(PointIterator *iterator, const TrackSegment *segment) {
+
+    // Segments without columns are walked through their waypoints, the others through a segment cursor
+    if (segment -> latitudes == NULL && segment -> compact == NULL) {
+        iterator -> waypointNode = segment -> waypoints -> head;
+        iterator -> segment = NULL;
+        return;
+    }
+    iterator -> waypointNode = NULL;
+    iterator -> segment = segment;
+    iterator -> runPosition = 0;
+    openSegmentCursor(&iterator -> cursor, segment);
+}
+
+static void setWaypointPoint(GPXPoint *point, const Waypoint *waypoint, int64_t index) {
+    point -> latitude = waypoint -> latitude;
+    point -> longitude = waypoint -> longitude;
+    point -> elevation = NAN;
+    point -> time = GPX_NO_TIME;
+    point -> index = index;
+    point -> waypoint = waypoint;
+}
+
+static bool getSegmentEnd(const TrackSegment *segment, bool last, GPXPoint *point) {
+    int64_t numPoints = getSegmentNumPoints(segment);
+    if (numPoints == 0) {
+        return(FALSE);
+    }
+
+    // Segments without columns are read from their waypoints, the others one point at a time without a cursor
+    int64_t index = (last == TRUE) ? numPoints - 1 : 0;
+    if (segment -> latitudes == NULL && segment -> compact == NULL) {
+        setWaypointPoint(point, (const Waypoint*)((last == TRUE) ? getFromBack(segment -> waypoints) : getFromFront(segment -> waypoints)), index);
+        return(TRUE);
+    }
+    getSegmentPoint(segment, index, &point -> latitude, &point -> longitude);
+    point -> elevation = (segment -> elevations != NULL) ? segment -> elevations[index] : NAN;
+    point -> time = (segment -> times != NULL) ? segment -> times[index] : GPX_NO_TIME;
+    point -> index = index;
+    point -> waypoint = NULL;
+    return(TRUE);
+}
+
+static bool visitPoints(PointIterator *iterator, const GPXVisitor *visitor, void *context, ComponentType type) {
+    if (visitor -> point == NULL) {
+        return(TRUE);
+    }
+    GPXPoint point;
+    GPX_FOR_EACH_POINT(point, *iterator) {
+        if (visitor -> point(context, type, &point) == FALSE) {
+            return(FALSE);
+        }
+    }
+    return(TRUE);
+}
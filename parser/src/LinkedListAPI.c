@@ -1,4 +1,5 @@
 #include "LinkedListAPI.h"
+#include "GPXPool.h"
 #include "assert.h"
 
 /** Function to initialize the list metadata head to the appropriate function pointers. Allocates memory to the struct.
@@ -13,7 +14,7 @@ List * initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFun
     assert(deleteFunction != NULL);
     assert(compareFunction != NULL);
 
-    List * tmpList = malloc(sizeof(List));
+    List * tmpList = poolAllocate(POOL_LIST);
 	
 	tmpList->head = NULL;
 	tmpList->tail = NULL;
@@ -37,7 +38,7 @@ List * initializeList(char* (*printFunction)(void* toBePrinted),void (*deleteFun
 void freeList(List* list){	
 
     clearList(list);
-	free(list);
+	poolRelease(POOL_LIST, list);
 }
 
 /** Clears the list: frees the contents of the list - Node structs and data stored in them - 
@@ -63,7 +64,7 @@ void clearList(List* list){
 		list->deleteData(list->head->data);
 		tmp = list->head;
 		list->head = list->head->next;
-		free(tmp);
+		poolRelease(POOL_NODE, tmp);
 	}
 	
 	list->head = NULL;
@@ -81,7 +82,7 @@ void clearList(List* list){
 * @param data - is a void * pointer to any data type.  Data must be allocated on the heap.
 **/
 Node* initializeNode(void* data){
-	Node* tmpNode = (Node*)malloc(sizeof(Node));
+	Node* tmpNode = (Node*)poolAllocate(POOL_NODE);
 	
 	if (tmpNode == NULL){
 		return NULL;
@@ -195,7 +196,7 @@ void* deleteDataFromList(List* list, void* toBeDeleted){
 			}
 			
 			void* data = delNode->data;
-			free(delNode);
+			poolRelease(POOL_NODE, delNode);
 			
 			(list->length)--;
 
@@ -315,7 +316,7 @@ void* nextElement(ListIterator* iter){
     }
 }
 
-int getLength(List* list){
+int64_t getLength(List* list){
 	return list->length;
 }
 
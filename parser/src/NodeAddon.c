@@ -0,0 +1,661 @@
+#include <node_api.h>
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXCorpus.h"
+#include "GPXJSON.h"
+#include "GPXLibrary.h"
+#include "GPXCompact.h"
+#include "GPXScan.h"
+
+// Schema every file is validated against, relative to the directory app.js runs from like the ffi wrappers
+#define ADDON_SCHEMA_FILE "parser/src/gpx.xsd"
+
+// Longest path the JS arguments are copied into, and the most paths a function takes
+#define ADDON_PATH_LENGTH 4096
+#define ADDON_MAX_PATHS 2
+
+// A route or track scanned on the libuv threadpool, kept until the main thread builds its object
+typedef struct {
+    ComponentType type;
+    char *name;
+    int64_t numPoints;
+    float length;
+    bool loop;
+} AddonComponent;
+
+// State of a call that loads files on the libuv threadpool and settles a promise once it is done
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    char paths[ADDON_MAX_PATHS][ADDON_PATH_LENGTH];
+
+    //Results of the load, only one of them is used by each kind of call
+    GPXCorpus *corpus;
+    GPXdoc *doc;
+
+    //Result of a file scan, its routes and tracks in file order
+    GPXScan scan;
+    bool scanned;
+    AddonComponent *components;
+    int64_t numComponents;
+    int64_t componentCapacity;
+} AddonWork;
+
+// Chunks a stream may have waiting for the main thread, the threadpool blocks once this many are queued so memory stays bounded
+#define ADDON_STREAM_QUEUE 4
+
+// State of a call that writes JSON on the libuv threadpool and passes it, one chunk at a time, to a JS callback
+typedef struct {
+    napi_async_work work;
+    napi_deferred deferred;
+    napi_threadsafe_function onChunk;
+    char paths[1][ADDON_PATH_LENGTH];
+
+    //Whether every chunk was handed to the main thread
+    bool written;
+} AddonStream;
+
+// A chunk of a stream on its way to the main thread
+typedef struct {
+    size_t length;
+    char bytes[];
+} AddonChunk;
+
+// Parsed schema shared by every single file load, parsed on the main thread the first time it is needed
+static xmlSchemaPtr addonSchema = NULL;
+
+static bool getPathArguments(napi_env env, napi_callback_info info, size_t numPaths, char paths[][ADDON_PATH_LENGTH]);
+static xmlSchemaPtr getAddonSchema(void);
+static void setStringProperty(napi_env env, napi_value object, const char *key, const char *value);
+static void setNumberProperty(napi_env env, napi_value object, const char *key, double value);
+static void setBoolProperty(napi_env env, napi_value object, const char *key, bool value);
+static void setComponentProperties(napi_env env, napi_value object, const char *fileName, const char *name, int64_t numPoints, float length, bool loop);
+static napi_value corpusToObject(napi_env env, const GPXCorpus *corpus);
+static napi_value docSummaryToObject(napi_env env, const char *fileName, const GPXdoc *doc);
+static napi_value scanSummaryToObject(napi_env env, const char *fileName, const AddonWork *work);
+static bool keepScannedComponent(void *context, const ScannedComponent *component);
+static void initAddonWork(AddonWork *work);
+static void clearScanResult(AddonWork *work);
+static napi_value columnToTypedArray(napi_env env, const double *column, int64_t numPoints);
+static void coordinatesToTypedArrays(napi_env env, const TrackSegment *segment, napi_value *latitudes, napi_value *longitudes);
+static napi_value timesToTypedArray(napi_env env, const int64_t *times, int64_t numPoints);
+static napi_value docTracksToArray(napi_env env, const GPXdoc *doc);
+static napi_value queueWork(napi_env env, napi_callback_info info, const char *name, size_t numPaths, napi_async_execute_callback execute, napi_async_complete_callback complete);
+static napi_value queueStream(napi_env env, napi_callback_info info, const char *name, napi_async_execute_callback execute);
+static bool streamSink(void *context, const char *bytes, size_t length);
+static void callChunkCallback(napi_env env, napi_value callback, void *context, void *data);
+static void executeSummaryStream(napi_env env, void *data);
+static void executeGeometryStream(napi_env env, void *data);
+static void completeStream(napi_env env, napi_status status, void *data);
+static void finalizeStream(napi_env env, void *data, void *hint);
+static void executeSummary(napi_env env, void *data);
+static void completeSummary(napi_env env, napi_status status, void *data);
+static void executeFileSummary(napi_env env, void *data);
+static void completeFileSummary(napi_env env, napi_status status, void *data);
+static void executeTrackPoints(napi_env env, void *data);
+static void completeTrackPoints(napi_env env, napi_status status, void *data);
+
+static napi_value summary(napi_env env, napi_callback_info info) {
+    char paths[1][ADDON_PATH_LENGTH];
+    if (getPathArguments(env, info, 1, paths) == FALSE) {
+        return(NULL);
+    }
+
+    // Loading the directory once and building the summary straight into JS objects
+    GPXCorpus *corpus = createGPXCorpus(paths[0], ADDON_SCHEMA_FILE);
+    napi_value result = corpusToObject(env, corpus);
+    deleteGPXCorpus(corpus);
+    return(result);
+}
+
+static napi_value summaryAsync(napi_env env, napi_callback_info info) {
+    return(queueWork(env, info, "summaryAsync", 1, &executeSummary, &completeSummary));
+}
+
+static napi_value fileSummary(napi_env env, napi_callback_info info) {
+    char paths[2][ADDON_PATH_LENGTH];
+    if (getPathArguments(env, info, 2, paths) == FALSE) {
+        return(NULL);
+    }
+
+    // Summarizing one file of the directory with a scan, null when the file is invalid
+    getAddonSchema();
+    AddonWork work;
+    initAddonWork(&work);
+    memcpy(work.paths, paths, sizeof(paths));
+    executeFileSummary(env, &work);
+    napi_value result = scanSummaryToObject(env, work.paths[1], &work);
+    clearScanResult(&work);
+    return(result);
+}
+
+static napi_value fileSummaryAsync(napi_env env, napi_callback_info info) {
+
+    // The schema is parsed here on the main thread so the threadpool only ever reads it
+    getAddonSchema();
+    return(queueWork(env, info, "fileSummaryAsync", 2, &executeFileSummary, &completeFileSummary));
+}
+
+static napi_value trackPoints(napi_env env, napi_callback_info info) {
+    char paths[1][ADDON_PATH_LENGTH];
+    if (getPathArguments(env, info, 1, paths) == FALSE) {
+        return(NULL);
+    }
+
+    // An invalid file gives an empty array, like the ffi wrappers give an empty JSON array
+    GPXdoc *doc = loadValidGPXdoc(paths[0], getAddonSchema());
+    napi_value result = docTracksToArray(env, doc);
+    deleteGPXdoc(doc);
+    return(result);
+}
+
+static napi_value trackPointsAsync(napi_env env, napi_callback_info info) {
+
+    // The schema is parsed here on the main thread so the threadpool only ever reads it
+    getAddonSchema();
+    return(queueWork(env, info, "trackPointsAsync", 1, &executeTrackPoints, &completeTrackPoints));
+}
+
+static napi_value streamSummary(napi_env env, napi_callback_info info) {
+    return(queueStream(env, info, "streamSummary", &executeSummaryStream));
+}
+
+static napi_value streamGeometry(napi_env env, napi_callback_info info) {
+
+    // The schema is parsed here on the main thread so the threadpool only ever reads it
+    getAddonSchema();
+    return(queueStream(env, info, "streamGeometry", &executeGeometryStream));
+}
+
+static napi_value init(napi_env env, napi_value exports) {
+
+    // libxml2 sets up its global state once before any load can run on the threadpool, it is never shut down as the
+    // shared schema depends on it for as long as the process runs
+    if (gpx_library_init() == FALSE) {
+        napi_throw_error(env, NULL, "libxml2 could not be initialized");
+        return(NULL);
+    }
+
+    napi_property_descriptor properties[] = {
+        {"summary", NULL, &summary, NULL, NULL, NULL, napi_default, NULL},
+        {"summaryAsync", NULL, &summaryAsync, NULL, NULL, NULL, napi_default, NULL},
+        {"fileSummary", NULL, &fileSummary, NULL, NULL, NULL, napi_default, NULL},
+        {"fileSummaryAsync", NULL, &fileSummaryAsync, NULL, NULL, NULL, napi_default, NULL},
+        {"trackPoints", NULL, &trackPoints, NULL, NULL, NULL, napi_default, NULL},
+        {"trackPointsAsync", NULL, &trackPointsAsync, NULL, NULL, NULL, napi_default, NULL},
+        {"streamSummary", NULL, &streamSummary, NULL, NULL, NULL, napi_default, NULL},
+        {"streamGeometry", NULL, &streamGeometry, NULL, NULL, NULL, napi_default, NULL},
+    };
+    napi_define_properties(env, exports, sizeof(properties) / sizeof(properties[0]), properties);
+    return(exports);
+}
+
+NAPI_MODULE(gpxaddon, init)
+
+static bool getPathArguments(napi_env env, napi_callback_info info, size_t numPaths, char paths[][ADDON_PATH_LENGTH]) {
+
+    // Every function takes only strings, a directory or a file name
+    size_t argc = ADDON_MAX_PATHS;
+    napi_value argv[ADDON_MAX_PATHS];
+    napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    for (size_t i = 0; i < numPaths; i++) {
+        size_t length = 0;
+        if (i >= argc || napi_get_value_string_utf8(env, argv[i], paths[i], ADDON_PATH_LENGTH, &length) != napi_ok) {
+            napi_throw_type_error(env, NULL, "Expected a path string");
+            return(FALSE);
+        }
+        if (length >= ADDON_PATH_LENGTH - 1) {
+            napi_throw_range_error(env, NULL, "Path is too long");
+            return(FALSE);
+        }
+    }
+    return(TRUE);
+}
+
+static xmlSchemaPtr getAddonSchema(void) {
+    if (addonSchema == NULL) {
+        addonSchema = parseSchemaFile(ADDON_SCHEMA_FILE);
+    }
+    return(addonSchema);
+}
+
+static void setStringProperty(napi_env env, napi_value object, const char *key, const char *value) {
+    napi_value string;
+    napi_create_string_utf8(env, value, NAPI_AUTO_LENGTH, &string);
+    napi_set_named_property(env, object, key, string);
+}
+
+static void setNumberProperty(napi_env env, napi_value object, const char *key, double value) {
+    napi_value number;
+    napi_create_double(env, value, &number);
+    napi_set_named_property(env, object, key, number);
+}
+
+static void setBoolProperty(napi_env env, napi_value object, const char *key, bool value) {
+    napi_value boolean;
+    napi_get_boolean(env, value, &boolean);
+    napi_set_named_property(env, object, key, boolean);
+}
+
+static void setComponentProperties(napi_env env, napi_value object, const char *fileName, const char *name, int64_t numPoints, float length, bool loop) {
+
+    // The same fields as routeToJSON and trackToJSON, empty names are shown as "None" and lengths rounded to 10m
+    setStringProperty(env, object, "fileName", fileName);
+    setStringProperty(env, object, "name", (strcmp(name, "") == 0) ? "None" : name);
+    setNumberProperty(env, object, "numPoints", numPoints);
+    setNumberProperty(env, object, "len", round10(length));
+    setBoolProperty(env, object, "loop", loop);
+}
+
+static napi_value corpusToObject(napi_env env, const GPXCorpus *corpus) {
+    napi_value result, files, failedFiles;
+    napi_create_object(env, &result);
+    napi_create_array(env, &files);
+    napi_create_array(env, &failedFiles);
+    napi_set_named_property(env, result, "files", files);
+    napi_set_named_property(env, result, "failedFiles", failedFiles);
+
+    // A directory that could not be read is summarized as empty, like corpusSummaryToJSON does
+    if (corpus == NULL) {
+        return(result);
+    }
+
+    // Building the same objects corpusSummaryToJSON writes, without going through a JSON string
+    for (int i = 0; i < corpus -> numDocuments; i++) {
+        napi_set_element(env, files, i, docSummaryToObject(env, corpus -> documents[i].fileName, corpus -> documents[i].doc));
+    }
+
+    for (int i = 0; i < corpus -> numFailedFiles; i++) {
+        napi_value failedFile;
+        napi_create_string_utf8(env, corpus -> failedFiles[i], NAPI_AUTO_LENGTH, &failedFile);
+        napi_set_element(env, failedFiles, i, failedFile);
+    }
+
+    return(result);
+}
+
+static napi_value docSummaryToObject(napi_env env, const char *fileName, const GPXdoc *doc) {
+    if (doc == NULL) {
+        napi_value null;
+        napi_get_null(env, &null);
+        return(null);
+    }
+
+    napi_value file, routes, tracks;
+    napi_create_object(env, &file);
+    setStringProperty(env, file, "fileName", fileName);
+    setNumberProperty(env, file, "version", doc -> version);
+    setStringProperty(env, file, "creator", doc -> creator);
+    setNumberProperty(env, file, "numWaypoints", getLength(doc -> waypoints));
+    setNumberProperty(env, file, "numRoutes", getLength(doc -> routes));
+    setNumberProperty(env, file, "numTracks", getLength(doc -> tracks));
+
+    uint32_t routeNumber = 0;
+    napi_create_array(env, &routes);
+    ListIterator routeIterator = createIterator(doc -> routes);
+    void *routeElement;
+    while ((routeElement = nextElement(&routeIterator)) != NULL) {
+        Route *routeStruct = (Route*)routeElement;
+        napi_value route;
+        napi_create_object(env, &route);
+        setComponentProperties(env, route, fileName, routeStruct -> name, getLength(routeStruct -> waypoints), getRouteLen(routeStruct), isLoopRoute(routeStruct, 10));
+        napi_set_element(env, routes, routeNumber++, route);
+    }
+
+    uint32_t trackNumber = 0;
+    napi_create_array(env, &tracks);
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    void *trackElement;
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+        Track *trackStruct = (Track*)trackElement;
+        int64_t numPoints = 0;
+        ListIterator segmentIterator = createIterator(trackStruct -> segments);
+        void *segmentElement;
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            numPoints += getSegmentNumPoints((TrackSegment*)segmentElement);
+        }
+
+        napi_value track;
+        napi_create_object(env, &track);
+        setComponentProperties(env, track, fileName, trackStruct -> name, numPoints, getTrackLen(trackStruct), isLoopTrack(trackStruct, 10));
+        napi_set_element(env, tracks, trackNumber++, track);
+    }
+
+    napi_set_named_property(env, file, "routes", routes);
+    napi_set_named_property(env, file, "tracks", tracks);
+    return(file);
+}
+
+static napi_value scanSummaryToObject(napi_env env, const char *fileName, const AddonWork *work) {
+    if (work -> scanned == FALSE) {
+        napi_value null;
+        napi_get_null(env, &null);
+        return(null);
+    }
+
+    // Building the same object docSummaryToObject builds, from the counts and components of the scan
+    napi_value file, routes, tracks;
+    napi_create_object(env, &file);
+    setStringProperty(env, file, "fileName", fileName);
+    setNumberProperty(env, file, "version", work -> scan.version);
+    setStringProperty(env, file, "creator", work -> scan.creator);
+    setNumberProperty(env, file, "numWaypoints", work -> scan.numWaypoints);
+    setNumberProperty(env, file, "numRoutes", work -> scan.numRoutes);
+    setNumberProperty(env, file, "numTracks", work -> scan.numTracks);
+
+    uint32_t routeNumber = 0;
+    uint32_t trackNumber = 0;
+    napi_create_array(env, &routes);
+    napi_create_array(env, &tracks);
+    for (int64_t i = 0; i < work -> numComponents; i++) {
+        const AddonComponent *component = &work -> components[i];
+        napi_value object;
+        napi_create_object(env, &object);
+        setComponentProperties(env, object, fileName, component -> name, component -> numPoints, component -> length, component -> loop);
+        if (component -> type == GPX_ROUTE) {
+            napi_set_element(env, routes, routeNumber++, object);
+        }
+        else {
+            napi_set_element(env, tracks, trackNumber++, object);
+        }
+    }
+
+    napi_set_named_property(env, file, "routes", routes);
+    napi_set_named_property(env, file, "tracks", tracks);
+    return(file);
+}
+
+static bool keepScannedComponent(void *context, const ScannedComponent *component) {
+    AddonWork *work = (AddonWork*)context;
+
+    // Doubling the array when it is full, the name is only valid during the callback so it is copied
+    if (work -> numComponents == work -> componentCapacity) {
+        int64_t capacity = (work -> componentCapacity == 0) ? 16 : work -> componentCapacity * 2;
+        AddonComponent *components = realloc(work -> components, capacity * sizeof(AddonComponent));
+        if (components == NULL) {
+            fprintf(stderr, "ERROR: Could not allocate the scanned components\n");
+            return(FALSE);
+        }
+        work -> components = components;
+        work -> componentCapacity = capacity;
+    }
+    AddonComponent *kept = &work -> components[work -> numComponents++];
+    kept -> type = component -> type;
+    kept -> name = malloc(strlen(component -> name) + 1);
+    strcpy(kept -> name, component -> name);
+    kept -> numPoints = component -> numPoints;
+    kept -> length = component -> length;
+    kept -> loop = component -> loop;
+    return(TRUE);
+}
+
+static void initAddonWork(AddonWork *work) {
+    work -> corpus = NULL;
+    work -> doc = NULL;
+    work -> scan.creator = NULL;
+    work -> scanned = FALSE;
+    work -> components = NULL;
+    work -> numComponents = 0;
+    work -> componentCapacity = 0;
+}
+
+static void clearScanResult(AddonWork *work) {
+    for (int64_t i = 0; i < work -> numComponents; i++) {
+        free(work -> components[i].name);
+    }
+    free(work -> components);
+    work -> components = NULL;
+    work -> numComponents = 0;
+    work -> componentCapacity = 0;
+    clearGPXScan(&work -> scan);
+}
+
+static napi_value columnToTypedArray(napi_env env, const double *column, int64_t numPoints) {
+
+    // Copying the column into a Float64Array in one go, no number is boxed on the way
+    void *data;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, numPoints * sizeof(double), &data, &buffer);
+    if (numPoints > 0) {
+        memcpy(data, column, numPoints * sizeof(double));
+    }
+    napi_create_typedarray(env, napi_float64_array, numPoints, buffer, 0, &array);
+    return(array);
+}
+
+static void coordinatesToTypedArrays(napi_env env, const TrackSegment *segment, napi_value *latitudes, napi_value *longitudes) {
+
+    // Copying the coordinates a run at a time with a segment cursor, which decodes compacted segments on the way
+    int64_t numPoints = getSegmentNumPoints(segment);
+    void *latitudeData, *longitudeData;
+    napi_value latitudeBuffer, longitudeBuffer;
+    napi_create_arraybuffer(env, numPoints * sizeof(double), &latitudeData, &latitudeBuffer);
+    napi_create_arraybuffer(env, numPoints * sizeof(double), &longitudeData, &longitudeBuffer);
+    SegmentCursor cursor;
+    openSegmentCursor(&cursor, segment);
+    while (nextSegmentRun(&cursor) > 0) {
+        memcpy((double*)latitudeData + cursor.firstPoint, cursor.latitudes, cursor.numPoints * sizeof(double));
+        memcpy((double*)longitudeData + cursor.firstPoint, cursor.longitudes, cursor.numPoints * sizeof(double));
+    }
+    napi_create_typedarray(env, napi_float64_array, numPoints, latitudeBuffer, 0, latitudes);
+    napi_create_typedarray(env, napi_float64_array, numPoints, longitudeBuffer, 0, longitudes);
+}
+
+static napi_value timesToTypedArray(napi_env env, const int64_t *times, int64_t numPoints) {
+
+    // Times become milliseconds since the epoch, which Date takes as is, and NaN where a point has no time
+    void *data;
+    napi_value buffer, array;
+    napi_create_arraybuffer(env, numPoints * sizeof(double), &data, &buffer);
+    double *milliseconds = (double*)data;
+    for (int64_t i = 0; i < numPoints; i++) {
+        milliseconds[i] = (times[i] == GPX_NO_TIME) ? NAN : (double)times[i];
+    }
+    napi_create_typedarray(env, napi_float64_array, numPoints, buffer, 0, &array);
+    return(array);
+}
+
+static napi_value docTracksToArray(napi_env env, const GPXdoc *doc) {
+    napi_value tracks;
+    napi_create_array(env, &tracks);
+    if (doc == NULL) {
+        return(tracks);
+    }
+
+    // Each track is its name and a list of segments, each segment holding one Float64Array per point column
+    uint32_t trackNumber = 0;
+    ListIterator trackIterator = createIterator(doc -> tracks);
+    void *trackElement;
+    while ((trackElement = nextElement(&trackIterator)) != NULL) {
+        Track *trackStruct = (Track*)trackElement;
+        napi_value track, segments;
+        napi_create_object(env, &track);
+        napi_create_array(env, &segments);
+        setStringProperty(env, track, "name", (strcmp(trackStruct -> name, "") == 0) ? "None" : trackStruct -> name);
+
+        uint32_t segmentNumber = 0;
+        ListIterator segmentIterator = createIterator(trackStruct -> segments);
+        void *segmentElement;
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL) {
+            TrackSegment *segmentStruct = (TrackSegment*)segmentElement;
+            napi_value segment, latitudes, longitudes;
+            napi_create_object(env, &segment);
+            coordinatesToTypedArrays(env, segmentStruct, &latitudes, &longitudes);
+            napi_set_named_property(env, segment, "latitudes", latitudes);
+            napi_set_named_property(env, segment, "longitudes", longitudes);
+            napi_set_named_property(env, segment, "elevations", columnToTypedArray(env, segmentStruct -> elevations, segmentStruct -> numPoints));
+            napi_set_named_property(env, segment, "times", timesToTypedArray(env, segmentStruct -> times, segmentStruct -> numPoints));
+            napi_set_element(env, segments, segmentNumber++, segment);
+        }
+
+        napi_set_named_property(env, track, "segments", segments);
+        napi_set_element(env, tracks, trackNumber++, track);
+    }
+
+    return(tracks);
+}
+
+static napi_value queueWork(napi_env env, napi_callback_info info, const char *name, size_t numPaths, napi_async_execute_callback execute, napi_async_complete_callback complete) {
+    AddonWork *work = malloc(sizeof(AddonWork));
+    initAddonWork(work);
+    if (getPathArguments(env, info, numPaths, work -> paths) == FALSE) {
+        free(work);
+        return(NULL);
+    }
+
+    // The load runs on the libuv threadpool and the promise is settled back on the main thread
+    napi_value promise, resourceName;
+    napi_create_promise(env, &work -> deferred, &promise);
+    napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resourceName);
+    napi_create_async_work(env, NULL, resourceName, execute, complete, work, &work -> work);
+    napi_queue_async_work(env, work -> work);
+    return(promise);
+}
+
+static napi_value queueStream(napi_env env, napi_callback_info info, const char *name, napi_async_execute_callback execute) {
+    AddonStream *stream = malloc(sizeof(AddonStream));
+    stream -> written = FALSE;
+    if (getPathArguments(env, info, 1, stream -> paths) == FALSE) {
+        free(stream);
+        return(NULL);
+    }
+
+    // The callback the chunks are passed to follows the path
+    size_t argc = 2;
+    napi_value argv[2];
+    napi_valuetype callbackType = napi_undefined;
+    napi_get_cb_info(env, info, &argc, argv, NULL, NULL);
+    if (argc >= 2) {
+        napi_typeof(env, argv[1], &callbackType);
+    }
+    if (callbackType != napi_function) {
+        napi_throw_type_error(env, NULL, "Expected a chunk callback");
+        free(stream);
+        return(NULL);
+    }
+
+    // The JSON is written on the libuv threadpool, each chunk is passed to the callback on the main thread as a Buffer
+    napi_value promise, resourceName;
+    napi_create_promise(env, &stream -> deferred, &promise);
+    napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &resourceName);
+    napi_create_threadsafe_function(env, argv[1], NULL, resourceName, ADDON_STREAM_QUEUE, 1, stream, &finalizeStream, NULL, &callChunkCallback, &stream -> onChunk);
+    napi_create_async_work(env, NULL, resourceName, execute, &completeStream, stream, &stream -> work);
+    napi_queue_async_work(env, stream -> work);
+    return(promise);
+}
+
+static bool streamSink(void *context, const char *bytes, size_t length) {
+    AddonStream *stream = (AddonStream*)context;
+
+    // Copying the chunk for the main thread, waiting while the queue is full
+    AddonChunk *chunk = malloc(sizeof(AddonChunk) + length);
+    chunk -> length = length;
+    memcpy(chunk -> bytes, bytes, length);
+    if (napi_call_threadsafe_function(stream -> onChunk, chunk, napi_tsfn_blocking) != napi_ok) {
+        free(chunk);
+        return(FALSE);
+    }
+    return(TRUE);
+}
+
+static void callChunkCallback(napi_env env, napi_value callback, void *context, void *data) {
+    AddonChunk *chunk = (AddonChunk*)data;
+
+    // The environment is NULL when Node is shutting down, the chunk is then only freed
+    if (env != NULL) {
+        napi_value buffer, undefined;
+        napi_create_buffer_copy(env, chunk -> length, chunk -> bytes, NULL, &buffer);
+        napi_get_undefined(env, &undefined);
+        napi_call_function(env, undefined, callback, 1, &buffer, NULL);
+    }
+    free(chunk);
+}
+
+static void executeSummaryStream(napi_env env, void *data) {
+    AddonStream *stream = (AddonStream*)data;
+    GPXCorpus *corpus = createGPXCorpus(stream -> paths[0], ADDON_SCHEMA_FILE);
+    JSONWriter writer;
+    initJSONWriter(&writer, &streamSink, stream);
+    stream -> written = writeCorpusSummary(&writer, corpus);
+    deleteGPXCorpus(corpus);
+}
+
+static void executeGeometryStream(napi_env env, void *data) {
+    AddonStream *stream = (AddonStream*)data;
+    GPXdoc *doc = loadValidGPXdoc(stream -> paths[0], addonSchema);
+    JSONWriter writer;
+    initJSONWriter(&writer, &streamSink, stream);
+
+    // An invalid file is an empty FeatureCollection, like geometryOfFile gives
+    if (doc == NULL) {
+        writeJSONText(&writer, "{\"type\":\"FeatureCollection\",\"features\":[]}");
+    }
+    else {
+        writeDocGeoJSON(&writer, doc);
+        deleteGPXdoc(doc);
+    }
+    stream -> written = flushJSONWriter(&writer);
+}
+
+static void completeStream(napi_env env, napi_status status, void *data) {
+    AddonStream *stream = (AddonStream*)data;
+
+    // Releasing the callback lets Node finalize it once the chunks still queued have been passed to it
+    napi_delete_async_work(env, stream -> work);
+    napi_release_threadsafe_function(stream -> onChunk, napi_tsfn_release);
+}
+
+static void finalizeStream(napi_env env, void *data, void *hint) {
+    AddonStream *stream = (AddonStream*)data;
+
+    // Every chunk has been passed to the callback by now, so the promise settles after the last one
+    napi_value written;
+    napi_get_boolean(env, stream -> written, &written);
+    napi_resolve_deferred(env, stream -> deferred, written);
+    free(stream);
+}
+
+static void executeSummary(napi_env env, void *data) {
+    AddonWork *work = (AddonWork*)data;
+    work -> corpus = createGPXCorpus(work -> paths[0], ADDON_SCHEMA_FILE);
+}
+
+static void completeSummary(napi_env env, napi_status status, void *data) {
+    AddonWork *work = (AddonWork*)data;
+    napi_resolve_deferred(env, work -> deferred, corpusToObject(env, work -> corpus));
+    deleteGPXCorpus(work -> corpus);
+    napi_delete_async_work(env, work -> work);
+    free(work);
+}
+
+static void executeFileSummary(napi_env env, void *data) {
+    AddonWork *work = (AddonWork*)data;
+    char *filePath = malloc(strlen(work -> paths[0]) + 1 + strlen(work -> paths[1]) + 1);
+    sprintf(filePath, "%s/%s", work -> paths[0], work -> paths[1]);
+
+    // The file is only scanned, its routes and tracks are kept until the main thread turns them into objects
+    work -> scanned = (addonSchema != NULL) && scanGPXFile(filePath, addonSchema, &work -> scan, &keepScannedComponent, work);
+    free(filePath);
+}
+
+static void completeFileSummary(napi_env env, napi_status status, void *data) {
+    AddonWork *work = (AddonWork*)data;
+    napi_resolve_deferred(env, work -> deferred, scanSummaryToObject(env, work -> paths[1], work));
+    clearScanResult(work);
+    napi_delete_async_work(env, work -> work);
+    free(work);
+}
+
+static void executeTrackPoints(napi_env env, void *data) {
+    AddonWork *work = (AddonWork*)data;
+    work -> doc = loadValidGPXdoc(work -> paths[0], addonSchema);
+}
+
+static void completeTrackPoints(napi_env env, napi_status status, void *data) {
+    AddonWork *work = (AddonWork*)data;
+    napi_resolve_deferred(env, work -> deferred, docTracksToArray(env, work -> doc));
+    deleteGPXdoc(work -> doc);
+    napi_delete_async_work(env, work -> work);
+    free(work);
+}
@@ -0,0 +1,36 @@
+#ifndef GPX_TEST_H
+#define GPX_TEST_H
+
+#include <stdio.h>
+
+// Schema the tests validate with, the tests are run from parser/ by "make test"
+#define TEST_SCHEMA_FILE "src/gpx.xsd"
+#define TEST_FIXTURE_DIRECTORY "test/fixtures/"
+
+// Number of checks that failed in the test program, main returns it so make stops on a failing test
+static int numFailedChecks = 0;
+
+// Checks a condition and prints the message with where it failed, the test carries on with its other checks
+// Failures go to stdout, the errors the parser prints to stderr for the malformed input the tests give it are expected
+#define GPX_CHECK(condition, ...) \
+    do { \
+        if (!(condition)) { \
+            printf("FAILED: %s:%d: ", __FILE__, __LINE__); \
+            printf(__VA_ARGS__); \
+            printf("\n"); \
+            numFailedChecks++; \
+        } \
+    } while (0)
+
+// Prints the number of failed checks of the test program and returns its exit status
+static inline int finishTest(const char *testName) {
+    if (numFailedChecks == 0) {
+        printf("%s: passed\n", testName);
+    }
+    else {
+        printf("%s: %d checks failed\n", testName, numFailedChecks);
+    }
+    return(numFailedChecks == 0 ? 0 : 1);
+}
+
+#endif
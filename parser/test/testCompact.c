@@ -0,0 +1,169 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXCompact.h"
+#include "GPXStats.h"
+#include "GPXTest.h"
+
+// Segments of the fixture, one over several blocks with jumps to both poles and across the antimeridian, one of exactly a block and a single point
+#define COMPACT_FIXTURE TEST_FIXTURE_DIRECTORY "compactTrack.gpx"
+#define NUM_FIXTURE_SEGMENTS 3
+
+// Where the compacted document is written to be loaded again, next to the test programs
+#define WRITTEN_FILE "bin/testCompactWritten.gpx"
+
+// A segment's points and statistics as they were before it was compacted
+typedef struct {
+    int64_t numPoints;
+    double *latitudes;
+    double *longitudes;
+    double *elevations;
+    int64_t *times;
+    MotionStats stats;
+} SavedSegment;
+
+static void saveSegment(SavedSegment *saved, const TrackSegment *segment);
+static void checkCompactedSegment(const SavedSegment *saved, const TrackSegment *segment, int number);
+static void checkWrittenSegment(const SavedSegment *saved, const TrackSegment *segment, int number);
+static double compactedLongitude(double longitude);
+static List *getFixtureSegments(const GPXdoc *doc);
+
+int main(void) {
+    GPXdoc *doc = createValidGPXdoc(COMPACT_FIXTURE, TEST_SCHEMA_FILE);
+    GPX_CHECK(doc != NULL, "%s could not be loaded", COMPACT_FIXTURE);
+    if (doc == NULL) {
+        return(finishTest("testCompact"));
+    }
+
+    // Keeping the coordinates of every segment from its columns before they are replaced
+    SavedSegment saved[NUM_FIXTURE_SEGMENTS];
+    int numSegments = 0;
+    void *segmentElement;
+    ListIterator segmentIterator = createIterator(getFixtureSegments(doc));
+    while ((segmentElement = nextElement(&segmentIterator)) != NULL && numSegments < NUM_FIXTURE_SEGMENTS) {
+        saveSegment(&saved[numSegments++], (TrackSegment*)segmentElement);
+    }
+    GPX_CHECK(numSegments == NUM_FIXTURE_SEGMENTS, "the fixture has %d segments", numSegments);
+
+    // Every segment is compacted once, a second time changes nothing
+    GPX_CHECK(compactGPXdoc(doc) == numSegments, "not every segment was compacted");
+    GPX_CHECK(compactGPXdoc(doc) == 0, "a compacted segment was compacted again");
+
+    // Decoding gives back each coordinate rounded to 1e-7 degrees, with the elevations, times and statistics unchanged
+    int number = 0;
+    segmentIterator = createIterator(getFixtureSegments(doc));
+    while ((segmentElement = nextElement(&segmentIterator)) != NULL && number < numSegments) {
+        checkCompactedSegment(&saved[number], (TrackSegment*)segmentElement, number);
+        number++;
+    }
+
+    // The compacted document is still valid and writing it gives back the decoded coordinates, elevations and times
+    GPX_CHECK(validateGPXDoc(doc, TEST_SCHEMA_FILE) == TRUE, "the compacted document does not validate");
+    GPX_CHECK(writeGPXdoc(doc, WRITTEN_FILE) == TRUE, "the compacted document could not be written");
+    GPXdoc *written = createValidGPXdoc(WRITTEN_FILE, TEST_SCHEMA_FILE);
+    GPX_CHECK(written != NULL, "the written document could not be loaded");
+    if (written != NULL) {
+        number = 0;
+        segmentIterator = createIterator(getFixtureSegments(written));
+        while ((segmentElement = nextElement(&segmentIterator)) != NULL && number < numSegments) {
+            checkWrittenSegment(&saved[number], (TrackSegment*)segmentElement, number);
+            number++;
+        }
+        GPX_CHECK(number == numSegments, "the written document has %d segments", number);
+    }
+    remove(WRITTEN_FILE);
+
+    for (int i = 0; i < numSegments; i++) {
+        free(saved[i].latitudes);
+        free(saved[i].longitudes);
+        free(saved[i].elevations);
+        free(saved[i].times);
+    }
+    deleteGPXdoc(written);
+    deleteGPXdoc(doc);
+    xmlCleanupParser();
+    return(finishTest("testCompact"));
+}
+
+static void saveSegment(SavedSegment *saved, const TrackSegment *segment) {
+    saved -> numPoints = segment -> numPoints;
+    saved -> latitudes = malloc((segment -> numPoints + 1) * sizeof(double));
+    saved -> longitudes = malloc((segment -> numPoints + 1) * sizeof(double));
+    saved -> elevations = malloc((segment -> numPoints + 1) * sizeof(double));
+    saved -> times = malloc((segment -> numPoints + 1) * sizeof(int64_t));
+    memcpy(saved -> latitudes, segment -> latitudes, segment -> numPoints * sizeof(double));
+    memcpy(saved -> longitudes, segment -> longitudes, segment -> numPoints * sizeof(double));
+    memcpy(saved -> elevations, segment -> elevations, segment -> numPoints * sizeof(double));
+    memcpy(saved -> times, segment -> times, segment -> numPoints * sizeof(int64_t));
+    getSegmentStats(segment, 0.5, 2, &saved -> stats);
+}
+
+static void checkCompactedSegment(const SavedSegment *saved, const TrackSegment *segment, int number) {
+    GPX_CHECK(segment -> compact != NULL && segment -> latitudes == NULL, "segment %d was not compacted", number);
+    GPX_CHECK(getLength(segment -> waypoints) == 0, "segment %d kept its waypoints", number);
+    GPX_CHECK(getSegmentNumPoints(segment) == saved -> numPoints, "segment %d has %lld points instead of %lld", number,
+        (long long)getSegmentNumPoints(segment), (long long)saved -> numPoints);
+
+    // Reading each point on its own and with a cursor a block at a time gives the same rounded coordinates
+    SegmentCursor cursor;
+    openSegmentCursor(&cursor, segment);
+    int64_t numRead = 0;
+    while (nextSegmentRun(&cursor) > 0) {
+        GPX_CHECK(cursor.firstPoint == numRead && cursor.numPoints <= COMPACT_BLOCK_POINTS, "segment %d has a run of %lld points at %lld", number,
+            (long long)cursor.numPoints, (long long)cursor.firstPoint);
+        for (int64_t i = 0; i < cursor.numPoints && numRead < saved -> numPoints; i++, numRead++) {
+            double latitude = llround(saved -> latitudes[numRead] * COMPACT_SCALE) / COMPACT_SCALE;
+            double longitude = compactedLongitude(saved -> longitudes[numRead]);
+            GPX_CHECK(cursor.latitudes[i] == latitude && cursor.longitudes[i] == longitude, "point %lld of segment %d was decoded as %.9f,%.9f instead of %.9f,%.9f",
+                (long long)numRead, number, cursor.latitudes[i], cursor.longitudes[i], latitude, longitude);
+
+            double pointLatitude, pointLongitude;
+            GPX_CHECK(getSegmentPoint(segment, numRead, &pointLatitude, &pointLongitude) == TRUE && pointLatitude == latitude && pointLongitude == longitude,
+                "point %lld of segment %d was read on its own as %.9f,%.9f", (long long)numRead, number, pointLatitude, pointLongitude);
+        }
+    }
+    GPX_CHECK(numRead == saved -> numPoints, "the cursor read %lld points of segment %d", (long long)numRead, number);
+    double latitude, longitude;
+    GPX_CHECK(getSegmentPoint(segment, -1, &latitude, &longitude) == TRUE && latitude == llround(saved -> latitudes[saved -> numPoints - 1] * COMPACT_SCALE) / COMPACT_SCALE,
+        "the last point of segment %d was not read from the end", number);
+    GPX_CHECK(getSegmentPoint(segment, saved -> numPoints, &latitude, &longitude) == FALSE && getSegmentPoint(segment, -saved -> numPoints - 1, &latitude, &longitude) == FALSE,
+        "a point outside of segment %d was read", number);
+
+    // Elevations and times are kept as they were, so the statistics only move by the rounding of the coordinates
+    GPX_CHECK(memcmp(segment -> elevations, saved -> elevations, saved -> numPoints * sizeof(double)) == 0, "the elevations of segment %d changed", number);
+    GPX_CHECK(memcmp(segment -> times, saved -> times, saved -> numPoints * sizeof(int64_t)) == 0, "the times of segment %d changed", number);
+    MotionStats stats;
+    getSegmentStats(segment, 0.5, 2, &stats);
+    GPX_CHECK(stats.numPoints == saved -> stats.numPoints && fabs(stats.distance - saved -> stats.distance) < 0.01 * saved -> numPoints &&
+        stats.elevationGain == saved -> stats.elevationGain && stats.startTime == saved -> stats.startTime && stats.endTime == saved -> stats.endTime,
+        "the statistics of segment %d changed", number);
+}
+
+static void checkWrittenSegment(const SavedSegment *saved, const TrackSegment *segment, int number) {
+    GPX_CHECK(segment -> numPoints == saved -> numPoints, "the written segment %d has %lld points", number, (long long)segment -> numPoints);
+    for (int64_t i = 0; i < segment -> numPoints && i < saved -> numPoints; i++) {
+        double latitude = llround(saved -> latitudes[i] * COMPACT_SCALE) / COMPACT_SCALE;
+        double longitude = compactedLongitude(saved -> longitudes[i]);
+        GPX_CHECK(segment -> latitudes[i] == latitude && segment -> longitudes[i] == longitude, "point %lld of the written segment %d is %.9f,%.9f instead of %.9f,%.9f",
+            (long long)i, number, segment -> latitudes[i], segment -> longitudes[i], latitude, longitude);
+        GPX_CHECK((isnan(segment -> elevations[i]) && isnan(saved -> elevations[i])) || segment -> elevations[i] == saved -> elevations[i],
+            "the elevation of point %lld of the written segment %d changed", (long long)i, number);
+        GPX_CHECK(segment -> times[i] == saved -> times[i], "the time of point %lld of the written segment %d changed", (long long)i, number);
+    }
+}
+
+static double compactedLongitude(double longitude) {
+
+    // Rounded to 1e-7 degrees like every coordinate, except that a longitude below 180 stays below it as the schema requires
+    int64_t rounded = llround(longitude * COMPACT_SCALE);
+    if (rounded == (int64_t)(180 * COMPACT_SCALE) && longitude < 180) {
+        rounded--;
+    }
+    return(rounded / COMPACT_SCALE);
+}
+
+static List *getFixtureSegments(const GPXdoc *doc) {
+
+    // The fixture's segments are all in its only track
+    return(((Track*)getFromFront(doc -> tracks)) -> segments);
+}
@@ -0,0 +1,119 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXJSON.h"
+#include "GPXTest.h"
+
+// Longest string checked, past two 32 byte vector blocks so a character is seen in every position of both widths and of the tail
+#define MAX_ESCAPE_LENGTH 80
+
+static void checkEscape(const char *text);
+static void appendReferenceEscape(StringBuffer *buffer, const char *text);
+static bool readStringValue(void *context, JSONEvent event, const JSONValue *value);
+static bool stopAfterFirstPiece(void *context, const char *bytes, size_t length);
+
+int main(void) {
+
+    // Every character that needs an escape, in every position of strings of every length up to a few vector blocks
+    char specials[34];
+    int numSpecials = 0;
+    for (int character = 1; character < 0x20; character++) {
+        specials[numSpecials++] = (char)character;
+    }
+    specials[numSpecials++] = '"';
+    specials[numSpecials++] = '\\';
+
+    char text[MAX_ESCAPE_LENGTH + 1];
+    for (int length = 1; length <= MAX_ESCAPE_LENGTH; length++) {
+        for (int position = 0; position < length; position++) {
+            for (int i = 0; i < numSpecials && numFailedChecks < 20; i++) {
+                memset(text, 'a', length);
+                text[length] = '\0';
+                text[position] = specials[i];
+                checkEscape(text);
+            }
+        }
+    }
+
+    // Bytes of UTF-8 characters and DEL need no escape, they have to pass through whole next to the characters that do
+    for (int length = 1; length <= MAX_ESCAPE_LENGTH; length++) {
+        for (int i = 0; i < length; i++) {
+            text[i] = (i % 3 == 0) ? (char)0xC3 : (i % 3 == 1) ? (char)0xA9 : (char)0x7F;
+        }
+        text[length] = '\0';
+        checkEscape(text);
+        text[length - 1] = '\n';
+        checkEscape(text);
+    }
+
+    // Strings where every character needs an escape, and the empty string
+    checkEscape("\"\\\"\\\n\r\t\b\f\x01\x1f\"\\\"\\\n\r\t\b\f\x01\x1f\"\\\"\\\n\r\t\b\f\x01\x1f\"\\\"\\\n\r\t\b\f\x01\x1f");
+    checkEscape("");
+
+    // NULL is written as an empty string, and a sink that stops part way makes the escape fail
+    StringBuffer buffer;
+    initStringBuffer(&buffer);
+    GPX_CHECK(escapeJSONString(NULL, &stringBufferSink, &buffer) == TRUE && strcmp(buffer.string, "\"\"") == 0, "NULL was escaped as %s", buffer.string);
+    free(buffer.string);
+    int numPieces = 0;
+    GPX_CHECK(escapeJSONString("a\nb", &stopAfterFirstPiece, &numPieces) == FALSE && numPieces == 1, "the escape went on after its sink stopped it");
+
+    return(finishTest("testEscape"));
+}
+
+static void checkEscape(const char *text) {
+    StringBuffer escaped;
+    StringBuffer expected;
+    initStringBuffer(&escaped);
+    initStringBuffer(&expected);
+    GPX_CHECK(escapeJSONString(text, &stringBufferSink, &escaped) == TRUE, "escaping a string of length %d failed", (int)strlen(text));
+    appendReferenceEscape(&expected, text);
+    GPX_CHECK(strcmp(escaped.string, expected.string) == 0, "a string of length %d was escaped as %s instead of %s", (int)strlen(text), escaped.string, expected.string);
+
+    // The escaped string has to read back as the original with the JSON reader
+    StringBuffer read;
+    initStringBuffer(&read);
+    GPX_CHECK(readJSON(escaped.string, &readStringValue, &read) == TRUE, "%s could not be read as a JSON string", escaped.string);
+    GPX_CHECK(read.string != NULL && strcmp(read.string, text) == 0, "%s was read back as a different string", escaped.string);
+
+    free(escaped.string);
+    free(expected.string);
+    free(read.string);
+}
+
+static void appendReferenceEscape(StringBuffer *buffer, const char *text) {
+
+    // A byte at a time, with the short escapes JSON has and \u00XX for every other control character
+    appendToStringBuffer(buffer, "\"");
+    for (const unsigned char *character = (const unsigned char*)text; *character != '\0'; character++) {
+        switch (*character) {
+            case '"': appendToStringBuffer(buffer, "\\\""); break;
+            case '\\': appendToStringBuffer(buffer, "\\\\"); break;
+            case '\n': appendToStringBuffer(buffer, "\\n"); break;
+            case '\r': appendToStringBuffer(buffer, "\\r"); break;
+            case '\t': appendToStringBuffer(buffer, "\\t"); break;
+            case '\b': appendToStringBuffer(buffer, "\\b"); break;
+            case '\f': appendToStringBuffer(buffer, "\\f"); break;
+            default:
+                if (*character < 0x20) {
+                    appendFormatToStringBuffer(buffer, "\\u%04x", *character);
+                }
+                else {
+                    appendBytesToStringBuffer(buffer, (const char*)character, 1);
+                }
+        }
+    }
+    appendToStringBuffer(buffer, "\"");
+}
+
+static bool readStringValue(void *context, JSONEvent event, const JSONValue *value) {
+    if (event == JSON_STRING) {
+        appendBytesToStringBuffer((StringBuffer*)context, value -> text, value -> length);
+    }
+    return(event == JSON_STRING);
+}
+
+static bool stopAfterFirstPiece(void *context, const char *bytes, size_t length) {
+    (*(int*)context)++;
+    return(FALSE);
+}
@@ -0,0 +1,132 @@
+#include <float.h>
+#include <stdlib.h>
+#include "GPXParser.h"
+#include "GPXNumber.h"
+#include "GPXTest.h"
+
+// Numbers of random values each round trip is checked with
+#define NUM_RANDOM_DOUBLES 200000
+#define NUM_RANDOM_DECIMALS 200000
+
+static uint64_t nextRandom(uint64_t *state);
+static void checkShortestRoundTrip(double value);
+static void checkParseMatchesStrtod(const char *string);
+static void checkFixedMatchesPrintf(double value, int decimals);
+
+int main(void) {
+
+    // Values the positional and exponent notations switch between, and the ends of the range of doubles
+    double values[] = {0.0, -0.0, 0.1, 0.2, 0.3, 1.0, -1.0, 43.5372991, -80.2289, 1e-12, 1e-13, 1.5e-15, 1e20, 1e21, 123456789012345678.0,
+        DBL_MAX, -DBL_MAX, DBL_MIN, 4.9e-324, 2.2250738585072009e-308, 9007199254740993.0, 5e-324 * 3};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        checkShortestRoundTrip(values[i]);
+    }
+
+    // Numbers written the way the GPX writer and the JSON output need them, positional without a trailing exponent
+    char string[GPX_NUMBER_STRING_LENGTH];
+    formatShortestDouble(43.5372991, string);
+    GPX_CHECK(strcmp(string, "43.5372991") == 0, "43.5372991 was written as %s", string);
+    formatShortestDouble(-80.2289, string);
+    GPX_CHECK(strcmp(string, "-80.2289") == 0, "-80.2289 was written as %s", string);
+    formatShortestDouble(0.1, string);
+    GPX_CHECK(strcmp(string, "0.1") == 0, "0.1 was written as %s", string);
+    formatShortestDouble(1e20, string);
+    GPX_CHECK(strchr(string, 'e') == NULL, "1e20 was written in exponent notation as %s", string);
+    formatShortestDouble(1.5e-15, string);
+    GPX_CHECK(strchr(string, 'e') != NULL, "1.5e-15 was written in positional notation as %s", string);
+
+    // Doubles made of random bits cover every exponent and significand
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < NUM_RANDOM_DOUBLES && numFailedChecks < 20; i++) {
+        uint64_t bits = nextRandom(&state);
+        double value;
+        memcpy(&value, &bits, sizeof(double));
+        if (isfinite(value)) {
+            checkShortestRoundTrip(value);
+        }
+    }
+
+    // Coordinates and elevations as GPX files write them take the exact fast path, longer numbers are handed to strtod
+    const char *decimals[] = {"0", "-0", "43.5372991", "-80.2289", "  12.5", "1e5", "1.5E-3", "123456789012345", "1234567890123456789",
+        "0.1000000000000000055511151231257827", "4.9e-324", "1e400", "-1e-400", ".5", "5.", "+7", "1.7976931348623157e308"};
+    for (size_t i = 0; i < sizeof(decimals) / sizeof(decimals[0]); i++) {
+        checkParseMatchesStrtod(decimals[i]);
+    }
+    for (int i = 0; i < NUM_RANDOM_DECIMALS && numFailedChecks < 20; i++) {
+        uint64_t random = nextRandom(&state);
+        int numDigits = 1 + (int)(random % 20);
+        int point = (int)((random >> 8) % (numDigits + 1));
+        char decimal[64];
+        int length = 0;
+        if ((random >> 16) & 1) {
+            decimal[length++] = '-';
+        }
+        for (int digit = 0; digit < numDigits; digit++) {
+            if (digit == point) {
+                decimal[length++] = '.';
+            }
+            decimal[length++] = '0' + (char)(nextRandom(&state) % 10);
+        }
+        if ((random >> 17) & 1) {
+            length += sprintf(decimal + length, "e%d", (int)((random >> 20) % 41) - 20);
+        }
+        decimal[length] = '\0';
+        checkParseMatchesStrtod(decimal);
+    }
+
+    // Fixed decimals give the digits of printf in the ranges coordinates, elevations and lengths take,
+    // as long as the digits fit in a double's significand, past that the shortest digits are written
+    for (int i = 0; i < NUM_RANDOM_DOUBLES && numFailedChecks < 20; i++) {
+        uint64_t random = nextRandom(&state);
+        double value = ((double)(random >> 11) / (double)(1ULL << 53) - 0.5) * 2e6;
+        int decimals = (int)(nextRandom(&state) % 11);
+        if (fabs(value) * pow(10, decimals) < 9007199254740992.0) {
+            checkFixedMatchesPrintf(value, decimals);
+        }
+    }
+    checkFixedMatchesPrintf(0.5, 0);
+    checkFixedMatchesPrintf(1.5, 0);
+    checkFixedMatchesPrintf(2.675, 2);
+    checkFixedMatchesPrintf(-0.05, 1);
+
+    return(finishTest("testNumber"));
+}
+
+static uint64_t nextRandom(uint64_t *state) {
+
+    // xorshift64*, the tests only need a fixed sequence of well spread bits
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return(*state * 0x2545F4914F6CDD1DULL);
+}
+
+static void checkShortestRoundTrip(double value) {
+    char string[GPX_NUMBER_STRING_LENGTH];
+    int length = formatShortestDouble(value, string);
+    GPX_CHECK(length == (int)strlen(string) && length < GPX_NUMBER_STRING_LENGTH, "%.17g was written as %s with length %d", value, string, length);
+
+    // The string has to read back as exactly the same double with either reader, only the sign of zero is not written
+    char *end;
+    double parsed = parseDecimal(string, &end);
+    GPX_CHECK(*end == '\0' && parsed == value, "%.17g was written as %s which parseDecimal reads as %.17g", value, string, parsed);
+    double expected = strtod(string, NULL);
+    GPX_CHECK(expected == value, "%.17g was written as %s which strtod reads as %.17g", value, string, expected);
+}
+
+static void checkParseMatchesStrtod(const char *string) {
+    char *end;
+    char *expectedEnd;
+    double parsed = parseDecimal(string, &end);
+    double expected = strtod(string, &expectedEnd);
+    GPX_CHECK(memcmp(&parsed, &expected, sizeof(double)) == 0, "parseDecimal read %s as %.17g where strtod reads %.17g", string, parsed, expected);
+    GPX_CHECK(end == expectedEnd, "parseDecimal stopped reading %s after %d characters where strtod stops after %d", string, (int)(end - string), (int)(expectedEnd - string));
+}
+
+static void checkFixedMatchesPrintf(double value, int decimals) {
+    char string[GPX_NUMBER_STRING_LENGTH];
+    char expected[GPX_NUMBER_STRING_LENGTH * 2];
+    formatFixedDouble(value, decimals, string);
+    snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+    GPX_CHECK(strcmp(string, expected) == 0, "%.17g with %d decimals was written as %s where printf writes %s", value, decimals, string, expected);
+}
@@ -0,0 +1,90 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXQuery.h"
+#include "GPXBatch.h"
+#include "GPXTest.h"
+
+static void checkBatchTypes(const char *queries, int numQueries, const BatchQueryType *types);
+
+int main(void) {
+
+    // Expressions that cannot be read give no query at all rather than one missing a predicate
+    const char *malformed[] = {"type", "type:", "type:bogus", "type:route,,track", "type:route extra", ":route", "color:red", "name:\"Mount Steele",
+        "points:", "points:x", "points:-1", "points:5..x", "points:1..2..3", "points:nan", "points:inf", "points:1e20", "points:..99999999999",
+        "loop:", "loop:maybe", "loop:TRUE", "bbox:1,2,3", "bbox:1,2,3,4,5", "bbox:a,b,c,d", "bbox:1,2,3,4x", "bbox:nan,0,1,1", "bbox:0,0,1,inf",
+        "time:2021-01-01T00:00:00Z", "time:yesterday..", "time:..2021-13-01T00:00:00Z", "len:", "len:..-5", "len:nan", "len:inf..", "len:5..nan"};
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        GPXQuery *query = createGPXQuery(malformed[i]);
+        GPX_CHECK(query == NULL, "the malformed query \"%s\" was read", malformed[i]);
+        deleteGPXQuery(query);
+    }
+    GPX_CHECK(createGPXQuery(NULL) == NULL, "a NULL query was read");
+
+    // Well formed expressions are read whole
+    const char *wellFormed[] = {"", "   ", "type:route,track", "type:waypoint", "name:\"Mount Steele*\"", "name:", "points:5", "points:..10", "points:3..",
+        "loop:true", "bbox:43,-81,44,-80", "time:2021-01-01T00:00:00Z..", "time:..2021-01-01T00:00:00+05:00", "len:100..200.5",
+        "type:track points:2.. loop:false len:..1e6 bbox:-90,-180,90,180"};
+    for (size_t i = 0; i < sizeof(wellFormed) / sizeof(wellFormed[0]); i++) {
+        GPXQuery *query = createGPXQuery(wellFormed[i]);
+        GPX_CHECK(query != NULL, "the query \"%s\" was not read", wellFormed[i]);
+        deleteGPXQuery(query);
+    }
+
+    // The predicates hold the values of the expression
+    GPXQuery *query = createGPXQuery("type:route,track name:\"Mount Steele*\" points:2..8 loop:false len:..1500 bbox:44,-80,43,-81");
+    GPX_CHECK(query != NULL, "the combined query was not read");
+    if (query != NULL) {
+        GPX_CHECK(query -> types == (QUERY_ROUTES | QUERY_TRACKS), "the query has types %d", query -> types);
+        GPX_CHECK(query -> name != NULL && strcmp(query -> name, "Mount Steele") == 0 && query -> namePrefix == TRUE, "the query has the name %s", query -> name);
+        GPX_CHECK(query -> minPoints == 2 && query -> maxPoints == 8, "the query has points %d..%d", query -> minPoints, query -> maxPoints);
+        GPX_CHECK(query -> loop == 0, "the query has loop %d", query -> loop);
+        GPX_CHECK(query -> hasLength == TRUE && query -> minLength < 0 && query -> maxLength == 1500, "the query has length %f..%f", query -> minLength, query -> maxLength);
+        GPX_CHECK(query -> hasBox == TRUE && query -> box.minLatitude == 43 && query -> box.maxLatitude == 44 && query -> box.minLongitude == -81 &&
+            query -> box.maxLongitude == -80, "the query's box was not put in order");
+        deleteGPXQuery(query);
+    }
+
+    // A batch keeps a query it cannot read as BATCH_INVALID in its place, so the queries after it still line up with their results
+    GPX_CHECK(createGPXBatch(NULL) == NULL, "a NULL batch was read");
+    checkBatchTypes("count", 1, (BatchQueryType[]){BATCH_COUNT});
+    checkBatchTypes("count;", 1, (BatchQueryType[]){BATCH_COUNT});
+    checkBatchTypes("", 1, (BatchQueryType[]){BATCH_INVALID});
+    checkBatchTypes(";;count", 3, (BatchQueryType[]){BATCH_INVALID, BATCH_INVALID, BATCH_COUNT});
+    checkBatchTypes("  count  ;  routesWithLength 10 5  ", 2, (BatchQueryType[]){BATCH_COUNT, BATCH_ROUTES_WITH_LENGTH});
+    checkBatchTypes("count 1;bogus 1;routesNear 1 2;routesNear 1 2 3 4;routesNear 1 2 x;routesNear 1,2,3", 6,
+        (BatchQueryType[]){BATCH_INVALID, BATCH_INVALID, BATCH_INVALID, BATCH_INVALID, BATCH_INVALID, BATCH_INVALID});
+    checkBatchTypes("routesNear nan 2 3;tracksWithLength inf 5;tracksThrough 1 2 3 4 -inf;routesBetween 1 2 3 4 NAN", 4,
+        (BatchQueryType[]){BATCH_INVALID, BATCH_INVALID, BATCH_INVALID, BATCH_INVALID});
+    checkBatchTypes("routesBetween 1 2 3 4 5;bogus;tracksThrough 1 2 3 4 5;tracksNear -1.5 2e1 10", 4,
+        (BatchQueryType[]){BATCH_ROUTES_BETWEEN, BATCH_INVALID, BATCH_TRACKS_THROUGH, BATCH_TRACKS_NEAR});
+
+    GPXBatch *batch = createGPXBatch("tracksNear -1.5 2e1 10");
+    GPX_CHECK(batch != NULL && batch -> queries[0].arguments[0] == -1.5f && batch -> queries[0].arguments[1] == 20 && batch -> queries[0].arguments[2] == 10,
+        "the arguments of tracksNear were not read");
+    deleteGPXBatch(batch);
+
+    // The results of a batch with invalid queries still hold one entry for each query, null for the invalid ones
+    GPXdoc *doc = createValidGPXdoc(TEST_FIXTURE_DIRECTORY "compactTrack.gpx", TEST_SCHEMA_FILE);
+    batch = createGPXBatch("count;bogus;routesNear 1 2 nan");
+    GPX_CHECK(doc != NULL && batch != NULL, "the batch or its document could not be created");
+    if (doc != NULL && batch != NULL) {
+        char *results = batchDocToJSON(batch, doc);
+        GPX_CHECK(strstr(results, ",null,null]") != NULL, "the batch results were %s", results);
+        free(results);
+    }
+    deleteGPXBatch(batch);
+    deleteGPXdoc(doc);
+    xmlCleanupParser();
+
+    return(finishTest("testQuery"));
+}
+
+static void checkBatchTypes(const char *queries, int numQueries, const BatchQueryType *types) {
+    GPXBatch *batch = createGPXBatch(queries);
+    GPX_CHECK(batch != NULL && batch -> numQueries == numQueries, "the batch \"%s\" has %d queries instead of %d", queries, (batch != NULL) ? batch -> numQueries : -1, numQueries);
+    for (int i = 0; batch != NULL && i < batch -> numQueries && i < numQueries; i++) {
+        GPX_CHECK(batch -> queries[i].type == types[i], "query %d of the batch \"%s\" was read as type %d instead of %d", i + 1, queries, batch -> queries[i].type, types[i]);
+    }
+    deleteGPXBatch(batch);
+}
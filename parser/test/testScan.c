@@ -0,0 +1,51 @@
+#include "GPXParser.h"
+#include "LinkedListAPI.h"
+#include "GPXHelpers.h"
+#include "GPXScan.h"
+#include "GPXTest.h"
+
+static void checkScanAgreesWithLoad(xmlSchemaPtr schema, const char *fixture, bool valid);
+
+int main(void) {
+    xmlSchemaPtr schema = parseSchemaFile(TEST_SCHEMA_FILE);
+    GPX_CHECK(schema != NULL, "%s could not be parsed", TEST_SCHEMA_FILE);
+    if (schema == NULL) {
+        return(finishTest("testScan"));
+    }
+
+    // Point data the schema puts before <name> has to be written back before it, or the second validation loadGPXdoc makes rejects the file
+    checkScanAgreesWithLoad(schema, "elevationBeforeName.gpx", TRUE);
+    checkScanAgreesWithLoad(schema, "compactTrack.gpx", TRUE);
+
+    // Both have to reject a file the schema does not allow as well
+    checkScanAgreesWithLoad(schema, "nameAfterDescription.gpx", FALSE);
+
+    xmlSchemaFree(schema);
+    xmlCleanupParser();
+    return(finishTest("testScan"));
+}
+
+static void checkScanAgreesWithLoad(xmlSchemaPtr schema, const char *fixture, bool valid) {
+    char fileName[256];
+    snprintf(fileName, sizeof(fileName), "%s%s", TEST_FIXTURE_DIRECTORY, fixture);
+
+    GPXScan scan;
+    bool scanned = scanGPXFile(fileName, schema, &scan, NULL, NULL);
+    GPXdoc *doc = loadValidGPXdoc(fileName, schema);
+    GPX_CHECK(scanned == valid, "%s: scanGPXFile returned %d", fixture, scanned);
+    GPX_CHECK((doc != NULL) == valid, "%s: loadValidGPXdoc returned %s", fixture, (doc != NULL) ? "a GPXdoc" : "NULL");
+
+    // The counts of the scan are the ones the getNum functions return for the GPXdoc
+    if (scanned == TRUE && doc != NULL) {
+        GPX_CHECK(scan.version == doc -> version, "%s: the versions differ", fixture);
+        GPX_CHECK(scan.creator != NULL && strcmp(scan.creator, doc -> creator) == 0, "%s: the creators differ", fixture);
+        GPX_CHECK(scan.numWaypoints == getNumWaypoints(doc), "%s: the waypoint counts differ", fixture);
+        GPX_CHECK(scan.numRoutes == getNumRoutes(doc), "%s: the route counts differ", fixture);
+        GPX_CHECK(scan.numTracks == getNumTracks(doc), "%s: the track counts differ", fixture);
+        GPX_CHECK(scan.numSegments == getNumSegments(doc), "%s: the segment counts differ", fixture);
+        GPX_CHECK(scan.numGPXData == getNumGPXData(doc), "%s: the GPXData counts differ", fixture);
+    }
+
+    clearGPXScan(&scan);
+    deleteGPXdoc(doc);
+}
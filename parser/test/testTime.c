@@ -0,0 +1,80 @@
+#include "GPXParser.h"
+#include "GPXTime.h"
+#include "GPXTest.h"
+
+// Number of random times the round trip is checked with
+#define NUM_RANDOM_TIMES 200000
+
+// Milliseconds from the epoch to the start of year 292000000, past which parseGPXTime stops accepting years
+#define LAST_ROUND_TRIP_TIME 9214567816780800000LL
+
+static uint64_t nextRandom(uint64_t *state);
+static void checkSameTime(const char *string, const char *expected);
+
+int main(void) {
+    char string[GPX_TIME_STRING_LENGTH];
+
+    // Times written by formatGPXTime read back as the same time, down to the millisecond
+    int64_t times[] = {0, 1, -1, 999, 1614834367500LL, -62135596800000LL, -LAST_ROUND_TRIP_TIME, LAST_ROUND_TRIP_TIME};
+    for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+        formatGPXTime(times[i], string);
+        GPX_CHECK(parseGPXTime(string) == times[i], "%lld was written as %s which reads as %lld", (long long)times[i], string, (long long)parseGPXTime(string));
+    }
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < NUM_RANDOM_TIMES && numFailedChecks < 20; i++) {
+        // Every other time is kept within a few centuries of the epoch, where recorded tracks are
+        uint64_t random = nextRandom(&state);
+        int64_t range = (i % 2 == 0) ? LAST_ROUND_TRIP_TIME : 10000000000000LL;
+        int64_t time = (int64_t)((random >> 1) % range) * ((random & 1) ? -1 : 1);
+        formatGPXTime(time, string);
+        GPX_CHECK(parseGPXTime(string) == time, "%lld was written as %s which reads as %lld", (long long)time, string, (long long)parseGPXTime(string));
+    }
+
+    // Strings are written in UTC with milliseconds only when they are not 0
+    formatGPXTime(parseGPXTime("2021-03-04T05:06:07.5Z"), string);
+    GPX_CHECK(strcmp(string, "2021-03-04T05:06:07.500Z") == 0, "2021-03-04T05:06:07.5Z was written as %s", string);
+    formatGPXTime(0, string);
+    GPX_CHECK(strcmp(string, "1970-01-01T00:00:00Z") == 0, "the epoch was written as %s", string);
+
+    // Zones, the end of a day, leap seconds, years before 0 and surrounding whitespace are read as the same instant as their UTC time
+    checkSameTime("2021-03-04T05:06:07+01:30", "2021-03-04T03:36:07Z");
+    checkSameTime("2021-03-04T05:06:07-14:00", "2021-03-04T19:06:07Z");
+    checkSameTime("2021-03-04T05:06:07", "2021-03-04T05:06:07Z");
+    checkSameTime("2021-01-01T24:00:00Z", "2021-01-02T00:00:00Z");
+    checkSameTime("2016-12-31T23:59:60Z", "2017-01-01T00:00:00Z");
+    checkSameTime("2020-02-29T12:00:00Z", "2020-02-29T12:00:00.000Z");
+    checkSameTime(" \n2021-03-04T05:06:07Z\t", "2021-03-04T05:06:07Z");
+    checkSameTime("-0001-12-31T23:59:59.999Z", "-0001-12-31T23:59:59.999Z");
+
+    // Malformed times and times out of range are not read
+    const char *invalid[] = {"", "2021", "2021-03-04", "202-03-04T05:06:07Z", "2021-3-04T05:06:07Z", "2021-02-29T00:00:00Z", "2021-13-01T00:00:00Z",
+        "2021-00-10T00:00:00Z", "2021-01-32T00:00:00Z", "2021-01-01T25:00:00Z", "2021-01-01T24:00:01Z", "2021-01-01T00:60:00Z",
+        "2021-01-01T00:00:61Z", "2021-01-01T00:00:00.Z", "2021-01-01T00:00:00+15:00", "2021-01-01T00:00:00+01", "2021-01-01T00:00:00Zjunk",
+        "2021-01-01 00:00:00Z", "1234567890-01-01T00:00:00Z", "292000001-01-01T00:00:00Z", "-292000001-01-01T00:00:00Z", "999999999-12-31T00:00:00Z"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        GPX_CHECK(parseGPXTime(invalid[i]) == GPX_NO_TIME, "\"%s\" was read as %lld", invalid[i], (long long)parseGPXTime(invalid[i]));
+    }
+    GPX_CHECK(parseGPXTime(NULL) == GPX_NO_TIME, "NULL was read as a time");
+
+    // Times past the years parseGPXTime accepts are clamped, so the string always fits
+    formatGPXTime(INT64_MAX, string);
+    GPX_CHECK(strncmp(string, "292000000-", 10) == 0, "the largest time was written as %s", string);
+    formatGPXTime(INT64_MIN + 1, string);
+    GPX_CHECK(strncmp(string, "-292000000-", 11) == 0, "the smallest time was written as %s", string);
+
+    return(finishTest("testTime"));
+}
+
+static uint64_t nextRandom(uint64_t *state) {
+
+    // xorshift64*, the tests only need a fixed sequence of well spread bits
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return(*state * 0x2545F4914F6CDD1DULL);
+}
+
+static void checkSameTime(const char *string, const char *expected) {
+    int64_t time = parseGPXTime(string);
+    GPX_CHECK(time != GPX_NO_TIME && time == parseGPXTime(expected), "\"%s\" was read as %lld instead of the time of %s", string, (long long)time, expected);
+}
@@ -0,0 +1,157 @@
+"use strict";
+
+// Bounded pool of worker threads that run the C parser calls of app.js, with a queue, per call timeouts and backpressure
+const { Worker } = require("worker_threads");
+const os = require("os");
+const path = require("path");
+
+// Calls that rewrite an uploaded file, each of them runs alone so no other call reads a file while it is being written
+// Every other call runs next to any number of others, as the library never tears down libxml's global state between calls
+const WRITING_CALLS = new Set([
+	"renameGPXComponent",
+	"createGPXFile",
+	"addRouteToFile",
+	"addWaypointToRoute",
+	"addRoutesToFile",
+]);
+
+class ParserPool {
+	// size is the number of workers, maxQueue the number of calls that may wait for one, and timeout the milliseconds a call may take from when it is made
+	constructor(options = {}) {
+		this.size = options.size || Math.min(os.cpus().length, 4);
+		this.maxQueue = options.maxQueue || 64;
+		this.timeout = options.timeout || 10000;
+		this.queue = [];
+		this.nextId = 0;
+		this.slots = [];
+		for (let i = 0; i < this.size; i++) {
+			this.slots.push(this.createSlot());
+		}
+	}
+
+	// Function that runs a C function on a worker, returning a promise of its result
+	// The promise is rejected with code PARSER_BUSY when the queue is full, and PARSER_TIMEOUT when the call took too long
+	call(name, args, timeout = this.timeout) {
+		if (this.queue.length >= this.maxQueue) {
+			let error = new Error(`Parser queue is full, ${name} was not run`);
+			error.code = "PARSER_BUSY";
+			return Promise.reject(error);
+		}
+
+		return new Promise((resolve, reject) => {
+			let job = {
+				id: this.nextId++,
+				name: name,
+				args: args,
+				exclusive: WRITING_CALLS.has(name),
+				resolve: resolve,
+				reject: reject,
+				slot: null,
+				settled: false,
+			};
+			job.timer = setTimeout(() => this.expire(job), timeout);
+			this.queue.push(job);
+			this.dispatch();
+		});
+	}
+
+	// Function that creates a worker along with the slot tracking the job it is running
+	createSlot() {
+		let slot = {
+			worker: new Worker(path.join(__dirname, "parserWorker.js")),
+			job: null,
+			terminating: false,
+		};
+		slot.worker.on("message", (message) => this.finish(slot, message));
+		slot.worker.on("error", (error) => this.settle(slot.job, error));
+		slot.worker.on("exit", () => this.replace(slot));
+		return slot;
+	}
+
+	// Function that starts queued jobs, in order, on idle workers
+	dispatch() {
+		while (this.queue.length > 0) {
+			let busySlots = this.slots.filter((slot) => slot.job !== null);
+			let job = this.queue[0];
+
+			// Nothing starts next to an exclusive call, and an exclusive call waits for every worker to be idle
+			if (busySlots.some((slot) => slot.job.exclusive)) {
+				return;
+			}
+			if (job.exclusive && busySlots.length > 0) {
+				return;
+			}
+			let idleSlot = this.slots.find((slot) => slot.job === null);
+			if (idleSlot === undefined) {
+				return;
+			}
+
+			this.queue.shift();
+			idleSlot.job = job;
+			job.slot = idleSlot;
+			idleSlot.worker.postMessage({ id: job.id, name: job.name, args: job.args });
+		}
+	}
+
+	// Function that settles the job a worker finished and gives the worker its next job
+	finish(slot, message) {
+		let job = slot.job;
+		if (job === null || job.id !== message.id || slot.terminating) {
+			return;
+		}
+		slot.job = null;
+		if (message.error !== undefined) {
+			this.settle(job, new Error(message.error));
+		} else {
+			this.settle(job, null, message.result);
+		}
+		this.dispatch();
+	}
+
+	// Function that rejects a job which ran out of time
+	expire(job) {
+		let error = new Error(`Parser call ${job.name} timed out`);
+		error.code = "PARSER_TIMEOUT";
+
+		// A queued job is simply dropped from the queue
+		if (job.slot === null) {
+			this.queue.splice(this.queue.indexOf(job), 1);
+			this.settle(job, error);
+			return;
+		}
+
+		// A native call cannot be interrupted, so its worker is terminated and the slot stays busy until the thread has exited
+		this.settle(job, error);
+		job.slot.terminating = true;
+		job.slot.worker.terminate();
+	}
+
+	// Function that swaps an exited worker for a new one, failing the job it was running if it still had one
+	replace(slot) {
+		let index = this.slots.indexOf(slot);
+		if (index < 0) {
+			return;
+		}
+		if (slot.job !== null) {
+			this.settle(slot.job, new Error(`Parser worker exited while running ${slot.job.name}`));
+		}
+		this.slots[index] = this.createSlot();
+		this.dispatch();
+	}
+
+	// Function that resolves or rejects a job once, however many ways it ends
+	settle(job, error, result) {
+		if (job === null || job.settled) {
+			return;
+		}
+		job.settled = true;
+		clearTimeout(job.timer);
+		if (error) {
+			job.reject(error);
+		} else {
+			job.resolve(result);
+		}
+	}
+}
+
+module.exports = ParserPool;
@@ -0,0 +1,94 @@
+"use strict";
+
+// Worker thread of the parser pool, it loads the C library and runs the calls app.js sends so they never block the Express event loop
+const { parentPort } = require("worker_threads");
+const ffi = require("ffi-napi");
+
+// Return type of the C functions that return an allocated string, they are read as raw pointers so the worker can free them
+const STRING_RESULT = "pointer";
+
+// Signatures of the C functions app.js calls
+const signatures = {
+	GPXFiletoJSON: [STRING_RESULT, ["string"]],
+	GPXFiletoRouteListJSON: [STRING_RESULT, ["string"]],
+	GPXFiletoTrackListJSON: [STRING_RESULT, ["string"]],
+	GPXFiletoRouteGPXDataListJSON: [STRING_RESULT, ["string"]],
+	GPXFiletoTrackGPXDataListJSON: [STRING_RESULT, ["string"]],
+	renameGPXComponent: ["int", ["string", "string", "string", "int"]],
+	createGPXFile: ["int", ["string", "string"]],
+	addRouteToFile: ["int", ["string", "string"]],
+	addWaypointToRoute: ["int", ["string", "string"]],
+	addRoutesToFile: ["int", ["string", "string"]],
+	routeListOfRoutesBetween: [
+		STRING_RESULT,
+		["string", "float", "float", "float", "float", "float"],
+	],
+	trackListOfRoutesBetween: [
+		STRING_RESULT,
+		["string", "float", "float", "float", "float", "float"],
+	],
+	routeListOfRoutesAlong: [
+		STRING_RESULT,
+		["string", "float", "float", "float", "float", "float", "int"],
+	],
+	trackListOfTracksAlong: [
+		STRING_RESULT,
+		["string", "float", "float", "float", "float", "float", "int"],
+	],
+	summaryOfDirectory: [STRING_RESULT, ["string"]],
+	summaryOfFile: [STRING_RESULT, ["string", "string"]],
+	geometryOfFile: [STRING_RESULT, ["string"]],
+	geofenceOfDirectory: [STRING_RESULT, ["string", "string"]],
+	tracksActiveInDirectory: [STRING_RESULT, ["string", "string", "string"]],
+	trackStatsOfFile: [STRING_RESULT, ["string", "float", "float"]],
+	queryFile: [STRING_RESULT, ["string", "string"]],
+	queryDirectory: [STRING_RESULT, ["string", "string"]],
+	batchFile: [STRING_RESULT, ["string", "string"]],
+	batchDirectory: [STRING_RESULT, ["string", "string"]],
+	pointsInTimeWindowOfDirectory: [STRING_RESULT, ["string", "string", "string"]],
+	numberOfRoutesWithLengthFromFile: ["int64", ["string", "float", "float"]],
+	numberOfTracksWithLengthFromFile: ["int64", ["string", "float", "float"]],
+};
+
+// Names of the functions whose results have to be copied out and freed
+const stringCalls = new Set(
+	Object.keys(signatures).filter((name) => signatures[name][0] === STRING_RESULT)
+);
+
+// Creating an object called sharedLib that will contain the C functions, along with the one that takes their string results
+let sharedLib = ffi.Library("./libgpxparser", {
+	...signatures,
+	gpx_copy_result: ["int", ["pointer", "pointer", "int"]],
+	gpx_library_init: ["bool", []],
+});
+
+// Initializing the library once before this worker runs any call, the other workers may already be running theirs
+if (!sharedLib.gpx_library_init()) {
+	throw new Error("The parser library could not be initialized");
+}
+
+// Buffer the results are copied into, reused by every call and only grown when a result does not fit
+let resultBuffer = Buffer.alloc(64 * 1024);
+
+// Function that copies a string returned by the C library into the result buffer, where the library frees it, and returns it
+function takeResult(pointer) {
+	let length = sharedLib.gpx_copy_result(pointer, resultBuffer, resultBuffer.length);
+	if (length + 1 > resultBuffer.length) {
+		resultBuffer = Buffer.alloc(Math.max(length + 1, resultBuffer.length * 2));
+		sharedLib.gpx_copy_result(pointer, resultBuffer, resultBuffer.length);
+	}
+	return resultBuffer.toString("utf8", 0, length);
+}
+
+// Runs each call and posts back its result, or the message of the error it threw, under the id it was sent with
+parentPort.on("message", (message) => {
+	try {
+		let result = sharedLib[message.name](...message.args);
+		if (stringCalls.has(message.name)) {
+			result = takeResult(result);
+		}
+		parentPort.postMessage({ id: message.id, result: result });
+	} catch (error) {
+		parentPort.postMessage({ id: message.id, error: error.message });
+	}
+});
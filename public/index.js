@@ -41,14 +41,17 @@ $(document).ready(function () {
 
 	// On-load, loads all GPX attribute information regarding the successfully loaded files and appends their information onto the first table
 	$.ajax({
-		// Get request for a json data type from /GPXattributes
+		// Get request for a json data type from /uploadsSummary, the summary of every file with its routes and tracks
 		type: "get",
 		dataType: "json",
-		url: "/GPXattributes",
+		url: "/uploadsSummary",
 		// Function if the get request is successful
-		success: function (GPXData) {
-			// Traverses through the array of objects, GPXData contains only valid GPX files as only valid GPX files were included on the server side
-			$.each(GPXData.JSONObjectArray, function (i, data) {
+		success: function (summary) {
+			// Keeping the summary so that the routes and tracks of a file can be shown without another request
+			uploadsSummary = summary;
+
+			// Traverses through the array of objects, the summary contains only valid GPX files as the invalid ones were removed on the server side
+			$.each(summary.files, function (i, data) {
 				// Appends the GPX file data onto the first table giving various alert messages to the alert box and the console
 				console.log(`${data.fileName} successful upload`);
 				$("#FileLogRows").append(`<tr>
@@ -68,7 +71,7 @@ $(document).ready(function () {
 			});
 
 			// Checking the size of the array of objects, if it is 0, means that there are no files on the server and displays no file for the table
-			if (GPXData.JSONObjectArray.length === 0) {
+			if (summary.files.length === 0) {
 				$("#FileLogRows").append(`<tr>
                 <th scope="row">No files</th>
                 </tr>`);
@@ -76,15 +79,15 @@ $(document).ready(function () {
 			}
 
 			// If the failed uploads is greater than 0, alerts the user, puts it in the alert box and prints it to the console the files that failed to upload
-			if (GPXData.failedUploads != 0) {
+			if (summary.failedFiles != 0) {
 				console.log(
-					`Files failed to upload and was removed: ${GPXData.failedUploads}`
+					`Files failed to upload and was removed: ${summary.failedFiles}`
 				);
 				$("#statusContainer").append(
-					`<p>Files failed to upload and was removed: ${GPXData.failedUploads}</p>`
+					`<p>Files failed to upload and was removed: ${summary.failedFiles}</p>`
 				);
 				alert(
-					`Files failed to upload and was removed: ${GPXData.failedUploads}`
+					`Files failed to upload and was removed: ${summary.failedFiles}`
 				);
 			}
 		},
@@ -104,22 +107,28 @@ $(document).ready(function () {
 	$("#FindPathTable").hide();
 });
 
-// Function to load the file table without the on-load
-function loadFileTable() {
+// The summary of every uploaded file with its routes and tracks, loaded with the file table
+let uploadsSummary = { files: [], failedFiles: [] };
+
+// Function to load the file table without the on-load, calling onLoaded once the summary has been loaded
+function loadFileTable(onLoaded) {
 	// Ajax get request to fill the file log table
 	$.ajax({
-		// Get request for a json data type from /GPXattributes
+		// Get request for a json data type from /uploadsSummary, the summary of every file with its routes and tracks
 		type: "get",
 		dataType: "json",
-		url: "/GPXattributes",
+		url: "/uploadsSummary",
 		// Function if the get request is successful
-		success: function (GPXData) {
+		success: function (summary) {
 			// Removing the rows off the table so that it can be reappended later and the file drop down
 			$("#FileLogRows tr").remove();
 			$("#fileDropdownMenu button").remove();
 
-			// Traverses through the array of objects, GPXData contains only valid GPX files as only valid GPX files were included on the server side
-			$.each(GPXData.JSONObjectArray, function (i, data) {
+			// Keeping the summary so that the routes and tracks of a file can be shown without another request
+			uploadsSummary = summary;
+
+			// Traverses through the array of objects, the summary contains only valid GPX files as the invalid ones were removed on the server side
+			$.each(summary.files, function (i, data) {
 				// Appends the GPX file data onto the first table giving various alert messages to the alert box
 				$("#FileLogRows").append(`<tr>
                 <th scope="row"><a href="../uploads/${data.fileName}" download ">${data.fileName}</a></th>
@@ -137,17 +146,22 @@ function loadFileTable() {
 			});
 
 			// If the failed uploads is greater than 0, alerts the user, puts it in the alert box and prints it to the console the files that failed to upload
-			if (GPXData.failedUploads != 0) {
+			if (summary.failedFiles != 0) {
 				console.log(
-					`Files failed to upload and was removed: ${GPXData.failedUploads}`
+					`Files failed to upload and was removed: ${summary.failedFiles}`
 				);
 				$("#statusContainer").append(
-					`<p>Files failed to upload and was removed: ${GPXData.failedUploads}</p>`
+					`<p>Files failed to upload and was removed: ${summary.failedFiles}</p>`
 				);
 				alert(
-					`Files failed to upload and was removed: ${GPXData.failedUploads}`
+					`Files failed to upload and was removed: ${summary.failedFiles}`
 				);
 			}
+
+			// Updating anything shown from the summary, such as the view panel table
+			if (onLoaded !== undefined) {
+				onLoaded();
+			}
 		},
 		// Function if the get request is unsuccessful for any reason, appends the error message onto the alert box and sends an error message to the console
 		fail: function (error) {
@@ -195,110 +209,81 @@ function dropDownFunction(fileName) {
 	// Setting the current file to be viewed variable getting the innerHTML of the button the user clicked on
 	currentFile = fileName.innerHTML;
 
-	// Making a get request for the route and track data of the user selected file
-	$.ajax({
-		// Get request for a JSON data type from /RouteListData
-		type: "get",
-		data: "json",
-		url: "/componentData",
-		// Function if the get request is successful
-		success: function (componentData) {
-			// Removing the contents of the table upon the user choosing a file and also removing the buttons in the "Show other Data" and "Rename" modal
-			$("#ViewPanelRows tr").remove();
-			$("#ContainerForOtherDataButtons button").remove();
-			$("#ContainerForRenameComponentButtons button").remove();
-
-			// Traverses through the array of arrays containing JSON strings of routes
-			$.each(componentData.routeData, function (i, data) {
-				// If the array isn't empty, traverses through the array
-				if (data !== "[]") {
-					// Traversing through the JSON strings in the array
-					$.each(data, function (i, JSONString) {
-						// If the JSON string matches the respective file chosen by the user, appends the file routes to the table
-						if (JSONString.fileName === fileName.innerHTML) {
-							$("#ViewPanelRows").append(`<tr>
-							<th scope="row">Route ${i + 1}</th>
-							<th>${JSONString.name}</th>
-							<th>${JSONString.numPoints}</th>
-							<th>${JSONString.len}</th>
-							<th>${JSONString.loop}</th>
-							</tr>`);
-
-							// Appends the components as buttons onto the modal that shows when the "Show other data" and "Rename" button is pressed
-							$("#ContainerForOtherDataButtons").append(`<button
-								type="button"
-								id="ComponentButton"
-								class="btn btn-primary Button"
-								onclick="showData(this)"
-								data-dismiss="modal"
-							>Route ${i + 1}</button>`);
-							$("#ContainerForRenameComponentButtons").append(`<button
-							type="button"
-							id="RenameComponentButton"
-							class="btn btn-primary Button"
-							onclick="renameData(this)"
-							data-dismiss="modal"
-							data-toggle="modal"
-							data-target="#RenameForm"
-							>Route ${i + 1}</button>`);
-						}
-					});
-				}
-			});
+	// Removing the contents of the table upon the user choosing a file and also removing the buttons in the "Show other Data" and "Rename" modal
+	$("#ViewPanelRows tr").remove();
+	$("#ContainerForOtherDataButtons button").remove();
+	$("#ContainerForRenameComponentButtons button").remove();
 
-			// Travereses through the array of arrays containing JSON strings of tracks
-			$.each(componentData.trackData, function (i, data) {
-				// If the array isn't empty, traverses through the array
-				if (data !== "[]") {
-					// Traversing through the JSON strings in the array
-					$.each(data, function (i, JSONString) {
-						// If the JSON string matches the respective file chosen by the user, appends the file tracks to the table
-						if (JSONString.fileName === fileName.innerHTML) {
-							$("#ViewPanelRows").append(`<tr>
-							<th scope="row">Track ${i + 1}</th>
-							<th>${JSONString.name}</th>
-							<th>${JSONString.numPoints}</th>
-							<th>${JSONString.len}</th>
-							<th>${JSONString.loop}</th>
-							</tr>`);
+	// The routes and tracks of the file are taken from the summary loaded with the file table, so no other request is made
+	let file = uploadsSummary.files.find(
+		(summary) => summary.fileName === fileName.innerHTML
+	);
+	if (file !== undefined) {
+		// Appends the file routes to the table
+		$.each(file.routes, function (i, route) {
+			$("#ViewPanelRows").append(`<tr>
+			<th scope="row">Route ${i + 1}</th>
+			<th>${route.name}</th>
+			<th>${route.numPoints}</th>
+			<th>${route.len}</th>
+			<th>${route.loop}</th>
+			</tr>`);
+
+			// Appends the components as buttons onto the modal that shows when the "Show other data" and "Rename" button is pressed
+			$("#ContainerForOtherDataButtons").append(`<button
+				type="button"
+				id="ComponentButton"
+				class="btn btn-primary Button"
+				onclick="showData(this)"
+				data-dismiss="modal"
+			>Route ${i + 1}</button>`);
+			$("#ContainerForRenameComponentButtons").append(`<button
+			type="button"
+			id="RenameComponentButton"
+			class="btn btn-primary Button"
+			onclick="renameData(this)"
+			data-dismiss="modal"
+			data-toggle="modal"
+			data-target="#RenameForm"
+			>Route ${i + 1}</button>`);
+		});
 
-							// Appends the components as buttons onto the modal that shows when the "Show other data" and "Rename button is pressed
-							$("#ContainerForOtherDataButtons").append(`<button
-								type="button"
-								id="ComponentButton"
-								class="btn btn-primary Button"
-								onclick="showData(this)"
-								data-dismiss="modal"
-							>Track ${i + 1}</button>`);
-							$("#ContainerForRenameComponentButtons").append(`<button
-							type="button"
-							id="RenameComponentButton"
-							class="btn btn-primary Button"
-							onclick="renameData(this)"
-							data-dismiss="modal"
-							data-toggle="modal"
-							data-target="#RenameForm"
-							>Track ${i + 1}</button>`);
-						}
-					});
-				}
-			});
+		// Appends the file tracks to the table
+		$.each(file.tracks, function (i, track) {
+			$("#ViewPanelRows").append(`<tr>
+			<th scope="row">Track ${i + 1}</th>
+			<th>${track.name}</th>
+			<th>${track.numPoints}</th>
+			<th>${track.len}</th>
+			<th>${track.loop}</th>
+			</tr>`);
+
+			// Appends the components as buttons onto the modal that shows when the "Show other data" and "Rename button is pressed
+			$("#ContainerForOtherDataButtons").append(`<button
+				type="button"
+				id="ComponentButton"
+				class="btn btn-primary Button"
+				onclick="showData(this)"
+				data-dismiss="modal"
+			>Track ${i + 1}</button>`);
+			$("#ContainerForRenameComponentButtons").append(`<button
+			type="button"
+			id="RenameComponentButton"
+			class="btn btn-primary Button"
+			onclick="renameData(this)"
+			data-dismiss="modal"
+			data-toggle="modal"
+			data-target="#RenameForm"
+			>Track ${i + 1}</button>`);
+		});
+	}
 
-			// If there were no components for the file, puts it in the table
-			if ($("#ViewPanelRows tr").length === 0) {
-				$("#ViewPanelRows").append(`<tr>
-				<th scope="row">This file has no components</th>
-				</tr>`);
-			}
-		},
-		// Function if the get request is unsuccessful for any reason, appends the error message onto the alert box and sends an error message to the console
-		fail: function (error) {
-			$("#statusContainer").append(
-				`<p>Error with get request for components for a GPX file</p>`
-			);
-			console.log("Error with get request for components for a GPX file");
-		},
-	});
+	// If there were no components for the file, puts it in the table
+	if ($("#ViewPanelRows tr").length === 0) {
+		$("#ViewPanelRows").append(`<tr>
+		<th scope="row">This file has no components</th>
+		</tr>`);
+	}
 }
 
 // Error check to send an error message to the user that they must choose a file before trying to press "Show Other Data"
@@ -439,8 +424,10 @@ $("#RenameSubmitButton").on("click", function () {
 			// Sends a user an alert about the status of the renaming
 			alert(`Rename Status:\n\n${data.status}!`);
 
-			// Calls on the dropDownFunction to update the view panel table
-			dropDownFunction(currentFileButton);
+			// Reloads the summary and calls on the dropDownFunction to update the view panel table with the new name
+			loadFileTable(function () {
+				dropDownFunction(currentFileButton);
+			});
 
 			// Adding it to the console log and alert box
 			$("#statusContainer").append(
@@ -613,17 +600,17 @@ $("#AddRouteContainer").on("click", function () {
 	}
 	// If the waypointsArray length is not 0, means that there is a waypoint to be added and adds the route to the file
 	else {
-		// Gets the route name the user wants and stores it inside a JSON
-		let routeName = { name: $("#newRouteName").val() };
+		// Gets the route name the user wants and stores it inside a JSON along with its waypoints
+		let route = { name: $("#newRouteName").val(), points: waypointsArray };
 
-		// Sends a post request to create a new route within the file specified by the user
+		// Sends a post request to create the new route and its waypoints within the file specified by the user
 		$.ajax({
 			// Post request to send data to "/routeCreate" to create a new route
 			url: "/routeCreate",
 			type: "post",
 			data: {
 				fileName: currentFile, // Sends the current file the user wants to add the route to
-				routeName: JSON.stringify(routeName), // Sends the route the user wants as a JSON string
+				routes: JSON.stringify([route]), // Sends the routes the user wants as a JSON string
 			},
 			// Function if the post request succeeds
 			success: function (response) {
@@ -647,44 +634,10 @@ $("#AddRouteContainer").on("click", function () {
 			},
 		});
 
-		// If there are waypoints entered by the user, adds those waypoints to the route
-		if (waypointsArray.length != 0) {
-			// Sends a post request to add the current waypoint to the route
-			$.ajax({
-				type: "post",
-				url: "/addWaypoint",
-				data: {
-					fileName: currentFile, // Sends the current file the user wants to add the waypoints to
-					waypoint: waypointsArray, // Sends the array of waypoints to the post request
-				},
-				// Function if the post request succeeds
-				success: function (response) {
-					if (response === "FAIL") {
-						$("#statusContainer").append(
-							`<p>Error adding waypoints to route</p>`
-						);
-						console.log("Error adding waypoints to route");
-						alert("Error adding waypoints to route");
-					} else {
-						$("#statusContainer").append(
-							`<p>Successfully added waypoints to the new route</p>`
-						);
-						console.log("Successfully added waypoints to the new route");
-					}
-				},
-				// Function if the post request fails for any reason
-				fail: function (error) {
-					$("#statusContainer").append(
-						`<p>Error with post request to add waypoints to the route</p>`
-					);
-					console.log("Error with post request to add waypoints to the route");
-				},
-			});
-		}
-
 		// Loading the new file log table and gpx view panel
-		loadFileTable();
-		dropDownFunction(currentFileButton);
+		loadFileTable(function () {
+			dropDownFunction(currentFileButton);
+		});
 
 		// Resetting the latitude, longitude forms, the waypointsArray, the area showing the waypoints and the route name form
 		$("#newRouteName").val("");